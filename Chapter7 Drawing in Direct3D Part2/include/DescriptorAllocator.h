@@ -0,0 +1,155 @@
+/*
+描述符堆内的索引分配逻辑（纯 CPU，不依赖 D3D12，可以直接在 Linux 上测试）。
+DescriptorFreeList：常驻区域，按连续区间分配，释放后与相邻空闲区间合并；
+分配到的起始索引在释放之前不会移动，所以句柄可以长期保存。
+空闲区间同时按起始索引（用于合并）和按长度（用于分配）索引，分配和释放都是 O(log n)，
+碎片很多时也不用逐个扫描空闲区间。
+DescriptorLinearAllocator：每帧的临时区域，只推进偏移量，帧的围栏完成后整体 Reset。
+*/
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <set>
+#include <utility>
+
+class DescriptorFreeList
+{
+public:
+    static constexpr std::uint32_t InvalidIndex = 0xffffffff;
+
+    DescriptorFreeList() = default;
+    explicit DescriptorFreeList(std::uint32_t capacity) :
+        mCapacity(capacity)
+    {
+        if(capacity > 0)
+        {
+            mFreeRanges.emplace(0, capacity);
+            mBySize.emplace(capacity, 0);
+        }
+    }
+
+    // 最佳适配：取放得下的最短空闲区间，同样长时取起始索引最低的；空间不足时返回 InvalidIndex
+    std::uint32_t Allocate(std::uint32_t count)
+    {
+        if(count == 0)
+            return InvalidIndex;
+
+        auto best = mBySize.lower_bound({ count, 0 });
+        if(best == mBySize.end())
+            return InvalidIndex;
+
+        std::uint32_t length = best->first;
+        std::uint32_t start = best->second;
+        mBySize.erase(best);
+
+        auto it = mFreeRanges.find(start);
+        if(length == count)
+        {
+            mFreeRanges.erase(it);
+        }
+        else
+        {
+            // 顺序不变，复用节点只改起始索引，避免重新分配内存
+            auto hint = std::next(it);
+            auto node = mFreeRanges.extract(it);
+            node.key() += count;
+            node.mapped() -= count;
+            mFreeRanges.insert(hint, std::move(node));
+            mBySize.emplace(length - count, start + count);
+        }
+
+        mAllocated += count;
+        return start;
+    }
+
+    // start/count 必须与 Allocate 时一致
+    void Free(std::uint32_t start, std::uint32_t count)
+    {
+        if(start == InvalidIndex || count == 0)
+            return;
+
+        mAllocated -= count;
+
+        // 空闲区间按起始索引有序保存，插入时与前后区间合并
+        auto next = mFreeRanges.lower_bound(start);
+        if(next != mFreeRanges.end() && start + count == next->first)
+        {
+            mBySize.erase({ next->second, next->first });
+            count += next->second;
+            next = mFreeRanges.erase(next);
+        }
+
+        if(next != mFreeRanges.begin())
+        {
+            auto prev = std::prev(next);
+            if(prev->first + prev->second == start)
+            {
+                mBySize.erase({ prev->second, prev->first });
+                prev->second += count;
+                mBySize.emplace(prev->second, prev->first);
+                return;
+            }
+        }
+
+        mFreeRanges.emplace_hint(next, start, count);
+        mBySize.emplace(count, start);
+    }
+
+    std::uint32_t Capacity()const { return mCapacity; }
+    std::uint32_t AllocatedCount()const { return mAllocated; }
+    std::uint32_t FreeRangeCount()const { return (std::uint32_t)mFreeRanges.size(); }
+
+    std::uint32_t LargestFreeRange()const
+    {
+        return mBySize.empty() ? 0 : mBySize.rbegin()->first;
+    }
+
+private:
+    std::uint32_t mCapacity = 0;
+    std::uint32_t mAllocated = 0;
+    std::map<std::uint32_t, std::uint32_t> mFreeRanges; // 起始索引 -> 个数
+    std::set<std::pair<std::uint32_t, std::uint32_t>> mBySize; // (个数, 起始索引)，与 mFreeRanges 一一对应
+};
+
+class DescriptorLinearAllocator
+{
+public:
+    static constexpr std::uint32_t InvalidIndex = 0xffffffff;
+
+    DescriptorLinearAllocator() = default;
+    // base 是这段区域在整个描述符堆里的起始索引
+    DescriptorLinearAllocator(std::uint32_t base, std::uint32_t capacity) :
+        mBase(base),
+        mCapacity(capacity)
+    {
+    }
+
+    // 返回堆内的绝对索引，空间不足时返回 InvalidIndex
+    std::uint32_t Allocate(std::uint32_t count)
+    {
+        if(count == 0 || count > mCapacity - mOffset)
+            return InvalidIndex;
+
+        std::uint32_t index = mBase + mOffset;
+        mOffset += count;
+        if(mOffset > mHighWatermark)
+            mHighWatermark = mOffset;
+        return index;
+    }
+
+    // 只有在 GPU 不再读取这段描述符（围栏已完成）之后才能调用
+    void Reset() { mOffset = 0; }
+
+    std::uint32_t Base()const { return mBase; }
+    std::uint32_t Capacity()const { return mCapacity; }
+    std::uint32_t Used()const { return mOffset; }
+    std::uint32_t HighWatermark()const { return mHighWatermark; }
+
+private:
+    std::uint32_t mBase = 0;
+    std::uint32_t mCapacity = 0;
+    std::uint32_t mOffset = 0;
+    std::uint32_t mHighWatermark = 0;
+};
@@ -0,0 +1,94 @@
+/*
+描述符管理：
+1. 着色器可见堆 = [常驻区域 | 第0帧临时区域 | 第1帧临时区域 | ...]。
+   常驻区域用 DescriptorFreeList 分配，句柄稳定，可以在运行时增删物体；
+   每帧的临时区域是线性分配，帧开始时（该帧围栏已完成）整体回收。
+2. 暂存堆（CPU-only，不可着色器访问）：描述符先在这里创建，绘制前把需要的描述符
+   一次 CopyDescriptors 批量复制进当前帧的临时区域。
+*/
+#pragma once
+
+#include "d3dUtil.h"
+#include "DescriptorAllocator.h"
+
+struct DescriptorAllocation
+{
+    UINT Index = DescriptorFreeList::InvalidIndex; // 在所属堆中的起始索引
+    UINT Count = 0;
+    UINT DescriptorSize = 0;
+    D3D12_CPU_DESCRIPTOR_HANDLE CpuStart = {};
+    D3D12_GPU_DESCRIPTOR_HANDLE GpuStart = {}; // 暂存堆中的分配没有 GPU 句柄
+
+    bool IsValid()const { return Index != DescriptorFreeList::InvalidIndex; }
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE CpuHandle(UINT offset = 0)const
+    {
+        return CD3DX12_CPU_DESCRIPTOR_HANDLE(CpuStart, (INT)offset, DescriptorSize);
+    }
+
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GpuHandle(UINT offset = 0)const
+    {
+        return CD3DX12_GPU_DESCRIPTOR_HANDLE(GpuStart, (INT)offset, DescriptorSize);
+    }
+};
+
+class DescriptorHeapManager
+{
+public:
+    DescriptorHeapManager(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+        UINT persistentCapacity, UINT transientCapacityPerFrame, UINT frameCount, UINT stagingCapacity);
+    DescriptorHeapManager(const DescriptorHeapManager& rhs) = delete;
+    DescriptorHeapManager& operator=(const DescriptorHeapManager& rhs) = delete;
+
+    // 常驻区域。释放时传入最后一次使用这些描述符的帧的围栏值，围栏完成后才真正回收
+    DescriptorAllocation AllocatePersistent(UINT count);
+    void FreePersistent(const DescriptorAllocation& alloc, UINT64 fenceValue);
+
+    // 暂存堆。CopyDescriptors 在 CPU 上立即执行，所以暂存描述符可以直接释放
+    DescriptorAllocation AllocateStaging(UINT count);
+    void FreeStaging(const DescriptorAllocation& alloc);
+
+    // 帧开始时调用（该帧资源的围栏已经完成）：回收该帧的临时区域和已完成的延迟释放
+    void BeginFrame(UINT frameIndex, UINT64 completedFence);
+    // 从当前帧的临时区域分配，空间不足时抛出异常
+    DescriptorAllocation AllocateTransient(UINT count);
+
+    // 记录一次复制（src 必须位于暂存堆），FlushCopies 时合并成一次 CopyDescriptors
+    void QueueCopy(const DescriptorAllocation& dest, UINT destOffset, D3D12_CPU_DESCRIPTOR_HANDLE src, UINT count);
+    void FlushCopies();
+
+    ID3D12DescriptorHeap* ShaderVisibleHeap()const { return mShaderVisibleHeap.Get(); }
+    ID3D12DescriptorHeap* StagingHeap()const { return mStagingHeap.Get(); }
+    UINT DescriptorSize()const { return mDescriptorSize; }
+    const DescriptorFreeList& PersistentRegion()const { return mPersistent; }
+    const DescriptorLinearAllocator& TransientRegion(UINT frameIndex)const { return mTransient[frameIndex]; }
+
+private:
+    struct PendingFree
+    {
+        UINT Index = 0;
+        UINT Count = 0;
+        UINT64 FenceValue = 0;
+    };
+
+    DescriptorAllocation MakeShaderVisible(UINT index, UINT count)const;
+
+    ID3D12Device* mDevice = nullptr;
+    D3D12_DESCRIPTOR_HEAP_TYPE mType;
+    UINT mDescriptorSize = 0;
+
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mShaderVisibleHeap;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mStagingHeap;
+
+    DescriptorFreeList mPersistent;
+    DescriptorFreeList mStaging;
+    std::vector<DescriptorLinearAllocator> mTransient;
+    UINT mCurrentFrame = 0;
+    std::vector<PendingFree> mPendingFrees;
+
+    // 待提交的复制：目标与源都是连续区间
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mCopyDestStarts;
+    std::vector<UINT> mCopyDestSizes;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mCopySrcStarts;
+    std::vector<UINT> mCopySrcSizes;
+};
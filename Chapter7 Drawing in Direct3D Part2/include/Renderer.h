@@ -13,6 +13,7 @@
 #include "UploadBuffer.h"
 #include "Camera.h"
 #include "FrameResource.h"
+#include "DescriptorHeapManager.h"
 
 struct RenderItem
 {
@@ -26,6 +27,7 @@ struct RenderItem
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
     int NumFramesDirty = gNumFrameResources;
+    DescriptorAllocation ObjCbvs; //暂存堆中的objCBV，每个帧资源一个（第i个对应第i个帧资源）
 };
 
 class Renderer {
@@ -108,7 +110,12 @@ private:
     //std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
     //std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mCbvHeap = nullptr;
+    //描述符堆：常驻区域 + 每帧临时区域 + CPU暂存堆
+    static constexpr UINT PersistentDescriptorCapacity = 1024;
+    static constexpr UINT TransientDescriptorsPerFrame = 4096;
+    static constexpr UINT StagingDescriptorCapacity = 16384;
+    std::unique_ptr<DescriptorHeapManager> mDescriptors;
+    DescriptorAllocation mPassCbvs; //常驻区域中的passCBV，每个帧资源一个
     std::unique_ptr<UploadBuffer<ObjectConstants>> objCB = nullptr;
     std::unique_ptr<UploadBuffer<PassConstants>> passCB = nullptr;
     std::unique_ptr<MeshGeometry> geo = nullptr;
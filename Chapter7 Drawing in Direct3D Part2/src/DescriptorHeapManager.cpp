@@ -0,0 +1,146 @@
+#include "DescriptorHeapManager.h"
+#include <stdexcept>
+
+DescriptorHeapManager::DescriptorHeapManager(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+    UINT persistentCapacity, UINT transientCapacityPerFrame, UINT frameCount, UINT stagingCapacity) :
+    mDevice(device),
+    mType(type),
+    mPersistent(persistentCapacity),
+    mStaging(stagingCapacity)
+{
+    mDescriptorSize = mDevice->GetDescriptorHandleIncrementSize(type);
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+    heapDesc.NumDescriptors = persistentCapacity + transientCapacityPerFrame * frameCount;
+    heapDesc.Type = type;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    heapDesc.NodeMask = 0;
+    ThrowIfFailed(mDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mShaderVisibleHeap)));
+    d3dSetDebugName(mShaderVisibleHeap.Get(), "ShaderVisibleDescriptorHeap");
+
+    // 暂存堆不能设置 SHADER_VISIBLE，CPU 读取它（CopyDescriptors 的源）才是高效的
+    heapDesc.NumDescriptors = stagingCapacity;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    ThrowIfFailed(mDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mStagingHeap)));
+    d3dSetDebugName(mStagingHeap.Get(), "StagingDescriptorHeap");
+
+    for(UINT i = 0; i < frameCount; ++i)
+        mTransient.emplace_back(persistentCapacity + transientCapacityPerFrame * i, transientCapacityPerFrame);
+}
+
+DescriptorAllocation DescriptorHeapManager::MakeShaderVisible(UINT index, UINT count)const
+{
+    DescriptorAllocation alloc;
+    alloc.Index = index;
+    alloc.Count = count;
+    alloc.DescriptorSize = mDescriptorSize;
+    alloc.CpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(mShaderVisibleHeap->GetCPUDescriptorHandleForHeapStart(), (INT)index, mDescriptorSize);
+    alloc.GpuStart = CD3DX12_GPU_DESCRIPTOR_HANDLE(mShaderVisibleHeap->GetGPUDescriptorHandleForHeapStart(), (INT)index, mDescriptorSize);
+    return alloc;
+}
+
+DescriptorAllocation DescriptorHeapManager::AllocatePersistent(UINT count)
+{
+    UINT index = mPersistent.Allocate(count);
+    if(index == DescriptorFreeList::InvalidIndex)
+        throw std::runtime_error("DescriptorHeapManager: persistent descriptor region is full");
+
+    return MakeShaderVisible(index, count);
+}
+
+void DescriptorHeapManager::FreePersistent(const DescriptorAllocation& alloc, UINT64 fenceValue)
+{
+    if(!alloc.IsValid())
+        return;
+
+    PendingFree pending;
+    pending.Index = alloc.Index;
+    pending.Count = alloc.Count;
+    pending.FenceValue = fenceValue;
+    mPendingFrees.push_back(pending);
+}
+
+DescriptorAllocation DescriptorHeapManager::AllocateStaging(UINT count)
+{
+    UINT index = mStaging.Allocate(count);
+    if(index == DescriptorFreeList::InvalidIndex)
+        throw std::runtime_error("DescriptorHeapManager: staging descriptor heap is full");
+
+    DescriptorAllocation alloc;
+    alloc.Index = index;
+    alloc.Count = count;
+    alloc.DescriptorSize = mDescriptorSize;
+    alloc.CpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(mStagingHeap->GetCPUDescriptorHandleForHeapStart(), (INT)index, mDescriptorSize);
+    return alloc;
+}
+
+void DescriptorHeapManager::FreeStaging(const DescriptorAllocation& alloc)
+{
+    if(alloc.IsValid())
+        mStaging.Free(alloc.Index, alloc.Count);
+}
+
+void DescriptorHeapManager::BeginFrame(UINT frameIndex, UINT64 completedFence)
+{
+    mCurrentFrame = frameIndex;
+    mTransient[frameIndex].Reset();
+
+    size_t kept = 0;
+    for(size_t i = 0; i < mPendingFrees.size(); ++i)
+    {
+        if(mPendingFrees[i].FenceValue <= completedFence)
+            mPersistent.Free(mPendingFrees[i].Index, mPendingFrees[i].Count);
+        else
+            mPendingFrees[kept++] = mPendingFrees[i];
+    }
+    mPendingFrees.resize(kept);
+}
+
+DescriptorAllocation DescriptorHeapManager::AllocateTransient(UINT count)
+{
+    UINT index = mTransient[mCurrentFrame].Allocate(count);
+    if(index == DescriptorLinearAllocator::InvalidIndex)
+        throw std::runtime_error("DescriptorHeapManager: transient descriptor ring is full");
+
+    return MakeShaderVisible(index, count);
+}
+
+void DescriptorHeapManager::QueueCopy(const DescriptorAllocation& dest, UINT destOffset, D3D12_CPU_DESCRIPTOR_HANDLE src, UINT count)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE destStart = dest.CpuHandle(destOffset);
+
+    // 目标和源都紧接着上一次复制时，直接延长上一段，减少区间个数
+    if(!mCopyDestStarts.empty())
+    {
+        size_t last = mCopyDestStarts.size() - 1;
+        bool destContiguous = mCopyDestStarts[last].ptr + (SIZE_T)mCopyDestSizes[last] * mDescriptorSize == destStart.ptr;
+        bool srcContiguous = mCopySrcStarts[last].ptr + (SIZE_T)mCopySrcSizes[last] * mDescriptorSize == src.ptr;
+        if(destContiguous && srcContiguous)
+        {
+            mCopyDestSizes[last] += count;
+            mCopySrcSizes[last] += count;
+            return;
+        }
+    }
+
+    mCopyDestStarts.push_back(destStart);
+    mCopyDestSizes.push_back(count);
+    mCopySrcStarts.push_back(src);
+    mCopySrcSizes.push_back(count);
+}
+
+void DescriptorHeapManager::FlushCopies()
+{
+    if(mCopyDestStarts.empty())
+        return;
+
+    mDevice->CopyDescriptors(
+        (UINT)mCopyDestStarts.size(), mCopyDestStarts.data(), mCopyDestSizes.data(),
+        (UINT)mCopySrcStarts.size(), mCopySrcStarts.data(), mCopySrcSizes.data(),
+        mType);
+
+    mCopyDestStarts.clear();
+    mCopyDestSizes.clear();
+    mCopySrcStarts.clear();
+    mCopySrcSizes.clear();
+}
@@ -246,58 +246,44 @@ void Renderer::CreateDepthStencilBuffer()
 }
 
 void Renderer::BuildDescriptorHeaps(){
-    UINT objectCount = (UINT)mAllRitems.size();
-
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = (objectCount + 1)*gNumFrameResources; ////此处一个堆中包含(几何体个数（包含实例）+1)个CBV
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    cbvHeapDesc.NodeMask = 0;
-
-    ThrowIfFailed(m_device->CreateDescriptorHeap(&cbvHeapDesc,IID_PPV_ARGS(&mCbvHeap)));
+    //着色器可见堆分为常驻区域和每帧的临时区域，另有一个CPU暂存堆存放各物体的CBV，
+    //容量与物体个数无关，运行时可以增删物体
+    mDescriptors = std::make_unique<DescriptorHeapManager>(m_device.Get(),
+        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+        PersistentDescriptorCapacity,
+        TransientDescriptorsPerFrame,
+        gNumFrameResources,
+        StagingDescriptorCapacity);
 }
 
 void Renderer::BuildConstantBuffers(){
-    //创建objCB
-    UINT objectCount = (UINT)mAllRitems.size();
+    //创建objCB：每个物体在暂存堆中占gNumFrameResources个描述符
     UINT objConstSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 
-    //循环遍历
-    for(int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex){
-        std::cout << objectCount << std::endl;
-        //auto objectCB = FrameResourcesArray[frameIndex]->ObjectCB->Resource();
+    for(auto& ritem : mAllRitems){
+        ritem->ObjCbvs = mDescriptors->AllocateStaging(gNumFrameResources);
 
-        for(UINT i = 0; i < objectCount; ++i){
+        for(int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex){
             D3D12_GPU_VIRTUAL_ADDRESS objCB_Address = mFrameResources[frameIndex]->ObjectCB->Resource()->GetGPUVirtualAddress();
-            int objCbElementIndex = i;
-            objCB_Address += objCbElementIndex * objConstSize;//子物体在常量缓冲区中的地址
-            int heapIndex = frameIndex*objectCount + i;	//CBV堆中的CBV元素索引
-            auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCbvHeap->GetCPUDescriptorHandleForHeapStart());//获得CBV堆首地址
-            handle.Offset(heapIndex, m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));	//CBV句柄（CBV堆中的CBV元素地址）
+            objCB_Address += ritem->ObjCBIndex * objConstSize;//子物体在常量缓冲区中的地址
 
             //创建CBV描述符
             D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
             cbvDesc.BufferLocation = objCB_Address;
             cbvDesc.SizeInBytes = objConstSize;
-            m_device->CreateConstantBufferView(&cbvDesc, handle);
+            m_device->CreateConstantBufferView(&cbvDesc, ritem->ObjCbvs.CpuHandle(frameIndex));
         }
     }
 
-    //创建passCB
+    //创建passCB：常驻区域，直接写入着色器可见堆
     UINT passCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
+    mPassCbvs = mDescriptors->AllocatePersistent(gNumFrameResources);
 
     for(int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex){
-        D3D12_GPU_VIRTUAL_ADDRESS cbAddress1;
-        cbAddress1 = mFrameResources[frameIndex]->PassCB->Resource()->GetGPUVirtualAddress();
-
         D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc1;
-        cbvDesc1.BufferLocation = cbAddress1;
+        cbvDesc1.BufferLocation = mFrameResources[frameIndex]->PassCB->Resource()->GetGPUVirtualAddress();
         cbvDesc1.SizeInBytes = passCBByteSize;
-
-        int heapIndex1 = objectCount * gNumFrameResources + frameIndex;
-        auto handle1 = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCbvHeap->GetCPUDescriptorHandleForHeapStart());
-        handle1.Offset(heapIndex1, m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-        m_device->CreateConstantBufferView(&cbvDesc1, handle1);
+        m_device->CreateConstantBufferView(&cbvDesc1, mPassCbvs.CpuHandle(frameIndex));
     }
 }
 
@@ -595,6 +581,8 @@ void Renderer::Update()
         WaitForSingleObject(eventHandle, INFINITE);
         CloseHandle(eventHandle);
     }
+    //该帧资源已空闲，回收它的临时描述符
+    mDescriptors->BeginFrame(mCurrFrameResourceIndex, m_fence->GetCompletedValue());
     UpdateObjectCBs();
     UpdateMainPassCB();
 
@@ -636,6 +624,15 @@ void Renderer::UpdateMainPassCB(){
 
 void Renderer::DrawRenderItems(ID3D12GraphicsCommandList* m_commandList,const std::vector<RenderItem*>& ritems){
 
+    if(ritems.empty())
+        return;
+
+    //把本帧要用的objCBV从暂存堆批量复制到当前帧的临时区域（一次CopyDescriptors）
+    DescriptorAllocation objCbvTable = mDescriptors->AllocateTransient((UINT)ritems.size());
+    for (size_t i = 0; i < ritems.size(); i++)
+        mDescriptors->QueueCopy(objCbvTable, (UINT)i, ritems[i]->ObjCbvs.CpuHandle(mCurrFrameResourceIndex), 1);
+    mDescriptors->FlushCopies();
+
     //遍历渲染项数组
 	for (size_t i = 0; i < ritems.size(); i++)
 	{
@@ -646,11 +643,8 @@ void Renderer::DrawRenderItems(ID3D12GraphicsCommandList* m_commandList,const st
 		m_commandList->IASetPrimitiveTopology(ritem->PrimitiveType);
 
 		//设置根描述符表
-		UINT objCbvIndex = mCurrFrameResourceIndex*(UINT)mAllRitems.size() + ritem->ObjCBIndex;
-		auto handle = CD3DX12_GPU_DESCRIPTOR_HANDLE(mCbvHeap->GetGPUDescriptorHandleForHeapStart());
-		handle.Offset(objCbvIndex, m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
 		m_commandList->SetGraphicsRootDescriptorTable(0, //根参数的起始索引
-			handle);
+			objCbvTable.GpuHandle((UINT)i));
 
 		//绘制顶点（通过索引缓冲区绘制）
 		m_commandList->DrawIndexedInstanced(ritem->IndexCount, //每个实例要绘制的索引数
@@ -684,15 +678,12 @@ void Renderer::Render()
 
     // 设置我们要渲染的buffer
     m_commandList->OMSetRenderTargets(1, &CurrentBackBufferView(), TRUE, &DepthStencilView()); //RTV
-    ID3D12DescriptorHeap* descriptorHeaps[] = { mCbvHeap.Get() };
+    ID3D12DescriptorHeap* descriptorHeaps[] = { mDescriptors->ShaderVisibleHeap() };
     m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps); //CBV
     m_commandList->SetGraphicsRootSignature(m_rootSignature.Get()); //RootSignature
 
     //绑定passCbv
-    int passCbvIndex = (int)mAllRitems.size() * gNumFrameResources + mCurrFrameResourceIndex;
-    auto handle1 = CD3DX12_GPU_DESCRIPTOR_HANDLE(mCbvHeap->GetGPUDescriptorHandleForHeapStart());
-    handle1.Offset(passCbvIndex, m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-    m_commandList->SetGraphicsRootDescriptorTable(1, handle1);
+    m_commandList->SetGraphicsRootDescriptorTable(1, mPassCbvs.GpuHandle(mCurrFrameResourceIndex));
 
     //渲染几何体
     DrawRenderItems(m_commandList.Get(),mOpaqueRitems);
@@ -12,17 +12,29 @@
 
 #include "LightingUtil.hlsl"
 
-cbuffer cbPerObject : register(b0)
+//ObjectConstants 和 MaterialConstants 与 C++ 共用同一份定义，布局在 C++ 端编译期检查
+#include "../include/ShaderShared.h"
+
+//物体表分两层：静态层在默认堆里，动态层每帧写在上传堆里
+StructuredBuffer<ObjectConstants> gStaticObjects : register(t2);
+StructuredBuffer<ObjectConstants> gDynamicObjects : register(t3);
+
+//实例缓冲区：每个实例对应的物体下标，最高位为 1 表示动态层，其余位是层内槽位
+StructuredBuffer<uint> gInstanceObjects : register(t0);
+
+//本次绘制的第一个实例在 gInstanceObjects 中的下标（根常量）
+cbuffer cbInstance : register(b0)
 {
-	float4x4 gWorld; 
+	uint gBaseInstance;
 };
 
-cbuffer cbMaterial : register(b1)
+//材质表：所有材质紧密排列在一个 StructuredBuffer 里
+StructuredBuffer<MaterialConstants> gMaterialData : register(t1);
+
+//本次绘制使用的材质在 gMaterialData 中的下标（根常量）
+cbuffer cbMaterialIndex : register(b1)
 {
-    float4 gDiffuseAlbedo; //材质反照率
-    float3 gFresnelR0; //RF(0)值，即材质的反射属性
-    float gRoughness; //材质的粗糙度
-	float4x4 gMatTransform;
+    uint gMaterialIndex;
 };
 
 cbuffer cbPass : register(b2)
@@ -47,17 +59,27 @@ struct VertexOut
 	float3 WorldNormal : NORMAL;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceID : SV_InstanceID)
 {
 	VertexOut vout;
 
-    float4 PosW = mul(float4(vin.PosL, 1.0f), gWorld);
-    vout.WorldPos = PosW.xyz;
+    //SV_InstanceID 不包含 StartInstanceLocation，所以基准下标通过根常量传入
+    uint objectIndex = gInstanceObjects[gBaseInstance + instanceID];
+    uint objectSlot = objectIndex & 0x7FFFFFFF;
+    //World 是世界矩阵转置后的前 3 行，所以矩阵在左边。同一次绘制的实例通常在同一层，分支基本一致
+    float3x4 gWorld;
+    if((objectIndex & 0x80000000) != 0)
+        gWorld = gDynamicObjects[objectSlot].World;
+    else
+        gWorld = gStaticObjects[objectSlot].World;
+
+    float3 PosW = mul(gWorld, float4(vin.PosL, 1.0f));
+    vout.WorldPos = PosW;
     
     //只做均匀缩放，所以可以不使用逆转置矩阵
-    vout.WorldNormal = mul(vin.Normal, (float3x3)gWorld);
+    vout.WorldNormal = mul((float3x3)gWorld, vin.Normal);
     
-   	vout.PosH = mul(PosW, gViewProj); 
+   	vout.PosH = mul(float4(PosW, 1.0f), gViewProj); 
     
     return vout;
 }
@@ -67,7 +89,9 @@ float4 PS(VertexOut pin) : SV_Target
     float3 worldNormal = normalize(pin.WorldNormal);
     float3 worldView = normalize(gEyePosW - pin.WorldPos);
     
-    Material mat = { gDiffuseAlbedo, gFresnelR0, gRoughness };
+    MaterialConstants matData = gMaterialData[gMaterialIndex];
+    float4 gDiffuseAlbedo = matData.DiffuseAlbedo;
+    Material mat = { matData.DiffuseAlbedo, matData.FresnelR0, matData.Roughness };
     float3 shadowFactor = 1.0f;//暂时使用1.0，不对计算产生影响
     //直接光照
     float4 directLight = ComputerLighting(gLights, mat, pin.WorldPos, worldNormal, worldView, shadowFactor);
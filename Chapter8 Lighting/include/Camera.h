@@ -1,6 +1,7 @@
 #pragma once
 
 #include <DirectXMath.h>
+#include <cstdint>
 
 class Camera {
 public:
@@ -19,6 +20,9 @@ public:
     DirectX::XMMATRIX GetViewMatrix() const;
     DirectX::XMFLOAT3 GetPosition() const;
 
+    // 视图矩阵每更新一次加一，使用者和上次记下的值比较就知道摄像机有没有动
+    std::uint64_t Version() const;
+
     // 控制摄像机移动
     void MoveForward(float distance);
     void MoveRight(float distance);
@@ -41,4 +45,7 @@ private:
     float m_pitch; // 俯仰角
 
     float m_speed; // 移动速度
+
+    std::uint64_t m_version = 0;    // 视图矩阵的版本
+    bool m_orbitInitialized = false; // 第一次 Rotate 会把位置放到轨道上，之后没有旋转量时不用重算
 };
\ No newline at end of file
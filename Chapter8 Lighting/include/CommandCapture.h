@@ -0,0 +1,198 @@
+/*
+命令流捕获与回放（不依赖 D3D12）。
+CaptureGraphicsDevice 包在任意 GraphicsDevice 外面：不捕获时只是转发；BeginCapture 之后，
+命令列表在转发的同时把调用写进 CommandStream，提交、Signal 和 CaptureUpload 登记的上传内容
+按发生顺序记录下来，每次 Signal 算一帧，满 frameCount 帧后自动停止。
+内层后端本身就记录命令流时（RecordsCommandStreams，例如 NullGraphicsDevice），CreateCommandList
+直接返回内层的命令列表，录制时没有任何额外开销，提交时复制一次它的命令流。
+命令流和上传内容都追加到同一块字节数组里，记录只保存区间；BeginCapture 时按预估大小一次分配并
+触碰这块内存，捕获期间每帧只是追加复制，不会因为新分配内存的缺页拖慢被捕获的帧。
+捕获结果可以保存成二进制文件，由 CommandReplayer 通过任意后端（通常是 NullGraphicsDevice）
+以最快速度重新提交，用来单独测量提交开销、复现性能问题，或者比较两个版本的命令流。
+
+文件格式（小端）：
+  头部：魔数 "D3DCAP01"、版本 (u32)、帧数 (u32)、记录数 (u64)
+  记录：类型 (u8)，之后
+    Execute：列表数 (u32)，每个列表：字节数 (u64) + 命令流
+    Signal ：围栏值 (u64)
+    Upload ：GPU 地址 (u64)、字节数 (u64) + 数据
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CommandStream.h"
+#include "GraphicsDevice.h"
+
+enum class CaptureRecordKind : std::uint8_t
+{
+    Execute,
+    Signal,
+    Upload
+};
+
+// CommandCapture::Bytes 中的一段
+struct CaptureRange
+{
+    std::uint64_t Offset = 0;
+    std::uint64_t Size = 0;
+};
+
+struct CaptureRecord
+{
+    CaptureRecordKind Kind = CaptureRecordKind::Execute;
+    std::uint64_t Value = 0;           // Signal 的围栏值或 Upload 的 GPU 地址
+    std::vector<CaptureRange> Lists;   // Execute：按提交顺序的命令流
+    CaptureRange Data;                 // Upload：上传内容
+};
+
+struct CommandCapture
+{
+    std::uint32_t FrameCount = 0;
+    std::vector<CaptureRecord> Records;
+    std::vector<std::uint8_t> Bytes;   // 所有命令流和上传内容，Bytes.size() 之后的容量是预留的
+
+    const std::uint8_t* Data(const CaptureRange& range)const { return Bytes.data() + range.Offset; }
+    CaptureRange Append(const void* data, std::size_t byteSize);
+};
+
+bool SaveCommandCapture(const CommandCapture& capture, const std::string& path);
+bool LoadCommandCapture(const std::string& path, CommandCapture& capture);
+
+// 解码一段命令流并逐条调用到 list 上，commandCount/drawCount 非空时累加调用的命令数和绘制数。
+// 流损坏时返回 false（已经解码的部分已经调用）
+bool DispatchCommandStream(const std::uint8_t* bytes, std::size_t byteSize, CommandList& list,
+    std::uint64_t* commandCount = nullptr, std::uint64_t* drawCount = nullptr);
+
+// 每种操作码出现的次数，用于比较两次捕获
+using CommandHistogram = std::array<std::uint64_t, (std::size_t)CommandOp::Count>;
+CommandHistogram CountCommands(const CommandCapture& capture);
+const char* CommandOpName(CommandOp op);
+
+class CaptureGraphicsDevice;
+
+class CaptureCommandList : public CommandList
+{
+public:
+    CaptureCommandList(CaptureGraphicsDevice& device, std::unique_ptr<CommandList> inner);
+
+    void Begin(PipelineHandle initialPipeline) override;
+    void End() override;
+
+    void TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter) override;
+    void ClearRenderTarget(DescriptorHandle rtv, const float color[4]) override;
+    void ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil) override;
+
+    void SetViewport(const ViewportDesc& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv) override;
+    void SetGraphicsRootSignature(RootSignatureHandle rootSignature) override;
+    void SetPipelineState(PipelineHandle pipeline) override;
+    void SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address) override;
+    void SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address) override;
+    void SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset) override;
+
+    void SetVertexBuffer(const VertexBufferBinding& view) override;
+    void SetIndexBuffer(const IndexBufferBinding& view) override;
+    void SetPrimitiveTopology(std::uint32_t topology) override;
+    void DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+        std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation) override;
+    void ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+        ResourceHandle argumentBuffer, std::uint64_t argumentOffset) override;
+    void CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+        ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes) override;
+
+    CommandList* Inner()const { return mInner.get(); }
+    // 这一次录制是否在捕获（Begin 时决定，整条列表保持一致）
+    bool Capturing()const { return mCapturing; }
+    const CommandStreamWriter& Stream()const { return mStream; }
+
+private:
+    CaptureGraphicsDevice& mDevice;
+    std::unique_ptr<CommandList> mInner;
+    CommandStreamWriter mStream;
+    bool mCapturing = false;
+};
+
+class CaptureGraphicsDevice : public GraphicsDevice
+{
+public:
+    explicit CaptureGraphicsDevice(std::unique_ptr<GraphicsDevice> inner);
+
+    // 从下一次 Begin 的命令列表开始捕获 frameCount 帧（每次 Signal 结束一帧）。
+    // reserveBytes 是预计的总字节数（命令流加上传内容），超出时照常增长，只是那一帧会慢一些；
+    // listReserveBytes 是每条命令列表一次录制的预计字节数，捕获时 Begin 按它预先分配命令流
+    // （内层后端记录命令流时不需要）。
+    // 在这之前就已经 Begin 的列表记录为空流；内层后端记录命令流时整条列表都会记录下来
+    void BeginCapture(std::uint32_t frameCount, std::size_t reserveBytes = 0, std::size_t listReserveBytes = 0);
+    bool IsCapturing()const { return mCapturing.load(std::memory_order_acquire); }
+    // 捕获已经结束并且还没有被取走
+    bool HasCompletedCapture()const;
+    CommandCapture TakeCapture();
+
+    // 捕获期间登记一块上传内容（例如这一帧写进上传环的常量），不捕获时直接返回
+    void CaptureUpload(GpuAddress address, const void* data, std::size_t byteSize);
+
+    std::unique_ptr<CommandList> CreateCommandList() override;
+    void ExecuteCommandLists(CommandList* const* lists, std::uint32_t count) override;
+
+    void Signal(std::uint64_t fenceValue) override;
+    std::uint64_t CompletedFenceValue() override;
+    void WaitForFenceValue(std::uint64_t fenceValue) override;
+
+    GraphicsDevice& Inner()const { return *mInner; }
+    // 捕获时每条命令列表预先分配的命令流字节数
+    std::size_t ListReserveBytes()const { return mListReserveBytes.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<GraphicsDevice> mInner;
+    const bool mSharesInnerStreams; // 命令列表就是内层的列表，捕获时复制它们自己的命令流
+    std::atomic<bool> mCapturing{ false };
+    std::atomic<std::size_t> mListReserveBytes{ 0 };
+
+    mutable std::mutex mMutex; // 保护下面的成员
+    std::uint32_t mFramesRemaining = 0;
+    bool mCompleted = false;
+    CommandCapture mCapture;
+    std::vector<CommandList*> mInnerLists;
+};
+
+class CommandReplayer
+{
+public:
+    struct Stats
+    {
+        std::uint64_t Frames = 0;
+        std::uint64_t Lists = 0;
+        std::uint64_t Commands = 0;
+        std::uint64_t Draws = 0;
+        std::uint64_t UploadBytes = 0;
+    };
+
+    using UploadFunction = std::function<void(GpuAddress address, const std::uint8_t* data, std::size_t byteSize)>;
+
+    // 最多 framesInFlight 帧的命令列表同时在 GPU 上，超过时等待最早那一帧的围栏
+    explicit CommandReplayer(GraphicsDevice& device, std::uint32_t framesInFlight = 3);
+
+    // 按捕获顺序重新录制并提交。围栏值由回放器自己递增，不使用捕获里的值。
+    // 上传内容交给 onUpload（为空时忽略）；命令流损坏时抛出 std::runtime_error
+    Stats Replay(const CommandCapture& capture, const UploadFunction& onUpload = nullptr);
+    // 等待回放提交的全部工作完成
+    void Flush();
+
+private:
+    CommandList* AcquireList();
+
+    GraphicsDevice& mDevice;
+    std::uint32_t mFramesInFlight;
+    std::vector<std::vector<std::unique_ptr<CommandList>>> mFrameLists;
+    std::vector<std::uint64_t> mFrameFences;
+    std::uint32_t mFrameIndex = 0;
+    std::size_t mListsUsed = 0;
+    std::uint64_t mFence = 0;
+};
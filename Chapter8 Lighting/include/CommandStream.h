@@ -0,0 +1,193 @@
+/*
+紧凑的内存命令流（不依赖 D3D12）。
+每条命令是 1 字节操作码加上固定大小的参数（直接按字节复制的 POD 结构，没有对齐填充），
+NullGraphicsDevice 用它记录命令列表的内容，遍历时按操作码查表得到参数大小。
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "GraphicsDevice.h"
+
+enum class CommandOp : std::uint8_t
+{
+    TransitionBarrier,
+    ClearRenderTarget,
+    ClearDepthStencil,
+    SetViewport,
+    SetScissorRect,
+    SetRenderTarget,
+    SetGraphicsRootSignature,
+    SetPipelineState,
+    SetGraphicsRootConstantBufferView,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetPrimitiveTopology,
+    DrawIndexedInstanced,
+    // 新的操作码只加在末尾，已有捕获文件里的编号保持不变
+    SetGraphicsRootShaderResourceView,
+    SetGraphicsRoot32BitConstant,
+    ExecuteIndirect,
+    CopyBufferRegion,
+    Count
+};
+
+#pragma pack(push, 1)
+struct TransitionBarrierArgs { ResourceHandle Resource; std::uint32_t StateBefore; std::uint32_t StateAfter; };
+struct ClearRenderTargetArgs { DescriptorHandle Rtv; float Color[4]; };
+struct ClearDepthStencilArgs { DescriptorHandle Dsv; float Depth; std::uint8_t Stencil; };
+struct SetRenderTargetArgs { DescriptorHandle Rtv; DescriptorHandle Dsv; };
+struct SetRootConstantBufferViewArgs { std::uint32_t RootParameterIndex; GpuAddress Address; };
+struct SetRootShaderResourceViewArgs { std::uint32_t RootParameterIndex; GpuAddress Address; };
+struct SetRoot32BitConstantArgs { std::uint32_t RootParameterIndex; std::uint32_t Value; std::uint32_t DestOffset; };
+struct ExecuteIndirectArgs
+{
+    CommandSignatureHandle Signature;
+    std::uint32_t MaxCommandCount;
+    ResourceHandle ArgumentBuffer;
+    std::uint64_t ArgumentOffset;
+};
+struct CopyBufferRegionArgs
+{
+    ResourceHandle Dst;
+    std::uint64_t DstOffset;
+    ResourceHandle Src;
+    std::uint64_t SrcOffset;
+    std::uint64_t NumBytes;
+};
+struct DrawIndexedInstancedArgs
+{
+    std::uint32_t IndexCountPerInstance;
+    std::uint32_t InstanceCount;
+    std::uint32_t StartIndexLocation;
+    std::int32_t BaseVertexLocation;
+    std::uint32_t StartInstanceLocation;
+};
+#pragma pack(pop)
+
+// 各操作码的参数字节数，下标是 CommandOp
+inline std::size_t CommandPayloadSize(CommandOp op)
+{
+    static const std::size_t sizes[] =
+    {
+        sizeof(TransitionBarrierArgs),
+        sizeof(ClearRenderTargetArgs),
+        sizeof(ClearDepthStencilArgs),
+        sizeof(ViewportDesc),
+        sizeof(ScissorRect),
+        sizeof(SetRenderTargetArgs),
+        sizeof(RootSignatureHandle),
+        sizeof(PipelineHandle),
+        sizeof(SetRootConstantBufferViewArgs),
+        sizeof(VertexBufferBinding),
+        sizeof(IndexBufferBinding),
+        sizeof(std::uint32_t),
+        sizeof(DrawIndexedInstancedArgs),
+        sizeof(SetRootShaderResourceViewArgs),
+        sizeof(SetRoot32BitConstantArgs),
+        sizeof(ExecuteIndirectArgs),
+        sizeof(CopyBufferRegionArgs),
+    };
+    static_assert(sizeof(sizes) / sizeof(sizes[0]) == (std::size_t)CommandOp::Count, "每个操作码都要有参数大小");
+    return sizes[(std::size_t)op];
+}
+
+class CommandStreamWriter
+{
+public:
+    template<typename T>
+    void Write(CommandOp op, const T& args)
+    {
+        // 容量按倍数增长，之后每条命令只是两次复制，不逐条 resize（resize 会先清零）
+        const std::size_t size = 1 + sizeof(T);
+        if(mSize + size > mBytes.size())
+            mBytes.resize(std::max<std::size_t>(mBytes.size() * 2, mSize + size + 4096));
+
+        std::uint8_t* dst = mBytes.data() + mSize;
+        dst[0] = (std::uint8_t)op;
+        std::memcpy(dst + 1, &args, sizeof(T));
+        mSize += size;
+        mCommandCount++;
+    }
+
+    // 预先分配至少 byteSize 字节，录制时不再增长
+    void Reserve(std::size_t byteSize)
+    {
+        if(byteSize > mBytes.size())
+            mBytes.resize(byteSize);
+    }
+
+    // 保留已分配的内存，下一帧重复使用
+    void Clear()
+    {
+        mSize = 0;
+        mCommandCount = 0;
+    }
+
+    const std::uint8_t* Data()const { return mBytes.data(); }
+    std::size_t Size()const { return mSize; }
+    std::size_t CommandCount()const { return mCommandCount; }
+
+private:
+    std::vector<std::uint8_t> mBytes;
+    std::size_t mSize = 0;
+    std::size_t mCommandCount = 0;
+};
+
+// 顺序遍历命令流。流被截断或操作码非法时 Next 返回 false 并且 Valid() 为 false
+class CommandStreamReader
+{
+public:
+    CommandStreamReader(const std::uint8_t* data, std::size_t byteSize) :
+        mCursor(data), mEnd(data + byteSize)
+    {
+    }
+
+    explicit CommandStreamReader(const std::vector<std::uint8_t>& bytes) :
+        CommandStreamReader(bytes.data(), bytes.size())
+    {
+    }
+
+    bool Next(CommandOp& op, const std::uint8_t*& payload)
+    {
+        if(mCursor >= mEnd)
+            return false;
+
+        std::uint8_t code = *mCursor;
+        if(code >= (std::uint8_t)CommandOp::Count)
+        {
+            mValid = false;
+            return false;
+        }
+
+        op = (CommandOp)code;
+        std::size_t size = CommandPayloadSize(op);
+        if((std::size_t)(mEnd - mCursor) < 1 + size)
+        {
+            mValid = false;
+            return false;
+        }
+
+        payload = mCursor + 1;
+        mCursor += 1 + size;
+        return true;
+    }
+
+    template<typename T>
+    static T Read(const std::uint8_t* payload)
+    {
+        T value;
+        std::memcpy(&value, payload, sizeof(T));
+        return value;
+    }
+
+    bool Valid()const { return mValid; }
+
+private:
+    const std::uint8_t* mCursor;
+    const std::uint8_t* mEnd;
+    bool mValid = true;
+};
@@ -0,0 +1,48 @@
+/*
+StreamingQueue 的 D3D12 实现：独立的 COPY 命令队列，配一个自己的 UploadBatcher
+（自己的命令分配器、暂存环和围栏）。渲染队列通过 ID3D12CommandQueue::Wait 等待 Fence()，
+与复制队列完成跨队列同步。
+*/
+#pragma once
+
+#include "d3dUtil.h"
+#include "UploadBatcher.h"
+#include "StreamingScheduler.h"
+
+class CopyQueueStreamer : public StreamingQueue
+{
+public:
+    CopyQueueStreamer(ID3D12Device* device, UINT64 stagingByteSize = UploadBatcher::DefaultStagingByteSize)
+    {
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        ThrowIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mCopyQueue)));
+        d3dSetDebugName(mCopyQueue.Get(), "StreamingCopyQueue");
+
+        mUploader = std::make_unique<UploadBatcher>(device, mCopyQueue.Get(), stagingByteSize);
+    }
+
+    CopyQueueStreamer(const CopyQueueStreamer& rhs) = delete;
+    CopyQueueStreamer& operator=(const CopyQueueStreamer& rhs) = delete;
+
+    UINT64 Submit() override
+    {
+        UINT64 fence = mUploader->Submit();
+        mUploader->RetireCompleted();
+        return fence;
+    }
+
+    UINT64 CompletedValue() const override
+    {
+        return mUploader->Fence()->GetCompletedValue();
+    }
+
+    UploadBatcher& Uploader() { return *mUploader; }
+    ID3D12CommandQueue* Queue()const { return mCopyQueue.Get(); }
+    ID3D12Fence* Fence()const { return mUploader->Fence(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCopyQueue;
+    std::unique_ptr<UploadBatcher> mUploader;
+};
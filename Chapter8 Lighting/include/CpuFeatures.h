@@ -0,0 +1,18 @@
+/*
+运行时选择 SIMD 路径（不依赖 D3D12）。
+程序不需要整体用 /arch:AVX 编译：各个批处理函数（TransformPacker、FrustumCuller）都带有标量、SSE、AVX 三种实现，
+按这里检测到的 CPU 支持情况选择；标量路径同时是对照用的参考实现。
+*/
+#pragma once
+
+#include <cstdint>
+
+enum class SimdPath : std::uint8_t
+{
+    Scalar,
+    Sse,
+    Avx
+};
+
+// 当前 CPU 上最快的可用路径（第一次调用时检测，之后直接返回）
+SimdPath BestSimdPath();
@@ -0,0 +1,99 @@
+/*
+几何体在系统内存中的副本（纯 CPU，不依赖 D3D12）。
+上传到默认堆之后，CPU 端是否还保留数据由 ShadowCopyPolicy 决定：
+  DropAfterUpload 直接丢弃；KeepCompressed 按元素步长做字节重排后 LZ 压缩保存；
+  KeepRaw 原样保存；PageFromFile 只记住数据在资源文件里的位置，用到时再读。
+拾取等 CPU 端使用者统一通过 Acquire() 访问，按需解压或读文件；
+同一时间多个使用者共享一份解压结果，最后一个 ShadowCopyView 释放后内存随之释放。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class ShadowCopyPolicy : std::uint8_t
+{
+    DropAfterUpload,
+    KeepCompressed,
+    KeepRaw,
+    PageFromFile
+};
+
+struct ShadowFileSource
+{
+    std::string Path;
+    std::uint64_t Offset = 0;
+    std::uint64_t ByteSize = 0;
+};
+
+// Acquire 的结果：持有数据的引用，存在期间 Data() 一直有效
+class ShadowCopyView
+{
+public:
+    ShadowCopyView() = default;
+    explicit ShadowCopyView(std::shared_ptr<const std::vector<std::uint8_t>> bytes) : mBytes(std::move(bytes)) {}
+
+    bool IsValid()const { return mBytes != nullptr; }
+    const std::uint8_t* Data()const { return mBytes ? mBytes->data() : nullptr; }
+    std::size_t Size()const { return mBytes ? mBytes->size() : 0; }
+
+    template<typename T>
+    const T* As()const { return reinterpret_cast<const T*>(Data()); }
+    template<typename T>
+    std::size_t Count()const { return Size() / sizeof(T); }
+
+private:
+    std::shared_ptr<const std::vector<std::uint8_t>> mBytes;
+};
+
+namespace ShadowCompression
+{
+    // elementStride 为顶点/索引的字节步长：先把每个元素的第 k 个字节排在一起，再做 LZ 压缩
+    std::vector<std::uint8_t> Compress(const void* data, std::size_t byteSize, std::uint32_t elementStride);
+    // 数据损坏时返回 false
+    bool Decompress(const std::vector<std::uint8_t>& compressed, std::vector<std::uint8_t>& out);
+}
+
+class CpuShadowCopy
+{
+public:
+    CpuShadowCopy() = default;
+    // 移动后源对象为空（DropAfterUpload、没有文件来源），仍可以继续 Store / Acquire；
+    // 每个对象始终持有自己的互斥量，移动时不转移
+    CpuShadowCopy(CpuShadowCopy&& rhs) noexcept;
+    CpuShadowCopy& operator=(CpuShadowCopy&& rhs) noexcept;
+    CpuShadowCopy(const CpuShadowCopy& rhs) = delete;
+    CpuShadowCopy& operator=(const CpuShadowCopy& rhs) = delete;
+
+    // 按 policy 保存 data（调用返回后 data 可以释放）。
+    // PageFromFile 需要事先 SetFileSource，否则等同于 DropAfterUpload
+    void Store(const void* data, std::size_t byteSize, ShadowCopyPolicy policy, std::uint32_t elementStride = 1);
+    void SetFileSource(ShadowFileSource source);
+    void Reset();
+
+    // 数据不可用（已丢弃或读文件失败）时返回无效的 view
+    ShadowCopyView Acquire()const;
+
+    bool Available()const;
+    ShadowCopyPolicy Policy()const { return mPolicy; }
+    std::size_t ByteSize()const { return mByteSize; }
+    // 常驻系统内存的字节数（不含 Acquire 出去的临时解压结果）
+    std::size_t ResidentBytes()const;
+
+private:
+    std::shared_ptr<const std::vector<std::uint8_t>> Load()const;
+
+    ShadowCopyPolicy mPolicy = ShadowCopyPolicy::DropAfterUpload;
+    std::size_t mByteSize = 0;
+    std::shared_ptr<const std::vector<std::uint8_t>> mRaw;
+    std::vector<std::uint8_t> mCompressed;
+    ShadowFileSource mFile;
+    bool mHasFile = false;
+
+    mutable std::mutex mCacheMutex; // 保护 mCache，Acquire 可能来自多个线程
+    mutable std::weak_ptr<const std::vector<std::uint8_t>> mCache;
+};
@@ -0,0 +1,80 @@
+/*
+GraphicsDevice 的 D3D12 实现：每个命令列表自带一个分配器，围栏和队列由 Renderer 创建后传进来。
+句柄与 D3D12 对象之间的转换函数也放在这里，Renderer 录制时用它们把 D3D12 对象交给抽象接口。
+*/
+#pragma once
+
+#include "d3dUtil.h"
+#include "GraphicsDevice.h"
+
+inline ResourceHandle ToHandle(ID3D12Resource* resource) { return (ResourceHandle)reinterpret_cast<std::uintptr_t>(resource); }
+inline PipelineHandle ToHandle(ID3D12PipelineState* pipeline) { return (PipelineHandle)reinterpret_cast<std::uintptr_t>(pipeline); }
+inline RootSignatureHandle ToHandle(ID3D12RootSignature* rootSignature) { return (RootSignatureHandle)reinterpret_cast<std::uintptr_t>(rootSignature); }
+inline CommandSignatureHandle ToHandle(ID3D12CommandSignature* signature) { return (CommandSignatureHandle)reinterpret_cast<std::uintptr_t>(signature); }
+inline DescriptorHandle ToHandle(D3D12_CPU_DESCRIPTOR_HANDLE descriptor) { return (DescriptorHandle)descriptor.ptr; }
+
+inline VertexBufferBinding ToBinding(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+    return VertexBufferBinding{ view.BufferLocation, view.SizeInBytes, view.StrideInBytes };
+}
+
+inline IndexBufferBinding ToBinding(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    return IndexBufferBinding{ view.BufferLocation, view.SizeInBytes, (std::uint32_t)view.Format };
+}
+
+class D3D12CommandList : public CommandList
+{
+public:
+    explicit D3D12CommandList(ID3D12Device* device);
+
+    void Begin(PipelineHandle initialPipeline) override;
+    void End() override;
+
+    void TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter) override;
+    void ClearRenderTarget(DescriptorHandle rtv, const float color[4]) override;
+    void ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil) override;
+
+    void SetViewport(const ViewportDesc& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv) override;
+    void SetGraphicsRootSignature(RootSignatureHandle rootSignature) override;
+    void SetPipelineState(PipelineHandle pipeline) override;
+    void SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address) override;
+    void SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address) override;
+    void SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset) override;
+
+    void SetVertexBuffer(const VertexBufferBinding& view) override;
+    void SetIndexBuffer(const IndexBufferBinding& view) override;
+    void SetPrimitiveTopology(std::uint32_t topology) override;
+    void DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+        std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation) override;
+    void ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+        ResourceHandle argumentBuffer, std::uint64_t argumentOffset) override;
+    void CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+        ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes) override;
+
+    ID3D12GraphicsCommandList* Native()const { return mCommandList.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mAllocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
+};
+
+class D3D12GraphicsDevice : public GraphicsDevice
+{
+public:
+    D3D12GraphicsDevice(ID3D12Device* device, ID3D12CommandQueue* queue, ID3D12Fence* fence);
+
+    std::unique_ptr<CommandList> CreateCommandList() override;
+    void ExecuteCommandLists(CommandList* const* lists, std::uint32_t count) override;
+
+    void Signal(std::uint64_t fenceValue) override;
+    std::uint64_t CompletedFenceValue() override;
+    void WaitForFenceValue(std::uint64_t fenceValue) override;
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> mQueue;
+    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+};
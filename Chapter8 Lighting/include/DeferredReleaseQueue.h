@@ -0,0 +1,128 @@
+/*
+延迟释放队列（纯 CPU，不依赖 D3D12）。
+对象连同“最后一次使用它的那一帧的围栏值”一起入队，等 GPU 围栏的完成值越过这个值之后
+才真正析构，不再需要 FlushCommandQueue 把 CPU 卡到 GPU 空闲。
+任意线程都可以 Enqueue（无锁的多生产者单消费者栈）；Reclaim 只在渲染线程调用，
+每次只回收已经完成的对象，可以限制单次回收个数，把开销摊到多帧。
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+class DeferredReleaseQueue
+{
+public:
+    DeferredReleaseQueue() = default;
+    DeferredReleaseQueue(const DeferredReleaseQueue& rhs) = delete;
+    DeferredReleaseQueue& operator=(const DeferredReleaseQueue& rhs) = delete;
+
+    // 析构时直接释放所有剩余对象：调用者负责保证此时 GPU 已经空闲
+    ~DeferredReleaseQueue()
+    {
+        ReclaimAll();
+    }
+
+    // 任意线程调用。object 在围栏完成之后才析构（ComPtr、unique_ptr 等任何可移动对象都可以）
+    template<typename T>
+    void Enqueue(std::uint64_t fenceValue, T object)
+    {
+        Push(new Holder<T>(fenceValue, std::move(object)));
+    }
+
+    // 任意线程调用。callback 在围栏完成之后于渲染线程上执行（例如归还显存池中的分配）
+    void EnqueueCallback(std::uint64_t fenceValue, std::function<void()> callback)
+    {
+        Push(new CallbackHolder(fenceValue, std::move(callback)));
+    }
+
+    // 渲染线程调用：释放围栏值 <= completedValue 的对象，最多 maxCount 个，返回释放的个数
+    std::size_t Reclaim(std::uint64_t completedValue, std::size_t maxCount = std::numeric_limits<std::size_t>::max())
+    {
+        DrainIncoming();
+
+        std::size_t released = 0;
+        while(!mPending.empty() && released < maxCount && mPending.front()->FenceValue <= completedValue)
+        {
+            std::pop_heap(mPending.begin(), mPending.end(), LaterFence);
+            delete mPending.back();
+            mPending.pop_back();
+            released++;
+        }
+        mReleased += released;
+        return released;
+    }
+
+    // GPU 已经空闲时（例如 FlushCommandQueue 之后）释放全部对象
+    std::size_t ReclaimAll()
+    {
+        return Reclaim(std::numeric_limits<std::uint64_t>::max());
+    }
+
+    // 渲染线程调用。只统计已经从无锁栈转移过来的对象
+    std::size_t PendingCount()const { return mPending.size(); }
+    std::uint64_t ReleasedCount()const { return mReleased; }
+    bool Empty()const { return mPending.empty() && mIncoming.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node
+    {
+        explicit Node(std::uint64_t fenceValue) : FenceValue(fenceValue) {}
+        virtual ~Node() = default;
+
+        std::uint64_t FenceValue;
+        Node* Next = nullptr;
+    };
+
+    template<typename T>
+    struct Holder : Node
+    {
+        Holder(std::uint64_t fenceValue, T&& object) : Node(fenceValue), Object(std::move(object)) {}
+        T Object;
+    };
+
+    struct CallbackHolder : Node
+    {
+        CallbackHolder(std::uint64_t fenceValue, std::function<void()>&& callback) : Node(fenceValue), Callback(std::move(callback)) {}
+        ~CallbackHolder() override
+        {
+            if(Callback)
+                Callback();
+        }
+        std::function<void()> Callback;
+    };
+
+    // 小顶堆：围栏值最小的在 front
+    static bool LaterFence(const Node* a, const Node* b) { return a->FenceValue > b->FenceValue; }
+
+    void Push(Node* node)
+    {
+        node->Next = mIncoming.load(std::memory_order_relaxed);
+        while(!mIncoming.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // 消费者一次取走整个栈，所以不存在 ABA 问题
+    void DrainIncoming()
+    {
+        Node* node = mIncoming.exchange(nullptr, std::memory_order_acquire);
+        while(node != nullptr)
+        {
+            Node* next = node->Next;
+            mPending.push_back(node);
+            std::push_heap(mPending.begin(), mPending.end(), LaterFence);
+            node = next;
+        }
+    }
+
+    std::atomic<Node*> mIncoming{ nullptr };
+    std::vector<Node*> mPending; // 只在渲染线程访问
+    std::uint64_t mReleased = 0;
+};
@@ -0,0 +1,56 @@
+/*
+绘制排序键（不依赖 D3D12）。
+64 位键从高到低依次是：渲染阶段、PSO、材质、几何体、量化深度，按键升序提交时
+先按状态切换代价从大到小分组，同一组内由近到远（不透明物体尽早通过 early-Z 剔除后面的像素）。
+
+  | 63..60 阶段 | 59..50 PSO | 49..36 材质 | 35..24 几何体 | 23..0 深度 |
+
+各字段超出位宽时截断到最大值，排序仍然正确，只是同一字段内可能不再唯一。
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace DrawSortKey
+{
+    constexpr unsigned PassBits = 4;
+    constexpr unsigned PipelineBits = 10;
+    constexpr unsigned MaterialBits = 14;
+    constexpr unsigned GeometryBits = 12;
+    constexpr unsigned DepthBits = 24;
+    static_assert(PassBits + PipelineBits + MaterialBits + GeometryBits + DepthBits == 64, "排序键必须正好 64 位");
+
+    constexpr unsigned DepthShift = 0;
+    constexpr unsigned GeometryShift = DepthShift + DepthBits;
+    constexpr unsigned MaterialShift = GeometryShift + GeometryBits;
+    constexpr unsigned PipelineShift = MaterialShift + MaterialBits;
+    constexpr unsigned PassShift = PipelineShift + PipelineBits;
+
+    constexpr std::uint64_t FieldMax(unsigned bits) { return (std::uint64_t(1) << bits) - 1; }
+
+    // 视空间深度映射到 [0, 2^DepthBits)，近处小；超出 [nearZ, farZ] 的截断到两端
+    inline std::uint32_t QuantizeDepth(float viewDepth, float nearZ, float farZ)
+    {
+        float t = (viewDepth - nearZ) / (farZ - nearZ);
+        t = std::min(std::max(t, 0.0f), 1.0f);
+        return (std::uint32_t)(t * (float)FieldMax(DepthBits));
+    }
+
+    inline std::uint64_t Make(std::uint32_t pass, std::uint32_t pipeline, std::uint32_t material,
+        std::uint32_t geometry, std::uint32_t quantizedDepth)
+    {
+        auto clamp = [](std::uint32_t value, unsigned bits) { return std::min<std::uint64_t>(value, FieldMax(bits)); };
+        return (clamp(pass, PassBits) << PassShift) |
+            (clamp(pipeline, PipelineBits) << PipelineShift) |
+            (clamp(material, MaterialBits) << MaterialShift) |
+            (clamp(geometry, GeometryBits) << GeometryShift) |
+            (clamp(quantizedDepth, DepthBits) << DepthShift);
+    }
+
+    inline std::uint32_t Pass(std::uint64_t key) { return (std::uint32_t)((key >> PassShift) & FieldMax(PassBits)); }
+    inline std::uint32_t Pipeline(std::uint64_t key) { return (std::uint32_t)((key >> PipelineShift) & FieldMax(PipelineBits)); }
+    inline std::uint32_t Material(std::uint64_t key) { return (std::uint32_t)((key >> MaterialShift) & FieldMax(MaterialBits)); }
+    inline std::uint32_t Geometry(std::uint64_t key) { return (std::uint32_t)((key >> GeometryShift) & FieldMax(GeometryBits)); }
+    inline std::uint32_t Depth(std::uint64_t key) { return (std::uint32_t)((key >> DepthShift) & FieldMax(DepthBits)); }
+}
@@ -0,0 +1,33 @@
+/*
+BudgetSource 的 DXGI 实现：IDXGIAdapter3::QueryVideoMemoryInfo 查询本地显存段（LOCAL）的预算和用量。
+预算由操作系统按当前系统负载动态调整，所以每帧都要重新查询。
+*/
+#pragma once
+
+#include "d3dUtil.h"
+#include "ResidencyManager.h"
+
+class DxgiBudgetSource : public BudgetSource
+{
+public:
+    // 找到 device 所在的适配器
+    DxgiBudgetSource(IDXGIFactory4* factory, ID3D12Device* device)
+    {
+        LUID luid = device->GetAdapterLuid();
+        ThrowIfFailed(factory->EnumAdapterByLuid(luid, IID_PPV_ARGS(&mAdapter)));
+    }
+
+    MemoryBudget Query() override
+    {
+        DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+        ThrowIfFailed(mAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info));
+
+        MemoryBudget budget;
+        budget.Budget = info.Budget;
+        budget.CurrentUsage = info.CurrentUsage;
+        return budget;
+    }
+
+private:
+    Microsoft::WRL::ComPtr<IDXGIAdapter3> mAdapter;
+};
@@ -0,0 +1,75 @@
+/*
+按帧资源分开的稀疏脏列表（不依赖 D3D12）。
+每个帧资源有自己的一份数据（材质表、动态物体表），一项变化后每个帧资源都要各写一次。
+以前的做法是给每项一个 NumFramesDirty 计数，每帧扫描全部项找出计数大于 0 的；
+这里改成每个帧资源一个稠密的下标列表：标记时把下标追加到还没有它的列表里，
+帧资源写完自己的列表后清空。每帧的开销只和变化的项数有关，和总项数无关。
+每项用一个字节的位掩码记录已经在哪些列表里，同一项在写入之前重复标记只算一次。
+*/
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class FrameDirtyTracker
+{
+public:
+    static constexpr std::uint32_t MaxFrames = 8;
+
+    explicit FrameDirtyTracker(std::uint32_t frameCount) :
+        mFrameCount(frameCount),
+        mAllFrames((std::uint8_t)((1u << frameCount) - 1)),
+        mLists(frameCount)
+    {
+        assert(frameCount > 0 && frameCount <= MaxFrames);
+    }
+
+    // 改变项数。新加入的项在所有帧资源里都是脏的
+    void Resize(std::size_t itemCount)
+    {
+        std::size_t oldCount = mMask.size();
+        mMask.resize(itemCount, 0);
+        for(std::size_t item = oldCount; item < itemCount; ++item)
+            Mark((std::uint32_t)item);
+    }
+
+    void Mark(std::uint32_t item)
+    {
+        assert(item < mMask.size());
+        std::uint8_t mask = mMask[item];
+        if(mask == mAllFrames)
+            return;
+
+        for(std::uint32_t frame = 0; frame < mFrameCount; ++frame)
+        {
+            if((mask & (1u << frame)) == 0)
+                mLists[frame].push_back(item);
+        }
+        mMask[item] = mAllFrames;
+    }
+
+    // 帧资源 frame 需要重写的项（无序）
+    const std::vector<std::uint32_t>& Dirty(std::uint32_t frame)const
+    {
+        return mLists[frame];
+    }
+
+    // 帧资源 frame 已经写完了自己的列表（或者整表重写过）
+    void Clear(std::uint32_t frame)
+    {
+        std::uint8_t bit = (std::uint8_t)(1u << frame);
+        for(std::uint32_t item : mLists[frame])
+            mMask[item] &= (std::uint8_t)~bit;
+        mLists[frame].clear();
+    }
+
+    std::size_t ItemCount()const { return mMask.size(); }
+
+private:
+    std::uint32_t mFrameCount;
+    std::uint8_t mAllFrames;
+    std::vector<std::uint8_t> mMask;                 // 每项已经在哪些帧资源的列表里
+    std::vector<std::vector<std::uint32_t>> mLists;  // 每个帧资源的脏列表
+};
@@ -3,12 +3,8 @@
 #include "d3dUtil.h"
 #include "MathHelper.h"
 #include "UploadBuffer.h"
-
-struct ObjectConstants
-{
-    DirectX::XMFLOAT4X4 world = MathHelper::Identity4x4();
-    DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-};
+#include "UploadRing.h"
+#include "GraphicsDevice.h"
 
 struct PassConstants
 {
@@ -46,20 +42,57 @@ struct FrameResource
 {
 public:
     
-    FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount);
+    FrameResource(ID3D12Device* device, GraphicsDevice& graphics, UINT64 uploadRingByteSize, UINT commandListCount);
     FrameResource(const FrameResource& rhs) = delete;
     FrameResource& operator=(const FrameResource& rhs) = delete;
     ~FrameResource();
 
     // We cannot reset the allocator until the GPU is done processing the commands.
-    // So each frame needs their own allocator.
-    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+    // So each frame needs their own allocators.  There is one allocator/list pair
+    // per recording batch so that worker threads can record in parallel.
+    // Each CommandList owns its allocator and is created closed.
+    std::vector<std::unique_ptr<CommandList>> CmdLists;
 
     // We cannot update a cbuffer until the GPU is done processing the commands
-    // that reference it.  So each frame needs their own cbuffers.
-    std::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
-    std::unique_ptr<UploadBuffer<ObjectConstants>> ObjectCB = nullptr;
-    std::unique_ptr<UploadBuffer<MaterialConstants>> MaterialCB = nullptr;
+    // that reference it.  So each frame needs their own upload memory.
+    // All per-frame constants are suballocated from this ring, which is reset
+    // once Fence has completed.
+    std::unique_ptr<FrameUploadRing> UploadRing = nullptr;
+
+    // Blocks handed out by UploadRing for this frame.
+    // DynamicObjectBuffer is the dynamic object tier: one ObjectConstants per dynamic item,
+    // only changed items are rewritten. Static items live in a DEFAULT-heap buffer owned by the Renderer;
+    // StaticPatchStaging holds this frame's changed static items, copied into it before drawing.
+    // Its size changes every frame, so it is allocated last to keep the other blocks in place.
+    // InstanceBuffer holds one InstanceObjectIndex per visible item, in instance group order.
+    LinearAllocation PassCB;
+    LinearAllocation DynamicObjectBuffer;
+    LinearAllocation StaticPatchStaging;
+    LinearAllocation InstanceBuffer;
+    // MaterialBuffer is the material table: one MaterialConstants per material, indexed by MatCBIndex.
+    LinearAllocation MaterialBuffer;
+    // IndirectArgs holds one IndirectDrawCommand per instance group; sized from the previous
+    // group count plus headroom. A frame with more groups than that draws each group directly.
+    LinearAllocation IndirectArgs;
+
+    // Generation of the content last written to PassCB, InstanceBuffer and IndirectArgs.
+    // A block is rewritten only when the Renderer's generation moved on (or the block moved,
+    // which resets these to 0). The dynamic object tier and the material table are instead
+    // patched per item from sparse dirty lists (FrameDirtyTracker).
+    std::uint64_t PassGeneration = 0;
+    std::uint64_t InstanceGeneration = 0;
+    std::uint64_t IndirectGeneration = 0;
+
+    // Registration of UploadRing in the ResidencyManager; re-tracked when the ring grows.
+    std::uint32_t UploadRingResidencyId = ResidencyManager::InvalidId;
+
+    // Called after UploadRing replaced its buffer: nothing written to the old one survives,
+    // so every block counts as relocated and every generation-skipped block is rewritten.
+    void ForgetUploadBlocks()
+    {
+        PassCB = DynamicObjectBuffer = StaticPatchStaging = InstanceBuffer = MaterialBuffer = IndirectArgs = LinearAllocation();
+        PassGeneration = InstanceGeneration = IndirectGeneration = 0;
+    }
 
     // Fence value to mark commands up to this fence point.  This lets us
     // check if these frame resources are still in use by the GPU.
@@ -0,0 +1,82 @@
+/*
+视锥剔除（不依赖 D3D12）。
+从观察-投影矩阵提取 6 个平面（Gribb-Hartmann，法线指向视锥内部并归一化）。每个物体的局部包围盒用 Arvo 的方法
+变换成世界空间的轴对齐包围盒：中心直接乘世界矩阵，半长是矩阵前三行取绝对值后的线性组合，不用变换 8 个角点。
+包围盒在某个平面外侧（中心到平面的有符号距离加上包围盒在平面法线上的投影半径小于 0）就剔除；
+只测 6 个平面是保守的，靠近视锥棱角的少数包围盒会被留下，但不会剔掉可见的物体。
+AVX 路径每轮处理 8 个物体：两个物体各占一个 128 位通道一起做 Arvo 变换，再在通道内转置成 SoA（8 个 x、8 个 y……）
+和平面比较；SSE 路径每轮 4 个物体；标量路径是对照用的参考实现，三种路径的运算顺序相同，结果逐位一致。
+可见物体的下标直接紧凑地写进输出数组，不需要额外的标记数组。
+每帧剔除大量物体时，从渲染项里跨步读世界矩阵和局部包围盒要搬动整条热数据记录；WorldBoundsArray 把
+世界空间的包围盒按分量存成 6 个连续的 float 数组（每个盒子 24 字节），只在物体加入、移动、删除时更新，
+CullBoxes 的另一个重载直接按 SoA 读它，不需要 Arvo 变换和转置。两个重载对同一批物体的结果逐位一致。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include "CpuFeatures.h"
+
+struct FrustumPlanes
+{
+    // 左、右、下、上、近、远；(x, y, z) 是指向视锥内部的单位法线，点 p 在内侧当且仅当 dot(n, p) + w >= 0
+    DirectX::XMFLOAT4 Planes[6];
+};
+
+// viewProj 按 DirectXMath 的约定是行向量右乘（v * viewProj），深度范围 [0, 1]
+FrustumPlanes ExtractFrustumPlanes(const DirectX::XMFLOAT4X4& viewProj);
+
+// 待剔除的物体：第 i 个物体的世界矩阵和局部包围盒分别在 World、Bounds 之后 i * Stride 字节处，
+// 可以直接指向渲染项数组里的字段
+struct CullSource
+{
+    const DirectX::XMFLOAT4X4* World = nullptr;
+    const DirectX::BoundingBox* Bounds = nullptr;
+    std::size_t Stride = 0;
+};
+
+// 剔除 count 个物体，把可见物体的下标（firstIndex + i）按原顺序写进 visible，返回可见个数。
+// visible 至少要有 count 个元素
+std::size_t CullBoxes(const FrustumPlanes& frustum, const CullSource& source, std::size_t count,
+    std::uint32_t firstIndex, std::uint32_t* visible, SimdPath path = BestSimdPath());
+
+// 世界空间轴对齐包围盒的只读视图：第 i 个盒子的中心是 (CenterX[i], CenterY[i], CenterZ[i])，半长同理
+struct CullBounds
+{
+    const float* CenterX = nullptr;
+    const float* CenterY = nullptr;
+    const float* CenterZ = nullptr;
+    const float* ExtentX = nullptr;
+    const float* ExtentY = nullptr;
+    const float* ExtentZ = nullptr;
+};
+
+// 按下标排列的世界空间包围盒。下标的含义由使用者决定，Renderer 里和渲染项池的稠密下标一一对应，
+// 删除时同样把最后一个搬到空位上
+class WorldBoundsArray
+{
+public:
+    std::size_t Size()const { return mComponents[0].size(); }
+    void Clear();
+
+    // 追加 local 经 world 变换后的包围盒（Arvo 的方法，运算顺序与 CullSource 的剔除路径相同）
+    void PushBack(const DirectX::XMFLOAT4X4& world, const DirectX::BoundingBox& local);
+    // 物体移动之后重新计算第 i 个
+    void Set(std::size_t i, const DirectX::XMFLOAT4X4& world, const DirectX::BoundingBox& local);
+    // 把最后一个搬到 i 上再去掉最后一个，与 HandlePool::Remove 的 swap-back 对应
+    void RemoveSwapBack(std::size_t i);
+
+    DirectX::BoundingBox At(std::size_t i)const;
+    // 从第 first 个开始的视图
+    CullBounds View(std::size_t first = 0)const;
+
+private:
+    std::vector<float> mComponents[6]; // 中心 x、y、z，半长 x、y、z
+};
+
+// 与上面的重载相同，但直接读已经变换到世界空间的 SoA 包围盒 bounds[0, count)
+std::size_t CullBoxes(const FrustumPlanes& frustum, const CullBounds& bounds, std::size_t count,
+    std::uint32_t firstIndex, std::uint32_t* visible, SimdPath path = BestSimdPath());
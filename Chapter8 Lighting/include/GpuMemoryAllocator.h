@@ -0,0 +1,47 @@
+/*
+HeapPool 的 D3D12 绑定：为每个池化堆创建一个 ID3D12Heap，并在其中创建放置资源（placed resource）。
+避免每个缓冲区都调用 CreateCommittedResource 产生独立的堆和内核分配。
+Resource Heap Tier 1 的硬件不允许缓冲区和纹理共用一个堆，所以一个分配器只服务一类资源，
+由 heapFlags 指定（例如 D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS）。
+*/
+#pragma once
+
+#include "d3dUtil.h"
+#include "HeapPool.h"
+
+class GpuMemoryAllocator
+{
+public:
+    static constexpr UINT64 DefaultHeapSize = 64 * 1024 * 1024;
+
+    GpuMemoryAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags,
+        UINT64 heapSize = DefaultHeapSize);
+    GpuMemoryAllocator(const GpuMemoryAllocator& rhs) = delete;
+    GpuMemoryAllocator& operator=(const GpuMemoryAllocator& rhs) = delete;
+
+    // 在池中分配并创建放置资源；allocation 用于之后的 Free
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreatePlacedResource(
+        const D3D12_RESOURCE_DESC& desc,
+        D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* optimizedClearValue,
+        PoolAllocation& allocation);
+
+    // 调用者需保证 GPU 已不再使用该资源，并已释放资源本身
+    void Free(const PoolAllocation& allocation);
+
+    D3D12_HEAP_TYPE HeapType()const { return mHeapType; }
+    ID3D12Heap* Heap(UINT heapIndex)const { return mHeaps[heapIndex].Get(); }
+    const HeapPool& Pool()const { return mPool; }
+
+    std::vector<HeapStats> GetHeapStats()const { return mPool.GetHeapStats(); }
+    DefragPlan PlanDefragmentation(UINT64 maxBytesToMove = 0)const { return mPool.PlanDefragmentation(maxBytesToMove); }
+
+private:
+    void CreateMissingHeaps();
+
+    ID3D12Device* mDevice = nullptr;
+    D3D12_HEAP_TYPE mHeapType = D3D12_HEAP_TYPE_DEFAULT;
+    D3D12_HEAP_FLAGS mHeapFlags = D3D12_HEAP_FLAG_NONE;
+    HeapPool mPool;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> mHeaps;
+};
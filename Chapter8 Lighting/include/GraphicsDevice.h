@@ -0,0 +1,134 @@
+/*
+Renderer 录制每帧命令时使用的设备/命令列表抽象（不依赖 D3D12，Linux 上也能编译）。
+两个实现：D3D12GraphicsDevice（原有的 D3D12 路径）和 NullGraphicsDevice（把命令写进内存中的
+紧凑命令流并模拟围栏，用于在没有 GPU 的机器上测量 CPU 端开销）。
+这里的枚举值和句柄与 D3D12 一一对应：状态、图元拓扑、索引格式直接使用 D3D12/DXGI 的数值，
+句柄就是 D3D12 对象指针或描述符句柄的 ptr，所以 D3D12 实现只做类型转换。
+*/
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+using GpuAddress = std::uint64_t;
+using ResourceHandle = std::uint64_t;      // ID3D12Resource*
+using DescriptorHandle = std::uint64_t;    // D3D12_CPU_DESCRIPTOR_HANDLE::ptr
+using PipelineHandle = std::uint64_t;      // ID3D12PipelineState*
+using RootSignatureHandle = std::uint64_t; // ID3D12RootSignature*
+using CommandSignatureHandle = std::uint64_t; // ID3D12CommandSignature*
+
+class CommandStreamWriter;
+
+// 与 D3D12_RESOURCE_STATES 数值相同（只列出用到的）
+namespace ResourceState
+{
+    constexpr std::uint32_t Common = 0;
+    constexpr std::uint32_t Present = 0;
+    constexpr std::uint32_t RenderTarget = 0x4;
+    constexpr std::uint32_t DepthWrite = 0x10;
+    constexpr std::uint32_t CopyDest = 0x400;
+    constexpr std::uint32_t GenericRead = 0xAC3;
+}
+
+// 与 D3D_PRIMITIVE_TOPOLOGY / DXGI_FORMAT 数值相同
+namespace PrimitiveTopology
+{
+    constexpr std::uint32_t TriangleList = 4;
+    constexpr std::uint32_t TriangleStrip = 5;
+}
+
+namespace IndexFormat
+{
+    constexpr std::uint32_t R32Uint = 42;
+    constexpr std::uint32_t R16Uint = 57;
+}
+
+struct VertexBufferBinding
+{
+    GpuAddress BufferLocation = 0;
+    std::uint32_t SizeInBytes = 0;
+    std::uint32_t StrideInBytes = 0;
+};
+
+struct IndexBufferBinding
+{
+    GpuAddress BufferLocation = 0;
+    std::uint32_t SizeInBytes = 0;
+    std::uint32_t Format = IndexFormat::R16Uint;
+};
+
+struct ViewportDesc
+{
+    float TopLeftX = 0.0f;
+    float TopLeftY = 0.0f;
+    float Width = 0.0f;
+    float Height = 0.0f;
+    float MinDepth = 0.0f;
+    float MaxDepth = 1.0f;
+};
+
+struct ScissorRect
+{
+    std::int32_t Left = 0;
+    std::int32_t Top = 0;
+    std::int32_t Right = 0;
+    std::int32_t Bottom = 0;
+};
+
+class CommandList
+{
+public:
+    virtual ~CommandList() = default;
+
+    // 重置分配器并开始录制。只能在上一次提交的围栏完成之后调用
+    virtual void Begin(PipelineHandle initialPipeline) = 0;
+    virtual void End() = 0;
+
+    virtual void TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter) = 0;
+    virtual void ClearRenderTarget(DescriptorHandle rtv, const float color[4]) = 0;
+    virtual void ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil) = 0;
+
+    virtual void SetViewport(const ViewportDesc& viewport) = 0;
+    virtual void SetScissorRect(const ScissorRect& rect) = 0;
+    virtual void SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv) = 0;
+    virtual void SetGraphicsRootSignature(RootSignatureHandle rootSignature) = 0;
+    virtual void SetPipelineState(PipelineHandle pipeline) = 0;
+    virtual void SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address) = 0;
+    virtual void SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address) = 0;
+    // 根常量参数中第 destOffset 个 32 位值
+    virtual void SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset) = 0;
+
+    virtual void SetVertexBuffer(const VertexBufferBinding& view) = 0;
+    virtual void SetIndexBuffer(const IndexBufferBinding& view) = 0;
+    virtual void SetPrimitiveTopology(std::uint32_t topology) = 0;
+    virtual void DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+        std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation) = 0;
+    // 按命令签名执行 argumentBuffer 中从 argumentOffset 开始的 maxCommandCount 条命令
+    virtual void ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+        ResourceHandle argumentBuffer, std::uint64_t argumentOffset) = 0;
+    // 缓冲区之间复制 numBytes 字节；dst 必须处于 CopyDest 状态
+    virtual void CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+        ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes) = 0;
+
+    // 本身就把命令写成 CommandStream 的后端（NullGraphicsDevice）返回这次录制的命令流，
+    // 捕获时直接复制它，不用逐条命令再写一遍；其他后端返回 nullptr
+    virtual const CommandStreamWriter* RecordedStream()const { return nullptr; }
+};
+
+class GraphicsDevice
+{
+public:
+    virtual ~GraphicsDevice() = default;
+
+    virtual std::unique_ptr<CommandList> CreateCommandList() = 0;
+    // 创建的命令列表都有 RecordedStream
+    virtual bool RecordsCommandStreams()const { return false; }
+    // 按顺序提交已经 End 的命令列表
+    virtual void ExecuteCommandLists(CommandList* const* lists, std::uint32_t count) = 0;
+
+    // 在队列上放一个围栏值；之前提交的命令都完成后 CompletedFenceValue 才会达到它
+    virtual void Signal(std::uint64_t fenceValue) = 0;
+    virtual std::uint64_t CompletedFenceValue() = 0;
+    // 阻塞 CPU 直到围栏达到 fenceValue
+    virtual void WaitForFenceValue(std::uint64_t fenceValue) = 0;
+};
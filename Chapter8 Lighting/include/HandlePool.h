@@ -0,0 +1,165 @@
+/*
+带代数句柄的分块对象池（不依赖 D3D12）。
+每个元素分成热、冷两部分：热数据是每帧遍历的字段（世界矩阵、包围盒、排序键），冷数据是只在
+分组和录制时才读的字段。两部分各自按稠密下标连续存放在固定大小的块里，遍历热数据时缓存行里
+只有要用的字段；池增长只追加新块，已有元素不会因为扩容而搬动。
+删除时把最后一个元素搬到空位上（swap-back），稠密区间始终没有空洞，增删都是 O(1)。
+外部只持有 32 位句柄：低位是槽位（指向稠密下标的间接表），高位是代数。槽位被删除后代数加一，
+旧句柄从此失效，查找返回 nullptr，不会访问到占用同一槽位的新元素。
+稠密下标会在删除时变化，只能在两次增删之间使用。
+*/
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct PoolHandle
+{
+    static constexpr std::uint32_t SlotBits = 22;       // 最多约 400 万个元素
+    // 剩下 10 位是代数，有效值 1..1023，回绕时跳过 0。同一个槽位被删除并重新占用 1023 次之后，
+    // 代数回到旧句柄的值，旧句柄又会被当成有效（空闲槽位按后进先出复用，反复增删时最快）。
+    // 持有句柄的一方不能跨越这么多次增删；需要更长时可以减少 SlotBits
+    static constexpr std::uint32_t GenerationBits = 32 - SlotBits;
+    static constexpr std::uint32_t SlotMask = (1u << SlotBits) - 1;
+    static constexpr std::uint32_t GenerationMask = (1u << GenerationBits) - 1;
+
+    std::uint32_t Value = 0; // 代数从 1 开始，0 不是任何元素的句柄
+
+    std::uint32_t Slot()const { return Value & SlotMask; }
+    std::uint32_t Generation()const { return Value >> SlotBits; }
+    bool IsNull()const { return Value == 0; }
+
+    static PoolHandle Make(std::uint32_t slot, std::uint32_t generation)
+    {
+        PoolHandle handle;
+        handle.Value = (generation << SlotBits) | slot;
+        return handle;
+    }
+
+    bool operator==(const PoolHandle& rhs)const { return Value == rhs.Value; }
+    bool operator!=(const PoolHandle& rhs)const { return Value != rhs.Value; }
+};
+
+template<typename Hot, typename Cold, std::size_t ChunkSize = 1024>
+class HandlePool
+{
+    static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize 必须是 2 的幂");
+
+public:
+    static constexpr std::size_t MaxElements = (std::size_t)PoolHandle::SlotMask + 1;
+    static constexpr std::size_t ElementsPerChunk = ChunkSize;
+
+    PoolHandle Add(const Hot& hot, const Cold& cold)
+    {
+        std::uint32_t slot;
+        if(!mFreeSlots.empty())
+        {
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        else
+        {
+            assert(mSlotDense.size() < MaxElements && "HandlePool: too many elements");
+            slot = (std::uint32_t)mSlotDense.size();
+            mSlotDense.push_back(0);
+            mSlotGeneration.push_back(1);
+        }
+
+        std::size_t dense = mSize++;
+        if(dense == mHotChunks.size() * ChunkSize)
+        {
+            mHotChunks.emplace_back(new Hot[ChunkSize]);
+            mColdChunks.emplace_back(new Cold[ChunkSize]);
+        }
+        HotAt(dense) = hot;
+        ColdAt(dense) = cold;
+        mDenseSlot.push_back(slot);
+        mSlotDense[slot] = (std::uint32_t)dense;
+        return PoolHandle::Make(slot, mSlotGeneration[slot]);
+    }
+
+    // 句柄已经失效时返回 false
+    bool Remove(PoolHandle handle)
+    {
+        if(!IsValid(handle))
+            return false;
+
+        std::uint32_t slot = handle.Slot();
+        std::size_t dense = mSlotDense[slot];
+        std::size_t last = mSize - 1;
+        if(dense != last)
+        {
+            HotAt(dense) = std::move(HotAt(last));
+            ColdAt(dense) = std::move(ColdAt(last));
+            std::uint32_t movedSlot = mDenseSlot[last];
+            mDenseSlot[dense] = movedSlot;
+            mSlotDense[movedSlot] = (std::uint32_t)dense;
+        }
+        // 空出来的位置恢复成默认值，不再持有旧元素的内容
+        HotAt(last) = Hot();
+        ColdAt(last) = Cold();
+        mDenseSlot.pop_back();
+        --mSize;
+
+        // 代数加一让旧句柄失效；回绕时跳过 0
+        std::uint32_t generation = (mSlotGeneration[slot] + 1) & PoolHandle::GenerationMask;
+        mSlotGeneration[slot] = generation == 0 ? 1 : generation;
+        mFreeSlots.push_back(slot);
+        return true;
+    }
+
+    bool IsValid(PoolHandle handle)const
+    {
+        std::uint32_t slot = handle.Slot();
+        return !handle.IsNull() && slot < mSlotDense.size() && mSlotGeneration[slot] == handle.Generation();
+    }
+
+    // 句柄失效时返回 nullptr
+    Hot* TryGetHot(PoolHandle handle) { return IsValid(handle) ? &HotAt(mSlotDense[handle.Slot()]) : nullptr; }
+    const Hot* TryGetHot(PoolHandle handle)const { return IsValid(handle) ? &HotAt(mSlotDense[handle.Slot()]) : nullptr; }
+    Cold* TryGetCold(PoolHandle handle) { return IsValid(handle) ? &ColdAt(mSlotDense[handle.Slot()]) : nullptr; }
+    const Cold* TryGetCold(PoolHandle handle)const { return IsValid(handle) ? &ColdAt(mSlotDense[handle.Slot()]) : nullptr; }
+
+    // 按稠密下标 [0, Size()) 访问
+    std::size_t Size()const { return mSize; }
+    Hot& HotAt(std::size_t dense) { return mHotChunks[dense / ChunkSize][dense % ChunkSize]; }
+    const Hot& HotAt(std::size_t dense)const { return mHotChunks[dense / ChunkSize][dense % ChunkSize]; }
+    Cold& ColdAt(std::size_t dense) { return mColdChunks[dense / ChunkSize][dense % ChunkSize]; }
+    const Cold& ColdAt(std::size_t dense)const { return mColdChunks[dense / ChunkSize][dense % ChunkSize]; }
+    PoolHandle HandleAt(std::size_t dense)const
+    {
+        std::uint32_t slot = mDenseSlot[dense];
+        return PoolHandle::Make(slot, mSlotGeneration[slot]);
+    }
+    // HandleAt 的反过来：有效句柄当前的稠密下标。和池并列存放的数组（例如剔除用的包围盒）
+    // 在 Remove 之前用它找到要 swap-back 的位置
+    std::size_t DenseIndexOf(PoolHandle handle)const
+    {
+        assert(IsValid(handle));
+        return mSlotDense[handle.Slot()];
+    }
+
+    // 按块遍历热数据：第 chunk 块是稠密下标 [chunk * ChunkSize, chunk * ChunkSize + ChunkLength(chunk)) 的连续数组
+    std::size_t ChunkCount()const { return (mSize + ChunkSize - 1) / ChunkSize; }
+    std::size_t ChunkLength(std::size_t chunk)const
+    {
+        std::size_t first = chunk * ChunkSize;
+        return mSize - first < ChunkSize ? mSize - first : ChunkSize;
+    }
+    Hot* ChunkHot(std::size_t chunk) { return mHotChunks[chunk].get(); }
+    const Hot* ChunkHot(std::size_t chunk)const { return mHotChunks[chunk].get(); }
+
+private:
+    std::vector<std::unique_ptr<Hot[]>> mHotChunks;
+    std::vector<std::unique_ptr<Cold[]>> mColdChunks;
+    std::size_t mSize = 0;
+
+    std::vector<std::uint32_t> mDenseSlot;      // 稠密下标 -> 槽位
+    std::vector<std::uint32_t> mSlotDense;      // 槽位 -> 稠密下标
+    std::vector<std::uint32_t> mSlotGeneration; // 槽位当前的代数
+    std::vector<std::uint32_t> mFreeSlots;
+};
@@ -0,0 +1,125 @@
+/*
+GPU 显存子分配的纯 CPU 部分：只计算 (堆索引, 偏移)，不创建任何 D3D12 对象。
+BuddyAllocator 管理单个堆，最小块 64KB（D3D12 放置资源的默认对齐）；
+HeapPool 管理一组大小相同的堆，并能给出碎片整理的搬迁计划和每个堆的使用统计。
+真正创建 ID3D12Heap / 放置资源的部分见 GpuMemoryAllocator.h。
+*/
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+class BuddyAllocator
+{
+public:
+    static constexpr std::uint64_t InvalidOffset = ~0ull;
+    static constexpr std::uint64_t DefaultMinBlockSize = 64 * 1024;
+
+    struct Block
+    {
+        std::uint64_t Offset = 0;
+        std::uint64_t Size = 0;      // 调用者请求的大小
+        std::uint64_t BlockSize = 0; // 实际占用的伙伴块大小
+    };
+
+    BuddyAllocator() = default;
+    // capacity 会被向上取整为 minBlockSize 的 2 的幂倍
+    BuddyAllocator(std::uint64_t capacity, std::uint64_t minBlockSize = DefaultMinBlockSize);
+
+    // 返回块的偏移，失败时返回 InvalidOffset。伙伴块天然按自身大小对齐。
+    std::uint64_t Allocate(std::uint64_t byteSize, std::uint64_t alignment = DefaultMinBlockSize);
+    void Free(std::uint64_t offset);
+
+    std::uint64_t Capacity() const { return mMinBlockSize << mMaxOrder; }
+    std::uint64_t MinBlockSize() const { return mMinBlockSize; }
+    std::uint64_t AllocatedBytes() const { return mAllocatedBytes; }
+    std::uint64_t RequestedBytes() const { return mRequestedBytes; }
+    std::uint64_t FreeBytes() const { return Capacity() - mAllocatedBytes; }
+    std::uint64_t LargestFreeBlock() const;
+    std::uint32_t FreeBlockCount() const;
+    std::uint32_t AllocationCount() const { return (std::uint32_t)mAllocations.size(); }
+    bool Empty() const { return mAllocations.empty(); }
+
+    std::vector<Block> Allocations() const;
+
+private:
+    std::uint32_t OrderForSize(std::uint64_t byteSize) const;
+
+    struct AllocationInfo
+    {
+        std::uint32_t Order = 0;
+        std::uint64_t Size = 0;
+    };
+
+    std::uint64_t mMinBlockSize = DefaultMinBlockSize;
+    std::uint32_t mMaxOrder = 0;
+    std::vector<std::set<std::uint64_t>> mFreeBlocks; // 每一阶的空闲块偏移
+    std::map<std::uint64_t, AllocationInfo> mAllocations;
+    std::uint64_t mAllocatedBytes = 0;
+    std::uint64_t mRequestedBytes = 0;
+};
+
+struct PoolAllocation
+{
+    static constexpr std::uint32_t InvalidHeap = 0xffffffff;
+
+    std::uint32_t HeapIndex = InvalidHeap;
+    std::uint64_t Offset = 0;
+    std::uint64_t Size = 0;
+
+    bool IsValid() const { return HeapIndex != InvalidHeap; }
+};
+
+struct HeapStats
+{
+    std::uint32_t HeapIndex = 0;
+    std::uint64_t Capacity = 0;
+    std::uint64_t AllocatedBytes = 0;   // 按伙伴块计
+    std::uint64_t RequestedBytes = 0;   // 按请求大小计，差值就是内部碎片
+    std::uint64_t LargestFreeBlock = 0;
+    std::uint32_t AllocationCount = 0;
+    std::uint32_t FreeBlockCount = 0;
+};
+
+// 把 Source 搬到 DestHeap 的 DestOffset 处
+struct DefragMove
+{
+    PoolAllocation Source;
+    std::uint32_t DestHeap = 0;
+    std::uint64_t DestOffset = 0;
+    std::uint64_t BlockSize = 0; // 用作 AllocateInHeap 的 alignment 即可得到同样的块
+};
+
+struct DefragPlan
+{
+    std::vector<DefragMove> Moves;
+    std::vector<std::uint32_t> FreedHeaps; // 执行完 Moves 后会变空、可以释放的堆
+    std::uint64_t BytesMoved = 0;
+};
+
+class HeapPool
+{
+public:
+    explicit HeapPool(std::uint64_t heapSize, std::uint64_t minBlockSize = BuddyAllocator::DefaultMinBlockSize);
+
+    // 现有的堆放不下时会追加一个新堆（HeapCount() 随之增长），比 heapSize 大的请求会得到专用的大堆
+    PoolAllocation Allocate(std::uint64_t byteSize, std::uint64_t alignment = BuddyAllocator::DefaultMinBlockSize);
+    // 只在指定堆里分配，用于执行碎片整理计划
+    PoolAllocation AllocateInHeap(std::uint32_t heapIndex, std::uint64_t byteSize, std::uint64_t alignment = BuddyAllocator::DefaultMinBlockSize);
+    void Free(const PoolAllocation& allocation);
+
+    std::uint32_t HeapCount() const { return (std::uint32_t)mHeaps.size(); }
+    std::uint64_t HeapCapacity(std::uint32_t heapIndex) const { return mHeaps[heapIndex].Capacity(); }
+    std::vector<HeapStats> GetHeapStats() const;
+
+    // 从使用率最低的堆开始，尝试把它的全部分配搬进其他堆；能整堆腾空才计入计划。
+    // maxBytesToMove 限制一次计划的搬迁量（0 表示不限制）。
+    DefragPlan PlanDefragmentation(std::uint64_t maxBytesToMove = 0) const;
+
+private:
+    std::uint64_t mHeapSize = 0;
+    std::uint64_t mMinBlockSize = 0;
+    std::vector<BuddyAllocator> mHeaps;
+};
@@ -0,0 +1,47 @@
+/*
+ExecuteIndirect 路径的 CPU 端参数生成（不依赖 D3D12）。
+每个实例组对应一条 32 字节的间接命令：实例组基准下标和材质下标（两个根常量）、
+DrawIndexedInstanced 的参数，布局与 Renderer 里的命令签名一一对应。
+生成是一次对实例组数组的顺序遍历：没有分支，每条命令用两次 16 字节非临时存储直接写进上传堆。
+命令签名不改变顶点/索引缓冲区，所以几何体和图元拓扑相同的相邻组合成一段，每段一次 ExecuteIndirect。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "InstanceBatcher.h"
+
+struct IndirectDrawCommand
+{
+    std::uint32_t BaseInstance = 0;  // 槽位 0 的根常量 gBaseInstance
+    std::uint32_t MaterialIndex = 0; // 槽位 1 的根常量 gMaterialIndex
+    // 以下 5 个字段与 D3D12_DRAW_INDEXED_ARGUMENTS 相同
+    std::uint32_t IndexCountPerInstance = 0;
+    std::uint32_t InstanceCount = 0;
+    std::uint32_t StartIndexLocation = 0;
+    std::int32_t BaseVertexLocation = 0;
+    std::uint32_t StartInstanceLocation = 0;
+    std::uint32_t Padding = 0;       // 补到 32 字节，每条命令正好两次 16 字节写入
+};
+static_assert(sizeof(IndirectDrawCommand) == 32, "间接命令必须紧密排列为 32 字节");
+
+// 共用顶点/索引缓冲区和图元拓扑的一段连续实例组 [First, Last)，命令下标与组下标相同
+struct IndirectRun
+{
+    std::size_t First = 0;
+    std::size_t Last = 0;
+};
+
+// 把 groups[0, count) 转成间接命令写到 dst[0, count)。dst 必须 16 字节对齐，可以是上传堆的映射内存；
+// 写完不带 fence，交给 GPU 之前调用 WriteCombined::Fence()
+void BuildIndirectDrawCommands(const InstanceGroup* groups, std::size_t count, IndirectDrawCommand* dst);
+
+// 相邻且几何体和图元拓扑相同的实例组合成一段
+void BuildIndirectRuns(const InstanceGroup* groups, std::size_t count, std::vector<IndirectRun>& runs);
+
+// 上传环里为间接命令预留的条数。分配时还没有分组，只能按上一次的组数 previousGroups 加余量
+// （至少 minHeadroom 条，或组数的 1/8）预留，不超过 maxGroups（渲染项数）。
+// 组数超过当前预留时增长；降到新预留量的一半以下才收缩，组数小幅波动时块的大小不变，不用整块重写
+std::size_t IndirectCommandCapacity(std::size_t previousGroups, std::size_t currentCapacity,
+    std::size_t maxGroups, std::size_t minHeadroom);
@@ -0,0 +1,62 @@
+/*
+自动实例化的分组逻辑（不依赖 D3D12）。
+几何体、子网格（索引区间和基准顶点）、材质和图元拓扑都相同的渲染项可以合并成一次
+DrawIndexedInstanced：每组的实例数据在实例缓冲区里连续存放，着色器用
+gBaseInstance + SV_InstanceID 取到自己的那一项。
+组按在输入中第一次出现的顺序排列，组内保持输入顺序，所以输入先按排序键排好的话，
+组之间仍然按状态聚在一起，组内仍然由近到远。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 决定两个渲染项能否合并的全部绘制状态
+struct InstanceKey
+{
+    std::uint64_t Geometry = 0; // 几何体标识（Renderer 里是 MeshGeometry 的地址）
+    std::uint32_t Material = 0;
+    std::uint32_t IndexCount = 0;
+    std::uint32_t StartIndexLocation = 0;
+    std::int32_t BaseVertexLocation = 0;
+    std::uint32_t PrimitiveTopology = 0;
+
+    bool operator==(const InstanceKey& rhs)const
+    {
+        return Geometry == rhs.Geometry && Material == rhs.Material && IndexCount == rhs.IndexCount &&
+            StartIndexLocation == rhs.StartIndexLocation && BaseVertexLocation == rhs.BaseVertexLocation &&
+            PrimitiveTopology == rhs.PrimitiveTopology;
+    }
+};
+
+struct InstanceGroup
+{
+    InstanceKey Key;
+    std::uint32_t FirstInstance = 0; // 在 InstanceOrder 中的起始位置，也是着色器里的 gBaseInstance
+    std::uint32_t InstanceCount = 0;
+};
+
+class InstanceBatcher
+{
+public:
+    // keys[i] 是按绘制顺序第 i 个渲染项的键；重新分组，上一次的结果作废（内存保留复用）
+    void Build(const InstanceKey* keys, std::size_t count);
+
+    const std::vector<InstanceGroup>& Groups()const { return mGroups; }
+    // InstanceOrder()[i] 是实例缓冲区第 i 个元素对应的输入下标
+    const std::vector<std::uint32_t>& InstanceOrder()const { return mInstanceOrder; }
+
+private:
+    struct KeyHash
+    {
+        std::size_t operator()(const InstanceKey& key)const;
+    };
+
+    std::unordered_map<InstanceKey, std::uint32_t, KeyHash> mGroupIndex;
+    std::vector<std::uint32_t> mItemGroup; // 每个输入所属的组
+    std::vector<std::uint32_t> mCursor;    // 分散写入时各组的下一个位置
+    std::vector<InstanceGroup> mGroups;
+    std::vector<std::uint32_t> mInstanceOrder;
+};
@@ -0,0 +1,144 @@
+/*
+工作窃取（work-stealing）作业系统（纯 C++ 标准库，不依赖 D3D12/Windows）。
+每个线程一个 Chase-Lev 双端队列：所有者在底部压入/弹出，其他线程空闲时从顶部窃取。
+JobCounter 是依赖计数器：Run 时加一、作业完成时减一；RunAfter 把作业挂在计数器上，
+计数归零后才开始执行；Wait 在等待期间帮忙执行作业，所以主线程可以直接 fork/join。
+作业抛出的第一个异常保存在计数器里，由 Wait 重新抛出。
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+struct Job
+{
+    std::function<void()> Function;
+    class JobCounter* Counter = nullptr;
+};
+
+// 计数器只能在所有相关作业完成（Wait 返回）之后销毁
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter& rhs) = delete;
+    JobCounter& operator=(const JobCounter& rhs) = delete;
+
+    bool IsDone()const { return mValue.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> mValue{ 0 };
+    std::mutex mMutex; // 保护 mContinuations、mException，以及计数归零的那一刻
+    std::vector<Job*> mContinuations;
+    std::exception_ptr mException;
+};
+
+// Chase-Lev 双端队列（固定容量）。Push/Pop 只能由所有者线程调用，Steal 任意线程
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque(std::size_t capacity = 4096);
+
+    bool Push(Job* job);
+    Job* Pop();
+    Job* Steal();
+
+    std::size_t Capacity()const { return mMask + 1; }
+
+private:
+    alignas(64) std::atomic<std::int64_t> mTop{ 0 };
+    alignas(64) std::atomic<std::int64_t> mBottom{ 0 };
+    std::unique_ptr<std::atomic<Job*>[]> mBuffer;
+    std::size_t mMask;
+};
+
+class JobSystem
+{
+public:
+    // 构造它的线程成为 0 号线程（主线程），另外创建 workerThreadCount 个工作线程
+    explicit JobSystem(unsigned workerThreadCount = DefaultWorkerCount());
+    JobSystem(const JobSystem& rhs) = delete;
+    JobSystem& operator=(const JobSystem& rhs) = delete;
+    ~JobSystem();
+
+    static unsigned DefaultWorkerCount();
+
+    // 任意线程调用。counter 可以为空（不关心何时完成）
+    void Run(std::function<void()> function, JobCounter* counter = nullptr);
+    // dependency 归零后才执行 function
+    void RunAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+    // 等待 counter 归零，期间执行其他作业；有作业抛出异常时在这里重新抛出
+    void Wait(JobCounter& counter);
+
+    // 把 [begin, end) 按 grainSize 切块并行执行 function(first, last)，返回时全部完成
+    template<typename Function>
+    void ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, Function&& function)
+    {
+        if(end <= begin)
+            return;
+        if(grainSize == 0)
+            grainSize = 1;
+
+        JobCounter counter;
+        std::size_t first = begin;
+        // 最后一块留给当前线程自己执行
+        for(; first + grainSize < end; first += grainSize)
+        {
+            std::size_t last = first + grainSize;
+            Run([&function, first, last]() { function(first, last); }, &counter);
+        }
+
+        std::exception_ptr inlineException;
+        try
+        {
+            function(first, end);
+        }
+        catch(...)
+        {
+            inlineException = std::current_exception();
+        }
+        Wait(counter);
+        if(inlineException)
+            std::rethrow_exception(inlineException);
+    }
+
+    unsigned ThreadCount()const { return (unsigned)mQueues.size(); }
+    // 当前线程在本作业系统中的编号，不属于本系统的线程返回 -1
+    int CurrentThreadIndex()const;
+
+private:
+    void WorkerLoop(unsigned index);
+    void Submit(Job* job);
+    Job* FindJob(int index);
+    bool TryRunOne();
+    void Execute(Job* job);
+    void Finish(JobCounter* counter, std::exception_ptr exception);
+
+    std::vector<std::unique_ptr<WorkStealingDeque>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    // 非本系统线程提交的作业，以及本地队列满时的溢出
+    std::mutex mInjectionMutex;
+    std::vector<Job*> mInjection;
+    std::atomic<std::size_t> mInjectionCount{ 0 };
+
+    // 空闲工作线程在这里睡眠
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition;
+    std::atomic<std::int64_t> mQueuedJobs{ 0 };
+    std::atomic<int> mSleepers{ 0 };
+    std::atomic<bool> mStop{ false };
+};
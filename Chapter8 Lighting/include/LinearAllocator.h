@@ -0,0 +1,134 @@
+/*
+线性分配器（bump allocator）：只负责在一段已映射的内存里推进偏移量。
+它不依赖 D3D12，底层可以是上传堆，也可以是普通内存（方便在 Linux 上做单元测试）。
+整块内存在对应帧的围栏完成之后通过 Reset() 一次性回收。
+GrowableLinearAllocator 在回收时按需换一块更大的内存，创建和释放内存的部分交给 Backing（见 UploadRing.h）。
+*/
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+struct LinearAllocation
+{
+    std::uint8_t* CpuAddress = nullptr; // 可写入的 CPU 指针
+    std::uint64_t GpuAddress = 0;       // 对应的 GPU 虚拟地址
+    std::uint64_t Offset = 0;           // 相对于整块内存起始处的偏移
+    std::uint64_t Size = 0;
+
+    bool IsValid() const { return CpuAddress != nullptr; }
+};
+
+class LinearAllocator
+{
+public:
+    // 常量缓冲区视图要求 256 字节对齐
+    static constexpr std::uint64_t ConstantBufferAlignment = 256;
+
+    LinearAllocator() = default;
+    LinearAllocator(std::uint8_t* cpuBase, std::uint64_t gpuBase, std::uint64_t capacity) :
+        mCpuBase(cpuBase),
+        mGpuBase(gpuBase),
+        mCapacity(capacity)
+    {
+    }
+
+    // 分配失败（空间不足或对齐不是 2 的幂）时返回无效的 LinearAllocation
+    LinearAllocation Allocate(std::uint64_t byteSize, std::uint64_t alignment = ConstantBufferAlignment)
+    {
+        LinearAllocation alloc;
+        if(alignment == 0 || (alignment & (alignment - 1)) != 0)
+            return alloc;
+
+        std::uint64_t offset = AlignUp(mOffset, alignment);
+        if(offset > mCapacity || byteSize > mCapacity - offset)
+            return alloc;
+
+        alloc.CpuAddress = mCpuBase + offset;
+        alloc.GpuAddress = mGpuBase + offset;
+        alloc.Offset = offset;
+        alloc.Size = byteSize;
+
+        mOffset = offset + byteSize;
+        if(mOffset > mHighWatermark)
+            mHighWatermark = mOffset;
+
+        return alloc;
+    }
+
+    // 只有在 GPU 不再读取这块内存（围栏已完成）之后才能调用
+    void Reset()
+    {
+        mOffset = 0;
+    }
+
+    std::uint64_t Capacity() const { return mCapacity; }
+    std::uint64_t Used() const { return mOffset; }
+    std::uint64_t HighWatermark() const { return mHighWatermark; }
+
+    static std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+private:
+    std::uint8_t* mCpuBase = nullptr;
+    std::uint64_t mGpuBase = 0;
+    std::uint64_t mCapacity = 0;
+    std::uint64_t mOffset = 0;
+    std::uint64_t mHighWatermark = 0;
+};
+
+// 容量不固定的线性分配器：每次回收时调用方给出下一轮要分配的总字节数，不够时通过 Backing 换一块更大的内存，
+// 分配本身不会失败。Backing 需要提供：
+//   LinearAllocator Create(std::uint64_t byteSize); // 创建（并映射）一块内存，返回覆盖整块的分配器
+//   void Release();                                 // 释放 Create 创建的那一块
+template<typename Backing>
+class GrowableLinearAllocator
+{
+public:
+    // 增长后的容量按 64KB 取整
+    static constexpr std::uint64_t GrowthGranularity = 64 * 1024;
+
+    GrowableLinearAllocator(Backing backing, std::uint64_t byteSize) :
+        mBacking(std::move(backing))
+    {
+        mAllocator = mBacking.Create(byteSize);
+    }
+
+    GrowableLinearAllocator(const GrowableLinearAllocator& rhs) = delete;
+    GrowableLinearAllocator& operator=(const GrowableLinearAllocator& rhs) = delete;
+
+    // 容量由 Reset(requiredBytes) 保证，这一轮的分配总量不能超过当时给出的字节数
+    LinearAllocation Allocate(std::uint64_t byteSize, std::uint64_t alignment = LinearAllocator::ConstantBufferAlignment)
+    {
+        LinearAllocation alloc = mAllocator.Allocate(byteSize, alignment);
+        assert(alloc.IsValid() && "GrowableLinearAllocator: allocates more than was reserved in Reset");
+        return alloc;
+    }
+
+    // 调用者需保证 GPU 已经用完这块内存。requiredBytes 超过容量时换一块更大的（至少增长一半，避免每轮都重建）。
+    // 返回 true 表示换过内存：之前分配的块连同写进去的数据都不在了，调用方不能再沿用
+    bool Reset(std::uint64_t requiredBytes = 0)
+    {
+        mAllocator.Reset();
+        std::uint64_t capacity = mAllocator.Capacity();
+        if(requiredBytes <= capacity)
+            return false;
+
+        std::uint64_t newCapacity = (std::max)(requiredBytes, capacity + capacity / 2);
+        mBacking.Release();
+        mAllocator = mBacking.Create(LinearAllocator::AlignUp(newCapacity, GrowthGranularity));
+        return true;
+    }
+
+    const LinearAllocator& Allocator()const { return mAllocator; }
+    const Backing& GetBacking()const { return mBacking; }
+
+private:
+    Backing mBacking;
+    LinearAllocator mAllocator;
+};
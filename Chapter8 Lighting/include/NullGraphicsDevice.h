@@ -0,0 +1,97 @@
+/*
+不连接任何 GPU 的记录型后端（不依赖 D3D12）。
+命令列表把调用写进 CommandStream，提交时只遍历一遍命令流做统计；
+围栏在 Signal 之后 latency 才算完成，完成顺序与 Signal 顺序一致，用来模拟 GPU 落后 CPU 的帧数。
+配合 Renderer 的录制路径可以在无头环境里测量每帧的 CPU 开销。
+*/
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include "CommandStream.h"
+#include "GraphicsDevice.h"
+
+class NullCommandList : public CommandList
+{
+public:
+    void Begin(PipelineHandle initialPipeline) override;
+    void End() override;
+
+    void TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter) override;
+    void ClearRenderTarget(DescriptorHandle rtv, const float color[4]) override;
+    void ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil) override;
+
+    void SetViewport(const ViewportDesc& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv) override;
+    void SetGraphicsRootSignature(RootSignatureHandle rootSignature) override;
+    void SetPipelineState(PipelineHandle pipeline) override;
+    void SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address) override;
+    void SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address) override;
+    void SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset) override;
+
+    void SetVertexBuffer(const VertexBufferBinding& view) override;
+    void SetIndexBuffer(const IndexBufferBinding& view) override;
+    void SetPrimitiveTopology(std::uint32_t topology) override;
+    void DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+        std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation) override;
+    void ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+        ResourceHandle argumentBuffer, std::uint64_t argumentOffset) override;
+    void CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+        ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes) override;
+
+    const CommandStreamWriter* RecordedStream()const override { return &mStream; }
+
+    const CommandStreamWriter& Stream()const { return mStream; }
+    bool IsRecording()const { return mRecording; }
+
+private:
+    CommandStreamWriter mStream;
+    bool mRecording = false;
+};
+
+class NullGraphicsDevice : public GraphicsDevice
+{
+public:
+    struct Stats
+    {
+        std::uint64_t Submissions = 0;
+        std::uint64_t CommandLists = 0;
+        std::uint64_t Commands = 0;
+        std::uint64_t Draws = 0;            // DrawIndexedInstanced 和 ExecuteIndirect 的调用次数
+        std::uint64_t IndirectCommands = 0; // ExecuteIndirect 的命令数上限之和
+        std::uint64_t CopyCommands = 0;     // CopyBufferRegion 的调用次数
+        std::uint64_t CopyBytes = 0;        // CopyBufferRegion 复制的字节数之和
+        std::uint64_t Bytes = 0;
+    };
+
+    explicit NullGraphicsDevice(std::chrono::microseconds fenceLatency = std::chrono::microseconds(0));
+
+    std::unique_ptr<CommandList> CreateCommandList() override;
+    bool RecordsCommandStreams()const override { return true; }
+    // 提交的必须是本设备创建、已经 End 的列表，否则抛出 std::logic_error
+    void ExecuteCommandLists(CommandList* const* lists, std::uint32_t count) override;
+
+    void Signal(std::uint64_t fenceValue) override;
+    std::uint64_t CompletedFenceValue() override;
+    void WaitForFenceValue(std::uint64_t fenceValue) override;
+
+    void SetFenceLatency(std::chrono::microseconds latency);
+    Stats GetStats()const;
+
+private:
+    struct PendingSignal
+    {
+        std::uint64_t Value;
+        std::chrono::steady_clock::time_point CompleteTime;
+    };
+
+    void RetireSignals(std::chrono::steady_clock::time_point now);
+
+    mutable std::mutex mMutex;
+    std::chrono::microseconds mFenceLatency;
+    std::deque<PendingSignal> mPendingSignals;
+    std::uint64_t mCompletedValue = 0;
+    Stats mStats;
+};
@@ -0,0 +1,114 @@
+/*
+物体数据按更新频率分层（不依赖 D3D12）。
+静态层：几乎不动的物体（地面、柱子），数据放在默认堆的缓冲区里，初始化时写一次，
+GPU 每帧读的是显存而不是经过 PCIe 的上传堆。偶尔有静态物体变化时，把变化的槽位排序、
+合并成连续区间，新数据写进本帧上传环的暂存块，再用几条 CopyBufferRegion 补到默认堆里。
+动态层：经常变化的物体，数据在每个帧资源的上传环里各有一份，着色器直接从上传堆读；
+每个帧资源只重写自上次写入以来变化过的槽位（FrameDirtyTracker）。
+着色器里用的物体下标最高位表示所在的层，其余位是层内的槽位。
+表里只记录槽位和它们的所有者（调用方自己的标识），不保存物体数据本身。
+删除的槽位进空闲列表，之后加入的物体优先复用；复用的槽位会被标记为变化，保证写进新物体的数据。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FrameDirtyTracker.h"
+
+enum class UpdateFrequency : std::uint8_t
+{
+    Static,
+    Dynamic
+};
+
+// 着色器里 gInstanceObjects 存的物体下标
+namespace ObjectIndex
+{
+    constexpr std::uint32_t DynamicBit = 0x80000000u;
+    constexpr std::uint32_t SlotMask = ~DynamicBit;
+
+    inline std::uint32_t Make(UpdateFrequency frequency, std::uint32_t slot)
+    {
+        return frequency == UpdateFrequency::Dynamic ? (slot | DynamicBit) : slot;
+    }
+    inline bool IsDynamic(std::uint32_t objectIndex) { return (objectIndex & DynamicBit) != 0; }
+    inline std::uint32_t Slot(std::uint32_t objectIndex) { return objectIndex & SlotMask; }
+}
+
+// 一次 CopyBufferRegion：暂存块里从 StagingFirst 开始的 Count 个元素复制到静态层的 [FirstSlot, FirstSlot + Count)
+struct ObjectPatchRange
+{
+    std::uint32_t FirstSlot = 0;
+    std::uint32_t Count = 0;
+    std::uint32_t StagingFirst = 0;
+};
+
+class ObjectTierTable
+{
+public:
+    struct Stats
+    {
+        std::uint64_t StaticObjects = 0;
+        std::uint64_t DynamicObjects = 0;
+        std::uint64_t PatchedObjects = 0; // 本帧修补的静态槽位数（包括为了合并区间顺带复制的）
+        std::uint64_t PatchBytes = 0;     // 本帧暂存并复制到默认堆的字节数
+        std::uint64_t CopyCommands = 0;   // 本帧的 CopyBufferRegion 条数
+    };
+
+    // elementByteSize 是每个物体数据的大小，只用于统计字节数；frameCount 是帧资源数；
+    // 两个变化的槽位之间空着不超过 maxPatchGap 个槽位时合并成一次复制
+    ObjectTierTable(std::uint32_t elementByteSize, std::uint32_t frameCount, std::uint32_t maxPatchGap = 4);
+
+    void Clear();
+
+    // 加入一个物体，owner 是调用方用来找回物体数据的标识；返回着色器用的物体下标
+    std::uint32_t Add(UpdateFrequency frequency, std::uint32_t owner);
+
+    // 释放物体下标。槽位的所有者保持不变直到被复用，调用方打包数据时要能处理已经失效的所有者
+    void Remove(std::uint32_t objectIndex);
+
+    // 有空闲槽位时 Add 不会让这一层变大
+    bool HasFreeSlot(UpdateFrequency frequency)const
+    {
+        return frequency == UpdateFrequency::Dynamic ? !mDynamicFree.empty() : !mStaticFree.empty();
+    }
+
+    // 物体数据变了。静态层记进本帧的修补列表，动态层记进每个帧资源的脏列表；写入之前重复标记只算一次
+    void MarkChanged(std::uint32_t objectIndex);
+
+    // 把本帧标记过的静态槽位整理成复制区间，清空待修补列表并更新统计。每帧调用一次，
+    // 之后 PatchSlots() 是暂存块的内容顺序（第 i 个元素写 StaticOwners()[PatchSlots()[i]] 的数据）
+    void BuildFramePatches();
+
+    // 帧资源 frame 的动态层需要重写的槽位；写完（或整块重写后）调用 ClearDynamicDirty
+    const std::vector<std::uint32_t>& DynamicDirty(std::uint32_t frame)const { return mDynamicDirty.Dirty(frame); }
+    void ClearDynamicDirty(std::uint32_t frame) { mDynamicDirty.Clear(frame); }
+
+    const std::vector<ObjectPatchRange>& PatchRanges()const { return mPatchRanges; }
+    const std::vector<std::uint32_t>& PatchSlots()const { return mPatchSlots; }
+
+    // 下标是层内槽位，值是 Add 时的 owner（包括已经 Remove 的槽位）
+    const std::vector<std::uint32_t>& StaticOwners()const { return mStaticOwners; }
+    const std::vector<std::uint32_t>& DynamicOwners()const { return mDynamicOwners; }
+
+    std::uint32_t ElementByteSize()const { return mElementByteSize; }
+    const Stats& GetStats()const { return mStats; }
+
+private:
+    std::uint32_t mElementByteSize;
+    std::uint32_t mFrameCount;
+    std::uint32_t mMaxPatchGap;
+
+    std::vector<std::uint32_t> mStaticOwners;
+    std::vector<std::uint32_t> mDynamicOwners;
+    FrameDirtyTracker mDynamicDirty;
+    std::vector<std::uint32_t> mStaticFree;
+    std::vector<std::uint32_t> mDynamicFree;
+
+    std::vector<std::uint8_t> mPatchPending;   // 每个静态槽位是否已经在 mPendingSlots 里
+    std::vector<std::uint32_t> mPendingSlots;  // 本帧标记过的静态槽位，无序
+    std::vector<std::uint32_t> mPatchSlots;
+    std::vector<ObjectPatchRange> mPatchRanges;
+    Stats mStats;
+};
@@ -0,0 +1,81 @@
+/*
+多线程录制命令列表的分批与排序逻辑（不依赖 D3D12）。
+渲染项按原有顺序切成连续的批次，每批录制进自己的命令列表，
+提交时按批次顺序排列，所以 GPU 看到的绘制顺序与单线程录制完全一致。
+命令列表类型是模板参数：Renderer 使用 GraphicsDevice.h 的 CommandList（D3D12 或 NullCommandList）。
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <vector>
+#include "JobSystem.h"
+
+struct RecordBatch
+{
+    std::size_t First = 0; // [First, Last) 渲染项区间
+    std::size_t Last = 0;
+    unsigned ListIndex = 0;  // 录制进第几个命令列表，也是提交顺序
+};
+
+// 把 itemCount 个渲染项切成最多 maxLists 个连续批次，每批至少 minItemsPerBatch 个（项数不够时只有一批）。
+// 各批大小相差不超过 1；itemCount 为 0 时仍返回一个空批次，保证帧的开头/结尾命令有地方录制
+inline std::vector<RecordBatch> PartitionRecordBatches(std::size_t itemCount, unsigned maxLists, std::size_t minItemsPerBatch)
+{
+    if(maxLists == 0)
+        maxLists = 1;
+    if(minItemsPerBatch == 0)
+        minItemsPerBatch = 1;
+
+    std::size_t batchCount = std::min<std::size_t>(maxLists, std::max<std::size_t>(1, itemCount / minItemsPerBatch));
+
+    std::vector<RecordBatch> batches(batchCount);
+    std::size_t baseSize = itemCount / batchCount;
+    std::size_t remainder = itemCount % batchCount;
+    std::size_t first = 0;
+    for(std::size_t i = 0; i < batchCount; ++i)
+    {
+        std::size_t size = baseSize + (i < remainder ? 1 : 0);
+        batches[i].First = first;
+        batches[i].Last = first + size;
+        batches[i].ListIndex = (unsigned)i;
+        first += size;
+    }
+    return batches;
+}
+
+// 每个批次作为一个作业并行录制：record(list, batch) 负责 Reset、录制和 Close。
+// 返回按提交顺序排列的命令列表，直接交给一次 ExecuteCommandLists
+template<typename ListType, typename RecordFunction>
+std::vector<ListType*> RecordBatchesInParallel(JobSystem& jobs, const std::vector<RecordBatch>& batches,
+    ListType* const* lists, RecordFunction&& record)
+{
+    JobCounter recorded;
+    for(std::size_t i = 1; i < batches.size(); ++i)
+    {
+        const RecordBatch* batch = &batches[i];
+        jobs.Run([&record, lists, batch]() { record(lists[batch->ListIndex], *batch); }, &recorded);
+    }
+
+    // 第一批在当前线程录制
+    std::exception_ptr inlineException;
+    try
+    {
+        if(!batches.empty())
+            record(lists[batches[0].ListIndex], batches[0]);
+    }
+    catch(...)
+    {
+        inlineException = std::current_exception();
+    }
+    jobs.Wait(recorded);
+    if(inlineException)
+        std::rethrow_exception(inlineException);
+
+    std::vector<ListType*> ordered;
+    ordered.reserve(batches.size());
+    for(const auto& batch : batches)
+        ordered.push_back(lists[batch.ListIndex]);
+    return ordered;
+}
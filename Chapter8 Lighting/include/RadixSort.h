@@ -0,0 +1,28 @@
+/*
+64 位键的并行 LSD 基数排序（不依赖 D3D12）。
+每趟按 8 位分桶，共 8 趟；开始前统计一次全局直方图，所有键在某个字节上都相同的那一趟直接跳过
+（排序键的高位字段通常只有一两个取值，实际只需要 3~5 趟）。
+只有一块时一次遍历就统计出所有趟的直方图；否则每趟把数组切成若干连续块：各块并行统计直方图，按 (桶, 块) 顺序做前缀和得到每块每桶的起始位置，
+再并行分散写入。块内顺序保持不变，所以排序是稳定的。
+键与 32 位载荷（通常是渲染项下标）一起移动，调用方按排好的载荷顺序取渲染项。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// 排序用的临时缓冲区和直方图，每帧复用以免重新分配
+struct RadixSortScratch
+{
+    std::vector<std::uint64_t> Keys;
+    std::vector<std::uint32_t> Values;
+    std::vector<std::uint32_t> Histograms;
+};
+
+// 对 keys 升序排序，values 随之重排（两者长度必须相同）。
+// jobs 为空或元素太少时在当前线程排序；minItemsPerJob 控制每块至少多少元素
+void RadixSortKeys(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+    RadixSortScratch& scratch, JobSystem* jobs = nullptr, std::size_t minItemsPerJob = 16384);
@@ -10,26 +10,54 @@
 
 #include "MathHelper.h"
 #include "d3dUtil.h"
-#include "UploadBuffer.h"
 #include "Camera.h"
 #include "FrameResource.h"
+#include "GpuMemoryAllocator.h"
+#include "UploadBatcher.h"
+#include "CopyQueueStreamer.h"
+#include "DeferredReleaseQueue.h"
+#include "DxgiBudgetSource.h"
+#include "JobSystem.h"
+#include "ParallelRecording.h"
+#include "D3D12GraphicsDevice.h"
+#include "CommandCapture.h"
+#include "StateCachingEncoder.h"
+#include "DrawSortKey.h"
+#include "RadixSort.h"
+#include "InstanceBatcher.h"
+#include "IndirectDraw.h"
+#include "ObjectTiers.h"
+#include "TransformPacker.h"
+#include "FrameDirtyTracker.h"
+#include "HandlePool.h"
+#include "ResourceRegistry.h"
+#include "FrustumCuller.h"
 
-struct RenderItem
+//渲染项中每帧都要遍历的字段（剔除、排序、打包物体数据），在池里连续存放
+struct RenderItemHot
 {
-	RenderItem() = default;
-
     DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4(); //该几何体的世界矩阵
+    DirectX::BoundingBox Bounds;   //子网格在局部空间的包围盒
+    std::uint64_t SortKey = 0;     //排序键中与深度无关的部分（材质、几何体），加入时算好
+    std::uint32_t ObjectIndex = 0; //物体下标（ObjectIndex）：最高位区分静态/动态层，其余位是层内槽位
+};
+
+//只在分组和录制时读的字段
+struct RenderItem
+{
     DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-	UINT ObjCBIndex = -1; //该几何体的常量数据在objConstantBuffer中的索引
+    UpdateFrequency Frequency = UpdateFrequency::Static; //静态物体的数据常驻默认堆，动态物体写进上传环
 	MeshGeometry* Geo = nullptr;
     Material* Mat = nullptr;
     D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
     UINT IndexCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
-    int NumFramesDirty = gNumFrameResources;
 };
 
+typedef PoolHandle RenderItemHandle;
+typedef HandlePool<RenderItemHot, RenderItem> RenderItemPool;
+
 class Renderer {
 public:
     Renderer();
@@ -43,6 +71,63 @@ public:
     ID3D12Resource* CurrentBackBuffer() const;
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView() const;
 
+    // 任意线程调用：在复制队列上异步上传一个几何体，复制围栏完成后它才会出现在 mGeometries 里。
+    // shadowPolicy 决定上传后CPU端副本如何保留；PageFromFile 需要事先在 geo 上 SetFileSource
+    void StreamMeshGeometryAsync(std::unique_ptr<MeshGeometry> geo,
+        std::vector<BYTE> vertexData, std::vector<BYTE> indexData,
+        ShadowCopyPolicy shadowPolicy = ShadowCopyPolicy::DropAfterUpload);
+
+    // 各类别的显存用量和预算，供性能面板显示
+    ResidencyManager::Stats GetMemoryStats() const { return mResidency->GetStats(); }
+
+    // 修改材质参数后在主线程调用，每个帧资源下次更新时把它写进各自的材质表
+    void MarkMaterialDirty(Material* material);
+    // 以下在主线程调用。
+    // 加入渲染项：item 的 Geo、Mat 和 submesh 必须有效，索引区间和包围盒取自 submesh。
+    // 初始化之后加入的静态物体优先复用删除留下的静态层槽位，没有空位时放进动态层
+    RenderItemHandle AddRenderItem(const RenderItem& item, const SubmeshGeometry& submesh,
+        const DirectX::XMFLOAT4X4& world = MathHelper::Identity4x4());
+    // 删除渲染项，句柄随即失效；句柄已经失效时返回 false
+    bool RemoveRenderItem(RenderItemHandle handle);
+    // 修改世界矩阵。静态物体在下一帧用复制命令补到默认堆里，动态物体写进每个帧资源各自的动态层；
+    // 没有修改的物体不会重新上传，也不会重新排序
+    void SetRenderItemWorld(RenderItemHandle handle, const DirectX::XMFLOAT4X4& world);
+
+    // 上一帧录制时实际下发和因状态相同而跳过的调用数
+    StateCachingEncoder::Stats GetEncoderStats() const { return mEncoderStats; }
+
+    // 上一帧各块实际写进上传堆的字节数，以及上传环的占用
+    struct UploadStats
+    {
+        std::uint64_t DynamicObjectBytes = 0; //动态层中变化的物体
+        std::uint64_t StaticPatchBytes = 0;   //变化的静态物体，写进暂存块后复制到默认堆
+        std::uint64_t StaticPatchCopies = 0;  //修补静态层的 CopyBufferRegion 条数
+        std::uint64_t MaterialBytes = 0; //材质表中变化的材质
+        std::uint64_t InstanceBytes = 0; //每个实例的物体下标，绘制顺序不变时为 0
+        std::uint64_t PassBytes = 0;     //摄像机和光照不变时为 0
+        std::uint64_t IndirectBytes = 0;
+        std::uint64_t RingUsed = 0;          //本帧从上传环分配的字节数（含预留和对齐）
+        std::uint64_t RingHighWatermark = 0;
+        std::uint64_t RingCapacity = 0;
+
+        std::uint64_t TotalWritten()const
+        {
+            return DynamicObjectBytes + StaticPatchBytes + MaterialBytes + InstanceBytes + PassBytes + IndirectBytes;
+        }
+    };
+    UploadStats GetUploadStats() const { return mUploadStats; }
+
+    // 最近一次视锥剔除的渲染项总数和可见数
+    struct CullStats
+    {
+        std::uint64_t TotalItems = 0;
+        std::uint64_t VisibleItems = 0;
+    };
+    CullStats GetCullStats() const { return mCullStats; }
+
+    // 捕获接下来 frameCount 帧提交的命令和常量上传，完成后写到 path，可以用 CaptureReplay 工具回放
+    void CaptureFrames(UINT frameCount, const std::string& path);
+
 private:
     UINT m_width = 1280;  
     UINT m_height = 720; 
@@ -56,6 +141,17 @@ private:
     bool m4xMsaaState = false; // 是否启用 MSAA
     UINT m4xMsaaQuality = 0;   // MSAA 质量级别
     static const UINT SwapChainBufferCount = 2; 
+    //场景几何体的CPU端副本策略：目前没有CPU端使用者，压缩保存以备拾取使用
+    ShadowCopyPolicy mGeometryShadowPolicy = ShadowCopyPolicy::KeepCompressed;
+    static constexpr UINT64 FrameUploadRingByteSize = 2 * 1024 * 1024; //每个帧资源上传环的最小容量，场景更大时按需增长
+    static constexpr size_t ObjectUpdateGrainSize = 64; //UpdateObjectBuffer/UpdateInstanceData 每个作业处理的个数
+    static constexpr UINT MaxRecordingLists = 8;         //每个帧资源最多的并行录制命令列表数
+    static constexpr size_t MinGroupsPerRecordBatch = 512; //实例组少于这个数时不值得拆分到多个命令列表
+    static constexpr size_t SortKeyGrainSize = 1024;      //SortRenderItems 每个作业计算的排序键个数
+    static constexpr size_t IndirectCommandGrainSize = 4096; //BuildIndirectCommands 每个作业生成的命令条数
+    static constexpr size_t MinIndirectHeadroom = 256;   //间接命令在上一次的实例组数之外至少多预留的条数
+    static constexpr float CameraNearZ = 1.0f;
+    static constexpr float CameraFarZ = 1000.0f;
 
 
     //3缓冲
@@ -67,29 +163,52 @@ private:
 
     //初始化
     void CreateDevice();
+    void CreateGpuMemoryAllocators();
     void CreateDescriptorHeaps();
     void CreateFence();
-    void CreateConstantBuffer();
     void CreateDepthStencilBuffer();
     void CreateRenderTargetView();
     void CreateCommandQueue();
     void CreateSwapChain(HWND hwnd);
-    void BuildDescriptorHeaps();
-    void BuildConstantBuffers();
     void BuildRootSignature();
     void BuildShadersAndInputLayout();
     void BuildShapeGeometry();
     void BuildMaterials();
+    //材质加入材质表：分配 MatCBIndex（表中下标）并标记为脏。id 通常是 "name"_rid 字面量，
+    //运行时才知道名字的材质用 ResourceIdFromString
+    Material* RegisterMaterial(const NamedResourceId& id, std::unique_ptr<Material> material);
+    //按 Frequency 给渲染项分配物体下标，创建静态层的默认堆缓冲区并上传一次
+    void BuildObjectTiers();
     void BuildPSO();
-    void SetViewportAndScissor(UINT width, UINT height);
+    //ExecuteIndirect 用的命令签名，布局与 IndirectDrawCommand 一致，依赖根签名
+    void BuildCommandSignature();
+    void SetViewportAndScissor(CommandList* cmdList, UINT width, UINT height);
     void FlushCommandQueue();
     void ProcessInput();
     void OnKeyboardInput();
+    //把几何体交给延迟释放队列：最后一次可能使用它的帧完成后再释放显存
+    void DeferReleaseGeometry(std::unique_ptr<MeshGeometry> geo);
+    //被驱逐的几何体只释放显存，MeshGeometry 本身保留，重新流送同名几何体时再填回
+    void EvictGeometry(MeshGeometry* geo);
 
     HRESULT hr;
     Camera m_camera;
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    std::unique_ptr<GpuMemoryAllocator> mBufferAllocator;   //默认堆缓冲区的放置资源分配器
+    std::unique_ptr<GpuMemoryAllocator> mTextureAllocator;  //纹理（非RT/DS）的放置资源分配器
+    std::unique_ptr<UploadBatcher> mUploadBatcher;           //初始化阶段的批量上传
+    std::unique_ptr<CopyQueueStreamer> mCopyStreamer;        //运行时流送用的复制队列
+    std::unique_ptr<StreamingScheduler> mStreaming;          //流送请求队列，每帧在 Update 中推进
+    std::unique_ptr<BudgetSource> mBudgetSource;             //显存预算来源（QueryVideoMemoryInfo）
+    std::unique_ptr<ResidencyManager> mResidency;            //按类别统计显存，超预算时驱逐可流送资源
+    DeferredReleaseQueue mDeferredRelease;                   //GPU 可能仍在使用的对象，围栏完成后在 Update 中释放
+    std::unique_ptr<JobSystem> mJobs;                        //初始化和每帧更新用的工作窃取作业系统
+    std::unique_ptr<GraphicsDevice> mGraphics;               //每帧录制、提交和围栏走这层抽象（D3D12 或无头的 NullGraphicsDevice）
+    CaptureGraphicsDevice* mCapture = nullptr;               //包在 mGraphics 最外层，不捕获时只转发
+    std::string mCapturePath;
+    StateCachingEncoder::Stats mEncoderStats;
+    UploadStats mUploadStats;
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_commandQueue;
     Microsoft::WRL::ComPtr<IDXGISwapChain4> m_swapChain;
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_commandAllocator;
@@ -102,26 +221,76 @@ private:
 
     //画多个物体
     void BuildRenderItem();
-    void DrawRenderItems(ID3D12GraphicsCommandList* m_commandList,const std::vector<RenderItem*>& ritems);
+    //只绘制实例组 [firstGroup, lastGroup)，每组一次实例化绘制，多个线程可以同时录制不同的区间
+    void DrawInstanceGroups(StateCachingEncoder& encoder, size_t firstGroup, size_t lastGroup);
+    //间接绘制路径：只提交 [firstRun, lastRun) 这些段，每段一次 ExecuteIndirect
+    void DrawIndirectRuns(StateCachingEncoder& encoder, size_t firstRun, size_t lastRun);
     void UpdateCamera();
-    void UpdateObjectCBs();
+    //在主线程上按固定顺序分配本帧的常量块，返回只写变化项的两块是否换了位置（需要整块重写）；
+    //其余按代数跳过的块换了位置时把帧资源上记录的代数清零
+    void AllocateFrameConstants(bool& dynamicRelocated, bool& materialRelocated);
+    //AllocateFrameConstants 本帧最多要从上传环分配的字节数（含对齐）
+    UINT64 FrameConstantsByteSize()const;
+    //按上一次分组的组数确定本帧为间接命令预留的条数，在计算上传环大小之前调用
+    void UpdateIndirectCapacity();
     void UpdateMainPassCB();
-    void UpdateMaterialCB();
-    std::vector<std::unique_ptr<RenderItem>> mAllRitems;
-    std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
-    std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
-    std::vector<RenderItem*> mOpaqueRitems;
-    std::unordered_map<std::string,  Microsoft::WRL::ComPtr<ID3DBlob>> mShaders;
+    //本帧的观察-投影矩阵，常量缓冲区和视锥剔除用同一个
+    DirectX::XMMATRIX BuildViewProj()const;
+    //写动态层和静态层修补用的暂存块
+    void UpdateObjectData(bool dynamicRelocated);
+    //在本帧第一个命令列表开头把暂存块复制到静态层
+    void RecordStaticObjectPatches(CommandList* cmdList);
+    void UpdateMaterialBuffer(bool relocated);
+    //视锥剔除：池里每块渲染项一个作业，读 mWorldBounds，可见的稠密下标按池中顺序放在 mVisibleItems
+    void CullRenderItems();
+    //按 (阶段, PSO, 材质, 几何体, 深度) 的排序键对可见渲染项基数排序，结果放在 mSortIndices
+    void SortRenderItems();
+    //把 mSortIndices 中绘制状态相同的渲染项分成实例组
+    void BuildInstanceGroups();
+    //按实例组顺序把每个实例的物体下标写进本帧的实例缓冲区
+    void UpdateInstanceData();
+    //把实例组转成本帧的间接命令，并按几何体分段
+    void BuildIndirectCommands();
+    RenderItemPool mRenderItems;                //全部渲染项，目前都是不透明的
+    WorldBoundsArray mWorldBounds;              //与 mRenderItems 的稠密下标一一对应的世界空间包围盒，剔除只读这里
+    //按名字的标识登记，例如 mGeometries.Get("shapeGeo"_rid)
+    ResourceRegistry<std::unique_ptr<MeshGeometry>> mGeometries;
+    ResourceRegistry<std::unique_ptr<Material>> mMaterials;
+    std::vector<Material*> mMaterialTable;      //按 MatCBIndex 排列的材质，与 GPU 上的材质表一一对应
+    FrameDirtyTracker mMaterialDirty{ gNumFrameResources }; //每个帧资源还没写的材质下标
+    ObjectTierTable mObjectTiers{ sizeof(ObjectConstants), gNumFrameResources };
+    Microsoft::WRL::ComPtr<ID3D12Resource> mStaticObjectBuffer; //静态层，默认堆，所有帧资源共用
+    PoolAllocation mStaticObjectAllocation;
+    std::vector<std::uint32_t> mVisibleItems;   //剔除后可见的渲染项（池中的稠密下标）
+    std::vector<std::uint32_t> mCullScratch;    //每块的剔除结果先紧凑地写在这块自己的位置，再拼进 mVisibleItems
+    std::vector<std::uint32_t> mCullChunkVisible;
+    std::vector<std::uint32_t> mCullChunkOffset;
+    bool mFrustumCulling = true;                //F10 切换视锥剔除
+    CullStats mCullStats;
+    std::vector<std::uint64_t> mSortKeys;
+    std::vector<std::uint32_t> mSortIndices;    //按排序键排好的渲染项（池中的稠密下标），录制时按这个顺序绘制
+    RadixSortScratch mSortScratch;
+    std::vector<InstanceKey> mInstanceKeys;
+    InstanceBatcher mInstanceBatcher;
+    std::vector<IndirectRun> mIndirectRuns;
+    bool mIndirectDraws = true;                 //F8 切换 ExecuteIndirect 与逐组 DrawIndexedInstanced
+    bool mIndirectThisFrame = false;            //本帧实际走间接绘制（实例组比预留的命令多时退回逐组绘制）
+    size_t mIndirectCapacity = 0;               //每个帧资源为间接命令预留的条数
+    //内容的代数：变化时加一，帧资源记下自己的块写的是哪一代，相同就跳过重写
+    std::uint64_t mPassGeneration = 1;          //摄像机或光照变化
+    std::uint64_t mDrawListGeneration = 1;      //绘制顺序可能变化（摄像机移动，渲染项增删、移动，几何体替换）
+    std::uint64_t mSortedGeneration = 0;        //mSortIndices 和实例组对应的代数
+    std::uint64_t mCameraVersion = 0;
+    std::uint32_t mNextGeometrySortId = 0;
+    ResourceRegistry<Microsoft::WRL::ComPtr<ID3DBlob>> mShaders;
 	//std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
     //std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mCbvHeap = nullptr;
-    std::unique_ptr<UploadBuffer<ObjectConstants>> objCB = nullptr;
-    std::unique_ptr<UploadBuffer<PassConstants>> passCB = nullptr;
     std::unique_ptr<MeshGeometry> geo = nullptr;
     std::vector<D3D12_INPUT_ELEMENT_DESC> m_InputLayout;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
     Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
+    Microsoft::WRL::ComPtr<ID3D12CommandSignature> mDrawCommandSignature;
     Microsoft::WRL::ComPtr<ID3DBlob> mvsByteCode = nullptr; 
     Microsoft::WRL::ComPtr<ID3DBlob> mpsByteCode = nullptr; 
     DirectX::XMFLOAT4X4 mWorld = MathHelper::Identity4x4();
@@ -0,0 +1,135 @@
+/*
+显存预算与驻留管理（纯 CPU，不依赖 D3D12）。
+每个 GPU 分配按类别登记字节数；每帧 Update 向 BudgetSource 查询预算，
+超过高水位时按最近最少使用（LRU）顺序驱逐可流送的资源，直到降到低水位以下，
+高低水位之间的回差避免在预算边缘反复驱逐、重新加载。
+BudgetSource 的 DXGI 实现见 DxgiBudgetSource.h；FixedBudgetSource 是可配置的替身，便于在 Linux 上测试。
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+enum class MemoryCategory : std::uint32_t
+{
+    Geometry = 0,   // 顶点/索引缓冲区
+    Texture,
+    UploadHeap,     // 每帧上传环、暂存缓冲区
+    Other,
+    Count
+};
+
+const char* MemoryCategoryName(MemoryCategory category);
+
+struct MemoryBudget
+{
+    std::uint64_t Budget = 0;       // 操作系统给本进程的显存预算
+    std::uint64_t CurrentUsage = 0; // 本进程当前实际使用量（0 表示来源不提供）
+};
+
+class BudgetSource
+{
+public:
+    virtual ~BudgetSource() = default;
+    virtual MemoryBudget Query() = 0;
+};
+
+// 固定（可随时修改）的预算，用来模拟 QueryVideoMemoryInfo
+class FixedBudgetSource : public BudgetSource
+{
+public:
+    explicit FixedBudgetSource(std::uint64_t budget) : mBudget(budget) {}
+
+    MemoryBudget Query() override
+    {
+        MemoryBudget budget;
+        budget.Budget = mBudget;
+        return budget;
+    }
+
+    void SetBudget(std::uint64_t budget) { mBudget = budget; }
+
+private:
+    std::uint64_t mBudget;
+};
+
+class ResidencyManager
+{
+public:
+    static constexpr std::uint32_t InvalidId = 0xffffffff;
+
+    struct CategoryUsage
+    {
+        std::uint64_t Bytes = 0;
+        std::uint32_t Count = 0;
+        std::uint64_t EvictedBytes = 0;
+        std::uint32_t Evictions = 0;
+    };
+
+    struct Stats
+    {
+        MemoryBudget LastBudget;
+        std::uint64_t TrackedBytes = 0;
+        std::array<CategoryUsage, (size_t)MemoryCategory::Count> Categories;
+    };
+
+    // 超过 budget*highWatermark 开始驱逐，降到 budget*lowWatermark 为止。
+    // minIdleFrames：最近这么多帧用过的资源不驱逐（GPU 可能还在读它们），通常取帧资源个数
+    ResidencyManager(BudgetSource& source, float highWatermark = 0.95f, float lowWatermark = 0.85f,
+        std::uint64_t minIdleFrames = 3);
+    ResidencyManager(const ResidencyManager& rhs) = delete;
+    ResidencyManager& operator=(const ResidencyManager& rhs) = delete;
+
+    // 登记一个分配。streamable 的资源可以被驱逐，驱逐时调用 evict（负责释放显存，例如交给延迟释放队列），
+    // 随后该登记自动注销
+    std::uint32_t Track(MemoryCategory category, std::uint64_t byteSize,
+        bool streamable = false, std::function<void()> evict = nullptr);
+    void Untrack(std::uint32_t id);
+
+    // 标记本帧使用了该资源
+    void Touch(std::uint32_t id);
+
+    // 每帧调用一次：推进帧号、查询预算，必要时驱逐。返回本次驱逐的字节数
+    std::uint64_t Update();
+
+    bool IsTracked(std::uint32_t id) const;
+    CategoryUsage GetCategoryUsage(MemoryCategory category) const;
+    Stats GetStats() const;
+    std::uint64_t TrackedBytes() const;
+    std::uint64_t CurrentFrame() const { return mFrame; }
+
+private:
+    struct Entry
+    {
+        MemoryCategory Category = MemoryCategory::Other;
+        std::uint64_t ByteSize = 0;
+        std::uint64_t LastUsedFrame = 0;
+        std::function<void()> Evict;
+        bool Alive = false;
+        bool Streamable = false;
+        // 可流送资源的 LRU 双向链表，表头最久未使用
+        std::uint32_t Prev = InvalidId;
+        std::uint32_t Next = InvalidId;
+    };
+
+    void LinkBack(std::uint32_t id);
+    void Unlink(std::uint32_t id);
+    void Release(std::uint32_t id);
+
+    BudgetSource& mSource;
+    float mHighWatermark;
+    float mLowWatermark;
+    std::uint64_t mMinIdleFrames;
+
+    // Track/Untrack/Touch 可能来自加载线程的回调，统一加锁；驱逐回调在锁外执行
+    mutable std::mutex mMutex;
+    std::vector<Entry> mEntries;
+    std::vector<std::uint32_t> mFreeIds;
+    std::uint32_t mLruHead = InvalidId;
+    std::uint32_t mLruTail = InvalidId;
+    std::uint64_t mFrame = 0;
+    Stats mStats;
+};
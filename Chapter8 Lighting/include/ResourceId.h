@@ -0,0 +1,104 @@
+/*
+资源标识（不依赖 D3D12）。
+几何体、材质、子网格、着色器原来都用 std::string 作键查 unordered_map：每次查找都要对字符串求哈希、
+比较字符串，用字面量查找时还要先构造一个 std::string；operator[] 遇到拼错的名字会悄悄插入一个空元素。
+这里把名字换成 64 位的 FNV-1a 哈希："box"_rid 是 constexpr，编译期就算好，查找时只比较一个整数。
+运行时才知道的名字（流式加载的几何体、外部注册的材质）用 ResourceIdFromString 算一次，之后同样只用整数。
+调试版本保存一张哈希到名字的反查表：注册资源时记下名字，用于打印和检测两个名字哈希冲突；发布版本不保存名字。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(DEBUG) || defined(_DEBUG)
+    #define RESOURCE_ID_DEBUG_NAMES 1
+    #include <cassert>
+    #include <mutex>
+    #include <string>
+    #include <unordered_map>
+#else
+    #define RESOURCE_ID_DEBUG_NAMES 0
+#endif
+
+struct ResourceId
+{
+    std::uint64_t Value = 0; // 0 不是任何名字的标识
+
+    constexpr bool IsNull()const { return Value == 0; }
+    constexpr bool operator==(const ResourceId& rhs)const { return Value == rhs.Value; }
+    constexpr bool operator!=(const ResourceId& rhs)const { return Value != rhs.Value; }
+};
+
+// 64 位 FNV-1a。结果为 0 时改成 1，0 留给空标识
+constexpr ResourceId HashResourceName(const char* name, std::size_t length)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for(std::size_t i = 0; i < length; ++i)
+    {
+        hash ^= (std::uint8_t)name[i];
+        hash *= 0x100000001b3ull;
+    }
+    return ResourceId{ hash == 0 ? 1 : hash };
+}
+
+// 带名字的标识："box"_rid 的结果。名字指向字符串字面量本身，只在注册时给调试反查表用；
+// 需要 ResourceId 的地方可以直接传入
+struct NamedResourceId
+{
+    ResourceId Id;
+    std::string_view Name;
+
+    constexpr operator ResourceId()const { return Id; }
+};
+
+constexpr NamedResourceId operator""_rid(const char* name, std::size_t length)
+{
+    return NamedResourceId{ HashResourceName(name, length), std::string_view(name, length) };
+}
+
+// 运行时的名字（调用方负责名字在注册期间有效）
+inline NamedResourceId ResourceIdFromString(std::string_view name)
+{
+    return NamedResourceId{ HashResourceName(name.data(), name.size()), name };
+}
+
+// 调试反查表
+namespace ResourceNames
+{
+#if RESOURCE_ID_DEBUG_NAMES
+    struct Table
+    {
+        std::mutex Mutex;
+        std::unordered_map<std::uint64_t, std::string> Names;
+    };
+
+    inline Table& GetTable()
+    {
+        static Table table;
+        return table;
+    }
+
+    // 记下标识对应的名字；同一个标识已经记过别的名字说明两个名字哈希冲突了
+    inline void Record(const NamedResourceId& id)
+    {
+        Table& table = GetTable();
+        std::lock_guard<std::mutex> lock(table.Mutex);
+        auto inserted = table.Names.emplace(id.Id.Value, std::string(id.Name));
+        assert((inserted.second || inserted.first->second == id.Name) && "ResourceId: hash collision between two names");
+        (void)inserted;
+    }
+
+    // 没有记录过时返回空字符串
+    inline std::string Lookup(ResourceId id)
+    {
+        Table& table = GetTable();
+        std::lock_guard<std::mutex> lock(table.Mutex);
+        auto it = table.Names.find(id.Value);
+        return it != table.Names.end() ? it->second : std::string();
+    }
+#else
+    inline void Record(const NamedResourceId&) {}
+#endif
+}
@@ -0,0 +1,118 @@
+/*
+按 ResourceId 登记的资源表（不依赖 D3D12）。
+资源本身按加入顺序放在稠密数组里，稠密下标就是句柄：初始化时查一次拿到下标，之后直接按下标访问。
+按标识查找走一张开放寻址的小哈希表（标识本身已经是哈希值，不再对字符串求哈希），查找不分配内存；
+查不到时 Find 返回 nullptr、Get 断言失败，不会像 unordered_map::operator[] 那样插入一个空元素。
+资源只加不删；要替换同名资源时用 IndexOf 找到下标，直接改写那个位置。
+*/
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "ResourceId.h"
+
+template<typename T>
+class ResourceRegistry
+{
+public:
+    static constexpr std::uint32_t InvalidIndex = 0xffffffffu;
+
+    // 加入资源，返回稠密下标。标识必须还没有登记过
+    std::uint32_t Add(const NamedResourceId& id, T value)
+    {
+        assert(!id.Id.IsNull());
+        assert(IndexOf(id.Id) == InvalidIndex && "ResourceRegistry: id already registered");
+        ResourceNames::Record(id);
+
+        // 装载率保持在一半以下
+        if((mValues.size() + 1) * 2 > mSlotKeys.size())
+            Rehash(mSlotKeys.empty() ? 16 : mSlotKeys.size() * 2);
+
+        std::uint32_t index = (std::uint32_t)mValues.size();
+        mValues.push_back(std::move(value));
+        mIds.push_back(id.Id);
+        Insert(id.Id.Value, index);
+        return index;
+    }
+
+    // 没有登记时返回 InvalidIndex
+    std::uint32_t IndexOf(ResourceId id)const
+    {
+        if(mSlotKeys.empty())
+            return InvalidIndex;
+
+        std::size_t mask = mSlotKeys.size() - 1;
+        for(std::size_t slot = Home(id.Value, mask); ; slot = (slot + 1) & mask)
+        {
+            if(mSlotKeys[slot] == id.Value)
+                return mSlotIndices[slot];
+            if(mSlotKeys[slot] == 0)
+                return InvalidIndex;
+        }
+    }
+
+    // 没有登记时返回 nullptr
+    T* Find(ResourceId id)
+    {
+        std::uint32_t index = IndexOf(id);
+        return index != InvalidIndex ? &mValues[index] : nullptr;
+    }
+    const T* Find(ResourceId id)const
+    {
+        std::uint32_t index = IndexOf(id);
+        return index != InvalidIndex ? &mValues[index] : nullptr;
+    }
+
+    // 资源必须已经登记
+    T& Get(ResourceId id)
+    {
+        T* value = Find(id);
+        assert(value != nullptr && "ResourceRegistry: unknown id");
+        return *value;
+    }
+    const T& Get(ResourceId id)const
+    {
+        const T* value = Find(id);
+        assert(value != nullptr && "ResourceRegistry: unknown id");
+        return *value;
+    }
+
+    // 按稠密下标 [0, Size()) 访问
+    std::size_t Size()const { return mValues.size(); }
+    T& At(std::uint32_t index) { return mValues[index]; }
+    const T& At(std::uint32_t index)const { return mValues[index]; }
+    ResourceId IdAt(std::uint32_t index)const { return mIds[index]; }
+
+private:
+    static std::size_t Home(std::uint64_t key, std::size_t mask)
+    {
+        // 高位折叠进低位，容量较小时也用到整个哈希值
+        return (std::size_t)(key ^ (key >> 32)) & mask;
+    }
+
+    void Insert(std::uint64_t key, std::uint32_t index)
+    {
+        std::size_t mask = mSlotKeys.size() - 1;
+        std::size_t slot = Home(key, mask);
+        while(mSlotKeys[slot] != 0)
+            slot = (slot + 1) & mask;
+        mSlotKeys[slot] = key;
+        mSlotIndices[slot] = index;
+    }
+
+    void Rehash(std::size_t capacity)
+    {
+        mSlotKeys.assign(capacity, 0);
+        mSlotIndices.assign(capacity, InvalidIndex);
+        for(std::uint32_t i = 0; i < (std::uint32_t)mIds.size(); ++i)
+            Insert(mIds[i].Value, i);
+    }
+
+    std::vector<T> mValues;
+    std::vector<ResourceId> mIds;               // 稠密下标 -> 标识
+    std::vector<std::uint64_t> mSlotKeys;       // 哈希表，0 表示空位；容量是 2 的幂
+    std::vector<std::uint32_t> mSlotIndices;
+};
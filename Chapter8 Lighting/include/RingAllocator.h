@@ -0,0 +1,118 @@
+/*
+按围栏回收的环形分配器：只算偏移，不依赖 D3D12。
+一次提交（batch）里的所有分配在 FinishBatch(fence) 时打上同一个围栏值，
+Retire(completedFence) 时按提交顺序整批释放。用作上传暂存区（staging ring）。
+*/
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+class FencedRingAllocator
+{
+public:
+    static constexpr std::uint64_t InvalidOffset = ~0ull;
+
+    FencedRingAllocator() = default;
+    explicit FencedRingAllocator(std::uint64_t capacity) :
+        mCapacity(capacity)
+    {
+    }
+
+    // 分配一段连续空间，放不下时返回 InvalidOffset（调用者应先提交并等待旧的批次）
+    std::uint64_t Allocate(std::uint64_t byteSize, std::uint64_t alignment = 1)
+    {
+        if(byteSize == 0 || byteSize > mCapacity || mUsed >= mCapacity)
+            return InvalidOffset;
+
+        std::uint64_t offset = AlignUp(mHead, alignment);
+        std::uint64_t padding = offset - mHead;
+
+        if(mUsed == 0)
+        {
+            // 环是空的，直接从头开始，避免无谓的回绕浪费
+            mHead = mTail = 0;
+            offset = 0;
+            padding = 0;
+        }
+        else if(mHead >= mTail)
+        {
+            // 已用区间是 [tail, head)，先试尾部剩余空间，不够再回绕到 0
+            if(offset + byteSize > mCapacity)
+            {
+                std::uint64_t wasted = mCapacity - mHead;
+                if(byteSize > mTail)
+                    return InvalidOffset;
+
+                offset = 0;
+                padding = wasted;
+            }
+        }
+        else
+        {
+            // 已经回绕，可用区间是 [head, tail)
+            if(offset + byteSize > mTail)
+                return InvalidOffset;
+        }
+
+        mHead = offset + byteSize;
+        if(mHead == mCapacity)
+            mHead = 0;
+
+        mUsed += padding + byteSize;
+        mPendingBytes += padding + byteSize;
+        return offset;
+    }
+
+    // 把上一次 FinishBatch 以来的所有分配归入以 fenceValue 结束的批次
+    void FinishBatch(std::uint64_t fenceValue)
+    {
+        if(mPendingBytes == 0)
+            return;
+
+        Batch batch;
+        batch.FenceValue = fenceValue;
+        batch.End = mHead;
+        batch.Bytes = mPendingBytes;
+        mBatches.push_back(batch);
+        mPendingBytes = 0;
+    }
+
+    // 释放所有围栏值 <= completedFence 的批次
+    void Retire(std::uint64_t completedFence)
+    {
+        while(!mBatches.empty() && mBatches.front().FenceValue <= completedFence)
+        {
+            mTail = mBatches.front().End;
+            mUsed -= mBatches.front().Bytes;
+            mBatches.pop_front();
+        }
+    }
+
+    std::uint64_t Capacity() const { return mCapacity; }
+    std::uint64_t Used() const { return mUsed; }
+    std::uint64_t PendingBytes() const { return mPendingBytes; }
+    bool Empty() const { return mUsed == 0; }
+    bool HasInFlightBatches() const { return !mBatches.empty(); }
+    std::uint64_t OldestFence() const { return mBatches.empty() ? 0 : mBatches.front().FenceValue; }
+
+    static std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+
+private:
+    struct Batch
+    {
+        std::uint64_t FenceValue = 0;
+        std::uint64_t End = 0;
+        std::uint64_t Bytes = 0;
+    };
+
+    std::uint64_t mCapacity = 0;
+    std::uint64_t mHead = 0;
+    std::uint64_t mTail = 0;
+    std::uint64_t mUsed = 0;
+    std::uint64_t mPendingBytes = 0;
+    std::deque<Batch> mBatches;
+};
@@ -0,0 +1,72 @@
+/*
+C++ 与 HLSL 共用的结构体定义：color.hlsl 直接 #include 这个文件，两边的字段顺序和类型来自同一份源码。
+只用两种语言共有的语法：类型名按 HLSL 写，C++ 这边用 DirectXMath 的类型对应过去；
+StructuredBuffer 的元素按 4 字节紧密排列（不像 cbuffer 那样按 16 字节对齐、不跨寄存器），
+文件末尾的 static_assert 在编译期检查 C++ 结构体没有多出填充，大小和偏移与 HLSL 一致。
+纹理变换（TexTransform、MatTransform）这一章的着色器不读，留在 CPU 端，不再上传。
+*/
+#ifndef SHADER_SHARED_H
+#define SHADER_SHARED_H
+
+#ifdef __cplusplus
+    #include <cstddef>
+    #include <cstdint>
+    #include <type_traits>
+    #include <DirectXMath.h>
+
+    namespace ShaderShared
+    {
+        typedef std::uint32_t uint;
+        typedef DirectX::XMFLOAT3 float3;
+        typedef DirectX::XMFLOAT4 float4;
+        typedef DirectX::XMFLOAT3X4 float3x4; // 3 行 4 列，按行存储
+    }
+    #define SHADER_ROW_MAJOR
+    #define SHADER_SHARED_BEGIN namespace ShaderShared {
+    #define SHADER_SHARED_END }
+#else
+    #define SHADER_ROW_MAJOR row_major
+    #define SHADER_SHARED_BEGIN
+    #define SHADER_SHARED_END
+#endif
+
+SHADER_SHARED_BEGIN
+
+// 每个物体的数据，在静态层或动态层的物体表中按槽位排列。
+// World 是世界矩阵转置后的前 3 行（最后一列恒为 0,0,0,1，不存），着色器里 mul(World, float4(p, 1))
+struct ObjectConstants
+{
+    SHADER_ROW_MAJOR float3x4 World;
+};
+
+// 材质表的元素，按 MatCBIndex 排列
+struct MaterialConstants
+{
+    float4 DiffuseAlbedo; // 材质反照率
+    float3 FresnelR0;     // RF(0)值，即材质的反射属性
+    float Roughness;      // 材质的粗糙度
+};
+
+SHADER_SHARED_END
+
+#ifdef __cplusplus
+    using ShaderShared::ObjectConstants;
+    using ShaderShared::MaterialConstants;
+
+    // StructuredBuffer 的步长就是 sizeof；任何编译器插入的填充都会让两边错位
+    static_assert(std::is_standard_layout<ObjectConstants>::value, "ObjectConstants 必须是标准布局");
+    static_assert(sizeof(ObjectConstants) == 48, "ObjectConstants 与 HLSL 的 row_major float3x4 大小不一致");
+    static_assert(offsetof(ObjectConstants, World) == 0, "ObjectConstants::World 偏移与 HLSL 不一致");
+
+    static_assert(std::is_standard_layout<MaterialConstants>::value, "MaterialConstants 必须是标准布局");
+    static_assert(sizeof(MaterialConstants) == 32, "MaterialConstants 与 HLSL 的大小不一致");
+    static_assert(offsetof(MaterialConstants, DiffuseAlbedo) == 0, "MaterialConstants::DiffuseAlbedo 偏移与 HLSL 不一致");
+    static_assert(offsetof(MaterialConstants, FresnelR0) == 16, "MaterialConstants::FresnelR0 偏移与 HLSL 不一致");
+    static_assert(offsetof(MaterialConstants, Roughness) == 28, "MaterialConstants::Roughness 偏移与 HLSL 不一致");
+
+    // 实例缓冲区的元素：实例对应的物体下标（HLSL 里是 StructuredBuffer<uint>，编码见 ObjectTiers.h）
+    typedef std::uint32_t InstanceObjectIndex;
+    static_assert(sizeof(InstanceObjectIndex) == 4, "实例缓冲区元素必须是 32 位");
+#endif
+
+#endif
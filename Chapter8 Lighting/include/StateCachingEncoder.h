@@ -0,0 +1,195 @@
+/*
+带状态缓存的命令编码器（不依赖 D3D12）。
+记住当前命令列表上已经绑定的 PSO、根签名、各槽位的根 CBV/SRV 和根常量、顶点/索引缓冲区和图元拓扑，
+与上一次相同的设置直接跳过，不再调用到驱动。缓存只在一条命令列表的一次录制内有效
+（D3D12 的管线状态不会跨命令列表继承），换根签名时清空根参数的缓存。
+Issued/Skipped 计数用于衡量去掉了多少冗余调用。
+*/
+#pragma once
+
+#include <cstdint>
+#include "GraphicsDevice.h"
+
+class StateCachingEncoder
+{
+public:
+    struct Stats
+    {
+        std::uint64_t Issued = 0;  // 实际调用到命令列表的状态设置和绘制
+        std::uint64_t Skipped = 0; // 与当前状态相同而跳过的状态设置
+
+        Stats& operator+=(const Stats& rhs)
+        {
+            Issued += rhs.Issued;
+            Skipped += rhs.Skipped;
+            return *this;
+        }
+    };
+
+    // 根参数缓存覆盖的槽位数，更高的槽位不缓存、总是调用
+    static constexpr std::uint32_t MaxCachedRootSlots = 8;
+
+    // list 必须已经 Begin；initialPipeline 是 Begin 时设置的 PSO（0 表示没有）
+    StateCachingEncoder(CommandList* list, PipelineHandle initialPipeline) :
+        mList(list), mPipeline(initialPipeline)
+    {
+    }
+
+    CommandList* List()const { return mList; }
+    const Stats& GetStats()const { return mStats; }
+
+    // 直接在 List() 上录制了会改变状态的命令后调用，之后的设置都会重新下发
+    void Invalidate()
+    {
+        mPipeline = 0;
+        mRootSignature = 0;
+        mHasVertexBuffer = mHasIndexBuffer = mHasTopology = false;
+        ClearRootSlots();
+    }
+
+    void SetPipelineState(PipelineHandle pipeline)
+    {
+        if(pipeline != 0 && pipeline == mPipeline)
+        {
+            mStats.Skipped++;
+            return;
+        }
+        mPipeline = pipeline;
+        mList->SetPipelineState(pipeline);
+        mStats.Issued++;
+    }
+
+    void SetGraphicsRootSignature(RootSignatureHandle rootSignature)
+    {
+        if(rootSignature != 0 && rootSignature == mRootSignature)
+        {
+            mStats.Skipped++;
+            return;
+        }
+        // 换根签名后所有根参数都失效
+        mRootSignature = rootSignature;
+        ClearRootSlots();
+        mList->SetGraphicsRootSignature(rootSignature);
+        mStats.Issued++;
+    }
+
+    void SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address)
+    {
+        if(UpdateRootSlot(rootParameterIndex, address))
+            mList->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+    }
+
+    // 同一根签名里一个槽位只有一种类型，根 SRV 与根 CBV 共用地址缓存
+    void SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address)
+    {
+        if(UpdateRootSlot(rootParameterIndex, address))
+            mList->SetGraphicsRootShaderResourceView(rootParameterIndex, address);
+    }
+
+    // 只缓存每个根常量参数的第 0 个值，其余偏移总是调用
+    void SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset)
+    {
+        if(destOffset != 0)
+        {
+            mList->SetGraphicsRoot32BitConstant(rootParameterIndex, value, destOffset);
+            mStats.Issued++;
+            return;
+        }
+        if(UpdateRootSlot(rootParameterIndex, value))
+            mList->SetGraphicsRoot32BitConstant(rootParameterIndex, value, 0);
+    }
+
+    void SetVertexBuffer(const VertexBufferBinding& view)
+    {
+        if(mHasVertexBuffer && view.BufferLocation == mVertexBuffer.BufferLocation &&
+            view.SizeInBytes == mVertexBuffer.SizeInBytes && view.StrideInBytes == mVertexBuffer.StrideInBytes)
+        {
+            mStats.Skipped++;
+            return;
+        }
+        mVertexBuffer = view;
+        mHasVertexBuffer = true;
+        mList->SetVertexBuffer(view);
+        mStats.Issued++;
+    }
+
+    void SetIndexBuffer(const IndexBufferBinding& view)
+    {
+        if(mHasIndexBuffer && view.BufferLocation == mIndexBuffer.BufferLocation &&
+            view.SizeInBytes == mIndexBuffer.SizeInBytes && view.Format == mIndexBuffer.Format)
+        {
+            mStats.Skipped++;
+            return;
+        }
+        mIndexBuffer = view;
+        mHasIndexBuffer = true;
+        mList->SetIndexBuffer(view);
+        mStats.Issued++;
+    }
+
+    void SetPrimitiveTopology(std::uint32_t topology)
+    {
+        if(mHasTopology && topology == mTopology)
+        {
+            mStats.Skipped++;
+            return;
+        }
+        mTopology = topology;
+        mHasTopology = true;
+        mList->SetPrimitiveTopology(topology);
+        mStats.Issued++;
+    }
+
+    void DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+        std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation)
+    {
+        mList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation,
+            baseVertexLocation, startInstanceLocation);
+        mStats.Issued++;
+    }
+
+    // 命令签名会改写根参数，执行后这些槽位的值不再确定，清空根参数缓存
+    void ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+        ResourceHandle argumentBuffer, std::uint64_t argumentOffset)
+    {
+        mList->ExecuteIndirect(signature, maxCommandCount, argumentBuffer, argumentOffset);
+        mStats.Issued++;
+        ClearRootSlots();
+    }
+
+private:
+    void ClearRootSlots() { mRootSlotValid = 0; }
+
+    // 记录槽位的新值并计数；与缓存相同时返回 false，调用方不再下发
+    bool UpdateRootSlot(std::uint32_t rootParameterIndex, std::uint64_t value)
+    {
+        if(rootParameterIndex < MaxCachedRootSlots)
+        {
+            std::uint32_t bit = 1u << rootParameterIndex;
+            if((mRootSlotValid & bit) != 0 && mRootSlots[rootParameterIndex] == value)
+            {
+                mStats.Skipped++;
+                return false;
+            }
+            mRootSlots[rootParameterIndex] = value;
+            mRootSlotValid |= bit;
+        }
+        mStats.Issued++;
+        return true;
+    }
+
+    CommandList* mList;
+    Stats mStats;
+
+    PipelineHandle mPipeline = 0;
+    RootSignatureHandle mRootSignature = 0;
+    std::uint64_t mRootSlots[MaxCachedRootSlots] = {}; //根 CBV/SRV 的地址或根常量的第 0 个值
+    std::uint32_t mRootSlotValid = 0;
+
+    VertexBufferBinding mVertexBuffer;
+    IndexBufferBinding mIndexBuffer;
+    std::uint32_t mTopology = 0;
+    bool mHasVertexBuffer = false;
+    bool mHasIndexBuffer = false;
+    bool mHasTopology = false;
+};
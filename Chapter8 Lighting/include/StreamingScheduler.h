@@ -0,0 +1,145 @@
+/*
+运行时资源流送的调度逻辑（纯 CPU，不依赖 D3D12）。
+加载线程通过 Enqueue 提交请求；渲染线程每帧调用 Pump：录制请求、提交到复制队列、
+检查围栏，围栏完成的请求才调用 OnResident，把资源交给渲染使用。整个过程从不等待 GPU。
+StreamingQueue 抽象了“提交一批并得到围栏值”的队列，D3D12 实现见 CopyQueueStreamer.h，
+SimulatedStreamingQueue 用可配置的延迟模拟 GPU，便于在没有 GPU 的机器上测试。
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class StreamingQueue
+{
+public:
+    virtual ~StreamingQueue() = default;
+
+    // 提交目前为止录制的所有内容，返回这一批的围栏值
+    virtual std::uint64_t Submit() = 0;
+    virtual std::uint64_t CompletedValue() const = 0;
+};
+
+// 模拟的复制队列：每批在提交 latency 之后才算完成，完成顺序与提交顺序一致
+class SimulatedStreamingQueue : public StreamingQueue
+{
+public:
+    explicit SimulatedStreamingQueue(std::chrono::microseconds latency) :
+        mLatency(latency)
+    {
+    }
+
+    std::uint64_t Submit() override
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mSubmitted.push_back(std::chrono::steady_clock::now() + mLatency);
+        return mSubmitted.size();
+    }
+
+    std::uint64_t CompletedValue() const override
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto now = std::chrono::steady_clock::now();
+        while(mCompleted < mSubmitted.size() && mSubmitted[(size_t)mCompleted] <= now)
+            mCompleted++;
+        return mCompleted;
+    }
+
+    void SetLatency(std::chrono::microseconds latency)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLatency = latency;
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::chrono::microseconds mLatency;
+    std::vector<std::chrono::steady_clock::time_point> mSubmitted;
+    mutable std::uint64_t mCompleted = 0;
+};
+
+struct StreamRequest
+{
+    // 在渲染线程上调用，把复制命令录制进复制队列的当前批次
+    std::function<void()> Record;
+    // 可选，取代 Record：只录制数据的 [firstByte, firstByte + byteCount) 部分。
+    // 提供了它的大请求会被拆到多次 Pump 里录制，每次不超过录制上限；各部分按顺序录制，
+    // 第一次调用时 firstByte 为 0
+    std::function<void(std::uint64_t firstByte, std::uint64_t byteCount)> RecordRange;
+    // 围栏完成后在渲染线程上调用，此后资源才对渲染可见；拆分的请求等最后一部分的围栏完成
+    std::function<void()> OnResident;
+    // 要复制的数据量，用于限制每帧录制和在途的字节数
+    std::uint64_t ByteSize = 0;
+};
+
+class StreamingScheduler
+{
+public:
+    struct Stats
+    {
+        std::uint64_t Enqueued = 0;
+        std::uint64_t Submitted = 0;    // 全部录制完并提交的请求
+        std::uint64_t Resident = 0;
+        std::uint64_t Batches = 0;
+        std::uint64_t SplitRequests = 0; // 拆到多次 Pump 里录制的请求
+        std::uint64_t BytesSubmitted = 0;
+    };
+
+    // maxBytesPerPump 限制每次 Pump 录制的数据量，maxBytesInFlight 限制已提交、围栏还没完成的数据量
+    // （0 表示不限制）。两者都按复制队列暂存环的容量来定，录制时就不必等待之前的批次释放暂存空间。
+    // 超出上限的请求：提供了 RecordRange 的拆到多次 Pump 里录制；否则推迟到复制队列空闲时单独录制，
+    // 这时暂存环是空的，只有比整个暂存环还大的请求才会在录制时等待。
+    explicit StreamingScheduler(StreamingQueue& queue, std::uint64_t maxBytesPerPump = 0, std::uint64_t maxBytesInFlight = 0);
+
+    // 任意线程调用，返回请求编号
+    std::uint64_t Enqueue(StreamRequest request);
+
+    // 渲染线程每帧调用一次。返回本次变为可见的请求数。
+    std::uint32_t Pump();
+
+    // 所有已经可见的资源所需的复制围栏值，渲染队列在使用它们之前应 GPU 端等待这个值
+    std::uint64_t ResidentFenceValue() const { return mResidentFence; }
+    // 已提交、围栏还没完成的字节数，只在渲染线程调用
+    std::uint64_t BytesInFlight() const { return mInFlightBytes; }
+    bool Idle() const;
+    Stats GetStats() const;
+
+private:
+    struct InFlight
+    {
+        std::uint64_t FenceValue = 0;
+        std::uint64_t ByteSize = 0;
+        std::function<void()> OnResident;
+        bool CompletesRequest = true; // 拆分请求的中间部分为 false
+    };
+
+    // 拆分录制到一半的请求，总是排在所有待处理请求之前
+    struct PartialRequest
+    {
+        StreamRequest Request;
+        std::uint64_t RecordedBytes = 0;
+        bool Active = false;
+    };
+
+    std::uint64_t RecordBudget() const;
+    void RecordPartial(std::uint64_t budget, std::uint64_t& recordedBytes, std::vector<InFlight>& recorded);
+    std::uint32_t RetireCompleted();
+
+    StreamingQueue& mQueue;
+    std::uint64_t mMaxBytesPerPump = 0;
+    std::uint64_t mMaxBytesInFlight = 0;
+
+    mutable std::mutex mMutex; // 保护 mPending 和 mStats
+    std::deque<StreamRequest> mPending;
+    Stats mStats;
+
+    // 以下只在渲染线程访问
+    PartialRequest mPartial;
+    std::deque<InFlight> mInFlight;
+    std::uint64_t mInFlightBytes = 0;
+    std::uint64_t mResidentFence = 0;
+};
@@ -0,0 +1,26 @@
+/*
+把世界矩阵批量打包成物体表里的 ObjectConstants（不依赖 D3D12）。
+以前每个物体单独 XMLoadFloat4x4 + XMStoreFloat3x4 到栈上的临时变量，再整块复制进上传堆；
+这里一次处理一批：源矩阵按行存储（XMFLOAT4X4 的内存布局），转置后取前 3 行，
+用非临时存储直接写进目标内存，不经过临时变量。
+AVX 路径每轮处理 4 个矩阵：两个矩阵各占一个 128 位通道一起转置，三次 32 字节存储正好写完相邻两个物体；
+SSE 路径每个矩阵一次 4x4 转置、三次 16 字节存储；标量路径是对照用的参考实现。
+运行时按 CPU 支持的指令集选择路径（CpuFeatures.h）。
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "ShaderShared.h"
+#include "CpuFeatures.h"
+
+// dst[i] = worlds[i] 转置后的前 3 行，i 属于 [0, count)。worlds[i] 可以分散在各个渲染项里；
+// dst 可以是上传堆的映射内存，16 字节对齐时用非临时存储，否则退回标量路径。
+// 写完不带 fence，交给 GPU 之前调用 WriteCombined::Fence()
+void PackObjectWorlds(const DirectX::XMFLOAT4X4* const* worlds, std::size_t count, ObjectConstants* dst,
+    SimdPath path = BestSimdPath());
+
+// 同上，但第 i 个矩阵写到 dstBase[dstSlots[i]]（按脏列表写回物体表里分散的槽位）
+void PackObjectWorldsScattered(const DirectX::XMFLOAT4X4* const* worlds, std::size_t count,
+    ObjectConstants* dstBase, const std::uint32_t* dstSlots, SimdPath path = BestSimdPath());
@@ -0,0 +1,101 @@
+/*
+初始化阶段的批量上传：所有缓冲区/纹理上传共用一个暂存环（staging ring），
+每批只录制两次 ResourceBarrier（复制前一次、复制后一次），按批提交，
+围栏完成后暂存空间自动回收。取代每个 CreateDefaultBuffer 各建一个上传堆、
+并把它一直挂在 MeshGeometry 上的做法。
+*/
+#pragma once
+
+#include <unordered_map>
+#include "d3dUtil.h"
+#include "RingAllocator.h"
+
+class UploadBatcher
+{
+public:
+    static constexpr UINT64 DefaultStagingByteSize = 32 * 1024 * 1024;
+    static constexpr UINT64 DefaultBatchByteSize = 8 * 1024 * 1024;
+
+    struct Stats
+    {
+        UINT64 BytesUploaded = 0;
+        UINT64 BatchesSubmitted = 0;
+        UINT64 BarrierCalls = 0;
+        UINT64 PeakStagingBytes = 0;
+    };
+
+    // queue 决定上传在哪个队列上执行；batchByteSize 为单批暂存数据量的上限，超过就自动提交
+    UploadBatcher(ID3D12Device* device, ID3D12CommandQueue* queue,
+        UINT64 stagingByteSize = DefaultStagingByteSize, UINT64 batchByteSize = DefaultBatchByteSize);
+    UploadBatcher(const UploadBatcher& rhs) = delete;
+    UploadBatcher& operator=(const UploadBatcher& rhs) = delete;
+    ~UploadBatcher();
+
+    // dest 必须处于 COMMON 状态（刚创建的资源），复制完成后转换到 stateAfter。
+    // 在复制队列上 stateAfter 会被忽略，资源保持 COMMON。
+    // 数据立即复制进暂存环，调用返回后 data 可以释放。
+    void UploadBuffer(ID3D12Resource* dest, UINT64 destOffset, const void* data, UINT64 byteSize,
+        D3D12_RESOURCE_STATES stateAfter);
+    void UploadTexture(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources,
+        const D3D12_SUBRESOURCE_DATA* srcData, D3D12_RESOURCE_STATES stateAfter);
+
+    // 提交当前批次，返回它的围栏值（没有待提交内容时返回上一批的围栏值）
+    UINT64 Submit();
+    // 回收围栏已经完成的暂存空间和命令分配器
+    void RetireCompleted();
+    void WaitForFence(UINT64 fenceValue);
+    void WaitIdle();
+    // 没有进行中的上传时释放整个暂存堆，下次上传时再按需创建
+    void ReleaseStagingIfIdle();
+
+    bool IsComplete(UINT64 fenceValue)const { return mFence->GetCompletedValue() >= fenceValue; }
+    ID3D12Fence* Fence()const { return mFence.Get(); }
+    const Stats& GetStats()const { return mStats; }
+
+private:
+    struct PendingCopy
+    {
+        ID3D12Resource* Dest = nullptr;
+        bool IsTexture = false;
+        UINT64 DestOffset = 0;
+        UINT64 SrcOffset = 0;
+        UINT64 ByteSize = 0;
+        UINT Subresource = 0;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT Footprint = {};
+    };
+
+    struct CommandContext
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator;
+        UINT64 FenceValue = 0;
+    };
+
+    void EnsureStaging();
+    UINT64 AllocateStaging(UINT64 byteSize, UINT64 alignment);
+    void TrackResource(ID3D12Resource* dest, D3D12_RESOURCE_STATES stateAfter);
+    ID3D12CommandAllocator* AcquireAllocator();
+
+    ID3D12Device* mDevice = nullptr;
+    ID3D12CommandQueue* mQueue = nullptr;
+    D3D12_COMMAND_LIST_TYPE mListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    UINT64 mStagingByteSize = 0;
+    UINT64 mBatchByteSize = 0;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> mStaging;
+    BYTE* mStagingData = nullptr;
+    FencedRingAllocator mRing;
+
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
+    std::vector<CommandContext> mContexts;
+    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+    UINT64 mFenceValue = 0;
+
+    // 当前批次
+    std::vector<PendingCopy> mPendingCopies;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mPendingResources;
+    std::vector<D3D12_RESOURCE_STATES> mPendingStates;
+    std::unordered_map<ID3D12Resource*, size_t> mPendingResourceIndex;
+    UINT64 mPendingBytes = 0;
+
+    Stats mStats;
+};
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "d3dUtil.h"
+#include "WriteCombined.h"
 
 template<typename T>
 class UploadBuffer
@@ -15,6 +16,7 @@ public:
         mIsConstantBuffer(isConstantBuffer)
     {
         mElementByteSize = sizeof(T);
+        mElementCount = elementCount;
 
         if(isConstantBuffer)
             mElementByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(T));
@@ -50,10 +52,31 @@ public:
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
     }
 
+    // 一次写入 count 个连续元素，使用非临时存储，写完后 sfence
+    void CopyRange(int firstElement, const T* data, UINT count)
+    {
+        WriteCombined::StreamCopyStrided(&mMappedData[firstElement*mElementByteSize], mElementByteSize, data, sizeof(T), count);
+        WriteCombined::Fence();
+    }
+
+    // 返回覆盖整个缓冲区的只写写入器
+    UploadWriter<T> Map()
+    {
+        return UploadWriter<T>(mMappedData, mElementByteSize, mElementCount);
+    }
+
+    // 返回只覆盖 [firstElement, firstElement + count) 的写入器，多个线程分段写入时各用一个
+    UploadWriter<T> MapRange(UINT firstElement, UINT count)
+    {
+        assert(firstElement + count <= mElementCount);
+        return UploadWriter<T>(mMappedData, mElementByteSize, firstElement, count);
+    }
+
 private:
     Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
     BYTE* mMappedData = nullptr;
 
     UINT mElementByteSize = 0;
+    UINT mElementCount = 0;
     bool mIsConstantBuffer = false;
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+每帧一块持久映射的上传堆，用 LinearAllocator 在里面切分常量数据。
+取代以前每种常量各建一个 UploadBuffer<T> 的做法：新增一种每帧数据不需要再创建资源。
+容量不固定：每帧回收时调用方给出本帧要分配的总字节数，不够时换一块更大的缓冲区，分配本身不会失败。
+*/
+#pragma once
+
+#include "d3dUtil.h"
+#include "LinearAllocator.h"
+
+// GrowableLinearAllocator 的底层内存：一块持久映射的上传堆
+class UploadHeapBacking
+{
+public:
+    explicit UploadHeapBacking(ID3D12Device* device) :
+        mDevice(device)
+    {
+    }
+
+    UploadHeapBacking(UploadHeapBacking&& rhs) = default;
+    UploadHeapBacking& operator=(UploadHeapBacking&& rhs) = delete;
+    ~UploadHeapBacking()
+    {
+        Release();
+    }
+
+    LinearAllocator Create(UINT64 byteSize)
+    {
+        ThrowIfFailed(mDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&mUploadBuffer)));
+
+        // 上传堆在整个生命周期内保持映射
+        BYTE* mappedData = nullptr;
+        ThrowIfFailed(mUploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mappedData)));
+
+        return LinearAllocator(mappedData, mUploadBuffer->GetGPUVirtualAddress(), byteSize);
+    }
+
+    // 旧缓冲区只被这个帧资源已经完成的命令引用，可以直接释放
+    void Release()
+    {
+        if(mUploadBuffer != nullptr)
+            mUploadBuffer->Unmap(0, nullptr);
+        mUploadBuffer.Reset();
+    }
+
+    ID3D12Resource* Resource()const
+    {
+        return mUploadBuffer.Get();
+    }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+    Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+};
+
+class FrameUploadRing
+{
+public:
+    FrameUploadRing(ID3D12Device* device, UINT64 byteSize) :
+        mRing(UploadHeapBacking(device), byteSize)
+    {
+    }
+
+    ID3D12Resource* Resource()const
+    {
+        return mRing.GetBacking().Resource();
+    }
+
+    // 容量由 Reset(requiredBytes) 保证，本帧的分配总量不能超过当时给出的字节数
+    LinearAllocation Allocate(UINT64 byteSize, UINT64 alignment = LinearAllocator::ConstantBufferAlignment)
+    {
+        return mRing.Allocate(byteSize, alignment);
+    }
+
+    // 按常量缓冲区对齐分配 elementCount 个 T，返回块中每个元素的步长
+    template<typename T>
+    LinearAllocation AllocateConstants(UINT elementCount, UINT* elementByteSize = nullptr)
+    {
+        UINT stride = d3dUtil::CalcConstantBufferByteSize(sizeof(T));
+        if(elementByteSize != nullptr)
+            *elementByteSize = stride;
+
+        return Allocate((UINT64)stride * elementCount);
+    }
+
+    // 分配 elementCount 个紧密排列的 T，作为 StructuredBuffer 通过根 SRV 绑定
+    template<typename T>
+    LinearAllocation AllocateStructured(UINT elementCount)
+    {
+        return Allocate((UINT64)sizeof(T) * elementCount);
+    }
+
+    // 调用者需保证该帧的围栏已经完成。requiredBytes 是本帧要分配的总字节数（含对齐），超过容量时换一块更大的缓冲区；
+    // 返回 true 表示换过缓冲区，增长策略见 GrowableLinearAllocator::Reset
+    bool Reset(UINT64 requiredBytes = 0)
+    {
+        return mRing.Reset(requiredBytes);
+    }
+
+    const LinearAllocator& Allocator()const
+    {
+        return mRing.Allocator();
+    }
+
+private:
+    GrowableLinearAllocator<UploadHeapBacking> mRing;
+};
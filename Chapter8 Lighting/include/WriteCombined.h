@@ -0,0 +1,177 @@
+/*
+写入上传堆（write-combined 内存）的工具函数。
+WC 内存只适合顺序、整块地写：读它非常慢，零散的小块写入也会把合并缓冲拆碎。
+这里用 SSE2 的非临时存储（_mm_stream_si128）按 16 字节写入，绕开缓存。
+不依赖 D3D12，可以直接对普通内存使用。
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define WC_HAS_STREAMING_STORES 1
+#else
+    #define WC_HAS_STREAMING_STORES 0
+#endif
+
+// Debug 下检查同一作用域里对同一元素的重复写入（读-改-写模式通常就是这么出现的）
+#if defined(DEBUG) || defined(_DEBUG)
+    #define WC_DEBUG_CHECKS 1
+#else
+    #define WC_DEBUG_CHECKS 0
+#endif
+
+namespace WriteCombined
+{
+    // 把 byteSize 字节从 src 复制到 WC 内存 dst。
+    // 对齐的 16 字节块用非临时存储，首尾不对齐的部分退回 memcpy。
+    // 不带 fence，连续多次复制结束后调用 Fence()。
+    inline void StreamCopy(void* dst, const void* src, std::size_t byteSize)
+    {
+        std::uint8_t* d = static_cast<std::uint8_t*>(dst);
+        const std::uint8_t* s = static_cast<const std::uint8_t*>(src);
+
+#if WC_HAS_STREAMING_STORES
+        std::size_t head = (16 - (reinterpret_cast<std::uintptr_t>(d) & 15)) & 15;
+        if(head > byteSize)
+            head = byteSize;
+        if(head != 0)
+        {
+            std::memcpy(d, s, head);
+            d += head;
+            s += head;
+            byteSize -= head;
+        }
+
+        // 每次 64 字节（一条缓存行），让合并缓冲尽量整行刷出
+        while(byteSize >= 64)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+            __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+            d += 64;
+            s += 64;
+            byteSize -= 64;
+        }
+
+        while(byteSize >= 16)
+        {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+            d += 16;
+            s += 16;
+            byteSize -= 16;
+        }
+#endif
+
+        if(byteSize != 0)
+            std::memcpy(d, s, byteSize);
+    }
+
+    // 非临时存储是弱序的，交给 GPU 之前必须 sfence
+    inline void Fence()
+    {
+#if WC_HAS_STREAMING_STORES
+        _mm_sfence();
+#endif
+    }
+
+    // 按 dstStride 的间隔写入 count 个大小为 elementSize 的元素（例如 256 字节对齐的常量缓冲区）
+    inline void StreamCopyStrided(void* dst, std::size_t dstStride, const void* src, std::size_t elementSize, std::size_t count)
+    {
+        if(dstStride == elementSize)
+        {
+            StreamCopy(dst, src, elementSize * count);
+            return;
+        }
+
+        std::uint8_t* d = static_cast<std::uint8_t*>(dst);
+        const std::uint8_t* s = static_cast<const std::uint8_t*>(src);
+        for(std::size_t i = 0; i < count; ++i)
+            StreamCopy(d + i * dstStride, s + i * elementSize, elementSize);
+    }
+}
+
+// 映射期间只写不读的写入器：不提供任何读取接口，析构时自动 sfence。
+// 一个写入器负责缓冲区里下标 [firstIndex, firstIndex + count) 的元素，下标仍按整个缓冲区计，
+// 元素 i 写到 base + stride * i。多个线程各自负责一段时，每个写入器只覆盖自己那一段，
+// Debug 下的重复写入检查也只为这一段分配标记。
+template<typename T>
+class UploadWriter
+{
+public:
+    UploadWriter(void* mappedBase, std::size_t elementStride, std::size_t elementCount) :
+        UploadWriter(mappedBase, elementStride, 0, elementCount)
+    {
+    }
+
+    UploadWriter(void* mappedBase, std::size_t elementStride, std::size_t firstIndex, std::size_t elementCount) :
+        mBase(static_cast<std::uint8_t*>(mappedBase)),
+        mStride(elementStride),
+        mFirst(firstIndex),
+        mCount(elementCount)
+    {
+        assert(elementStride >= sizeof(T));
+#if WC_DEBUG_CHECKS
+        mWritten.assign(elementCount, false);
+#endif
+    }
+
+    UploadWriter(const UploadWriter& rhs) = delete;
+    UploadWriter& operator=(const UploadWriter& rhs) = delete;
+    ~UploadWriter()
+    {
+        WriteCombined::Fence();
+    }
+
+    void Write(std::size_t index, const T& data)
+    {
+        assert(index >= mFirst && index - mFirst < mCount);
+        MarkWritten(index, 1);
+        WriteCombined::StreamCopy(mBase + index * mStride, &data, sizeof(T));
+    }
+
+    // 连续写入 [firstIndex, firstIndex + count)
+    void WriteRange(std::size_t firstIndex, const T* data, std::size_t count)
+    {
+        assert(firstIndex >= mFirst && firstIndex + count <= mFirst + mCount);
+        MarkWritten(firstIndex, count);
+        WriteCombined::StreamCopyStrided(mBase + firstIndex * mStride, mStride, data, sizeof(T), count);
+    }
+
+    std::size_t First() const { return mFirst; }
+    std::size_t Count() const { return mCount; }
+
+private:
+    void MarkWritten(std::size_t first, std::size_t count)
+    {
+#if WC_DEBUG_CHECKS
+        for(std::size_t i = first - mFirst; i < first - mFirst + count; ++i)
+        {
+            // 同一元素写两次说明调用方在映射内存上做了读-改-写，应该先在栈上拼好再整体写入
+            assert(!mWritten[i] && "UploadWriter: element written twice, build it in system memory first");
+            mWritten[i] = true;
+        }
+#else
+        (void)first;
+        (void)count;
+#endif
+    }
+
+    std::uint8_t* mBase = nullptr;
+    std::size_t mStride = 0;
+    std::size_t mFirst = 0;
+    std::size_t mCount = 0;
+#if WC_DEBUG_CHECKS
+    std::vector<bool> mWritten;
+#endif
+};
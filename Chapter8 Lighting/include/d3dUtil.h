@@ -28,9 +28,17 @@
 #include "d3dx12.h"
 #include "DDSTextureLoader.h"
 #include "MathHelper.h"
+#include "HeapPool.h"
+#include "ResidencyManager.h"
+#include "CpuShadowCopy.h"
+#include "ShaderShared.h"
+#include "ResourceRegistry.h"
 
 extern const int gNumFrameResources;
 
+class GpuMemoryAllocator;
+class UploadBatcher;
+
 inline void d3dSetDebugName(IDXGIObject* obj, const char* name)
 {
     if(obj)
@@ -121,6 +129,24 @@ public:
         UINT64 byteSize,
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
 
+    // 默认堆缓冲区作为放置资源创建在 allocator 的池化堆里，数据交给 uploader 批量上传，
+    // 不再为每个缓冲区单独创建上传堆
+    static Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
+        GpuMemoryAllocator& allocator,
+        UploadBatcher& uploader,
+        const void* initData,
+        UINT64 byteSize,
+        PoolAllocation& allocation);
+
+    // 创建上传缓冲区并录制 initData -> defaultBuffer 的复制（COMMON -> COPY_DEST -> GENERIC_READ）
+    static void UploadToDefaultBuffer(
+        ID3D12Device* device,
+        ID3D12GraphicsCommandList* cmdList,
+        ID3D12Resource* defaultBuffer,
+        const void* initData,
+        UINT64 byteSize,
+        Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
+
 	static Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
 		const std::wstring& filename,
 		const D3D_SHADER_MACRO* defines,
@@ -162,10 +188,11 @@ struct MeshGeometry
 	// Give it a name so we can look it up by name.
 	std::string Name;
 
-	// System memory copies.  Use Blobs because the vertex/index format can be generic.
-	// It is up to the client to cast appropriately.  
-	Microsoft::WRL::ComPtr<ID3DBlob> VertexBufferCPU = nullptr;
-	Microsoft::WRL::ComPtr<ID3DBlob> IndexBufferCPU  = nullptr;
+	// System memory copies, kept according to a ShadowCopyPolicy (dropped, compressed,
+	// raw, or paged in from the asset file).  Read them through Acquire(); the format is
+	// generic, so it is up to the client to cast appropriately.
+	CpuShadowCopy VertexBufferCPU;
+	CpuShadowCopy IndexBufferCPU;
 
 	Microsoft::WRL::ComPtr<ID3D12Resource> VertexBufferGPU = nullptr;
 	Microsoft::WRL::ComPtr<ID3D12Resource> IndexBufferGPU = nullptr;
@@ -173,6 +200,16 @@ struct MeshGeometry
 	Microsoft::WRL::ComPtr<ID3D12Resource> VertexBufferUploader = nullptr;
 	Microsoft::WRL::ComPtr<ID3D12Resource> IndexBufferUploader = nullptr;
 
+	// Where VertexBufferGPU/IndexBufferGPU live when they are placed resources.
+	PoolAllocation VertexBufferAllocation;
+	PoolAllocation IndexBufferAllocation;
+
+	// Registration in the ResidencyManager, if the geometry is tracked.
+	std::uint32_t ResidencyId = ResidencyManager::InvalidId;
+
+	// Dense id assigned by the renderer; the geometry field of draw sort keys.
+	std::uint32_t SortId = 0;
+
     // Data about the buffers.
 	UINT VertexByteStride = 0;
 	UINT VertexBufferByteSize = 0;
@@ -181,8 +218,8 @@ struct MeshGeometry
 
 	// A MeshGeometry may store multiple geometries in one vertex/index buffer.
 	// Use this container to define the Submesh geometries so we can draw
-	// the Submeshes individually.
-	std::unordered_map<std::string, SubmeshGeometry> DrawArgs;
+	// the Submeshes individually. Keyed by id, e.g. DrawArgs.Get("box"_rid).
+	ResourceRegistry<SubmeshGeometry> DrawArgs;
 
 	D3D12_VERTEX_BUFFER_VIEW VertexBufferView()const
 	{
@@ -224,16 +261,6 @@ struct Light
 
 #define MaxLights 16
 
-struct MaterialConstants
-{
-	DirectX::XMFLOAT4 DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 1.0f };
-	DirectX::XMFLOAT3 FresnelR0 = { 0.01f, 0.01f, 0.01f };
-	float Roughness = 0.25f;
-
-	// Used in texture mapping.
-	DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
-};
-
 // Simple struct to represent a material for our demos.  A production 3D engine
 // would likely create a class hierarchy of Materials.
 struct Material
@@ -241,7 +268,7 @@ struct Material
 	// Unique material name for lookup.
 	std::string Name;
 
-	// Index into constant buffer corresponding to this material.
+	// Index into the material table (a structured buffer) corresponding to this material.
 	int MatCBIndex = -1;
 
 	// Index into SRV heap for diffuse texture.
@@ -250,11 +277,8 @@ struct Material
 	// Index into SRV heap for normal texture.
 	int NormalSrvHeapIndex = -1;
 
-	// Dirty flag indicating the material has changed and we need to update the constant buffer.
-	// Because we have a material constant buffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify a material we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	int NumFramesDirty = gNumFrameResources;
+	// There is a material table for each FrameResource, so a changed material has to be
+	// written once per FrameResource. Call Renderer::MarkMaterialDirty after modifying it.
 
 	// Material constant buffer data used for shading.
 	DirectX::XMFLOAT4 DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -51,6 +51,11 @@ void Camera::UpdateViewMatrix() {
     XMVECTOR upVec = XMLoadFloat3(&m_up);
 
     m_viewMatrix = XMMatrixLookAtLH(posVec, targetVec, upVec);
+    ++m_version;
+}
+
+std::uint64_t Camera::Version() const {
+    return m_version;
 }
 
 XMMATRIX Camera::GetViewMatrix() const {
@@ -86,6 +91,11 @@ void Camera::MoveUp(float distance) {
 }
 
 void Camera::Rotate(float yawDelta, float pitchDelta) {
+    // 每帧都会调用，鼠标没动时不改变视图矩阵（也就不改变版本）
+    if (m_orbitInitialized && yawDelta == 0.0f && pitchDelta == 0.0f)
+        return;
+    m_orbitInitialized = true;
+
     m_yaw += yawDelta;
     m_pitch += pitchDelta;
 
@@ -0,0 +1,657 @@
+#include "CommandCapture.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char CaptureMagic[8] = { 'D', '3', 'D', 'C', 'A', 'P', '0', '1' };
+    constexpr std::uint32_t CaptureVersion = 1;
+
+    template<typename T>
+    void WritePod(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool ReadPod(std::ifstream& file, T& value)
+    {
+        return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+
+    void WriteBytes(std::ofstream& file, const CommandCapture& capture, const CaptureRange& range)
+    {
+        WritePod(file, range.Size);
+        file.write(reinterpret_cast<const char*>(capture.Data(range)), (std::streamsize)range.Size);
+    }
+
+    bool ReadBytes(std::ifstream& file, std::uint64_t fileSize, CommandCapture& capture, CaptureRange& range)
+    {
+        std::uint64_t size = 0;
+        // 长度超过文件剩余字节说明文件已损坏，不要按它分配内存
+        if(!ReadPod(file, size) || size > fileSize - (std::uint64_t)file.tellg())
+            return false;
+        range.Offset = capture.Bytes.size();
+        range.Size = size;
+        capture.Bytes.resize((std::size_t)(range.Offset + size));
+        return (bool)file.read(reinterpret_cast<char*>(capture.Bytes.data() + range.Offset), (std::streamsize)size);
+    }
+}
+
+CaptureRange CommandCapture::Append(const void* data, std::size_t byteSize)
+{
+    CaptureRange range;
+    range.Offset = Bytes.size();
+    range.Size = byteSize;
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    Bytes.insert(Bytes.end(), bytes, bytes + byteSize);
+    return range;
+}
+
+bool SaveCommandCapture(const CommandCapture& capture, const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file)
+        return false;
+
+    file.write(CaptureMagic, sizeof(CaptureMagic));
+    WritePod(file, CaptureVersion);
+    WritePod(file, capture.FrameCount);
+    WritePod(file, (std::uint64_t)capture.Records.size());
+
+    for(const auto& record : capture.Records)
+    {
+        WritePod(file, (std::uint8_t)record.Kind);
+        switch(record.Kind)
+        {
+        case CaptureRecordKind::Execute:
+            WritePod(file, (std::uint32_t)record.Lists.size());
+            for(const auto& list : record.Lists)
+                WriteBytes(file, capture, list);
+            break;
+        case CaptureRecordKind::Signal:
+            WritePod(file, record.Value);
+            break;
+        case CaptureRecordKind::Upload:
+            WritePod(file, record.Value);
+            WriteBytes(file, capture, record.Data);
+            break;
+        }
+    }
+    return (bool)file;
+}
+
+bool LoadCommandCapture(const std::string& path, CommandCapture& capture)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file)
+        return false;
+    const std::uint64_t fileSize = (std::uint64_t)file.tellg();
+    file.seekg(0);
+
+    char magic[sizeof(CaptureMagic)];
+    std::uint32_t version = 0;
+    std::uint64_t recordCount = 0;
+    CommandCapture result;
+    if(!file.read(magic, sizeof(magic)) || std::memcmp(magic, CaptureMagic, sizeof(magic)) != 0)
+        return false;
+    if(!ReadPod(file, version) || version != CaptureVersion)
+        return false;
+    if(!ReadPod(file, result.FrameCount) || !ReadPod(file, recordCount))
+        return false;
+    result.Bytes.reserve((std::size_t)fileSize);
+
+    for(std::uint64_t r = 0; r < recordCount; ++r)
+    {
+        std::uint8_t kind = 0;
+        if(!ReadPod(file, kind))
+            return false;
+
+        CaptureRecord record;
+        record.Kind = (CaptureRecordKind)kind;
+        switch(record.Kind)
+        {
+        case CaptureRecordKind::Execute:
+        {
+            std::uint32_t listCount = 0;
+            if(!ReadPod(file, listCount))
+                return false;
+            for(std::uint32_t i = 0; i < listCount; ++i)
+            {
+                CaptureRange list;
+                if(!ReadBytes(file, fileSize, result, list))
+                    return false;
+                record.Lists.push_back(list);
+            }
+            break;
+        }
+        case CaptureRecordKind::Signal:
+            if(!ReadPod(file, record.Value))
+                return false;
+            break;
+        case CaptureRecordKind::Upload:
+            if(!ReadPod(file, record.Value) || !ReadBytes(file, fileSize, result, record.Data))
+                return false;
+            break;
+        default:
+            return false;
+        }
+        result.Records.push_back(std::move(record));
+    }
+
+    capture = std::move(result);
+    return true;
+}
+
+bool DispatchCommandStream(const std::uint8_t* bytes, std::size_t byteSize, CommandList& list,
+    std::uint64_t* commandCount, std::uint64_t* drawCount)
+{
+    std::uint64_t commands = 0;
+    std::uint64_t draws = 0;
+    CommandStreamReader reader(bytes, byteSize);
+    CommandOp op;
+    const std::uint8_t* p = nullptr;
+    while(reader.Next(op, p))
+    {
+        commands++;
+        switch(op)
+        {
+        case CommandOp::TransitionBarrier:
+        {
+            auto args = CommandStreamReader::Read<TransitionBarrierArgs>(p);
+            list.TransitionBarrier(args.Resource, args.StateBefore, args.StateAfter);
+            break;
+        }
+        case CommandOp::ClearRenderTarget:
+        {
+            auto args = CommandStreamReader::Read<ClearRenderTargetArgs>(p);
+            list.ClearRenderTarget(args.Rtv, args.Color);
+            break;
+        }
+        case CommandOp::ClearDepthStencil:
+        {
+            auto args = CommandStreamReader::Read<ClearDepthStencilArgs>(p);
+            list.ClearDepthStencil(args.Dsv, args.Depth, args.Stencil);
+            break;
+        }
+        case CommandOp::SetViewport:
+            list.SetViewport(CommandStreamReader::Read<ViewportDesc>(p));
+            break;
+        case CommandOp::SetScissorRect:
+            list.SetScissorRect(CommandStreamReader::Read<ScissorRect>(p));
+            break;
+        case CommandOp::SetRenderTarget:
+        {
+            auto args = CommandStreamReader::Read<SetRenderTargetArgs>(p);
+            list.SetRenderTarget(args.Rtv, args.Dsv);
+            break;
+        }
+        case CommandOp::SetGraphicsRootSignature:
+            list.SetGraphicsRootSignature(CommandStreamReader::Read<RootSignatureHandle>(p));
+            break;
+        case CommandOp::SetPipelineState:
+            list.SetPipelineState(CommandStreamReader::Read<PipelineHandle>(p));
+            break;
+        case CommandOp::SetGraphicsRootConstantBufferView:
+        {
+            auto args = CommandStreamReader::Read<SetRootConstantBufferViewArgs>(p);
+            list.SetGraphicsRootConstantBufferView(args.RootParameterIndex, args.Address);
+            break;
+        }
+        case CommandOp::SetGraphicsRootShaderResourceView:
+        {
+            auto args = CommandStreamReader::Read<SetRootShaderResourceViewArgs>(p);
+            list.SetGraphicsRootShaderResourceView(args.RootParameterIndex, args.Address);
+            break;
+        }
+        case CommandOp::SetGraphicsRoot32BitConstant:
+        {
+            auto args = CommandStreamReader::Read<SetRoot32BitConstantArgs>(p);
+            list.SetGraphicsRoot32BitConstant(args.RootParameterIndex, args.Value, args.DestOffset);
+            break;
+        }
+        case CommandOp::SetVertexBuffer:
+            list.SetVertexBuffer(CommandStreamReader::Read<VertexBufferBinding>(p));
+            break;
+        case CommandOp::SetIndexBuffer:
+            list.SetIndexBuffer(CommandStreamReader::Read<IndexBufferBinding>(p));
+            break;
+        case CommandOp::SetPrimitiveTopology:
+            list.SetPrimitiveTopology(CommandStreamReader::Read<std::uint32_t>(p));
+            break;
+        case CommandOp::DrawIndexedInstanced:
+        {
+            auto args = CommandStreamReader::Read<DrawIndexedInstancedArgs>(p);
+            list.DrawIndexedInstanced(args.IndexCountPerInstance, args.InstanceCount,
+                args.StartIndexLocation, args.BaseVertexLocation, args.StartInstanceLocation);
+            draws++;
+            break;
+        }
+        case CommandOp::ExecuteIndirect:
+        {
+            auto args = CommandStreamReader::Read<ExecuteIndirectArgs>(p);
+            list.ExecuteIndirect(args.Signature, args.MaxCommandCount, args.ArgumentBuffer, args.ArgumentOffset);
+            draws++;
+            break;
+        }
+        case CommandOp::CopyBufferRegion:
+        {
+            auto args = CommandStreamReader::Read<CopyBufferRegionArgs>(p);
+            list.CopyBufferRegion(args.Dst, args.DstOffset, args.Src, args.SrcOffset, args.NumBytes);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+
+    if(commandCount != nullptr)
+        *commandCount += commands;
+    if(drawCount != nullptr)
+        *drawCount += draws;
+    return reader.Valid();
+}
+
+CommandHistogram CountCommands(const CommandCapture& capture)
+{
+    CommandHistogram counts = {};
+    for(const auto& record : capture.Records)
+    {
+        for(const auto& list : record.Lists)
+        {
+            CommandStreamReader reader(capture.Data(list), (std::size_t)list.Size);
+            CommandOp op;
+            const std::uint8_t* payload = nullptr;
+            while(reader.Next(op, payload))
+                counts[(std::size_t)op]++;
+        }
+    }
+    return counts;
+}
+
+const char* CommandOpName(CommandOp op)
+{
+    switch(op)
+    {
+    case CommandOp::TransitionBarrier:                 return "TransitionBarrier";
+    case CommandOp::ClearRenderTarget:                 return "ClearRenderTarget";
+    case CommandOp::ClearDepthStencil:                 return "ClearDepthStencil";
+    case CommandOp::SetViewport:                       return "SetViewport";
+    case CommandOp::SetScissorRect:                    return "SetScissorRect";
+    case CommandOp::SetRenderTarget:                   return "SetRenderTarget";
+    case CommandOp::SetGraphicsRootSignature:          return "SetGraphicsRootSignature";
+    case CommandOp::SetPipelineState:                  return "SetPipelineState";
+    case CommandOp::SetGraphicsRootConstantBufferView: return "SetGraphicsRootConstantBufferView";
+    case CommandOp::SetVertexBuffer:                   return "SetVertexBuffer";
+    case CommandOp::SetIndexBuffer:                    return "SetIndexBuffer";
+    case CommandOp::SetPrimitiveTopology:              return "SetPrimitiveTopology";
+    case CommandOp::DrawIndexedInstanced:              return "DrawIndexedInstanced";
+    case CommandOp::SetGraphicsRootShaderResourceView: return "SetGraphicsRootShaderResourceView";
+    case CommandOp::SetGraphicsRoot32BitConstant:      return "SetGraphicsRoot32BitConstant";
+    case CommandOp::ExecuteIndirect:                   return "ExecuteIndirect";
+    case CommandOp::CopyBufferRegion:                  return "CopyBufferRegion";
+    default:                                           return "Unknown";
+    }
+}
+
+CaptureCommandList::CaptureCommandList(CaptureGraphicsDevice& device, std::unique_ptr<CommandList> inner) :
+    mDevice(device), mInner(std::move(inner))
+{
+}
+
+void CaptureCommandList::Begin(PipelineHandle initialPipeline)
+{
+    mInner->Begin(initialPipeline);
+    mCapturing = mDevice.IsCapturing();
+    mStream.Clear();
+    if(!mCapturing)
+        return;
+    // 第一次捕获时一次分配好，录制中不再增长
+    mStream.Reserve(mDevice.ListReserveBytes());
+    if(initialPipeline != 0)
+        mStream.Write(CommandOp::SetPipelineState, initialPipeline);
+}
+
+void CaptureCommandList::End()
+{
+    mInner->End();
+}
+
+void CaptureCommandList::TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter)
+{
+    mInner->TransitionBarrier(resource, stateBefore, stateAfter);
+    if(mCapturing)
+        mStream.Write(CommandOp::TransitionBarrier, TransitionBarrierArgs{ resource, stateBefore, stateAfter });
+}
+
+void CaptureCommandList::ClearRenderTarget(DescriptorHandle rtv, const float color[4])
+{
+    mInner->ClearRenderTarget(rtv, color);
+    if(mCapturing)
+    {
+        ClearRenderTargetArgs args;
+        args.Rtv = rtv;
+        std::memcpy(args.Color, color, sizeof(args.Color));
+        mStream.Write(CommandOp::ClearRenderTarget, args);
+    }
+}
+
+void CaptureCommandList::ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil)
+{
+    mInner->ClearDepthStencil(dsv, depth, stencil);
+    if(mCapturing)
+        mStream.Write(CommandOp::ClearDepthStencil, ClearDepthStencilArgs{ dsv, depth, stencil });
+}
+
+void CaptureCommandList::SetViewport(const ViewportDesc& viewport)
+{
+    mInner->SetViewport(viewport);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetViewport, viewport);
+}
+
+void CaptureCommandList::SetScissorRect(const ScissorRect& rect)
+{
+    mInner->SetScissorRect(rect);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetScissorRect, rect);
+}
+
+void CaptureCommandList::SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv)
+{
+    mInner->SetRenderTarget(rtv, dsv);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetRenderTarget, SetRenderTargetArgs{ rtv, dsv });
+}
+
+void CaptureCommandList::SetGraphicsRootSignature(RootSignatureHandle rootSignature)
+{
+    mInner->SetGraphicsRootSignature(rootSignature);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetGraphicsRootSignature, rootSignature);
+}
+
+void CaptureCommandList::SetPipelineState(PipelineHandle pipeline)
+{
+    mInner->SetPipelineState(pipeline);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetPipelineState, pipeline);
+}
+
+void CaptureCommandList::SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address)
+{
+    mInner->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetGraphicsRootConstantBufferView, SetRootConstantBufferViewArgs{ rootParameterIndex, address });
+}
+
+void CaptureCommandList::SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address)
+{
+    mInner->SetGraphicsRootShaderResourceView(rootParameterIndex, address);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetGraphicsRootShaderResourceView, SetRootShaderResourceViewArgs{ rootParameterIndex, address });
+}
+
+void CaptureCommandList::SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset)
+{
+    mInner->SetGraphicsRoot32BitConstant(rootParameterIndex, value, destOffset);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetGraphicsRoot32BitConstant, SetRoot32BitConstantArgs{ rootParameterIndex, value, destOffset });
+}
+
+void CaptureCommandList::SetVertexBuffer(const VertexBufferBinding& view)
+{
+    mInner->SetVertexBuffer(view);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetVertexBuffer, view);
+}
+
+void CaptureCommandList::SetIndexBuffer(const IndexBufferBinding& view)
+{
+    mInner->SetIndexBuffer(view);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetIndexBuffer, view);
+}
+
+void CaptureCommandList::SetPrimitiveTopology(std::uint32_t topology)
+{
+    mInner->SetPrimitiveTopology(topology);
+    if(mCapturing)
+        mStream.Write(CommandOp::SetPrimitiveTopology, topology);
+}
+
+void CaptureCommandList::DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+    std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation)
+{
+    mInner->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+    if(mCapturing)
+        mStream.Write(CommandOp::DrawIndexedInstanced, DrawIndexedInstancedArgs{
+            indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation });
+}
+
+void CaptureCommandList::ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+    ResourceHandle argumentBuffer, std::uint64_t argumentOffset)
+{
+    mInner->ExecuteIndirect(signature, maxCommandCount, argumentBuffer, argumentOffset);
+    if(mCapturing)
+        mStream.Write(CommandOp::ExecuteIndirect, ExecuteIndirectArgs{ signature, maxCommandCount, argumentBuffer, argumentOffset });
+}
+
+void CaptureCommandList::CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+    ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes)
+{
+    mInner->CopyBufferRegion(dst, dstOffset, src, srcOffset, numBytes);
+    if(mCapturing)
+        mStream.Write(CommandOp::CopyBufferRegion, CopyBufferRegionArgs{ dst, dstOffset, src, srcOffset, numBytes });
+}
+
+CaptureGraphicsDevice::CaptureGraphicsDevice(std::unique_ptr<GraphicsDevice> inner) :
+    mInner(std::move(inner)),
+    mSharesInnerStreams(mInner->RecordsCommandStreams())
+{
+}
+
+void CaptureGraphicsDevice::BeginCapture(std::uint32_t frameCount, std::size_t reserveBytes, std::size_t listReserveBytes)
+{
+    if(frameCount == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCapture = CommandCapture();
+    if(reserveBytes > 0)
+    {
+        // 先 resize 触碰每一页再清空，容量保留下来
+        mCapture.Bytes.resize(reserveBytes);
+        mCapture.Bytes.clear();
+    }
+    mListReserveBytes.store(listReserveBytes, std::memory_order_relaxed);
+    mFramesRemaining = frameCount;
+    mCompleted = false;
+    mCapturing.store(true, std::memory_order_release);
+}
+
+bool CaptureGraphicsDevice::HasCompletedCapture() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCompleted;
+}
+
+CommandCapture CaptureGraphicsDevice::TakeCapture()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCompleted = false;
+    return std::move(mCapture);
+}
+
+void CaptureGraphicsDevice::CaptureUpload(GpuAddress address, const void* data, std::size_t byteSize)
+{
+    if(!IsCapturing())
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(!IsCapturing())
+        return;
+
+    CaptureRecord record;
+    record.Kind = CaptureRecordKind::Upload;
+    record.Value = address;
+    record.Data = mCapture.Append(data, byteSize);
+    mCapture.Records.push_back(std::move(record));
+}
+
+std::unique_ptr<CommandList> CaptureGraphicsDevice::CreateCommandList()
+{
+    if(mSharesInnerStreams)
+        return mInner->CreateCommandList();
+    return std::make_unique<CaptureCommandList>(*this, mInner->CreateCommandList());
+}
+
+void CaptureGraphicsDevice::ExecuteCommandLists(CommandList* const* lists, std::uint32_t count)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(mSharesInnerStreams)
+    {
+        if(IsCapturing())
+        {
+            CaptureRecord record;
+            record.Kind = CaptureRecordKind::Execute;
+            record.Lists.resize(count);
+            for(std::uint32_t i = 0; i < count; ++i)
+            {
+                const CommandStreamWriter* stream = lists[i]->RecordedStream();
+                record.Lists[i] = mCapture.Append(stream->Data(), stream->Size());
+            }
+            mCapture.Records.push_back(std::move(record));
+        }
+        mInner->ExecuteCommandLists(lists, count);
+        return;
+    }
+
+    mInnerLists.resize(count);
+    for(std::uint32_t i = 0; i < count; ++i)
+        mInnerLists[i] = static_cast<CaptureCommandList*>(lists[i])->Inner();
+
+    if(IsCapturing())
+    {
+        // 在 BeginCapture 之前就开始录制的列表没有内容，记录为空流
+        CaptureRecord record;
+        record.Kind = CaptureRecordKind::Execute;
+        record.Lists.resize(count);
+        for(std::uint32_t i = 0; i < count; ++i)
+        {
+            auto* list = static_cast<CaptureCommandList*>(lists[i]);
+            if(list->Capturing())
+                record.Lists[i] = mCapture.Append(list->Stream().Data(), list->Stream().Size());
+        }
+        mCapture.Records.push_back(std::move(record));
+    }
+
+    mInner->ExecuteCommandLists(mInnerLists.data(), count);
+}
+
+void CaptureGraphicsDevice::Signal(std::uint64_t fenceValue)
+{
+    mInner->Signal(fenceValue);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(!IsCapturing())
+        return;
+
+    CaptureRecord record;
+    record.Kind = CaptureRecordKind::Signal;
+    record.Value = fenceValue;
+    mCapture.Records.push_back(std::move(record));
+    mCapture.FrameCount++;
+
+    if(--mFramesRemaining == 0)
+    {
+        mCapturing.store(false, std::memory_order_release);
+        mCompleted = true;
+    }
+}
+
+std::uint64_t CaptureGraphicsDevice::CompletedFenceValue()
+{
+    return mInner->CompletedFenceValue();
+}
+
+void CaptureGraphicsDevice::WaitForFenceValue(std::uint64_t fenceValue)
+{
+    mInner->WaitForFenceValue(fenceValue);
+}
+
+CommandReplayer::CommandReplayer(GraphicsDevice& device, std::uint32_t framesInFlight) :
+    mDevice(device),
+    mFramesInFlight(framesInFlight > 0 ? framesInFlight : 1),
+    mFrameLists(mFramesInFlight),
+    mFrameFences(mFramesInFlight, 0),
+    mFence(device.CompletedFenceValue())
+{
+}
+
+CommandList* CommandReplayer::AcquireList()
+{
+    auto& lists = mFrameLists[mFrameIndex];
+    if(mListsUsed == lists.size())
+        lists.push_back(mDevice.CreateCommandList());
+    return lists[mListsUsed++].get();
+}
+
+CommandReplayer::Stats CommandReplayer::Replay(const CommandCapture& capture, const UploadFunction& onUpload)
+{
+    Stats stats;
+    std::vector<CommandList*> submitted;
+
+    for(const auto& record : capture.Records)
+    {
+        switch(record.Kind)
+        {
+        case CaptureRecordKind::Upload:
+            stats.UploadBytes += record.Data.Size;
+            if(onUpload)
+                onUpload(record.Value, capture.Data(record.Data), (std::size_t)record.Data.Size);
+            break;
+
+        case CaptureRecordKind::Execute:
+        {
+            submitted.clear();
+            for(const auto& stream : record.Lists)
+            {
+                CommandList* list = AcquireList();
+                list->Begin(0);
+                if(!DispatchCommandStream(capture.Data(stream), (std::size_t)stream.Size, *list, &stats.Commands, &stats.Draws))
+                    throw std::runtime_error("CommandReplayer: 捕获的命令流已损坏");
+                list->End();
+                submitted.push_back(list);
+            }
+            mDevice.ExecuteCommandLists(submitted.data(), (std::uint32_t)submitted.size());
+            stats.Lists += submitted.size();
+            break;
+        }
+
+        case CaptureRecordKind::Signal:
+        {
+            // 一帧结束：换到下一组命令列表，GPU 还没用完它们时先等待
+            mFrameFences[mFrameIndex] = ++mFence;
+            mDevice.Signal(mFence);
+            stats.Frames++;
+
+            mFrameIndex = (mFrameIndex + 1) % mFramesInFlight;
+            mListsUsed = 0;
+            if(mFrameFences[mFrameIndex] != 0)
+                mDevice.WaitForFenceValue(mFrameFences[mFrameIndex]);
+            break;
+        }
+        }
+    }
+    return stats;
+}
+
+void CommandReplayer::Flush()
+{
+    // 最后一帧没有以 Signal 结束时，补一个围栏把它包含进去
+    mDevice.Signal(++mFence);
+    mDevice.WaitForFenceValue(mFence);
+}
@@ -0,0 +1,40 @@
+#include "CpuFeatures.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #define CPU_HAS_SSE 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#else
+    #define CPU_HAS_SSE 0
+#endif
+
+namespace
+{
+    SimdPath DetectSimdPath()
+    {
+#if CPU_HAS_SSE
+    #if defined(_MSC_VER) && !defined(__clang__)
+        // CPUID.1:ECX 的 OSXSAVE(27) 和 AVX(28) 位，并且操作系统会保存 YMM 寄存器（XCR0 的 1、2 位）
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if(osxsave && avx && (_xgetbv(0) & 6) == 6)
+            return SimdPath::Avx;
+    #else
+        if(__builtin_cpu_supports("avx"))
+            return SimdPath::Avx;
+    #endif
+        return SimdPath::Sse;
+#else
+        return SimdPath::Scalar;
+#endif
+    }
+}
+
+SimdPath BestSimdPath()
+{
+    static const SimdPath path = DetectSimdPath();
+    return path;
+}
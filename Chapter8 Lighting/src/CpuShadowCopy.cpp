@@ -0,0 +1,345 @@
+#include "CpuShadowCopy.h"
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    // 压缩流格式（与 LZ4 块格式相同的思路）：
+    //   头部：原始字节数 (u64)、元素步长 (u32)
+    //   序列：token（高4位字面量长度、低4位匹配长度-4，取15时后面跟扩展字节）、
+    //         字面量、匹配距离 (u16)；最后一个序列只有字面量
+    constexpr std::size_t HeaderSize = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+    constexpr std::size_t MinMatch = 4;
+    constexpr std::size_t MaxOffset = 65535;
+    constexpr int HashBits = 14;
+
+    std::uint32_t Read32(const std::uint8_t* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    std::uint32_t Hash(std::uint32_t v)
+    {
+        return (v * 2654435761u) >> (32 - HashBits);
+    }
+
+    void WriteLength(std::vector<std::uint8_t>& out, std::size_t length)
+    {
+        while(length >= 255)
+        {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back((std::uint8_t)length);
+    }
+
+    void EmitSequence(std::vector<std::uint8_t>& out, const std::uint8_t* literals, std::size_t literalLength,
+        std::size_t offset, std::size_t matchLength)
+    {
+        std::size_t matchCode = matchLength >= MinMatch ? matchLength - MinMatch : 0;
+        std::uint8_t token = (std::uint8_t)((literalLength < 15 ? literalLength : 15) << 4);
+        token |= (std::uint8_t)(matchCode < 15 ? matchCode : 15);
+        out.push_back(token);
+
+        if(literalLength >= 15)
+            WriteLength(out, literalLength - 15);
+        out.insert(out.end(), literals, literals + literalLength);
+
+        if(matchLength == 0)
+            return;
+
+        out.push_back((std::uint8_t)(offset & 0xff));
+        out.push_back((std::uint8_t)(offset >> 8));
+        if(matchCode >= 15)
+            WriteLength(out, matchCode - 15);
+    }
+
+    bool ReadLength(const std::uint8_t*& ip, const std::uint8_t* end, std::size_t& length)
+    {
+        std::uint8_t b;
+        do
+        {
+            if(ip >= end)
+                return false;
+            b = *ip++;
+            length += b;
+        } while(b == 255);
+        return true;
+    }
+
+    // 第 k 个字节平面放在一起：顶点的指数字节、索引的高字节往往大量重复，LZ 更容易匹配
+    void Shuffle(const std::uint8_t* src, std::size_t byteSize, std::uint32_t stride, std::uint8_t* dst)
+    {
+        std::size_t count = byteSize / stride;
+        for(std::size_t i = 0; i < count; ++i)
+            for(std::uint32_t b = 0; b < stride; ++b)
+                dst[b * count + i] = src[i * stride + b];
+        std::memcpy(dst + count * stride, src + count * stride, byteSize - count * stride);
+    }
+
+    void Unshuffle(const std::uint8_t* src, std::size_t byteSize, std::uint32_t stride, std::uint8_t* dst)
+    {
+        std::size_t count = byteSize / stride;
+        for(std::size_t i = 0; i < count; ++i)
+            for(std::uint32_t b = 0; b < stride; ++b)
+                dst[i * stride + b] = src[b * count + i];
+        std::memcpy(dst + count * stride, src + count * stride, byteSize - count * stride);
+    }
+}
+
+std::vector<std::uint8_t> ShadowCompression::Compress(const void* data, std::size_t byteSize, std::uint32_t elementStride)
+{
+    if(elementStride == 0)
+        elementStride = 1;
+
+    std::vector<std::uint8_t> shuffled(byteSize);
+    if(byteSize > 0)
+        Shuffle(static_cast<const std::uint8_t*>(data), byteSize, elementStride, shuffled.data());
+
+    std::vector<std::uint8_t> out(HeaderSize);
+    std::uint64_t rawSize = byteSize;
+    std::memcpy(out.data(), &rawSize, sizeof(rawSize));
+    std::memcpy(out.data() + sizeof(rawSize), &elementStride, sizeof(elementStride));
+    out.reserve(HeaderSize + byteSize / 2);
+
+    const std::uint8_t* src = shuffled.data();
+    std::vector<std::uint32_t> table((size_t)1 << HashBits, 0); // 存位置+1，0 表示空
+    std::size_t ip = 0;
+    std::size_t anchor = 0;
+
+    while(byteSize >= MinMatch && ip + MinMatch <= byteSize)
+    {
+        std::uint32_t seq = Read32(src + ip);
+        std::uint32_t h = Hash(seq);
+        std::size_t candidate = table[h];
+        table[h] = (std::uint32_t)(ip + 1);
+
+        if(candidate != 0 && ip - (candidate - 1) <= MaxOffset && Read32(src + candidate - 1) == seq)
+        {
+            std::size_t ref = candidate - 1;
+            std::size_t length = MinMatch;
+            while(ip + length < byteSize && src[ref + length] == src[ip + length])
+                length++;
+
+            EmitSequence(out, src + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+        }
+        else
+        {
+            ip++;
+        }
+    }
+
+    EmitSequence(out, src + anchor, byteSize - anchor, 0, 0);
+    return out;
+}
+
+bool ShadowCompression::Decompress(const std::vector<std::uint8_t>& compressed, std::vector<std::uint8_t>& out)
+{
+    if(compressed.size() < HeaderSize)
+        return false;
+
+    std::uint64_t rawSize = 0;
+    std::uint32_t stride = 1;
+    std::memcpy(&rawSize, compressed.data(), sizeof(rawSize));
+    std::memcpy(&stride, compressed.data() + sizeof(rawSize), sizeof(stride));
+    if(stride == 0)
+        return false;
+
+    std::vector<std::uint8_t> shuffled((size_t)rawSize);
+    std::uint8_t* op = shuffled.data();
+    std::uint8_t* const oend = op + rawSize;
+    const std::uint8_t* ip = compressed.data() + HeaderSize;
+    const std::uint8_t* const iend = compressed.data() + compressed.size();
+
+    while(ip < iend)
+    {
+        std::uint8_t token = *ip++;
+
+        std::size_t literalLength = token >> 4;
+        if(literalLength == 15 && !ReadLength(ip, iend, literalLength))
+            return false;
+        if(literalLength > (std::size_t)(iend - ip) || literalLength > (std::size_t)(oend - op))
+            return false;
+        if(literalLength > 0) // 空数据时 op 为空指针
+            std::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if(ip == iend)
+            break;
+
+        if(iend - ip < 2)
+            return false;
+        std::size_t offset = ip[0] | ((std::size_t)ip[1] << 8);
+        ip += 2;
+
+        std::size_t matchLength = token & 15;
+        if(matchLength == 15 && !ReadLength(ip, iend, matchLength))
+            return false;
+        matchLength += MinMatch;
+
+        if(offset == 0 || offset > (std::size_t)(op - shuffled.data()) || matchLength > (std::size_t)(oend - op))
+            return false;
+
+        // 匹配可能与输出重叠，逐字节复制
+        const std::uint8_t* match = op - offset;
+        for(std::size_t i = 0; i < matchLength; ++i)
+            op[i] = match[i];
+        op += matchLength;
+    }
+
+    if(op != oend)
+        return false;
+
+    out.resize((size_t)rawSize);
+    if(rawSize > 0)
+        Unshuffle(shuffled.data(), (size_t)rawSize, stride, out.data());
+    return true;
+}
+
+CpuShadowCopy::CpuShadowCopy(CpuShadowCopy&& rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+
+CpuShadowCopy& CpuShadowCopy::operator=(CpuShadowCopy&& rhs) noexcept
+{
+    if(this == &rhs)
+        return *this;
+
+    std::scoped_lock lock(mCacheMutex, rhs.mCacheMutex);
+    mPolicy = rhs.mPolicy;
+    mByteSize = rhs.mByteSize;
+    mRaw = std::move(rhs.mRaw);
+    mCompressed = std::move(rhs.mCompressed);
+    mFile = std::move(rhs.mFile);
+    mHasFile = rhs.mHasFile;
+    mCache = std::move(rhs.mCache);
+
+    // 源对象回到默认构造的状态
+    rhs.mPolicy = ShadowCopyPolicy::DropAfterUpload;
+    rhs.mByteSize = 0;
+    rhs.mRaw = nullptr;
+    rhs.mCompressed = std::vector<std::uint8_t>();
+    rhs.mFile = ShadowFileSource();
+    rhs.mHasFile = false;
+    rhs.mCache.reset();
+    return *this;
+}
+
+void CpuShadowCopy::Store(const void* data, std::size_t byteSize, ShadowCopyPolicy policy, std::uint32_t elementStride)
+{
+    mPolicy = policy;
+    mByteSize = byteSize;
+    mRaw = nullptr;
+    mCompressed.clear();
+    mCompressed.shrink_to_fit();
+    {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        mCache.reset();
+    }
+
+    switch(policy)
+    {
+    case ShadowCopyPolicy::KeepRaw:
+    {
+        const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+        mRaw = std::make_shared<const std::vector<std::uint8_t>>(bytes, bytes + byteSize);
+        break;
+    }
+    case ShadowCopyPolicy::KeepCompressed:
+        mCompressed = ShadowCompression::Compress(data, byteSize, elementStride);
+        break;
+    case ShadowCopyPolicy::PageFromFile:
+        if(mHasFile && mFile.ByteSize != byteSize)
+            mHasFile = false;
+        break;
+    case ShadowCopyPolicy::DropAfterUpload:
+        break;
+    }
+}
+
+void CpuShadowCopy::SetFileSource(ShadowFileSource source)
+{
+    mFile = std::move(source);
+    mHasFile = true;
+    mPolicy = ShadowCopyPolicy::PageFromFile;
+    mByteSize = (std::size_t)mFile.ByteSize;
+    mRaw = nullptr;
+    mCompressed.clear();
+    mCompressed.shrink_to_fit();
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    mCache.reset();
+}
+
+void CpuShadowCopy::Reset()
+{
+    Store(nullptr, 0, ShadowCopyPolicy::DropAfterUpload);
+    mHasFile = false;
+    mFile = ShadowFileSource();
+}
+
+bool CpuShadowCopy::Available() const
+{
+    switch(mPolicy)
+    {
+    case ShadowCopyPolicy::KeepRaw:        return mRaw != nullptr;
+    case ShadowCopyPolicy::KeepCompressed: return !mCompressed.empty();
+    case ShadowCopyPolicy::PageFromFile:   return mHasFile;
+    default:                               return false;
+    }
+}
+
+std::size_t CpuShadowCopy::ResidentBytes() const
+{
+    if(mRaw != nullptr)
+        return mRaw->size();
+    return mCompressed.size();
+}
+
+ShadowCopyView CpuShadowCopy::Acquire() const
+{
+    if(mPolicy == ShadowCopyPolicy::KeepRaw)
+        return ShadowCopyView(mRaw);
+
+    if(!Available())
+        return ShadowCopyView();
+
+    // 还有使用者持有上一次的解压结果时直接共享
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    auto cached = mCache.lock();
+    if(cached == nullptr)
+    {
+        cached = Load();
+        mCache = cached;
+    }
+    return ShadowCopyView(cached);
+}
+
+std::shared_ptr<const std::vector<std::uint8_t>> CpuShadowCopy::Load() const
+{
+    auto bytes = std::make_shared<std::vector<std::uint8_t>>();
+
+    if(mPolicy == ShadowCopyPolicy::KeepCompressed)
+    {
+        if(!ShadowCompression::Decompress(mCompressed, *bytes))
+            return nullptr;
+        return bytes;
+    }
+
+    std::ifstream file(mFile.Path, std::ios::binary);
+    if(!file)
+        return nullptr;
+
+    bytes->resize((size_t)mFile.ByteSize);
+    file.seekg((std::streamoff)mFile.Offset);
+    file.read(reinterpret_cast<char*>(bytes->data()), (std::streamsize)mFile.ByteSize);
+    if(!file)
+        return nullptr;
+
+    return bytes;
+}
@@ -0,0 +1,191 @@
+#include "D3D12GraphicsDevice.h"
+#include "d3dx12.h"
+
+// GraphicsDevice.h 里的常量直接当作 D3D12 的枚举值使用
+static_assert(ResourceState::Present == D3D12_RESOURCE_STATE_PRESENT, "资源状态与 D3D12 不一致");
+static_assert(ResourceState::RenderTarget == D3D12_RESOURCE_STATE_RENDER_TARGET, "资源状态与 D3D12 不一致");
+static_assert(ResourceState::DepthWrite == D3D12_RESOURCE_STATE_DEPTH_WRITE, "资源状态与 D3D12 不一致");
+static_assert(ResourceState::CopyDest == D3D12_RESOURCE_STATE_COPY_DEST, "资源状态与 D3D12 不一致");
+static_assert(PrimitiveTopology::TriangleList == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, "图元拓扑与 D3D12 不一致");
+static_assert(PrimitiveTopology::TriangleStrip == D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, "图元拓扑与 D3D12 不一致");
+static_assert(IndexFormat::R16Uint == DXGI_FORMAT_R16_UINT && IndexFormat::R32Uint == DXGI_FORMAT_R32_UINT, "索引格式与 DXGI 不一致");
+
+namespace
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE ToDescriptor(DescriptorHandle handle)
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE descriptor;
+        descriptor.ptr = (SIZE_T)handle;
+        return descriptor;
+    }
+
+    template<typename T>
+    T* FromHandle(std::uint64_t handle)
+    {
+        return reinterpret_cast<T*>((std::uintptr_t)handle);
+    }
+}
+
+D3D12CommandList::D3D12CommandList(ID3D12Device* device)
+{
+    ThrowIfFailed(device->CreateCommandAllocator(
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        IID_PPV_ARGS(mAllocator.GetAddressOf())));
+
+    // 创建后立即关闭，第一次 Begin 时再 Reset
+    ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        mAllocator.Get(), nullptr, IID_PPV_ARGS(mCommandList.GetAddressOf())));
+    ThrowIfFailed(mCommandList->Close());
+}
+
+void D3D12CommandList::Begin(PipelineHandle initialPipeline)
+{
+    ThrowIfFailed(mAllocator->Reset());
+    ThrowIfFailed(mCommandList->Reset(mAllocator.Get(), FromHandle<ID3D12PipelineState>(initialPipeline)));
+}
+
+void D3D12CommandList::End()
+{
+    ThrowIfFailed(mCommandList->Close());
+}
+
+void D3D12CommandList::TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter)
+{
+    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+        FromHandle<ID3D12Resource>(resource),
+        (D3D12_RESOURCE_STATES)stateBefore,
+        (D3D12_RESOURCE_STATES)stateAfter));
+}
+
+void D3D12CommandList::ClearRenderTarget(DescriptorHandle rtv, const float color[4])
+{
+    mCommandList->ClearRenderTargetView(ToDescriptor(rtv), color, 0, nullptr);
+}
+
+void D3D12CommandList::ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil)
+{
+    mCommandList->ClearDepthStencilView(ToDescriptor(dsv), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
+        depth, stencil, 0, nullptr);
+}
+
+void D3D12CommandList::SetViewport(const ViewportDesc& viewport)
+{
+    D3D12_VIEWPORT vp = { viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height,
+        viewport.MinDepth, viewport.MaxDepth };
+    mCommandList->RSSetViewports(1, &vp);
+}
+
+void D3D12CommandList::SetScissorRect(const ScissorRect& rect)
+{
+    D3D12_RECT scissor = { rect.Left, rect.Top, rect.Right, rect.Bottom };
+    mCommandList->RSSetScissorRects(1, &scissor);
+}
+
+void D3D12CommandList::SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvDescriptor = ToDescriptor(rtv);
+    D3D12_CPU_DESCRIPTOR_HANDLE dsvDescriptor = ToDescriptor(dsv);
+    mCommandList->OMSetRenderTargets(1, &rtvDescriptor, TRUE, dsv != 0 ? &dsvDescriptor : nullptr);
+}
+
+void D3D12CommandList::SetGraphicsRootSignature(RootSignatureHandle rootSignature)
+{
+    mCommandList->SetGraphicsRootSignature(FromHandle<ID3D12RootSignature>(rootSignature));
+}
+
+void D3D12CommandList::SetPipelineState(PipelineHandle pipeline)
+{
+    mCommandList->SetPipelineState(FromHandle<ID3D12PipelineState>(pipeline));
+}
+
+void D3D12CommandList::SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address)
+{
+    mCommandList->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+}
+
+void D3D12CommandList::SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address)
+{
+    mCommandList->SetGraphicsRootShaderResourceView(rootParameterIndex, address);
+}
+
+void D3D12CommandList::SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset)
+{
+    mCommandList->SetGraphicsRoot32BitConstant(rootParameterIndex, value, destOffset);
+}
+
+void D3D12CommandList::SetVertexBuffer(const VertexBufferBinding& view)
+{
+    D3D12_VERTEX_BUFFER_VIEW vbv = { view.BufferLocation, view.SizeInBytes, view.StrideInBytes };
+    mCommandList->IASetVertexBuffers(0, 1, &vbv);
+}
+
+void D3D12CommandList::SetIndexBuffer(const IndexBufferBinding& view)
+{
+    D3D12_INDEX_BUFFER_VIEW ibv = { view.BufferLocation, view.SizeInBytes, (DXGI_FORMAT)view.Format };
+    mCommandList->IASetIndexBuffer(&ibv);
+}
+
+void D3D12CommandList::SetPrimitiveTopology(std::uint32_t topology)
+{
+    mCommandList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)topology);
+}
+
+void D3D12CommandList::DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+    std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation)
+{
+    mCommandList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation,
+        baseVertexLocation, startInstanceLocation);
+}
+
+void D3D12CommandList::ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+    ResourceHandle argumentBuffer, std::uint64_t argumentOffset)
+{
+    mCommandList->ExecuteIndirect(FromHandle<ID3D12CommandSignature>(signature), maxCommandCount,
+        FromHandle<ID3D12Resource>(argumentBuffer), argumentOffset, nullptr, 0);
+}
+
+void D3D12CommandList::CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+    ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes)
+{
+    mCommandList->CopyBufferRegion(FromHandle<ID3D12Resource>(dst), dstOffset,
+        FromHandle<ID3D12Resource>(src), srcOffset, numBytes);
+}
+
+D3D12GraphicsDevice::D3D12GraphicsDevice(ID3D12Device* device, ID3D12CommandQueue* queue, ID3D12Fence* fence) :
+    mDevice(device), mQueue(queue), mFence(fence)
+{
+}
+
+std::unique_ptr<CommandList> D3D12GraphicsDevice::CreateCommandList()
+{
+    return std::make_unique<D3D12CommandList>(mDevice.Get());
+}
+
+void D3D12GraphicsDevice::ExecuteCommandLists(CommandList* const* lists, std::uint32_t count)
+{
+    std::vector<ID3D12CommandList*> nativeLists(count);
+    for(std::uint32_t i = 0; i < count; ++i)
+        nativeLists[i] = static_cast<D3D12CommandList*>(lists[i])->Native();
+    mQueue->ExecuteCommandLists(count, nativeLists.data());
+}
+
+void D3D12GraphicsDevice::Signal(std::uint64_t fenceValue)
+{
+    ThrowIfFailed(mQueue->Signal(mFence.Get(), fenceValue));
+}
+
+std::uint64_t D3D12GraphicsDevice::CompletedFenceValue()
+{
+    return mFence->GetCompletedValue();
+}
+
+void D3D12GraphicsDevice::WaitForFenceValue(std::uint64_t fenceValue)
+{
+    if(mFence->GetCompletedValue() >= fenceValue)
+        return;
+
+    HANDLE eventHandle = CreateEventEx(nullptr, FALSE, FALSE, EVENT_ALL_ACCESS);
+    ThrowIfFailed(mFence->SetEventOnCompletion(fenceValue, eventHandle));
+    WaitForSingleObject(eventHandle, INFINITE);
+    CloseHandle(eventHandle);
+}
@@ -1,15 +1,12 @@
 #include "FrameResource.h"
 #include "d3dUtil.h"
 
-FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount,UINT materialCount)
+FrameResource::FrameResource(ID3D12Device* device, GraphicsDevice& graphics, UINT64 uploadRingByteSize, UINT commandListCount)
 {
-    ThrowIfFailed(device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-		IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+    for(UINT i = 0; i < commandListCount; ++i)
+        CmdLists.push_back(graphics.CreateCommandList());
 
-    PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
-    MaterialCB = std::make_unique<UploadBuffer<MaterialConstants>>(device, materialCount, true);
-    ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+    UploadRing = std::make_unique<FrameUploadRing>(device, uploadRingByteSize);
 }
 
 FrameResource::~FrameResource()
@@ -0,0 +1,461 @@
+#include "FrustumCuller.h"
+#include <cmath>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <immintrin.h>
+    #define FC_HAS_SSE 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        // MSVC 不需要 /arch:AVX 就能使用 AVX 内建函数
+        #define FC_AVX_TARGET
+    #else
+        #define FC_AVX_TARGET __attribute__((target("avx")))
+    #endif
+#else
+    #define FC_HAS_SSE 0
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // SIMD 路径从 Center 和 Center + 2 各读 16 字节，正好覆盖 Center、Extents 的 6 个 float
+    static_assert(sizeof(BoundingBox) == 6 * sizeof(float), "BoundingBox 必须是紧密的 Center + Extents");
+    static_assert(offsetof(BoundingBox, Extents) == 3 * sizeof(float), "BoundingBox 的 Extents 必须紧跟 Center");
+
+    inline const float* WorldAt(const CullSource& source, std::size_t i)
+    {
+        return reinterpret_cast<const float*>(reinterpret_cast<const char*>(source.World) + i * source.Stride);
+    }
+
+    inline const float* BoundsAt(const CullSource& source, std::size_t i)
+    {
+        return reinterpret_cast<const float*>(reinterpret_cast<const char*>(source.Bounds) + i * source.Stride);
+    }
+
+    // 参考实现。运算顺序与 SIMD 路径相同：
+    // 中心 = ((c.x * r0 + c.y * r1) + c.z * r2) + r3，半长 = (e.x * |r0| + e.y * |r1|) + e.z * |r2|，
+    // 每个平面 ((n.x * x + n.y * y) + n.z * z + w) + ((|n.x| * ex + |n.y| * ey) + |n.z| * ez) >= 0
+    inline void ArvoScalar(const float* m, const float* b, float* center, float* extent)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            center[k] = ((b[0] * m[k] + b[1] * m[4 + k]) + b[2] * m[8 + k]) + m[12 + k];
+            extent[k] = (b[3] * std::fabs(m[k]) + b[4] * std::fabs(m[4 + k])) + b[5] * std::fabs(m[8 + k]);
+        }
+    }
+
+    inline bool IsInsideScalar(const FrustumPlanes& frustum, float cx, float cy, float cz, float ex, float ey, float ez)
+    {
+        bool visible = true;
+        for(const XMFLOAT4& p : frustum.Planes)
+        {
+            float distance = ((p.x * cx + p.y * cy) + p.z * cz) + p.w;
+            float radius = (std::fabs(p.x) * ex + std::fabs(p.y) * ey) + std::fabs(p.z) * ez;
+            visible &= distance + radius >= 0.0f;
+        }
+        return visible;
+    }
+
+    bool IsVisibleScalar(const FrustumPlanes& frustum, const float* m, const float* b)
+    {
+        float center[3];
+        float extent[3];
+        ArvoScalar(m, b, center, extent);
+        return IsInsideScalar(frustum, center[0], center[1], center[2], extent[0], extent[1], extent[2]);
+    }
+
+    inline bool IsVisibleScalar(const FrustumPlanes& frustum, const CullBounds& bounds, std::size_t i)
+    {
+        return IsInsideScalar(frustum, bounds.CenterX[i], bounds.CenterY[i], bounds.CenterZ[i],
+            bounds.ExtentX[i], bounds.ExtentY[i], bounds.ExtentZ[i]);
+    }
+
+    inline CullBounds Offset(const CullBounds& bounds, std::size_t first)
+    {
+        CullBounds view = bounds;
+        view.CenterX += first;
+        view.CenterY += first;
+        view.CenterZ += first;
+        view.ExtentX += first;
+        view.ExtentY += first;
+        view.ExtentZ += first;
+        return view;
+    }
+
+    // 按掩码把可见下标紧凑地写进 visible[written...]，不分支：每个位置都写，只有可见的才前进
+    inline std::size_t Compact(unsigned mask, unsigned lanes, std::uint32_t first, std::uint32_t* visible, std::size_t written)
+    {
+        for(unsigned k = 0; k < lanes; ++k)
+        {
+            visible[written] = first + k;
+            written += (mask >> k) & 1u;
+        }
+        return written;
+    }
+
+#if FC_HAS_SSE
+    // 一个物体的 Arvo 变换，结果的前 3 个分量有效
+    inline void ArvoSse(const float* m, const float* b, __m128& center, __m128& extent)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 r0 = _mm_loadu_ps(m);
+        __m128 r1 = _mm_loadu_ps(m + 4);
+        __m128 r2 = _mm_loadu_ps(m + 8);
+        __m128 r3 = _mm_loadu_ps(m + 12);
+        __m128 b0 = _mm_loadu_ps(b);     // c.x c.y c.z e.x
+        __m128 b1 = _mm_loadu_ps(b + 2); // c.z e.x e.y e.z
+
+        center = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_shuffle_ps(b0, b0, _MM_SHUFFLE(0, 0, 0, 0)), r0),
+            _mm_mul_ps(_mm_shuffle_ps(b0, b0, _MM_SHUFFLE(1, 1, 1, 1)), r1)),
+            _mm_mul_ps(_mm_shuffle_ps(b0, b0, _MM_SHUFFLE(2, 2, 2, 2)), r2)), r3);
+        extent = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_shuffle_ps(b0, b0, _MM_SHUFFLE(3, 3, 3, 3)), _mm_andnot_ps(signMask, r0)),
+            _mm_mul_ps(_mm_shuffle_ps(b1, b1, _MM_SHUFFLE(2, 2, 2, 2)), _mm_andnot_ps(signMask, r1))),
+            _mm_mul_ps(_mm_shuffle_ps(b1, b1, _MM_SHUFFLE(3, 3, 3, 3)), _mm_andnot_ps(signMask, r2)));
+    }
+
+    // 4 个向量的前 3 个分量转置成 x、y、z 三个向量
+    inline void TransposeXyzSse(__m128 v0, __m128 v1, __m128 v2, __m128 v3, __m128& x, __m128& y, __m128& z)
+    {
+        __m128 t0 = _mm_unpacklo_ps(v0, v1);
+        __m128 t1 = _mm_unpacklo_ps(v2, v3);
+        __m128 t2 = _mm_unpackhi_ps(v0, v1);
+        __m128 t3 = _mm_unpackhi_ps(v2, v3);
+        x = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        y = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        z = _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    }
+
+    std::size_t CullSse(const FrustumPlanes& frustum, const CullSource& source, std::size_t count,
+        std::uint32_t firstIndex, std::uint32_t* visible)
+    {
+        std::size_t written = 0;
+        std::size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 centers[4];
+            __m128 extents[4];
+            for(std::size_t k = 0; k < 4; ++k)
+                ArvoSse(WorldAt(source, i + k), BoundsAt(source, i + k), centers[k], extents[k]);
+
+            __m128 x, y, z, ex, ey, ez;
+            TransposeXyzSse(centers[0], centers[1], centers[2], centers[3], x, y, z);
+            TransposeXyzSse(extents[0], extents[1], extents[2], extents[3], ex, ey, ez);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(const XMFLOAT4& p : frustum.Planes)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y)),
+                    _mm_mul_ps(_mm_set1_ps(p.z), z)), _mm_set1_ps(p.w));
+                __m128 radius = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(std::fabs(p.x)), ex), _mm_mul_ps(_mm_set1_ps(std::fabs(p.y)), ey)),
+                    _mm_mul_ps(_mm_set1_ps(std::fabs(p.z)), ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+            written = Compact((unsigned)_mm_movemask_ps(inside), 4, firstIndex + (std::uint32_t)i, visible, written);
+        }
+
+        for(; i < count; ++i)
+        {
+            visible[written] = firstIndex + (std::uint32_t)i;
+            written += IsVisibleScalar(frustum, WorldAt(source, i), BoundsAt(source, i)) ? 1 : 0;
+        }
+        return written;
+    }
+
+    // SoA 包围盒：一次读 4 个盒子的同一分量，不需要变换和转置
+    std::size_t CullSoaSse(const FrustumPlanes& frustum, const CullBounds& bounds, std::size_t count,
+        std::uint32_t firstIndex, std::uint32_t* visible)
+    {
+        std::size_t written = 0;
+        std::size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(bounds.CenterX + i);
+            __m128 y = _mm_loadu_ps(bounds.CenterY + i);
+            __m128 z = _mm_loadu_ps(bounds.CenterZ + i);
+            __m128 ex = _mm_loadu_ps(bounds.ExtentX + i);
+            __m128 ey = _mm_loadu_ps(bounds.ExtentY + i);
+            __m128 ez = _mm_loadu_ps(bounds.ExtentZ + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(const XMFLOAT4& p : frustum.Planes)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y)),
+                    _mm_mul_ps(_mm_set1_ps(p.z), z)), _mm_set1_ps(p.w));
+                __m128 radius = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(std::fabs(p.x)), ex), _mm_mul_ps(_mm_set1_ps(std::fabs(p.y)), ey)),
+                    _mm_mul_ps(_mm_set1_ps(std::fabs(p.z)), ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+            written = Compact((unsigned)_mm_movemask_ps(inside), 4, firstIndex + (std::uint32_t)i, visible, written);
+        }
+
+        for(; i < count; ++i)
+        {
+            visible[written] = firstIndex + (std::uint32_t)i;
+            written += IsVisibleScalar(frustum, bounds, i) ? 1 : 0;
+        }
+        return written;
+    }
+
+    FC_AVX_TARGET inline __m256 LoadPair(const float* a, const float* b)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a)), _mm_loadu_ps(b), 1);
+    }
+
+    // 两个物体一起做 Arvo 变换：a 在低 128 位，b 在高 128 位
+    FC_AVX_TARGET inline void ArvoPairAvx(const float* ma, const float* ba, const float* mb, const float* bb,
+        __m256& center, __m256& extent)
+    {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        __m256 r0 = LoadPair(ma, mb);
+        __m256 r1 = LoadPair(ma + 4, mb + 4);
+        __m256 r2 = LoadPair(ma + 8, mb + 8);
+        __m256 r3 = LoadPair(ma + 12, mb + 12);
+        __m256 b0 = LoadPair(ba, bb);
+        __m256 b1 = LoadPair(ba + 2, bb + 2);
+
+        center = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(_mm256_permute_ps(b0, _MM_SHUFFLE(0, 0, 0, 0)), r0),
+            _mm256_mul_ps(_mm256_permute_ps(b0, _MM_SHUFFLE(1, 1, 1, 1)), r1)),
+            _mm256_mul_ps(_mm256_permute_ps(b0, _MM_SHUFFLE(2, 2, 2, 2)), r2)), r3);
+        extent = _mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(_mm256_permute_ps(b0, _MM_SHUFFLE(3, 3, 3, 3)), _mm256_andnot_ps(signMask, r0)),
+            _mm256_mul_ps(_mm256_permute_ps(b1, _MM_SHUFFLE(2, 2, 2, 2)), _mm256_andnot_ps(signMask, r1))),
+            _mm256_mul_ps(_mm256_permute_ps(b1, _MM_SHUFFLE(3, 3, 3, 3)), _mm256_andnot_ps(signMask, r2)));
+    }
+
+    FC_AVX_TARGET inline void TransposeXyzAvx(__m256 v0, __m256 v1, __m256 v2, __m256 v3, __m256& x, __m256& y, __m256& z)
+    {
+        __m256 t0 = _mm256_unpacklo_ps(v0, v1);
+        __m256 t1 = _mm256_unpacklo_ps(v2, v3);
+        __m256 t2 = _mm256_unpackhi_ps(v0, v1);
+        __m256 t3 = _mm256_unpackhi_ps(v2, v3);
+        x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    }
+
+    FC_AVX_TARGET std::size_t CullAvx(const FrustumPlanes& frustum, const CullSource& source, std::size_t count,
+        std::uint32_t firstIndex, std::uint32_t* visible)
+    {
+        // 平面系数每轮都要用，先展开成广播好的向量
+        __m256 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+        for(int p = 0; p < 6; ++p)
+        {
+            const XMFLOAT4& plane = frustum.Planes[p];
+            px[p] = _mm256_set1_ps(plane.x);
+            py[p] = _mm256_set1_ps(plane.y);
+            pz[p] = _mm256_set1_ps(plane.z);
+            pw[p] = _mm256_set1_ps(plane.w);
+            ax[p] = _mm256_set1_ps(std::fabs(plane.x));
+            ay[p] = _mm256_set1_ps(std::fabs(plane.y));
+            az[p] = _mm256_set1_ps(std::fabs(plane.z));
+        }
+
+        std::size_t written = 0;
+        std::size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            // 第 k 对是物体 i + k 和 i + k + 4，通道内转置后低 128 位是物体 i..i+3，高 128 位是 i+4..i+7
+            __m256 centers[4];
+            __m256 extents[4];
+            for(std::size_t k = 0; k < 4; ++k)
+            {
+                ArvoPairAvx(WorldAt(source, i + k), BoundsAt(source, i + k),
+                    WorldAt(source, i + k + 4), BoundsAt(source, i + k + 4), centers[k], extents[k]);
+            }
+
+            __m256 x, y, z, ex, ey, ez;
+            TransposeXyzAvx(centers[0], centers[1], centers[2], centers[3], x, y, z);
+            TransposeXyzAvx(extents[0], extents[1], extents[2], extents[3], ex, ey, ez);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for(int p = 0; p < 6; ++p)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                    _mm256_mul_ps(px[p], x), _mm256_mul_ps(py[p], y)), _mm256_mul_ps(pz[p], z)), pw[p]);
+                __m256 radius = _mm256_add_ps(_mm256_add_ps(
+                    _mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            written = Compact((unsigned)_mm256_movemask_ps(inside), 8, firstIndex + (std::uint32_t)i, visible, written);
+        }
+
+        // 不足 8 个的尾部交给 SSE 路径
+        CullSource tail = source;
+        tail.World = reinterpret_cast<const XMFLOAT4X4*>(WorldAt(source, i));
+        tail.Bounds = reinterpret_cast<const BoundingBox*>(BoundsAt(source, i));
+        return written + CullSse(frustum, tail, count - i, firstIndex + (std::uint32_t)i, visible + written);
+    }
+
+    FC_AVX_TARGET std::size_t CullSoaAvx(const FrustumPlanes& frustum, const CullBounds& bounds, std::size_t count,
+        std::uint32_t firstIndex, std::uint32_t* visible)
+    {
+        __m256 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+        for(int p = 0; p < 6; ++p)
+        {
+            const XMFLOAT4& plane = frustum.Planes[p];
+            px[p] = _mm256_set1_ps(plane.x);
+            py[p] = _mm256_set1_ps(plane.y);
+            pz[p] = _mm256_set1_ps(plane.z);
+            pw[p] = _mm256_set1_ps(plane.w);
+            ax[p] = _mm256_set1_ps(std::fabs(plane.x));
+            ay[p] = _mm256_set1_ps(std::fabs(plane.y));
+            az[p] = _mm256_set1_ps(std::fabs(plane.z));
+        }
+
+        std::size_t written = 0;
+        std::size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(bounds.CenterX + i);
+            __m256 y = _mm256_loadu_ps(bounds.CenterY + i);
+            __m256 z = _mm256_loadu_ps(bounds.CenterZ + i);
+            __m256 ex = _mm256_loadu_ps(bounds.ExtentX + i);
+            __m256 ey = _mm256_loadu_ps(bounds.ExtentY + i);
+            __m256 ez = _mm256_loadu_ps(bounds.ExtentZ + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for(int p = 0; p < 6; ++p)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                    _mm256_mul_ps(px[p], x), _mm256_mul_ps(py[p], y)), _mm256_mul_ps(pz[p], z)), pw[p]);
+                __m256 radius = _mm256_add_ps(_mm256_add_ps(
+                    _mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            written = Compact((unsigned)_mm256_movemask_ps(inside), 8, firstIndex + (std::uint32_t)i, visible, written);
+        }
+
+        return written + CullSoaSse(frustum, Offset(bounds, i), count - i, firstIndex + (std::uint32_t)i, visible + written);
+    }
+#endif
+}
+
+FrustumPlanes ExtractFrustumPlanes(const XMFLOAT4X4& viewProj)
+{
+    // 裁剪坐标 (x, y, z, w) = v * viewProj，第 j 个分量是 v 与第 j 列的点积；
+    // 可见区域是 -w <= x <= w、-w <= y <= w、0 <= z <= w
+    auto column = [&viewProj](int j){
+        return XMVectorSet(viewProj.m[0][j], viewProj.m[1][j], viewProj.m[2][j], viewProj.m[3][j]);
+    };
+    XMVECTOR c0 = column(0);
+    XMVECTOR c1 = column(1);
+    XMVECTOR c2 = column(2);
+    XMVECTOR c3 = column(3);
+
+    XMVECTOR planes[6] =
+    {
+        XMVectorAdd(c3, c0),      // 左
+        XMVectorSubtract(c3, c0), // 右
+        XMVectorAdd(c3, c1),      // 下
+        XMVectorSubtract(c3, c1), // 上
+        c2,                       // 近
+        XMVectorSubtract(c3, c2)  // 远
+    };
+
+    FrustumPlanes frustum;
+    for(int p = 0; p < 6; ++p)
+        XMStoreFloat4(&frustum.Planes[p], XMPlaneNormalize(planes[p]));
+    return frustum;
+}
+
+std::size_t CullBoxes(const FrustumPlanes& frustum, const CullSource& source, std::size_t count,
+    std::uint32_t firstIndex, std::uint32_t* visible, SimdPath path)
+{
+#if FC_HAS_SSE
+    if(path == SimdPath::Avx)
+        return CullAvx(frustum, source, count, firstIndex, visible);
+    if(path == SimdPath::Sse)
+        return CullSse(frustum, source, count, firstIndex, visible);
+#else
+    (void)path;
+#endif
+
+    std::size_t written = 0;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        visible[written] = firstIndex + (std::uint32_t)i;
+        written += IsVisibleScalar(frustum, WorldAt(source, i), BoundsAt(source, i)) ? 1 : 0;
+    }
+    return written;
+}
+
+std::size_t CullBoxes(const FrustumPlanes& frustum, const CullBounds& bounds, std::size_t count,
+    std::uint32_t firstIndex, std::uint32_t* visible, SimdPath path)
+{
+#if FC_HAS_SSE
+    if(path == SimdPath::Avx)
+        return CullSoaAvx(frustum, bounds, count, firstIndex, visible);
+    if(path == SimdPath::Sse)
+        return CullSoaSse(frustum, bounds, count, firstIndex, visible);
+#else
+    (void)path;
+#endif
+
+    std::size_t written = 0;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        visible[written] = firstIndex + (std::uint32_t)i;
+        written += IsVisibleScalar(frustum, bounds, i) ? 1 : 0;
+    }
+    return written;
+}
+
+void WorldBoundsArray::Clear()
+{
+    for(std::vector<float>& component : mComponents)
+        component.clear();
+}
+
+void WorldBoundsArray::PushBack(const XMFLOAT4X4& world, const BoundingBox& local)
+{
+    for(std::vector<float>& component : mComponents)
+        component.push_back(0.0f);
+    Set(Size() - 1, world, local);
+}
+
+void WorldBoundsArray::Set(std::size_t i, const XMFLOAT4X4& world, const BoundingBox& local)
+{
+    float center[3];
+    float extent[3];
+    ArvoScalar(&world.m[0][0], &local.Center.x, center, extent);
+    for(int k = 0; k < 3; ++k)
+    {
+        mComponents[k][i] = center[k];
+        mComponents[3 + k][i] = extent[k];
+    }
+}
+
+void WorldBoundsArray::RemoveSwapBack(std::size_t i)
+{
+    for(std::vector<float>& component : mComponents)
+    {
+        component[i] = component.back();
+        component.pop_back();
+    }
+}
+
+BoundingBox WorldBoundsArray::At(std::size_t i)const
+{
+    return BoundingBox(XMFLOAT3(mComponents[0][i], mComponents[1][i], mComponents[2][i]),
+        XMFLOAT3(mComponents[3][i], mComponents[4][i], mComponents[5][i]));
+}
+
+CullBounds WorldBoundsArray::View(std::size_t first)const
+{
+    CullBounds view;
+    view.CenterX = mComponents[0].data();
+    view.CenterY = mComponents[1].data();
+    view.CenterZ = mComponents[2].data();
+    view.ExtentX = mComponents[3].data();
+    view.ExtentY = mComponents[4].data();
+    view.ExtentZ = mComponents[5].data();
+    return Offset(view, first);
+}
@@ -0,0 +1,68 @@
+#include "GpuMemoryAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+GpuMemoryAllocator::GpuMemoryAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags, UINT64 heapSize) :
+    mDevice(device),
+    mHeapType(heapType),
+    mHeapFlags(heapFlags),
+    mPool(heapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+{
+}
+
+ComPtr<ID3D12Resource> GpuMemoryAllocator::CreatePlacedResource(
+    const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* optimizedClearValue,
+    PoolAllocation& allocation)
+{
+    // 由驱动给出资源实际需要的大小和对齐（缓冲区一般为 64KB）
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+    allocation = mPool.Allocate(info.SizeInBytes, info.Alignment);
+    if(!allocation.IsValid())
+        ThrowIfFailed(E_OUTOFMEMORY);
+
+    CreateMissingHeaps();
+
+    ComPtr<ID3D12Resource> resource;
+    HRESULT hr = mDevice->CreatePlacedResource(
+        mHeaps[allocation.HeapIndex].Get(),
+        allocation.Offset,
+        &desc,
+        initialState,
+        optimizedClearValue,
+        IID_PPV_ARGS(resource.GetAddressOf()));
+    if(FAILED(hr))
+    {
+        mPool.Free(allocation);
+        allocation = PoolAllocation();
+        ThrowIfFailed(hr);
+    }
+
+    return resource;
+}
+
+void GpuMemoryAllocator::Free(const PoolAllocation& allocation)
+{
+    mPool.Free(allocation);
+}
+
+void GpuMemoryAllocator::CreateMissingHeaps()
+{
+    // 池每追加一个堆，这里就创建对应的 ID3D12Heap
+    while(mHeaps.size() < mPool.HeapCount())
+    {
+        UINT heapIndex = (UINT)mHeaps.size();
+
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = mPool.HeapCapacity(heapIndex);
+        heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(mHeapType);
+        heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = mHeapFlags;
+
+        ComPtr<ID3D12Heap> heap;
+        ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(heap.GetAddressOf())));
+        mHeaps.push_back(heap);
+    }
+}
@@ -0,0 +1,275 @@
+#include "HeapPool.h"
+#include <algorithm>
+
+BuddyAllocator::BuddyAllocator(std::uint64_t capacity, std::uint64_t minBlockSize) :
+    mMinBlockSize(minBlockSize)
+{
+    while((mMinBlockSize << mMaxOrder) < capacity)
+        mMaxOrder++;
+
+    mFreeBlocks.resize(mMaxOrder + 1);
+    mFreeBlocks[mMaxOrder].insert(0);
+}
+
+std::uint32_t BuddyAllocator::OrderForSize(std::uint64_t byteSize) const
+{
+    std::uint32_t order = 0;
+    while((mMinBlockSize << order) < byteSize)
+        order++;
+    return order;
+}
+
+std::uint64_t BuddyAllocator::Allocate(std::uint64_t byteSize, std::uint64_t alignment)
+{
+    if(byteSize == 0)
+        byteSize = 1;
+
+    // 伙伴块的偏移总是块大小的整数倍，所以对齐只需要把块放大到 alignment
+    std::uint32_t order = OrderForSize(std::max(byteSize, alignment));
+    if(order > mMaxOrder)
+        return InvalidOffset;
+
+    std::uint32_t k = order;
+    while(k <= mMaxOrder && mFreeBlocks[k].empty())
+        k++;
+    if(k > mMaxOrder)
+        return InvalidOffset;
+
+    // 取地址最低的空闲块，让分配尽量挤在堆的前部
+    std::uint64_t offset = *mFreeBlocks[k].begin();
+    mFreeBlocks[k].erase(mFreeBlocks[k].begin());
+
+    // 逐级拆分，把上半块放回低一阶的空闲表
+    while(k > order)
+    {
+        k--;
+        mFreeBlocks[k].insert(offset + (mMinBlockSize << k));
+    }
+
+    AllocationInfo info;
+    info.Order = order;
+    info.Size = byteSize;
+    mAllocations[offset] = info;
+
+    mAllocatedBytes += mMinBlockSize << order;
+    mRequestedBytes += byteSize;
+
+    return offset;
+}
+
+void BuddyAllocator::Free(std::uint64_t offset)
+{
+    auto it = mAllocations.find(offset);
+    if(it == mAllocations.end())
+        return;
+
+    std::uint32_t k = it->second.Order;
+    mAllocatedBytes -= mMinBlockSize << k;
+    mRequestedBytes -= it->second.Size;
+    mAllocations.erase(it);
+
+    // 伙伴也空闲就合并，一直向上
+    while(k < mMaxOrder)
+    {
+        std::uint64_t buddy = offset ^ (mMinBlockSize << k);
+        auto buddyIt = mFreeBlocks[k].find(buddy);
+        if(buddyIt == mFreeBlocks[k].end())
+            break;
+
+        mFreeBlocks[k].erase(buddyIt);
+        offset = std::min(offset, buddy);
+        k++;
+    }
+
+    mFreeBlocks[k].insert(offset);
+}
+
+std::uint64_t BuddyAllocator::LargestFreeBlock() const
+{
+    for(std::uint32_t k = mMaxOrder + 1; k-- > 0;)
+    {
+        if(!mFreeBlocks[k].empty())
+            return mMinBlockSize << k;
+    }
+    return 0;
+}
+
+std::uint32_t BuddyAllocator::FreeBlockCount() const
+{
+    std::uint32_t count = 0;
+    for(const auto& freeList : mFreeBlocks)
+        count += (std::uint32_t)freeList.size();
+    return count;
+}
+
+std::vector<BuddyAllocator::Block> BuddyAllocator::Allocations() const
+{
+    std::vector<Block> blocks;
+    blocks.reserve(mAllocations.size());
+    for(const auto& e : mAllocations)
+    {
+        Block b;
+        b.Offset = e.first;
+        b.Size = e.second.Size;
+        b.BlockSize = mMinBlockSize << e.second.Order;
+        blocks.push_back(b);
+    }
+    return blocks;
+}
+
+HeapPool::HeapPool(std::uint64_t heapSize, std::uint64_t minBlockSize) :
+    mHeapSize(heapSize),
+    mMinBlockSize(minBlockSize)
+{
+}
+
+PoolAllocation HeapPool::Allocate(std::uint64_t byteSize, std::uint64_t alignment)
+{
+    for(std::uint32_t i = 0; i < (std::uint32_t)mHeaps.size(); ++i)
+    {
+        PoolAllocation alloc = AllocateInHeap(i, byteSize, alignment);
+        if(alloc.IsValid())
+            return alloc;
+    }
+
+    mHeaps.emplace_back(std::max(mHeapSize, std::max(byteSize, alignment)), mMinBlockSize);
+    return AllocateInHeap((std::uint32_t)mHeaps.size() - 1, byteSize, alignment);
+}
+
+PoolAllocation HeapPool::AllocateInHeap(std::uint32_t heapIndex, std::uint64_t byteSize, std::uint64_t alignment)
+{
+    PoolAllocation alloc;
+    if(heapIndex >= mHeaps.size())
+        return alloc;
+
+    std::uint64_t offset = mHeaps[heapIndex].Allocate(byteSize, alignment);
+    if(offset == BuddyAllocator::InvalidOffset)
+        return alloc;
+
+    alloc.HeapIndex = heapIndex;
+    alloc.Offset = offset;
+    alloc.Size = byteSize;
+    return alloc;
+}
+
+void HeapPool::Free(const PoolAllocation& allocation)
+{
+    if(!allocation.IsValid() || allocation.HeapIndex >= mHeaps.size())
+        return;
+
+    mHeaps[allocation.HeapIndex].Free(allocation.Offset);
+}
+
+std::vector<HeapStats> HeapPool::GetHeapStats() const
+{
+    std::vector<HeapStats> stats;
+    stats.reserve(mHeaps.size());
+    for(std::uint32_t i = 0; i < (std::uint32_t)mHeaps.size(); ++i)
+    {
+        const BuddyAllocator& heap = mHeaps[i];
+
+        HeapStats s;
+        s.HeapIndex = i;
+        s.Capacity = heap.Capacity();
+        s.AllocatedBytes = heap.AllocatedBytes();
+        s.RequestedBytes = heap.RequestedBytes();
+        s.LargestFreeBlock = heap.LargestFreeBlock();
+        s.AllocationCount = heap.AllocationCount();
+        s.FreeBlockCount = heap.FreeBlockCount();
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+DefragPlan HeapPool::PlanDefragmentation(std::uint64_t maxBytesToMove) const
+{
+    DefragPlan plan;
+
+    // 在副本上模拟，不改动真实状态
+    std::vector<BuddyAllocator> sim = mHeaps;
+    std::vector<bool> isSource(sim.size(), false);
+
+    std::vector<std::uint32_t> candidates;
+    for(std::uint32_t i = 0; i < (std::uint32_t)sim.size(); ++i)
+    {
+        if(!sim[i].Empty())
+            candidates.push_back(i);
+    }
+    std::sort(candidates.begin(), candidates.end(), [&](std::uint32_t a, std::uint32_t b)
+    {
+        return sim[a].AllocatedBytes() < sim[b].AllocatedBytes();
+    });
+
+    for(std::uint32_t source : candidates)
+    {
+        std::vector<BuddyAllocator::Block> blocks = sim[source].Allocations();
+        std::uint64_t heapBytes = 0;
+        for(const auto& b : blocks)
+            heapBytes += b.Size;
+        if(maxBytesToMove != 0 && plan.BytesMoved + heapBytes > maxBytesToMove)
+            continue;
+
+        // 大块先放，减少失败的可能
+        std::sort(blocks.begin(), blocks.end(), [](const BuddyAllocator::Block& a, const BuddyAllocator::Block& b)
+        {
+            return a.BlockSize > b.BlockSize;
+        });
+
+        // 目标堆优先选最满的，让空闲空间集中到少数堆里。
+        // 空堆不作目标：搬进空堆只是把占用换到另一个堆，腾不出空间
+        std::vector<std::uint32_t> targets;
+        for(std::uint32_t i = 0; i < (std::uint32_t)sim.size(); ++i)
+        {
+            if(i != source && !isSource[i] && !sim[i].Empty())
+                targets.push_back(i);
+        }
+        std::sort(targets.begin(), targets.end(), [&](std::uint32_t a, std::uint32_t b)
+        {
+            return sim[a].AllocatedBytes() > sim[b].AllocatedBytes();
+        });
+
+        std::vector<BuddyAllocator> trial = sim;
+        std::vector<DefragMove> moves;
+        bool fits = true;
+        for(const auto& b : blocks)
+        {
+            bool placed = false;
+            for(std::uint32_t t : targets)
+            {
+                std::uint64_t offset = trial[t].Allocate(b.Size, b.BlockSize);
+                if(offset != BuddyAllocator::InvalidOffset)
+                {
+                    DefragMove move;
+                    move.Source.HeapIndex = source;
+                    move.Source.Offset = b.Offset;
+                    move.Source.Size = b.Size;
+                    move.DestHeap = t;
+                    move.DestOffset = offset;
+                    move.BlockSize = b.BlockSize;
+                    moves.push_back(move);
+                    placed = true;
+                    break;
+                }
+            }
+            if(!placed)
+            {
+                fits = false;
+                break;
+            }
+        }
+
+        if(!fits)
+            continue;
+
+        for(const auto& b : blocks)
+            trial[source].Free(b.Offset);
+
+        sim = std::move(trial);
+        isSource[source] = true;
+        plan.Moves.insert(plan.Moves.end(), moves.begin(), moves.end());
+        plan.FreedHeaps.push_back(source);
+        plan.BytesMoved += heapBytes;
+    }
+
+    return plan;
+}
@@ -0,0 +1,61 @@
+#include "IndirectDraw.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "WriteCombined.h"
+
+void BuildIndirectDrawCommands(const InstanceGroup* groups, std::size_t count, IndirectDrawCommand* dst)
+{
+    assert((reinterpret_cast<std::uintptr_t>(dst) & 15) == 0);
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        const InstanceGroup& group = groups[i];
+
+#if WC_HAS_STREAMING_STORES
+        // 前 16 字节：基准下标、材质下标、索引数、实例数；后 16 字节：起始索引、基准顶点、起始实例、填充
+        __m128i lo = _mm_set_epi32((int)group.InstanceCount, (int)group.Key.IndexCount,
+            (int)group.Key.Material, (int)group.FirstInstance);
+        __m128i hi = _mm_set_epi32(0, 0, group.Key.BaseVertexLocation, (int)group.Key.StartIndexLocation);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i) + 1, hi);
+#else
+        IndirectDrawCommand command;
+        command.BaseInstance = group.FirstInstance;
+        command.MaterialIndex = group.Key.Material;
+        command.IndexCountPerInstance = group.Key.IndexCount;
+        command.InstanceCount = group.InstanceCount;
+        command.StartIndexLocation = group.Key.StartIndexLocation;
+        command.BaseVertexLocation = group.Key.BaseVertexLocation;
+        command.StartInstanceLocation = 0;
+        std::memcpy(dst + i, &command, sizeof(command));
+#endif
+    }
+}
+
+void BuildIndirectRuns(const InstanceGroup* groups, std::size_t count, std::vector<IndirectRun>& runs)
+{
+    runs.clear();
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        if(i == 0 || groups[i].Key.Geometry != groups[i - 1].Key.Geometry ||
+            groups[i].Key.PrimitiveTopology != groups[i - 1].Key.PrimitiveTopology)
+        {
+            IndirectRun run;
+            run.First = i;
+            runs.push_back(run);
+        }
+        runs.back().Last = i + 1;
+    }
+}
+
+std::size_t IndirectCommandCapacity(std::size_t previousGroups, std::size_t currentCapacity,
+    std::size_t maxGroups, std::size_t minHeadroom)
+{
+    std::size_t headroom = std::max(minHeadroom, previousGroups / 8);
+    std::size_t target = std::min(previousGroups + headroom, maxGroups);
+    // 预留不足（包括还没预留过）时增长，远多于需要或超过渲染项数时收缩
+    bool tooSmall = previousGroups > currentCapacity || currentCapacity < std::min(minHeadroom, maxGroups);
+    bool tooLarge = target * 2 < currentCapacity || currentCapacity > maxGroups;
+    return tooSmall || tooLarge ? target : currentCapacity;
+}
@@ -0,0 +1,66 @@
+#include "InstanceBatcher.h"
+
+std::size_t InstanceBatcher::KeyHash::operator()(const InstanceKey& key)const
+{
+    // 64 位乘法混合，各字段依次并入
+    std::uint64_t h = key.Geometry * 0x9E3779B97F4A7C15ull;
+    auto mix = [&h](std::uint64_t value)
+    {
+        h ^= value + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    };
+    mix(key.Material);
+    mix(key.IndexCount);
+    mix(key.StartIndexLocation);
+    mix((std::uint32_t)key.BaseVertexLocation);
+    mix(key.PrimitiveTopology);
+    return (std::size_t)h;
+}
+
+void InstanceBatcher::Build(const InstanceKey* keys, std::size_t count)
+{
+    mGroupIndex.clear();
+    mGroups.clear();
+    mItemGroup.resize(count);
+    mInstanceOrder.resize(count);
+
+    // 1. 给每个输入找到组并计数。排好序的输入里相同的键通常相邻，先和上一个比较，省掉查表
+    std::uint32_t previousGroup = 0;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        std::uint32_t group;
+        if(i > 0 && keys[i] == keys[i - 1])
+        {
+            group = previousGroup;
+        }
+        else
+        {
+            auto inserted = mGroupIndex.emplace(keys[i], (std::uint32_t)mGroups.size());
+            group = inserted.first->second;
+            if(inserted.second)
+            {
+                InstanceGroup newGroup;
+                newGroup.Key = keys[i];
+                mGroups.push_back(newGroup);
+            }
+        }
+
+        mGroups[group].InstanceCount++;
+        mItemGroup[i] = group;
+        previousGroup = group;
+    }
+
+    // 2. 前缀和得到每组在实例缓冲区中的起始位置
+    std::uint32_t firstInstance = 0;
+    for(auto& group : mGroups)
+    {
+        group.FirstInstance = firstInstance;
+        firstInstance += group.InstanceCount;
+    }
+
+    // 3. 按输入顺序分散写入，组内顺序保持不变
+    mCursor.resize(mGroups.size());
+    for(std::size_t g = 0; g < mGroups.size(); ++g)
+        mCursor[g] = mGroups[g].FirstInstance;
+    for(std::size_t i = 0; i < count; ++i)
+        mInstanceOrder[mCursor[mItemGroup[i]]++] = (std::uint32_t)i;
+}
@@ -0,0 +1,314 @@
+#include "JobSystem.h"
+
+namespace
+{
+    thread_local JobSystem* tCurrentSystem = nullptr;
+    thread_local int tThreadIndex = -1;
+
+    // 空闲时先自旋这么多轮再睡眠，作业密集时避免频繁唤醒
+    constexpr int SpinCountBeforeSleep = 64;
+
+    std::size_t RoundUpPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while(result < value)
+            result <<= 1;
+        return result;
+    }
+}
+
+WorkStealingDeque::WorkStealingDeque(std::size_t capacity) :
+    mMask(RoundUpPowerOfTwo(capacity) - 1)
+{
+    mBuffer = std::make_unique<std::atomic<Job*>[]>(mMask + 1);
+    for(std::size_t i = 0; i <= mMask; ++i)
+        mBuffer[i].store(nullptr, std::memory_order_relaxed);
+}
+
+bool WorkStealingDeque::Push(Job* job)
+{
+    std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+    std::int64_t top = mTop.load(std::memory_order_acquire);
+    if(bottom - top > (std::int64_t)mMask)
+        return false;
+
+    mBuffer[(std::size_t)bottom & mMask].store(job, std::memory_order_relaxed);
+    // release：窃取者 acquire 读到新的 bottom 后一定能看到作业内容
+    mBottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+Job* WorkStealingDeque::Pop()
+{
+    std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = mTop.load(std::memory_order_relaxed);
+
+    if(top > bottom)
+    {
+        // 队列为空
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = mBuffer[(std::size_t)bottom & mMask].load(std::memory_order_relaxed);
+    if(top == bottom)
+    {
+        // 最后一个元素，和窃取者竞争
+        if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkStealingDeque::Steal()
+{
+    std::int64_t top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+    if(top >= bottom)
+        return nullptr;
+
+    Job* job = mBuffer[(std::size_t)top & mMask].load(std::memory_order_relaxed);
+    if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+unsigned JobSystem::DefaultWorkerCount()
+{
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem::JobSystem(unsigned workerThreadCount)
+{
+    for(unsigned i = 0; i <= workerThreadCount; ++i)
+        mQueues.push_back(std::make_unique<WorkStealingDeque>());
+
+    tCurrentSystem = this;
+    tThreadIndex = 0;
+
+    for(unsigned i = 1; i <= workerThreadCount; ++i)
+        mThreads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop.store(true);
+    }
+    mSleepCondition.notify_all();
+    for(auto& thread : mThreads)
+        thread.join();
+
+    // 没人等待的作业直接丢弃
+    for(auto& queue : mQueues)
+    {
+        while(Job* job = queue->Steal())
+            delete job;
+    }
+    for(Job* job : mInjection)
+        delete job;
+
+    if(tCurrentSystem == this)
+    {
+        tCurrentSystem = nullptr;
+        tThreadIndex = -1;
+    }
+}
+
+int JobSystem::CurrentThreadIndex() const
+{
+    return tCurrentSystem == this ? tThreadIndex : -1;
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter)
+{
+    if(counter != nullptr)
+        counter->mValue.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job;
+    job->Function = std::move(function);
+    job->Counter = counter;
+    Submit(job);
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter)
+{
+    if(counter != nullptr)
+        counter->mValue.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job;
+    job->Function = std::move(function);
+    job->Counter = counter;
+
+    {
+        std::lock_guard<std::mutex> lock(dependency.mMutex);
+        if(dependency.mValue.load(std::memory_order_acquire) != 0)
+        {
+            dependency.mContinuations.push_back(job);
+            return;
+        }
+    }
+    Submit(job);
+}
+
+void JobSystem::Submit(Job* job)
+{
+    mQueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+    int index = CurrentThreadIndex();
+    if(index < 0 || !mQueues[(size_t)index]->Push(job))
+    {
+        std::lock_guard<std::mutex> lock(mInjectionMutex);
+        mInjection.push_back(job);
+        mInjectionCount.fetch_add(1, std::memory_order_release);
+    }
+
+    // 与 WorkerLoop 中先登记 mSleepers 再检查 mQueuedJobs 的顺序配对，不会丢失唤醒
+    if(mSleepers.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mSleepCondition.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob(int index)
+{
+    Job* job = nullptr;
+    if(index >= 0)
+        job = mQueues[(size_t)index]->Pop();
+
+    if(job == nullptr && mInjectionCount.load(std::memory_order_acquire) > 0)
+    {
+        std::lock_guard<std::mutex> lock(mInjectionMutex);
+        if(!mInjection.empty())
+        {
+            job = mInjection.back();
+            mInjection.pop_back();
+            mInjectionCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    if(job == nullptr)
+    {
+        // 从自己的下一个线程开始轮流窃取，分散竞争
+        std::size_t count = mQueues.size();
+        std::size_t start = index >= 0 ? (size_t)index + 1 : 0;
+        for(std::size_t i = 0; i < count && job == nullptr; ++i)
+        {
+            std::size_t victim = (start + i) % count;
+            if((int)victim != index)
+                job = mQueues[victim]->Steal();
+        }
+    }
+
+    if(job != nullptr)
+        mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+bool JobSystem::TryRunOne()
+{
+    Job* job = FindJob(CurrentThreadIndex());
+    if(job == nullptr)
+        return false;
+
+    Execute(job);
+    return true;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    std::exception_ptr exception;
+    try
+    {
+        job->Function();
+    }
+    catch(...)
+    {
+        exception = std::current_exception();
+    }
+
+    JobCounter* counter = job->Counter;
+    delete job;
+    if(counter != nullptr)
+        Finish(counter, exception);
+}
+
+void JobSystem::Finish(JobCounter* counter, std::exception_ptr exception)
+{
+    std::vector<Job*> ready;
+    {
+        // 归零和取走后续作业在同一把锁内完成，Wait 拿到这把锁之后计数器就可以安全销毁
+        std::lock_guard<std::mutex> lock(counter->mMutex);
+        if(exception && !counter->mException)
+            counter->mException = exception;
+        if(counter->mValue.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(counter->mContinuations);
+    }
+
+    for(Job* job : ready)
+        Submit(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    int spins = 0;
+    while(!counter.IsDone())
+    {
+        if(TryRunOne())
+        {
+            spins = 0;
+            continue;
+        }
+
+        if(++spins > SpinCountBeforeSleep)
+            std::this_thread::yield();
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(counter.mMutex);
+        exception = counter.mException;
+        counter.mException = nullptr;
+    }
+    if(exception)
+        std::rethrow_exception(exception);
+}
+
+void JobSystem::WorkerLoop(unsigned index)
+{
+    tCurrentSystem = this;
+    tThreadIndex = (int)index;
+
+    int spins = 0;
+    while(!mStop.load(std::memory_order_acquire))
+    {
+        if(TryRunOne())
+        {
+            spins = 0;
+            continue;
+        }
+
+        if(++spins < SpinCountBeforeSleep)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleepers.fetch_add(1, std::memory_order_seq_cst);
+        mSleepCondition.wait(lock, [this]()
+        {
+            return mStop.load(std::memory_order_acquire) || mQueuedJobs.load(std::memory_order_seq_cst) > 0;
+        });
+        mSleepers.fetch_sub(1, std::memory_order_seq_cst);
+        spins = 0;
+    }
+}
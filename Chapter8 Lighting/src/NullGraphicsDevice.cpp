@@ -0,0 +1,226 @@
+#include "NullGraphicsDevice.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+void NullCommandList::Begin(PipelineHandle initialPipeline)
+{
+    mStream.Clear();
+    mRecording = true;
+    if(initialPipeline != 0)
+        mStream.Write(CommandOp::SetPipelineState, initialPipeline);
+}
+
+void NullCommandList::End()
+{
+    mRecording = false;
+}
+
+void NullCommandList::TransitionBarrier(ResourceHandle resource, std::uint32_t stateBefore, std::uint32_t stateAfter)
+{
+    mStream.Write(CommandOp::TransitionBarrier, TransitionBarrierArgs{ resource, stateBefore, stateAfter });
+}
+
+void NullCommandList::ClearRenderTarget(DescriptorHandle rtv, const float color[4])
+{
+    ClearRenderTargetArgs args;
+    args.Rtv = rtv;
+    std::copy(color, color + 4, args.Color);
+    mStream.Write(CommandOp::ClearRenderTarget, args);
+}
+
+void NullCommandList::ClearDepthStencil(DescriptorHandle dsv, float depth, std::uint8_t stencil)
+{
+    mStream.Write(CommandOp::ClearDepthStencil, ClearDepthStencilArgs{ dsv, depth, stencil });
+}
+
+void NullCommandList::SetViewport(const ViewportDesc& viewport)
+{
+    mStream.Write(CommandOp::SetViewport, viewport);
+}
+
+void NullCommandList::SetScissorRect(const ScissorRect& rect)
+{
+    mStream.Write(CommandOp::SetScissorRect, rect);
+}
+
+void NullCommandList::SetRenderTarget(DescriptorHandle rtv, DescriptorHandle dsv)
+{
+    mStream.Write(CommandOp::SetRenderTarget, SetRenderTargetArgs{ rtv, dsv });
+}
+
+void NullCommandList::SetGraphicsRootSignature(RootSignatureHandle rootSignature)
+{
+    mStream.Write(CommandOp::SetGraphicsRootSignature, rootSignature);
+}
+
+void NullCommandList::SetPipelineState(PipelineHandle pipeline)
+{
+    mStream.Write(CommandOp::SetPipelineState, pipeline);
+}
+
+void NullCommandList::SetGraphicsRootConstantBufferView(std::uint32_t rootParameterIndex, GpuAddress address)
+{
+    mStream.Write(CommandOp::SetGraphicsRootConstantBufferView, SetRootConstantBufferViewArgs{ rootParameterIndex, address });
+}
+
+void NullCommandList::SetGraphicsRootShaderResourceView(std::uint32_t rootParameterIndex, GpuAddress address)
+{
+    mStream.Write(CommandOp::SetGraphicsRootShaderResourceView, SetRootShaderResourceViewArgs{ rootParameterIndex, address });
+}
+
+void NullCommandList::SetGraphicsRoot32BitConstant(std::uint32_t rootParameterIndex, std::uint32_t value, std::uint32_t destOffset)
+{
+    mStream.Write(CommandOp::SetGraphicsRoot32BitConstant, SetRoot32BitConstantArgs{ rootParameterIndex, value, destOffset });
+}
+
+void NullCommandList::SetVertexBuffer(const VertexBufferBinding& view)
+{
+    mStream.Write(CommandOp::SetVertexBuffer, view);
+}
+
+void NullCommandList::SetIndexBuffer(const IndexBufferBinding& view)
+{
+    mStream.Write(CommandOp::SetIndexBuffer, view);
+}
+
+void NullCommandList::SetPrimitiveTopology(std::uint32_t topology)
+{
+    mStream.Write(CommandOp::SetPrimitiveTopology, topology);
+}
+
+void NullCommandList::DrawIndexedInstanced(std::uint32_t indexCountPerInstance, std::uint32_t instanceCount,
+    std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t startInstanceLocation)
+{
+    mStream.Write(CommandOp::DrawIndexedInstanced, DrawIndexedInstancedArgs{
+        indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation });
+}
+
+void NullCommandList::ExecuteIndirect(CommandSignatureHandle signature, std::uint32_t maxCommandCount,
+    ResourceHandle argumentBuffer, std::uint64_t argumentOffset)
+{
+    mStream.Write(CommandOp::ExecuteIndirect, ExecuteIndirectArgs{ signature, maxCommandCount, argumentBuffer, argumentOffset });
+}
+
+void NullCommandList::CopyBufferRegion(ResourceHandle dst, std::uint64_t dstOffset,
+    ResourceHandle src, std::uint64_t srcOffset, std::uint64_t numBytes)
+{
+    mStream.Write(CommandOp::CopyBufferRegion, CopyBufferRegionArgs{ dst, dstOffset, src, srcOffset, numBytes });
+}
+
+NullGraphicsDevice::NullGraphicsDevice(std::chrono::microseconds fenceLatency) :
+    mFenceLatency(fenceLatency)
+{
+}
+
+std::unique_ptr<CommandList> NullGraphicsDevice::CreateCommandList()
+{
+    return std::make_unique<NullCommandList>();
+}
+
+void NullGraphicsDevice::ExecuteCommandLists(CommandList* const* lists, std::uint32_t count)
+{
+    Stats submitted;
+    submitted.Submissions = 1;
+    for(std::uint32_t i = 0; i < count; ++i)
+    {
+        auto* list = dynamic_cast<NullCommandList*>(lists[i]);
+        if(list == nullptr || list->IsRecording())
+            throw std::logic_error("NullGraphicsDevice: 只能提交本设备创建并且已经 End 的命令列表");
+
+        // 代替 GPU 读一遍命令流
+        const CommandStreamWriter& stream = list->Stream();
+        CommandStreamReader reader(stream.Data(), stream.Size());
+        CommandOp op;
+        const std::uint8_t* payload = nullptr;
+        while(reader.Next(op, payload))
+        {
+            submitted.Commands++;
+            if(op == CommandOp::DrawIndexedInstanced)
+            {
+                submitted.Draws++;
+            }
+            else if(op == CommandOp::ExecuteIndirect)
+            {
+                // 参数在 GPU 内存里，这里只能按上限统计
+                submitted.Draws++;
+                submitted.IndirectCommands += CommandStreamReader::Read<ExecuteIndirectArgs>(payload).MaxCommandCount;
+            }
+            else if(op == CommandOp::CopyBufferRegion)
+            {
+                submitted.CopyCommands++;
+                submitted.CopyBytes += CommandStreamReader::Read<CopyBufferRegionArgs>(payload).NumBytes;
+            }
+        }
+        if(!reader.Valid())
+            throw std::logic_error("NullGraphicsDevice: 命令流已损坏");
+
+        submitted.CommandLists++;
+        submitted.Bytes += stream.Size();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.Submissions += submitted.Submissions;
+    mStats.CommandLists += submitted.CommandLists;
+    mStats.Commands += submitted.Commands;
+    mStats.Draws += submitted.Draws;
+    mStats.IndirectCommands += submitted.IndirectCommands;
+    mStats.CopyCommands += submitted.CopyCommands;
+    mStats.CopyBytes += submitted.CopyBytes;
+    mStats.Bytes += submitted.Bytes;
+}
+
+void NullGraphicsDevice::Signal(std::uint64_t fenceValue)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPendingSignals.push_back({ fenceValue, std::chrono::steady_clock::now() + mFenceLatency });
+}
+
+void NullGraphicsDevice::RetireSignals(std::chrono::steady_clock::time_point now)
+{
+    while(!mPendingSignals.empty() && mPendingSignals.front().CompleteTime <= now)
+    {
+        mCompletedValue = std::max(mCompletedValue, mPendingSignals.front().Value);
+        mPendingSignals.pop_front();
+    }
+}
+
+std::uint64_t NullGraphicsDevice::CompletedFenceValue()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    RetireSignals(std::chrono::steady_clock::now());
+    return mCompletedValue;
+}
+
+void NullGraphicsDevice::WaitForFenceValue(std::uint64_t fenceValue)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    RetireSignals(std::chrono::steady_clock::now());
+    if(mCompletedValue >= fenceValue)
+        return;
+
+    // 找到第一个能让围栏达到目标值的 Signal，睡到它完成为止
+    auto it = std::find_if(mPendingSignals.begin(), mPendingSignals.end(),
+        [fenceValue](const PendingSignal& s) { return s.Value >= fenceValue; });
+    if(it == mPendingSignals.end())
+        throw std::logic_error("NullGraphicsDevice: 等待一个从未 Signal 的围栏值会永远阻塞");
+
+    auto deadline = it->CompleteTime;
+    lock.unlock();
+    std::this_thread::sleep_until(deadline);
+    lock.lock();
+    // sleep_until 可能提前醒来，按 deadline 判定，保证返回时围栏已经达到目标值
+    RetireSignals(std::max(std::chrono::steady_clock::now(), deadline));
+}
+
+void NullGraphicsDevice::SetFenceLatency(std::chrono::microseconds latency)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFenceLatency = latency;
+}
+
+NullGraphicsDevice::Stats NullGraphicsDevice::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
@@ -0,0 +1,124 @@
+#include "ObjectTiers.h"
+#include <algorithm>
+#include <cassert>
+
+ObjectTierTable::ObjectTierTable(std::uint32_t elementByteSize, std::uint32_t frameCount, std::uint32_t maxPatchGap) :
+    mElementByteSize(elementByteSize),
+    mFrameCount(frameCount),
+    mMaxPatchGap(maxPatchGap),
+    mDynamicDirty(frameCount)
+{
+}
+
+void ObjectTierTable::Clear()
+{
+    mStaticOwners.clear();
+    mDynamicOwners.clear();
+    mDynamicDirty = FrameDirtyTracker(mFrameCount);
+    mStaticFree.clear();
+    mDynamicFree.clear();
+    mPatchPending.clear();
+    mPendingSlots.clear();
+    mPatchSlots.clear();
+    mPatchRanges.clear();
+    mStats = Stats();
+}
+
+std::uint32_t ObjectTierTable::Add(UpdateFrequency frequency, std::uint32_t owner)
+{
+    std::vector<std::uint32_t>& freeSlots = frequency == UpdateFrequency::Dynamic ? mDynamicFree : mStaticFree;
+    if(!freeSlots.empty())
+    {
+        //复用的槽位里还是旧物体的数据，按变化处理
+        std::uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        std::uint32_t objectIndex = ObjectIndex::Make(frequency, slot);
+        (frequency == UpdateFrequency::Dynamic ? mDynamicOwners : mStaticOwners)[slot] = owner;
+        MarkChanged(objectIndex);
+        return objectIndex;
+    }
+
+    if(frequency == UpdateFrequency::Dynamic)
+    {
+        mDynamicOwners.push_back(owner);
+        mDynamicDirty.Resize(mDynamicOwners.size());
+        return ObjectIndex::Make(frequency, (std::uint32_t)mDynamicOwners.size() - 1);
+    }
+
+    mStaticOwners.push_back(owner);
+    mPatchPending.push_back(0);
+    return ObjectIndex::Make(frequency, (std::uint32_t)mStaticOwners.size() - 1);
+}
+
+void ObjectTierTable::Remove(std::uint32_t objectIndex)
+{
+    std::uint32_t slot = ObjectIndex::Slot(objectIndex);
+    if(ObjectIndex::IsDynamic(objectIndex))
+    {
+        assert(slot < mDynamicOwners.size());
+        mDynamicFree.push_back(slot);
+    }
+    else
+    {
+        assert(slot < mStaticOwners.size());
+        mStaticFree.push_back(slot);
+    }
+}
+
+void ObjectTierTable::MarkChanged(std::uint32_t objectIndex)
+{
+    if(ObjectIndex::IsDynamic(objectIndex))
+    {
+        mDynamicDirty.Mark(ObjectIndex::Slot(objectIndex));
+        return;
+    }
+
+    std::uint32_t slot = ObjectIndex::Slot(objectIndex);
+    assert(slot < mStaticOwners.size());
+    if(mPatchPending[slot] != 0)
+        return;
+
+    mPatchPending[slot] = 1;
+    mPendingSlots.push_back(slot);
+}
+
+void ObjectTierTable::BuildFramePatches()
+{
+    mPatchSlots.clear();
+    mPatchRanges.clear();
+
+    // 通常每帧只有少数几个静态物体变化，直接排序
+    std::sort(mPendingSlots.begin(), mPendingSlots.end());
+    for(std::uint32_t slot : mPendingSlots)
+    {
+        mPatchPending[slot] = 0;
+
+        // 与上一段之间的空隙足够小就把空隙也一起复制（空隙里的数据没变，重新写一遍也是对的）
+        if(!mPatchRanges.empty())
+        {
+            ObjectPatchRange& last = mPatchRanges.back();
+            std::uint32_t end = last.FirstSlot + last.Count;
+            if(slot - end <= mMaxPatchGap)
+            {
+                for(std::uint32_t s = end; s <= slot; ++s)
+                    mPatchSlots.push_back(s);
+                last.Count = slot + 1 - last.FirstSlot;
+                continue;
+            }
+        }
+
+        ObjectPatchRange range;
+        range.FirstSlot = slot;
+        range.Count = 1;
+        range.StagingFirst = (std::uint32_t)mPatchSlots.size();
+        mPatchRanges.push_back(range);
+        mPatchSlots.push_back(slot);
+    }
+    mPendingSlots.clear();
+
+    mStats.StaticObjects = mStaticOwners.size() - mStaticFree.size();
+    mStats.DynamicObjects = mDynamicOwners.size() - mDynamicFree.size();
+    mStats.PatchedObjects = mPatchSlots.size();
+    mStats.PatchBytes = (std::uint64_t)mPatchSlots.size() * mElementByteSize;
+    mStats.CopyCommands = mPatchRanges.size();
+}
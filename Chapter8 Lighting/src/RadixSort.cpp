@@ -0,0 +1,162 @@
+#include "RadixSort.h"
+#include <algorithm>
+#include <stdexcept>
+#include "JobSystem.h"
+
+namespace
+{
+    constexpr unsigned DigitBits = 8;
+    constexpr unsigned BucketCount = 1u << DigitBits;
+    constexpr unsigned DigitCount = 64 / DigitBits;
+
+    // 在 jobs 上并行（或在当前线程依次）对每个块调用 function(chunk, first, last)
+    template<typename Function>
+    void ForEachChunk(JobSystem* jobs, std::size_t count, std::size_t chunkCount, Function&& function)
+    {
+        auto run = [&](std::size_t chunk)
+        {
+            std::size_t first = count * chunk / chunkCount;
+            std::size_t last = count * (chunk + 1) / chunkCount;
+            function(chunk, first, last);
+        };
+
+        if(jobs == nullptr || chunkCount == 1)
+        {
+            for(std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+                run(chunk);
+            return;
+        }
+
+        jobs->ParallelFor(0, chunkCount, 1, [&](std::size_t firstChunk, std::size_t lastChunk)
+        {
+            for(std::size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+                run(chunk);
+        });
+    }
+}
+
+void RadixSortKeys(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+    RadixSortScratch& scratch, JobSystem* jobs, std::size_t minItemsPerJob)
+{
+    if(keys.size() != values.size())
+        throw std::invalid_argument("RadixSortKeys: keys 和 values 的长度不同");
+
+    const std::size_t count = keys.size();
+    if(count < 2)
+        return;
+
+    std::size_t chunkCount = 1;
+    if(jobs != nullptr && minItemsPerJob > 0)
+        chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(jobs->ThreadCount(), count / minItemsPerJob));
+
+    // 所有键在某个字节上都相同 <=> 按位与和按位或在这个字节上相同，这一趟可以跳过
+    std::vector<std::uint64_t> chunkAnd(chunkCount, ~std::uint64_t(0));
+    std::vector<std::uint64_t> chunkOr(chunkCount, 0);
+    ForEachChunk(jobs, count, chunkCount, [&](std::size_t chunk, std::size_t first, std::size_t last)
+    {
+        std::uint64_t andBits = ~std::uint64_t(0);
+        std::uint64_t orBits = 0;
+        for(std::size_t i = first; i < last; ++i)
+        {
+            andBits &= keys[i];
+            orBits |= keys[i];
+        }
+        chunkAnd[chunk] = andBits;
+        chunkOr[chunk] = orBits;
+    });
+
+    std::uint64_t allAnd = ~std::uint64_t(0);
+    std::uint64_t allOr = 0;
+    for(std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        allAnd &= chunkAnd[chunk];
+        allOr |= chunkOr[chunk];
+    }
+    const std::uint64_t varyingBits = allAnd ^ allOr;
+
+    scratch.Keys.resize(count);
+    scratch.Values.resize(count);
+    scratch.Histograms.resize(std::max<std::size_t>(chunkCount, DigitCount) * BucketCount);
+
+    // 只有一块时直方图与元素顺序无关，一次遍历统计所有需要的趟，省掉每趟单独的统计
+    const bool singleChunk = chunkCount == 1;
+    if(singleChunk)
+    {
+        std::uint32_t* histograms = scratch.Histograms.data();
+        std::fill(histograms, histograms + DigitCount * BucketCount, 0u);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            std::uint64_t key = keys[i];
+            for(unsigned digit = 0; digit < DigitCount; ++digit)
+            {
+                if(((varyingBits >> (digit * DigitBits)) & (BucketCount - 1)) != 0)
+                    histograms[digit * BucketCount + ((key >> (digit * DigitBits)) & (BucketCount - 1))]++;
+            }
+        }
+    }
+
+    std::vector<std::uint64_t>* srcKeys = &keys;
+    std::vector<std::uint32_t>* srcValues = &values;
+    std::vector<std::uint64_t>* dstKeys = &scratch.Keys;
+    std::vector<std::uint32_t>* dstValues = &scratch.Values;
+
+    for(unsigned digit = 0; digit < DigitCount; ++digit)
+    {
+        const unsigned shift = digit * DigitBits;
+        if(((varyingBits >> shift) & (BucketCount - 1)) == 0)
+            continue;
+
+        const std::uint64_t* inKeys = srcKeys->data();
+        const std::uint32_t* inValues = srcValues->data();
+        std::uint64_t* outKeys = dstKeys->data();
+        std::uint32_t* outValues = dstValues->data();
+        std::uint32_t* histograms = scratch.Histograms.data() + (singleChunk ? digit * BucketCount : 0);
+
+        // 1. 各块统计自己的直方图
+        if(!singleChunk)
+        {
+            ForEachChunk(jobs, count, chunkCount, [&](std::size_t chunk, std::size_t first, std::size_t last)
+            {
+                std::uint32_t* histogram = histograms + chunk * BucketCount;
+                std::fill(histogram, histogram + BucketCount, 0u);
+                for(std::size_t i = first; i < last; ++i)
+                    histogram[(inKeys[i] >> shift) & (BucketCount - 1)]++;
+            });
+        }
+
+        // 2. 按 (桶, 块) 的顺序前缀和：块 c 的桶 b 从所有更小的桶、以及桶 b 中更靠前的块之后开始
+        std::uint32_t offset = 0;
+        for(unsigned bucket = 0; bucket < BucketCount; ++bucket)
+        {
+            for(std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                std::uint32_t& slot = histograms[chunk * BucketCount + bucket];
+                std::uint32_t bucketCount = slot;
+                slot = offset;
+                offset += bucketCount;
+            }
+        }
+
+        // 3. 各块按块内顺序分散写入，保持稳定
+        ForEachChunk(jobs, count, chunkCount, [&](std::size_t chunk, std::size_t first, std::size_t last)
+        {
+            std::uint32_t* cursor = histograms + chunk * BucketCount;
+            for(std::size_t i = first; i < last; ++i)
+            {
+                std::uint32_t position = cursor[(inKeys[i] >> shift) & (BucketCount - 1)]++;
+                outKeys[position] = inKeys[i];
+                outValues[position] = inValues[i];
+            }
+        });
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    // 奇数趟时结果在临时缓冲区里，交换 vector 而不是复制
+    if(srcKeys != &keys)
+    {
+        keys.swap(scratch.Keys);
+        values.swap(scratch.Values);
+    }
+}
@@ -13,8 +13,11 @@ const int gNumFrameResources = 3;
 Renderer::Renderer() : m_width(1280), m_height(720), mCurrBackBuffer(0), mCurrentFence(0){}
 Renderer::~Renderer()
 {
-    if (m_device != nullptr)
+    if (mGraphics != nullptr)
+    {
         FlushCommandQueue();
+        mDeferredRelease.ReclaimAll();
+    }
 }
 
 void Renderer::Initialize(HWND hwnd)
@@ -28,9 +31,25 @@ void Renderer::Initialize(HWND hwnd)
 }
 #endif
 
+    mJobs = std::make_unique<JobSystem>();
+
     CreateDevice();
     CreateFence();
+    CreateGpuMemoryAllocators();
+    mBudgetSource = std::make_unique<DxgiBudgetSource>(mdxgiFactory.Get(), m_device.Get());
+    //最近 gNumFrameResources 帧内用过的资源GPU可能还在读，不驱逐
+    mResidency = std::make_unique<ResidencyManager>(*mBudgetSource, 0.95f, 0.85f, gNumFrameResources);
     CreateCommandQueue();
+    auto capture = std::make_unique<CaptureGraphicsDevice>(
+        std::make_unique<D3D12GraphicsDevice>(m_device.Get(), m_commandQueue.Get(), m_fence.Get()));
+    mCapture = capture.get();
+    mGraphics = std::move(capture);
+    mUploadBatcher = std::make_unique<UploadBatcher>(m_device.Get(), m_commandQueue.Get());
+    mCopyStreamer = std::make_unique<CopyQueueStreamer>(m_device.Get());
+    //每帧最多录制暂存环四分之一的数据，在途数据不超过一半：暂存环回绕时剩下的两段空闲空间里
+    //总有一段放得下一次录制的量，复制队列的暂存空间不会让渲染线程等待
+    mStreaming = std::make_unique<StreamingScheduler>(*mCopyStreamer,
+        UploadBatcher::DefaultStagingByteSize / 4, UploadBatcher::DefaultStagingByteSize / 2);
     CreateSwapChain(hwnd);
     CreateDescriptorHeaps(); 
     CreateRenderTargetView();
@@ -40,22 +59,23 @@ void Renderer::Initialize(HWND hwnd)
     //画正方体
     ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), nullptr));
     
-    BuildRootSignature();
-    std::cout << "22" << std::endl;
-    BuildShadersAndInputLayout();
-    std::cout << "2" << std::endl;
-    BuildShapeGeometry();
-    std::cout << "3" << std::endl;
-    BuildMaterials();
-    std::cout << "4" << std::endl;
-    BuildRenderItem();
-    std::cout << "5" << std::endl;
-    BuildFrameResources();
-    //BuildDescriptorHeaps();
-    //BuildConstantBuffers();
-    BuildPSO();
+    //初始化各阶段按依赖关系作为作业并行执行：
+    //  根签名、着色器编译 -> PSO；几何体、材质 -> 渲染项 -> 帧资源
+    JobCounter psoInputs, sceneInputs, initDone;
+    mJobs->Run([this]() { BuildRootSignature(); }, &psoInputs);
+    mJobs->Run([this]() { BuildShadersAndInputLayout(); }, &psoInputs);
+    mJobs->Run([this]() { BuildShapeGeometry(); }, &sceneInputs);
+    mJobs->Run([this]() { BuildMaterials(); }, &sceneInputs);
+    mJobs->RunAfter(psoInputs, [this]() { BuildPSO(); }, &initDone);
+    mJobs->RunAfter(psoInputs, [this]() { BuildCommandSignature(); }, &initDone);
+    //帧资源的上传环按渲染项和材质的数量确定初始大小，放在它们之后
+    mJobs->RunAfter(sceneInputs, [this]() { BuildRenderItem(); BuildObjectTiers(); BuildFrameResources(); }, &initDone);
+    mJobs->Wait(initDone);
     std::cout << "BuildPSO" << std::endl;
 
+    //几何体等资源的上传已经攒成批次，这里提交最后一批
+    mUploadBatcher->Submit();
+
     ThrowIfFailed(m_commandList->Close());
 
     ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
@@ -63,6 +83,8 @@ void Renderer::Initialize(HWND hwnd)
 
     FlushCommandQueue();
 
+    //初始化上传全部完成，暂存堆可以整个释放
+    mUploadBatcher->ReleaseStagingIfIdle();
 }
 
 void Renderer::CreateDevice()
@@ -83,6 +105,15 @@ void Renderer::CreateDevice()
     }
 }
 
+void Renderer::CreateGpuMemoryAllocators()
+{
+    //默认堆上的缓冲区（顶点/索引等）都放到池化堆里，不再各自占一个隐式堆
+    mBufferAllocator = std::make_unique<GpuMemoryAllocator>(m_device.Get(),
+        D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+    mTextureAllocator = std::make_unique<GpuMemoryAllocator>(m_device.Get(),
+        D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES);
+}
+
 void Renderer::CreateFence()
 {
     // 创建一个 fence
@@ -253,74 +284,27 @@ void Renderer::CreateDepthStencilBuffer()
             D3D12_RESOURCE_STATE_DEPTH_WRITE));  // 目标状态
 }
 
-void Renderer::BuildDescriptorHeaps(){
-    UINT objectCount = (UINT)mAllRitems.size();
-
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = (objectCount + 1)*gNumFrameResources; ////此处一个堆中包含(几何体个数（包含实例）+1)个CBV
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    cbvHeapDesc.NodeMask = 0;
-
-    ThrowIfFailed(m_device->CreateDescriptorHeap(&cbvHeapDesc,IID_PPV_ARGS(&mCbvHeap)));
-}
-
-void Renderer::BuildConstantBuffers(){
-    //创建objCB
-    UINT objectCount = (UINT)mAllRitems.size();
-    UINT objConstSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-
-    //循环遍历
-    for(int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex){
-        std::cout << objectCount << std::endl;
-        //auto objectCB = FrameResourcesArray[frameIndex]->ObjectCB->Resource();
-
-        for(UINT i = 0; i < objectCount; ++i){
-            D3D12_GPU_VIRTUAL_ADDRESS objCB_Address = mFrameResources[frameIndex]->ObjectCB->Resource()->GetGPUVirtualAddress();
-            int objCbElementIndex = i;
-            objCB_Address += objCbElementIndex * objConstSize;//子物体在常量缓冲区中的地址
-            int heapIndex = frameIndex*objectCount + i;	//CBV堆中的CBV元素索引
-            auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCbvHeap->GetCPUDescriptorHandleForHeapStart());//获得CBV堆首地址
-            handle.Offset(heapIndex, m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));	//CBV句柄（CBV堆中的CBV元素地址）
-
-            //创建CBV描述符
-            D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
-            cbvDesc.BufferLocation = objCB_Address;
-            cbvDesc.SizeInBytes = objConstSize;
-            m_device->CreateConstantBufferView(&cbvDesc, handle);
-        }
-    }
-
-    //创建passCB
-    UINT passCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
-
-    for(int frameIndex = 0; frameIndex < gNumFrameResources; ++frameIndex){
-        D3D12_GPU_VIRTUAL_ADDRESS cbAddress1;
-        cbAddress1 = mFrameResources[frameIndex]->PassCB->Resource()->GetGPUVirtualAddress();
-
-        D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc1;
-        cbvDesc1.BufferLocation = cbAddress1;
-        cbvDesc1.SizeInBytes = passCBByteSize;
-
-        int heapIndex1 = objectCount * gNumFrameResources + frameIndex;
-        auto handle1 = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCbvHeap->GetCPUDescriptorHandleForHeapStart());
-        handle1.Offset(heapIndex1, m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-        m_device->CreateConstantBufferView(&cbvDesc1, handle1);
-    }
-}
-
 void Renderer::BuildRootSignature(){
 
     //定义根参数
-    CD3DX12_ROOT_PARAMETER slotRootParameter[3];
+    CD3DX12_ROOT_PARAMETER slotRootParameter[7];
 
-    //0号槽：cbuffer cbPerObject : register(b0)
-    slotRootParameter[0].InitAsConstantBufferView(0);
-    slotRootParameter[1].InitAsConstantBufferView(1);
+    //0号槽：cbuffer cbInstance : register(b0)，一个 32 位根常量（实例组的基准下标）
+    slotRootParameter[0].InitAsConstants(1, 0);
+    //1号槽：cbuffer cbMaterialIndex : register(b1)，一个 32 位根常量（材质表下标）
+    slotRootParameter[1].InitAsConstants(1, 1);
     slotRootParameter[2].InitAsConstantBufferView(2); 
+    //3号槽：StructuredBuffer<uint> gInstanceObjects : register(t0)
+    slotRootParameter[3].InitAsShaderResourceView(0);
+    //4号槽：StructuredBuffer<MaterialConstants> gMaterialData : register(t1)，每个命令列表只绑定一次
+    slotRootParameter[4].InitAsShaderResourceView(1);
+    //5号槽：StructuredBuffer<ObjectConstants> gStaticObjects : register(t2)，默认堆，每个命令列表只绑定一次
+    slotRootParameter[5].InitAsShaderResourceView(2);
+    //6号槽：StructuredBuffer<ObjectConstants> gDynamicObjects : register(t3)，本帧上传环里的动态层
+    slotRootParameter[6].InitAsShaderResourceView(3);
 
     //定义根签名描述符
-    CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(3, slotRootParameter, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+    CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(7, slotRootParameter, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
     
     //序列化根签名
     ComPtr<ID3DBlob> serializedRootSig = nullptr;
@@ -342,6 +326,35 @@ void Renderer::BuildRootSignature(){
 		IID_PPV_ARGS(&m_rootSignature)));
 }
 
+void Renderer::BuildCommandSignature(){
+    //每条间接命令依次改写槽位 0 的基准实例下标、槽位 1 的材质下标，然后 DrawIndexedInstanced
+    D3D12_INDIRECT_ARGUMENT_DESC arguments[3] = {};
+    arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+    arguments[0].Constant.RootParameterIndex = 0;
+    arguments[0].Constant.DestOffsetIn32BitValues = 0;
+    arguments[0].Constant.Num32BitValuesToSet = 1;
+    arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+    arguments[1].Constant.RootParameterIndex = 1;
+    arguments[1].Constant.DestOffsetIn32BitValues = 0;
+    arguments[1].Constant.Num32BitValuesToSet = 1;
+    arguments[2].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+    //参数在缓冲区中的顺序与 arguments 一致，绘制参数在最后，末尾的填充由 ByteStride 跳过
+    static_assert(offsetof(IndirectDrawCommand, MaterialIndex) == offsetof(IndirectDrawCommand, BaseInstance) + 4, "间接命令布局与命令签名不一致");
+    static_assert(offsetof(IndirectDrawCommand, IndexCountPerInstance) == offsetof(IndirectDrawCommand, MaterialIndex) + 4, "间接命令布局与命令签名不一致");
+    static_assert(offsetof(IndirectDrawCommand, Padding) == offsetof(IndirectDrawCommand, IndexCountPerInstance) + sizeof(D3D12_DRAW_INDEXED_ARGUMENTS),
+        "间接命令布局与命令签名不一致");
+
+    D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+    signatureDesc.ByteStride = sizeof(IndirectDrawCommand);
+    signatureDesc.NumArgumentDescs = _countof(arguments);
+    signatureDesc.pArgumentDescs = arguments;
+
+    //命令签名改写根参数，所以必须指定根签名
+    ThrowIfFailed(m_device->CreateCommandSignature(&signatureDesc, m_rootSignature.Get(),
+        IID_PPV_ARGS(&mDrawCommandSignature)));
+}
+
 void Renderer::BuildShadersAndInputLayout(){
 
     const D3D_SHADER_MACRO alphaTestDefines[] =
@@ -350,8 +363,8 @@ void Renderer::BuildShadersAndInputLayout(){
 		NULL, NULL
 	};
     std::cout << "222" << std::endl;
-	mShaders["standardVS"] = d3dUtil::CompileShader(L"D:\\Personal Project\\D3D12book_code\\Chapter8 Lighting\\Shaders\\color.hlsl", nullptr, "VS", "vs_5_0");
-	mShaders["opaquePS"] = d3dUtil::CompileShader(L"D:\\Personal Project\\D3D12book_code\\Chapter8 Lighting\\Shaders\\color.hlsl", nullptr, "PS", "ps_5_0");
+	mShaders.Add("standardVS"_rid, d3dUtil::CompileShader(L"D:\\Personal Project\\D3D12book_code\\Chapter8 Lighting\\Shaders\\color.hlsl", nullptr, "VS", "vs_5_0"));
+	mShaders.Add("opaquePS"_rid, d3dUtil::CompileShader(L"D:\\Personal Project\\D3D12book_code\\Chapter8 Lighting\\Shaders\\color.hlsl", nullptr, "PS", "ps_5_0"));
 
     m_InputLayout =
     {
@@ -361,96 +374,106 @@ void Renderer::BuildShadersAndInputLayout(){
 }
 
 void Renderer::BuildRenderItem(){
-    
-    auto boxRitem = std::make_unique<RenderItem>();
-    XMStoreFloat4x4(&boxRitem->World, XMMatrixScaling(2.0f, 2.0f, 2.0f)*XMMatrixTranslation(0.0f, 0.5f, 0.0f));
-    XMStoreFloat4x4(&boxRitem->TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
-    boxRitem->ObjCBIndex = 0;//BOX常量数据（world矩阵）在objConstantBuffer索引0上
-    boxRitem->Geo = mGeometries["shapeGeo"].get();
-    boxRitem->Mat = mMaterials["stone0"].get();
-    boxRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-    boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
-    boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
-    boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
-    mAllRitems.push_back(std::move(boxRitem));
-
-    auto gridRitem = std::make_unique<RenderItem>();
-	gridRitem->World = MathHelper::Identity4x4();
-    XMStoreFloat4x4(&gridRitem->TexTransform, XMMatrixScaling(8.0f, 8.0f, 1.0f));
-	gridRitem->ObjCBIndex = 1;//BOX常量数据（world矩阵）在objConstantBuffer索引1上
-    gridRitem->Geo = mGeometries["shapeGeo"].get();
-    gridRitem->Mat = mMaterials["tile0"].get();
-    gridRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	gridRitem->IndexCount = gridRitem->Geo->DrawArgs["grid"].IndexCount;
-	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
-	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
-	mAllRitems.push_back(std::move(gridRitem));
-
-    UINT objCBIndex = 2;//接下去的几何体常量数据在CB中的索引从2开始
-    XMMATRIX brickTexTransform = XMMatrixScaling(1.0f, 1.0f, 1.0f);
+    MeshGeometry* shapeGeo = mGeometries.Get("shapeGeo"_rid).get();
+
+    RenderItem boxRitem;
+    XMStoreFloat4x4(&boxRitem.TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
+    boxRitem.Geo = shapeGeo;
+    boxRitem.Mat = mMaterials.Get("stone0"_rid).get();
+    boxRitem.PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    XMFLOAT4X4 boxWorld;
+    XMStoreFloat4x4(&boxWorld, XMMatrixScaling(2.0f, 2.0f, 2.0f)*XMMatrixTranslation(0.0f, 0.5f, 0.0f));
+    AddRenderItem(boxRitem, shapeGeo->DrawArgs.Get("box"_rid), boxWorld);
+
+    RenderItem gridRitem;
+    XMStoreFloat4x4(&gridRitem.TexTransform, XMMatrixScaling(8.0f, 8.0f, 1.0f));
+    gridRitem.Geo = shapeGeo;
+    gridRitem.Mat = mMaterials.Get("tile0"_rid).get();
+    gridRitem.PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	AddRenderItem(gridRitem, shapeGeo->DrawArgs.Get("grid"_rid), MathHelper::Identity4x4());
+
+    RenderItem cylRitem;
+    XMStoreFloat4x4(&cylRitem.TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
+    cylRitem.Geo = shapeGeo;
+    cylRitem.Mat = mMaterials.Get("bricks0"_rid).get();
+    cylRitem.PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+    RenderItem sphereRitem;
+    sphereRitem.TexTransform = MathHelper::Identity4x4();
+    sphereRitem.Geo = shapeGeo;
+    sphereRitem.Mat = mMaterials.Get("stone0"_rid).get();
+    sphereRitem.PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
     for(int i = 0; i < 5; ++i)
 	{
-		auto leftCylRitem = std::make_unique<RenderItem>();
-		auto rightCylRitem = std::make_unique<RenderItem>();
-		auto leftSphereRitem = std::make_unique<RenderItem>();
-		auto rightSphereRitem = std::make_unique<RenderItem>();
-
-		XMMATRIX leftCylWorld = XMMatrixTranslation(-5.0f, 1.5f, -10.0f + i*5.0f);
-		XMMATRIX rightCylWorld = XMMatrixTranslation(+5.0f, 1.5f, -10.0f + i*5.0f);
-
-		XMMATRIX leftSphereWorld = XMMatrixTranslation(-5.0f, 3.5f, -10.0f + i*5.0f);
-		XMMATRIX rightSphereWorld = XMMatrixTranslation(+5.0f, 3.5f, -10.0f + i*5.0f);
-
-		XMStoreFloat4x4(&leftCylRitem->World, rightCylWorld);
-        XMStoreFloat4x4(&leftCylRitem->TexTransform, brickTexTransform);
-		leftCylRitem->ObjCBIndex = objCBIndex++;
-		leftCylRitem->Geo = mGeometries["shapeGeo"].get();
-        leftCylRitem->Mat = mMaterials["bricks0"].get();
-		leftCylRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-		leftCylRitem->IndexCount = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
-		leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
-		leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
-
-		XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
-        XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
-		rightCylRitem->ObjCBIndex = objCBIndex++;
-		rightCylRitem->Geo = mGeometries["shapeGeo"].get();
-        rightCylRitem->Mat = mMaterials["bricks0"].get();
-		rightCylRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-		rightCylRitem->IndexCount = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
-		rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
-		rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
-
-		XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
-        leftSphereRitem->TexTransform = MathHelper::Identity4x4();
-		leftSphereRitem->ObjCBIndex = objCBIndex++;
-		leftSphereRitem->Geo = mGeometries["shapeGeo"].get();
-        leftSphereRitem->Mat = mMaterials["stone0"].get();
-		leftSphereRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-		leftSphereRitem->IndexCount = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
-		leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
-		leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
-
-		XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
-        rightSphereRitem->TexTransform = MathHelper::Identity4x4();
-		rightSphereRitem->ObjCBIndex = objCBIndex++;
-		rightSphereRitem->Geo = mGeometries["shapeGeo"].get();
-        rightSphereRitem->Mat = mMaterials["stone0"].get();
-		rightSphereRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-		rightSphereRitem->IndexCount = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
-		rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
-		rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
-
-		mAllRitems.push_back(std::move(leftCylRitem));
-		mAllRitems.push_back(std::move(rightCylRitem));
-		mAllRitems.push_back(std::move(leftSphereRitem));
-		mAllRitems.push_back(std::move(rightSphereRitem));
+		XMFLOAT4X4 leftCylWorld, rightCylWorld, leftSphereWorld, rightSphereWorld;
+		XMStoreFloat4x4(&leftCylWorld, XMMatrixTranslation(-5.0f, 1.5f, -10.0f + i*5.0f));
+		XMStoreFloat4x4(&rightCylWorld, XMMatrixTranslation(+5.0f, 1.5f, -10.0f + i*5.0f));
+		XMStoreFloat4x4(&leftSphereWorld, XMMatrixTranslation(-5.0f, 3.5f, -10.0f + i*5.0f));
+		XMStoreFloat4x4(&rightSphereWorld, XMMatrixTranslation(+5.0f, 3.5f, -10.0f + i*5.0f));
+
+		AddRenderItem(cylRitem, shapeGeo->DrawArgs.Get("cylinder"_rid), rightCylWorld);
+		AddRenderItem(cylRitem, shapeGeo->DrawArgs.Get("cylinder"_rid), leftCylWorld);
+		AddRenderItem(sphereRitem, shapeGeo->DrawArgs.Get("sphere"_rid), leftSphereWorld);
+		AddRenderItem(sphereRitem, shapeGeo->DrawArgs.Get("sphere"_rid), rightSphereWorld);
 	}
+}
+
+RenderItemHandle Renderer::AddRenderItem(const RenderItem& item, const SubmeshGeometry& submesh, const XMFLOAT4X4& world)
+{
+    RenderItem cold = item;
+    cold.IndexCount = submesh.IndexCount;
+    cold.StartIndexLocation = submesh.StartIndexLocation;
+    cold.BaseVertexLocation = submesh.BaseVertexLocation;
+
+    RenderItemHot hot;
+    hot.World = world;
+    hot.Bounds = submesh.Bounds;
+    //目前只有一个渲染阶段和一个 PSO，这两个字段为 0；深度每次排序时再填
+    hot.SortKey = DrawSortKey::Make(0, 0, cold.Mat->MatCBIndex, cold.Geo->SortId, 0);
+    RenderItemHandle handle = mRenderItems.Add(hot, cold);
+    mWorldBounds.PushBack(world, submesh.Bounds);
+
+    //物体层在初始化时由 BuildObjectTiers 统一分配，之后加入的在这里分配
+    if(mStaticObjectBuffer != nullptr){
+        //静态层的默认堆缓冲区大小固定，没有空位时改放动态层
+        if(cold.Frequency == UpdateFrequency::Static && !mObjectTiers.HasFreeSlot(UpdateFrequency::Static)){
+            cold.Frequency = UpdateFrequency::Dynamic;
+            mRenderItems.TryGetCold(handle)->Frequency = UpdateFrequency::Dynamic;
+        }
+        mRenderItems.TryGetHot(handle)->ObjectIndex = mObjectTiers.Add(cold.Frequency, handle.Value);
+    }
+    ++mDrawListGeneration;
+    return handle;
+}
 
-    for(auto& e : mAllRitems)
-		mOpaqueRitems.push_back(e.get());
+bool Renderer::RemoveRenderItem(RenderItemHandle handle)
+{
+    const RenderItemHot* hot = mRenderItems.TryGetHot(handle);
+    if(hot == nullptr)
+        return false;
+
+    //物体层的槽位在 GPU 上可能还被之前的帧读，不过实例缓冲区里已经不会再引用它，下次复用时再覆盖
+    if(mStaticObjectBuffer != nullptr)
+        mObjectTiers.Remove(hot->ObjectIndex);
+    //池删除时把最后一个渲染项搬到空位上，包围盒数组做同样的搬动
+    mWorldBounds.RemoveSwapBack(mRenderItems.DenseIndexOf(handle));
+    mRenderItems.Remove(handle);
+    ++mDrawListGeneration;
+    return true;
+}
 
+void Renderer::SetRenderItemWorld(RenderItemHandle handle, const XMFLOAT4X4& world)
+{
+    RenderItemHot* hot = mRenderItems.TryGetHot(handle);
+    if(hot == nullptr)
+        return;
+
+    hot->World = world;
+    mWorldBounds.Set(mRenderItems.DenseIndexOf(handle), world, hot->Bounds);
+    mObjectTiers.MarkChanged(hot->ObjectIndex);
+    //位置变了，排序用的深度也跟着变
+    ++mDrawListGeneration;
 }
 
 void Renderer::BuildShapeGeometry(){
@@ -534,16 +557,14 @@ void Renderer::BuildShapeGeometry(){
     geo = std::make_unique<MeshGeometry>();
     geo->Name = "shapeGeo";
 
-    ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-
-    CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize); 
-    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    //CPU端副本按策略保存（拾取等需要时通过 Acquire 解压）
+    geo->VertexBufferCPU.Store(vertices.data(), vbByteSize, mGeometryShadowPolicy, sizeof(Vertex));
+    geo->IndexBufferCPU.Store(indices.data(), ibByteSize, mGeometryShadowPolicy, sizeof(std::uint16_t));
 
-	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(m_device.Get(),
-		m_commandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader); //创建 GPU 顶点缓冲区 将顶点数据从 CPU 上传到 GPU 的默认缓冲区中
-	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(m_device.Get(),
-		m_commandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader); //创建 GPU 顶点缓冲区 将索引数据从 CPU 上传到 GPU 的默认缓冲区中
+	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(*mBufferAllocator, *mUploadBatcher,
+		vertices.data(), vbByteSize, geo->VertexBufferAllocation); //创建 GPU 顶点缓冲区 将顶点数据从 CPU 上传到 GPU 的默认缓冲区中
+	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(*mBufferAllocator, *mUploadBatcher,
+		indices.data(), ibByteSize, geo->IndexBufferAllocation); //创建 GPU 顶点缓冲区 将索引数据从 CPU 上传到 GPU 的默认缓冲区中
 
     // 设置缓冲区属性
 	geo->VertexByteStride = sizeof(Vertex);
@@ -551,12 +572,17 @@ void Renderer::BuildShapeGeometry(){
 	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
 	geo->IndexBufferByteSize = ibByteSize;
 
-    geo->DrawArgs["box"] = boxSubmesh;
-    geo->DrawArgs["grid"] = gridSubmesh;
-    geo->DrawArgs["sphere"] = sphereSubmesh;
-    geo->DrawArgs["cylinder"] = cylinderSubmesh;
+    geo->DrawArgs.Add("box"_rid, boxSubmesh);
+    geo->DrawArgs.Add("grid"_rid, gridSubmesh);
+    geo->DrawArgs.Add("sphere"_rid, sphereSubmesh);
+    geo->DrawArgs.Add("cylinder"_rid, cylinderSubmesh);
 
-    mGeometries[geo->Name] = std::move(geo);
+    //场景自带的几何体常驻，不参与驱逐
+    geo->ResidencyId = mResidency->Track(MemoryCategory::Geometry,
+        geo->VertexBufferAllocation.Size + geo->IndexBufferAllocation.Size);
+
+    geo->SortId = mNextGeometrySortId++;
+    mGeometries.Add("shapeGeo"_rid, std::move(geo));
 
 }
 
@@ -564,7 +590,6 @@ void Renderer::BuildMaterials()
 {
     auto boxMat = std::make_unique<Material>();
     boxMat->Name = "bricks0";
-    boxMat->MatCBIndex = 0;
     boxMat->DiffuseSrvHeapIndex = 0;
     boxMat->DiffuseAlbedo = XMFLOAT4(Colors::ForestGreen);
     boxMat->FresnelR0 = XMFLOAT3(0.1f, 0.1f, 0.1f);
@@ -572,7 +597,6 @@ void Renderer::BuildMaterials()
 
     auto gridMat = std::make_unique<Material>();
     gridMat->Name = "stone0";
-    gridMat->MatCBIndex = 1;
     gridMat->DiffuseSrvHeapIndex = 1;
     gridMat->DiffuseAlbedo = XMFLOAT4(Colors::LightSteelBlue);
     gridMat->FresnelR0 = XMFLOAT3(0.05f, 0.05f, 0.05f);
@@ -580,7 +604,6 @@ void Renderer::BuildMaterials()
 
     auto sphereMat = std::make_unique<Material>();
     sphereMat->Name = "tile0";
-    sphereMat->MatCBIndex = 2;
     sphereMat->DiffuseSrvHeapIndex = 2;
     sphereMat->DiffuseAlbedo = XMFLOAT4(Colors::LightGray);
     sphereMat->FresnelR0 = XMFLOAT3(0.02f, 0.02f, 0.02f);
@@ -588,16 +611,31 @@ void Renderer::BuildMaterials()
 
     auto cylinderMat = std::make_unique<Material>();
     cylinderMat->Name = "skullMat";
-    cylinderMat->MatCBIndex = 3;
     cylinderMat->DiffuseSrvHeapIndex = 3;
     cylinderMat->DiffuseAlbedo = XMFLOAT4(Colors::Blue);
     cylinderMat->FresnelR0 = XMFLOAT3(0.05f, 0.05f, 0.05f);
     cylinderMat->Roughness = 0.3f;
 
-    mMaterials["bricks0"] = std::move(boxMat);
-    mMaterials["stone0"] = std::move(gridMat);
-    mMaterials["tile0"] = std::move(sphereMat);
-    mMaterials["skullMat"] = std::move(cylinderMat);
+    RegisterMaterial("bricks0"_rid, std::move(boxMat));
+    RegisterMaterial("stone0"_rid, std::move(gridMat));
+    RegisterMaterial("tile0"_rid, std::move(sphereMat));
+    RegisterMaterial("skullMat"_rid, std::move(cylinderMat));
+}
+
+Material* Renderer::RegisterMaterial(const NamedResourceId& id, std::unique_ptr<Material> material)
+{
+    //材质表是稠密的，新材质放在表尾；表的大小每帧重新读取，不需要事先固定材质数
+    material->MatCBIndex = (int)mMaterialTable.size();
+    Material* registered = material.get();
+    mMaterialTable.push_back(registered);
+    mMaterialDirty.Resize(mMaterialTable.size());
+    mMaterials.Add(id, std::move(material));
+    return registered;
+}
+
+void Renderer::MarkMaterialDirty(Material* material)
+{
+    mMaterialDirty.Mark((std::uint32_t)material->MatCBIndex);
 }
 
 void Renderer::BuildPSO(){
@@ -605,15 +643,17 @@ void Renderer::BuildPSO(){
     ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
     psoDesc.InputLayout = { m_InputLayout.data(), (UINT)m_InputLayout.size() };
     psoDesc.pRootSignature = m_rootSignature.Get();
+    ID3DBlob* standardVS = mShaders.Get("standardVS"_rid).Get();
+    ID3DBlob* opaquePS = mShaders.Get("opaquePS"_rid).Get();
     psoDesc.VS = 
 	{ 
-		reinterpret_cast<BYTE*>(mShaders["standardVS"]->GetBufferPointer()), 
-		mShaders["standardVS"]->GetBufferSize()
+		reinterpret_cast<BYTE*>(standardVS->GetBufferPointer()), 
+		standardVS->GetBufferSize()
 	};
     psoDesc.PS = 
 	{ 
-		reinterpret_cast<BYTE*>(mShaders["opaquePS"]->GetBufferPointer()),
-		mShaders["opaquePS"]->GetBufferSize() 
+		reinterpret_cast<BYTE*>(opaquePS->GetBufferPointer()),
+		opaquePS->GetBufferSize() 
 	};
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
@@ -629,22 +669,22 @@ void Renderer::BuildPSO(){
     ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
 }
 
-void Renderer::SetViewportAndScissor(UINT width, UINT height) {
-    D3D12_VIEWPORT viewport = {};
+void Renderer::SetViewportAndScissor(CommandList* cmdList, UINT width, UINT height) {
+    ViewportDesc viewport = {};
     viewport.TopLeftX = 0;
     viewport.TopLeftY = 0;
     viewport.Width = static_cast<float>(width);
     viewport.Height = static_cast<float>(height);
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
-    m_commandList->RSSetViewports(1, &viewport);
-
-    D3D12_RECT scissorRect = {};
-    scissorRect.left = 0;
-    scissorRect.top = 0;
-    scissorRect.right = width;
-    scissorRect.bottom = height;
-    m_commandList->RSSetScissorRects(1, &scissorRect);
+    cmdList->SetViewport(viewport);
+
+    ScissorRect scissorRect = {};
+    scissorRect.Left = 0;
+    scissorRect.Top = 0;
+    scissorRect.Right = width;
+    scissorRect.Bottom = height;
+    cmdList->SetScissorRect(scissorRect);
 }
 
 void Renderer::Update()
@@ -652,87 +692,305 @@ void Renderer::Update()
     OnKeyboardInput();
     UpdateCamera();
 
+    //摄像机动了，常量缓冲区和按深度排的绘制顺序都要更新
+    if(m_camera.Version() != mCameraVersion){
+        mCameraVersion = m_camera.Version();
+        ++mPassGeneration;
+        ++mDrawListGeneration;
+    }
+
     //每帧遍历一个帧资源（多帧的话就是环形遍历）
     mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
     mCurrFrameResource = mFrameResources[mCurrFrameResourceIndex].get();
 
     //如果GPU端围栏值小于CPU端围栏值，即CPU速度快于GPU，则令CPU等待
-    if (mCurrFrameResource->Fence != 0 && m_fence->GetCompletedValue() < mCurrFrameResource->Fence)
+    if (mCurrFrameResource->Fence != 0)
+        mGraphics->WaitForFenceValue(mCurrFrameResource->Fence);
+
+    //运行时的上传在围栏完成后回收暂存空间
+    mUploadBatcher->RetireCompleted();
+
+    //释放GPU已经用完的对象，不需要等待GPU空闲
+    mDeferredRelease.Reclaim(mGraphics->CompletedFenceValue());
+
+    //录制新的流送请求，并把复制已完成的资源交给渲染
+    mStreaming->Pump();
+
+    //查询显存预算，超出时驱逐最久未用的流送资源
+    mResidency->Update();
+
+    //分配在主线程按固定顺序完成，各块常量的写入互不相关，作为作业并行执行
+    bool dynamicRelocated = false;
+    bool materialRelocated = false;
+    mObjectTiers.BuildFramePatches();
+
+    //间接命令的预留条数影响本帧要分配的总量，先确定下来
+    UpdateIndirectCapacity();
+
+    //GPU已经用完这一帧的上传内存，可以整块回收；本帧要分配的超过环的容量时换一块更大的，
+    //换过之后环里以前写的内容都不在了，各块按第一次分配处理
+    FrameResource* frame = mCurrFrameResource;
+    if(frame->UploadRing->Reset(FrameConstantsByteSize())){
+        frame->ForgetUploadBlocks();
+        mResidency->Untrack(frame->UploadRingResidencyId);
+        frame->UploadRingResidencyId = mResidency->Track(MemoryCategory::UploadHeap, frame->UploadRing->Allocator().Capacity());
+    }
+    AllocateFrameConstants(dynamicRelocated, materialRelocated);
+
+    //剔除、排序、分组、写实例数据前后依赖，放在同一个作业里（各自内部的 ParallelFor 仍会分给其他线程）；
+    //绘制顺序没有变化（摄像机和渲染项都没动）时沿用上一帧的可见列表、排序和分组
+    JobCounter updateDone;
+    mJobs->Run([this]() {
+        if(mSortedGeneration != mDrawListGeneration){
+            CullRenderItems();
+            SortRenderItems();
+            BuildInstanceGroups();
+            mSortedGeneration = mDrawListGeneration;
+        }
+        UpdateInstanceData();
+        //实例组比预留的间接命令多（组数突然增加）时这一帧退回逐组绘制，下一帧按新的组数预留
+        mIndirectThisFrame = mIndirectDraws &&
+            sizeof(IndirectDrawCommand) * mInstanceBatcher.Groups().size() <= mCurrFrameResource->IndirectArgs.Size;
+        if(mIndirectThisFrame)
+            BuildIndirectCommands();
+        else
+            mUploadStats.IndirectBytes = 0;
+    }, &updateDone);
+    mJobs->Run([this, dynamicRelocated]() { UpdateObjectData(dynamicRelocated); }, &updateDone);
+    mJobs->Run([this, materialRelocated]() { UpdateMaterialBuffer(materialRelocated); }, &updateDone);
+    mJobs->Run([this]() { UpdateMainPassCB(); }, &updateDone);
+    mJobs->Wait(updateDone);
+
+    const LinearAllocator& ringAllocator = mCurrFrameResource->UploadRing->Allocator();
+    mUploadStats.RingUsed = ringAllocator.Used();
+    mUploadStats.RingHighWatermark = ringAllocator.HighWatermark();
+    mUploadStats.RingCapacity = ringAllocator.Capacity();
+
+    //捕获时记录这一帧上传的常量，回放时可以重建上传环的内容（从写合并内存读回很慢，只在捕获时做）
+    if(mCapture->IsCapturing())
     {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(m_fence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
+        for(const LinearAllocation* block : { &mCurrFrameResource->DynamicObjectBuffer, &mCurrFrameResource->StaticPatchStaging,
+            &mCurrFrameResource->MaterialBuffer, &mCurrFrameResource->InstanceBuffer, &mCurrFrameResource->PassCB,
+            &mCurrFrameResource->IndirectArgs })
+            mCapture->CaptureUpload(block->GpuAddress, block->CpuAddress, (size_t)block->Size);
     }
-    UpdateObjectCBs();
-    UpdateMaterialCB();
-    UpdateMainPassCB();
+}
 
+UINT64 Renderer::FrameConstantsByteSize()const{
+    //与 AllocateFrameConstants 的各块一一对应；每块的起点按常量缓冲区对齐，所以每块按对齐后的大小计
+    auto block = [](UINT64 byteSize){
+        return LinearAllocator::AlignUp(byteSize, LinearAllocator::ConstantBufferAlignment);
+    };
+    return block(sizeof(ObjectConstants) * mObjectTiers.DynamicOwners().size()) +
+        block(sizeof(MaterialConstants) * mMaterialTable.size()) +
+        block(sizeof(InstanceObjectIndex) * mRenderItems.Size()) +
+        block(d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants))) +
+        block(sizeof(IndirectDrawCommand) * mIndirectCapacity) +
+        block(sizeof(ObjectConstants) * mObjectTiers.PatchSlots().size());
 }
 
-void Renderer::UpdateMaterialCB(){
-    auto currMaterialCB = mCurrFrameResource->MaterialCB.get();
-    for(auto& e : mMaterials){
-        Material* mat = e.second.get();
-        if(mat->NumFramesDirty > 0){
-            XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
-			MaterialConstants matConstants;
-			matConstants.DiffuseAlbedo = mat->DiffuseAlbedo;
-			matConstants.FresnelR0 = mat->FresnelR0;
-			matConstants.Roughness = mat->Roughness;
-			XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
+void Renderer::UpdateIndirectCapacity(){
+    //不走间接绘制时不预留；打开之后的第一帧退回逐组绘制，下一帧按组数预留
+    if(!mIndirectDraws){
+        mIndirectCapacity = 0;
+        return;
+    }
+    mIndirectCapacity = IndirectCommandCapacity(mInstanceBatcher.Groups().size(), mIndirectCapacity,
+        mRenderItems.Size(), MinIndirectHeadroom);
+}
 
-			currMaterialCB->CopyData(mat->MatCBIndex, matConstants);
+void Renderer::AllocateFrameConstants(bool& dynamicRelocated, bool& materialRelocated){
+    //每帧的分配顺序固定为 dynamic object -> material -> instance -> pass -> indirect -> patch，保证各块在环中的位置稳定。
+    //环每帧从头分配，上一次写进这个帧资源的数据还留在原处，块的位置和大小都没变时只需要写变化的部分；
+    //位置变了（包括大小变了）的话，环里上一次写入的数据就不在这里了，需要整块重写
+    FrameResource* frame = mCurrFrameResource;
+    auto relocated = [](const LinearAllocation& before, const LinearAllocation& after){
+        return before.Offset != after.Offset || before.Size != after.Size;
+    };
+
+    LinearAllocation dynamicBuffer = frame->UploadRing->AllocateStructured<ObjectConstants>((UINT)mObjectTiers.DynamicOwners().size());
+    dynamicRelocated = relocated(frame->DynamicObjectBuffer, dynamicBuffer);
+    frame->DynamicObjectBuffer = dynamicBuffer;
+
+    LinearAllocation materialBuffer = frame->UploadRing->AllocateStructured<MaterialConstants>((UINT)mMaterialTable.size());
+    materialRelocated = relocated(frame->MaterialBuffer, materialBuffer);
+    frame->MaterialBuffer = materialBuffer;
+
+    //下面三块按代数整块跳过，换了位置就把记下的代数清零。
+    //可见的渲染项要等剔除之后才知道，实例缓冲区按全部渲染项预留，块的位置不随可见数变化
+    LinearAllocation instanceBuffer = frame->UploadRing->AllocateStructured<InstanceObjectIndex>((UINT)mRenderItems.Size());
+    if(relocated(frame->InstanceBuffer, instanceBuffer))
+        frame->InstanceGeneration = 0;
+    frame->InstanceBuffer = instanceBuffer;
+
+    LinearAllocation passCB = frame->UploadRing->AllocateConstants<PassConstants>(1);
+    if(relocated(frame->PassCB, passCB))
+        frame->PassGeneration = 0;
+    frame->PassCB = passCB;
+
+    //实例组数在分组之后才知道，按上一次的组数加余量预留（UpdateIndirectCapacity），这样分配仍然只在主线程上进行
+    LinearAllocation indirectArgs = frame->UploadRing->Allocate(sizeof(IndirectDrawCommand) * mIndirectCapacity);
+    if(relocated(frame->IndirectArgs, indirectArgs))
+        frame->IndirectGeneration = 0;
+    frame->IndirectArgs = indirectArgs;
+
+    //静态层的修补区间在 BuildFramePatches 里已经整理好；暂存块每帧大小不同，放在最后不影响其他块的位置
+    frame->StaticPatchStaging = frame->UploadRing->AllocateStructured<ObjectConstants>((UINT)mObjectTiers.PatchSlots().size());
+}
 
-			// Next FrameResource need to be updated too.
-			mat->NumFramesDirty--;
+void Renderer::BuildObjectTiers(){
+    //物体层的所有者是渲染项句柄，池里元素搬动不影响它
+    mObjectTiers.Clear();
+    for(size_t i = 0; i < mRenderItems.Size(); ++i)
+        mRenderItems.HotAt(i).ObjectIndex = mObjectTiers.Add(mRenderItems.ColdAt(i).Frequency, mRenderItems.HandleAt(i).Value);
+
+    //静态层只在这里整块上传一次，之后只有变化的槽位用复制命令修补
+    const std::vector<std::uint32_t>& staticOwners = mObjectTiers.StaticOwners();
+    std::vector<ObjectConstants> staticObjects((std::max)(staticOwners.size(), (size_t)1));
+    std::vector<const XMFLOAT4X4*> staticWorlds(staticOwners.size());
+    for(size_t slot = 0; slot < staticOwners.size(); ++slot)
+        staticWorlds[slot] = &mRenderItems.TryGetHot(RenderItemHandle{ staticOwners[slot] })->World;
+    PackObjectWorlds(staticWorlds.data(), staticWorlds.size(), staticObjects.data());
+    WriteCombined::Fence();
+
+    UINT64 byteSize = sizeof(ObjectConstants) * staticObjects.size();
+    mStaticObjectBuffer = d3dUtil::CreateDefaultBuffer(*mBufferAllocator, *mUploadBatcher,
+        staticObjects.data(), byteSize, mStaticObjectAllocation);
+    mResidency->Track(MemoryCategory::Other, byteSize);
+}
+
+void Renderer::UpdateObjectData(bool dynamicRelocated){
+    FrameResource* frame = mCurrFrameResource;
+    UINT frameIndex = (UINT)mCurrFrameResourceIndex;
+
+    //[first, last) 分批收集源矩阵的地址（ownerOf 给出第 i 个物体的渲染项句柄），
+    //每批交给 pack 用 PackObjectWorlds 整批转置打包，直接写进上传堆，不经过栈上的临时变量。
+    //已经删除的渲染项留下的槽位（合并复制区间时顺带写到的）写单位矩阵，没有实例会引用它们
+    static const XMFLOAT4X4 removedWorld = MathHelper::Identity4x4();
+    auto packObjects = [this](size_t first, size_t last, auto ownerOf, auto pack){
+        const XMFLOAT4X4* worlds[ObjectUpdateGrainSize];
+        for(size_t i = first; i < last; ){
+            size_t count = (std::min)(last - i, ObjectUpdateGrainSize);
+            for(size_t k = 0; k < count; ++k){
+                const RenderItemHot* hot = mRenderItems.TryGetHot(RenderItemHandle{ ownerOf(i + k) });
+                worlds[k] = hot != nullptr ? &hot->World : &removedWorld;
+            }
+            pack(worlds, i, count);
+            i += count;
         }
+        WriteCombined::Fence();
+    };
+
+    //动态层：块换了位置时整块重写，否则只写这个帧资源上次写入之后变化的槽位
+    const std::vector<std::uint32_t>& dynamicOwners = mObjectTiers.DynamicOwners();
+    ObjectConstants* dynamicObjects = reinterpret_cast<ObjectConstants*>(frame->DynamicObjectBuffer.CpuAddress);
+    size_t dynamicWritten = 0;
+    if(dynamicRelocated){
+        mJobs->ParallelFor(0, dynamicOwners.size(), ObjectUpdateGrainSize, [&](size_t first, size_t last){
+            packObjects(first, last, [&](size_t slot){ return dynamicOwners[slot]; },
+                [&](const XMFLOAT4X4* const* worlds, size_t i, size_t count){
+                    PackObjectWorlds(worlds, count, dynamicObjects + i);
+                });
+        });
+        dynamicWritten = dynamicOwners.size();
+    }
+    else{
+        const std::vector<std::uint32_t>& dirtySlots = mObjectTiers.DynamicDirty(frameIndex);
+        mJobs->ParallelFor(0, dirtySlots.size(), ObjectUpdateGrainSize, [&](size_t first, size_t last){
+            packObjects(first, last, [&](size_t i){ return dynamicOwners[dirtySlots[i]]; },
+                [&](const XMFLOAT4X4* const* worlds, size_t i, size_t count){
+                    PackObjectWorldsScattered(worlds, count, dynamicObjects, dirtySlots.data() + i);
+                });
+        });
+        dynamicWritten = dirtySlots.size();
     }
+    mObjectTiers.ClearDynamicDirty(frameIndex);
+
+    //静态层：变化的槽位按复制区间的顺序写进暂存块，录制时再复制到默认堆
+    const std::vector<std::uint32_t>& patchSlots = mObjectTiers.PatchSlots();
+    const std::vector<std::uint32_t>& staticOwners = mObjectTiers.StaticOwners();
+    ObjectConstants* staging = reinterpret_cast<ObjectConstants*>(frame->StaticPatchStaging.CpuAddress);
+    packObjects(0, patchSlots.size(), [&](size_t i){ return staticOwners[patchSlots[i]]; },
+        [&](const XMFLOAT4X4* const* worlds, size_t i, size_t count){
+            PackObjectWorlds(worlds, count, staging + i);
+        });
+
+    const ObjectTierTable::Stats& tierStats = mObjectTiers.GetStats();
+    mUploadStats.DynamicObjectBytes = sizeof(ObjectConstants) * dynamicWritten;
+    mUploadStats.StaticPatchBytes = tierStats.PatchBytes;
+    mUploadStats.StaticPatchCopies = tierStats.CopyCommands;
 }
 
-void Renderer::UpdateCamera(){
-    ProcessInput(); 
-    XMMATRIX view = m_camera.GetViewMatrix();  // 获取视图矩阵
-
+void Renderer::RecordStaticObjectPatches(CommandList* cmdList){
+    const std::vector<ObjectPatchRange>& ranges = mObjectTiers.PatchRanges();
+    if(ranges.empty())
+        return;
+
+    //复制前转换到 COPY_DEST，复制完再转到 GENERIC_READ 给本帧的绘制读
+    ResourceHandle staticBuffer = ToHandle(mStaticObjectBuffer.Get());
+    ResourceHandle uploadRing = ToHandle(mCurrFrameResource->UploadRing->Resource());
+    UINT64 stagingOffset = mCurrFrameResource->StaticPatchStaging.Offset;
+
+    //之前状态是 COMMON 而不是 GENERIC_READ：缓冲区在每次 ExecuteCommandLists 完成后都会衰减回 COMMON
+    //（见 UploadBatcher::Submit），上一帧末尾转到的 GENERIC_READ 到这一帧已经不存在了
+    cmdList->TransitionBarrier(staticBuffer, ResourceState::Common, ResourceState::CopyDest);
+    for(const ObjectPatchRange& range : ranges){
+        cmdList->CopyBufferRegion(staticBuffer, (UINT64)range.FirstSlot * sizeof(ObjectConstants),
+            uploadRing, stagingOffset + (UINT64)range.StagingFirst * sizeof(ObjectConstants),
+            (UINT64)range.Count * sizeof(ObjectConstants));
+    }
+    cmdList->TransitionBarrier(staticBuffer, ResourceState::CopyDest, ResourceState::GenericRead);
 }
 
-void Renderer::UpdateObjectCBs(){
-    auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-    for(auto& e : mAllRitems){
-        if(e->NumFramesDirty > 0){
-            XMMATRIX world = XMLoadFloat4x4(&e->World);
-            XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
+void Renderer::UpdateMaterialBuffer(bool relocated){
+    LinearAllocation materialBuffer = mCurrFrameResource->MaterialBuffer;
 
-            ObjectConstants objConstants;
-            XMStoreFloat4x4(&objConstants.world, XMMatrixTranspose(world));
-            XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+    //上传堆是write-combined内存，只能整块写入，不能在上面读-改-写
+    UploadWriter<MaterialConstants> matWriter(materialBuffer.CpuAddress, sizeof(MaterialConstants), mMaterialTable.size());
 
-            currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-            e->NumFramesDirty--;
-        }
+    std::uint64_t writtenBytes = 0;
+    auto writeMaterial = [&matWriter, &writtenBytes](const Material* mat){
+        MaterialConstants matConstants;
+        matConstants.DiffuseAlbedo = mat->DiffuseAlbedo;
+        matConstants.FresnelR0 = mat->FresnelR0;
+        matConstants.Roughness = mat->Roughness;
+
+        matWriter.Write(mat->MatCBIndex, matConstants);
+        writtenBytes += sizeof(MaterialConstants);
+    };
+
+    //块换了位置时整张表重写，否则只写这个帧资源的脏列表；写完清空，其他帧资源的列表不受影响
+    UINT frameIndex = (UINT)mCurrFrameResourceIndex;
+    if(relocated){
+        for(const Material* mat : mMaterialTable)
+            writeMaterial(mat);
     }
+    else{
+        for(std::uint32_t index : mMaterialDirty.Dirty(frameIndex))
+            writeMaterial(mMaterialTable[index]);
+    }
+    mMaterialDirty.Clear(frameIndex);
+    mUploadStats.MaterialBytes = writtenBytes;
+}
+
+void Renderer::UpdateCamera(){
+    ProcessInput(); 
+    XMMATRIX view = m_camera.GetViewMatrix();  // 获取视图矩阵
+
 }
 
 void Renderer::UpdateMainPassCB(){
+    //摄像机和光照都没变，这个帧资源里上次写的常量还能用
+    if(mCurrFrameResource->PassGeneration == mPassGeneration){
+        mUploadStats.PassBytes = 0;
+        return;
+    }
+
     PassConstants passConstants;
-    XMMATRIX view = m_camera.GetViewMatrix();
-    float aspectRatio = static_cast<float>(m_width) / static_cast<float>(m_height);
-    float fov = XMConvertToRadians(60.0f);
-    float nearZ = 1.0f;
-    float farZ = 1000.0f;
-    XMMATRIX proj = XMMatrixPerspectiveFovLH(fov, aspectRatio, nearZ, farZ);
-
-    XMMATRIX viewProj =  view * proj;
-	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-	XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-	XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
-
-	//XMStoreFloat4x4(&passConstants.View, XMMatrixTranspose(view));
-	//XMStoreFloat4x4(&passConstants.InvView, XMMatrixTranspose(invView));
-	//XMStoreFloat4x4(&passConstants.Proj, XMMatrixTranspose(proj));
-	//XMStoreFloat4x4(&passConstants.InvProj, XMMatrixTranspose(invProj));
+
+    //着色器只用 ViewProj，逆矩阵不再计算
+    XMMATRIX viewProj = BuildViewProj();
 	XMStoreFloat4x4(&passConstants.ViewProj, XMMatrixTranspose(viewProj));
-	//XMStoreFloat4x4(&passConstants.InvViewProj, XMMatrixTranspose(invViewProj));
 
     passConstants.eyePosW = m_camera.GetPosition();
 
@@ -752,87 +1010,317 @@ void Renderer::UpdateMainPassCB(){
     passConstants.Lights[0] = dirLight;
     */
 
-    auto currPassCB = mCurrFrameResource->PassCB.get();
-    currPassCB->CopyData(0, passConstants);
+    WriteCombined::StreamCopy(mCurrFrameResource->PassCB.CpuAddress, &passConstants, sizeof(PassConstants));
+    WriteCombined::Fence();
+    mCurrFrameResource->PassGeneration = mPassGeneration;
+    mUploadStats.PassBytes = sizeof(PassConstants);
 }
 
-void Renderer::DrawRenderItems(ID3D12GraphicsCommandList* m_commandList,const std::vector<RenderItem*>& ritems){
-    // 常量缓冲区字节对齐大小（例如 256 字节对齐）
-    UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-    UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
+XMMATRIX Renderer::BuildViewProj()const{
+    XMMATRIX view = m_camera.GetViewMatrix();
+    float aspectRatio = static_cast<float>(m_width) / static_cast<float>(m_height);
+    float fov = XMConvertToRadians(60.0f);
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(fov, aspectRatio, CameraNearZ, CameraFarZ);
+    return view * proj;
+}
 
-    // 获取当前帧的材质常量缓冲资源
-	auto objectCB = mCurrFrameResource->ObjectCB->Resource();
-	auto matCB = mCurrFrameResource->MaterialCB->Resource();
+void Renderer::CullRenderItems(){
+    size_t count = mRenderItems.Size();
+    mCullStats.TotalItems = count;
+    if(!mFrustumCulling){
+        mVisibleItems.resize(count);
+        for(size_t i = 0; i < count; ++i)
+            mVisibleItems[i] = (std::uint32_t)i;
+        mCullStats.VisibleItems = count;
+        return;
+    }
+
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, BuildViewProj());
+    FrustumPlanes frustum = ExtractFrustumPlanes(viewProj);
+
+    //按池的块划分作业，每个作业剔除一块；包围盒读 mWorldBounds 里已经变换好的 SoA 数组，每项 24 字节，
+    //不再读整条热数据记录。可见的下标紧凑地写在 mCullScratch 中这块自己的区间里，线程之间不共享输出位置
+    const size_t chunkSize = RenderItemPool::ElementsPerChunk;
+    size_t chunkCount = mRenderItems.ChunkCount();
+    mCullScratch.resize(count);
+    mCullChunkVisible.resize(chunkCount);
+    mCullChunkOffset.resize(chunkCount);
+    mJobs->ParallelFor(0, chunkCount, 1, [&](size_t first, size_t last){
+        for(size_t chunk = first; chunk < last; ++chunk){
+            std::uint32_t base = (std::uint32_t)(chunk * chunkSize);
+            mCullChunkVisible[chunk] = (std::uint32_t)CullBoxes(frustum, mWorldBounds.View(base),
+                mRenderItems.ChunkLength(chunk), base, mCullScratch.data() + base);
+        }
+    });
+
+    //按块的顺序拼起来，可见列表保持池中的顺序
+    size_t visibleCount = 0;
+    for(size_t chunk = 0; chunk < chunkCount; ++chunk){
+        mCullChunkOffset[chunk] = (std::uint32_t)visibleCount;
+        visibleCount += mCullChunkVisible[chunk];
+    }
+    mVisibleItems.resize(visibleCount);
+    mJobs->ParallelFor(0, chunkCount, 1, [&](size_t first, size_t last){
+        for(size_t chunk = first; chunk < last; ++chunk){
+            const std::uint32_t* src = mCullScratch.data() + chunk * chunkSize;
+            std::copy(src, src + mCullChunkVisible[chunk], mVisibleItems.data() + mCullChunkOffset[chunk]);
+        }
+    });
+    mCullStats.VisibleItems = visibleCount;
+}
+
+void Renderer::SortRenderItems(){
+    size_t count = mVisibleItems.size();
+    mSortKeys.resize(count);
+    mSortIndices.resize(count);
+
+    //深度取物体世界坐标原点在视空间的 z，用于同一状态组内由近到远；
+    //只读热数据，每个作业处理可见列表里连续的一段
+    XMMATRIX view = m_camera.GetViewMatrix();
+    mJobs->ParallelFor(0, count, SortKeyGrainSize, [&](size_t first, size_t last){
+        for(size_t i = first; i < last; ++i){
+            std::uint32_t dense = mVisibleItems[i];
+            const RenderItemHot& hot = mRenderItems.HotAt(dense);
+            XMVECTOR origin = XMVectorSet(hot.World._41, hot.World._42, hot.World._43, 1.0f);
+            float viewDepth = XMVectorGetZ(XMVector3TransformCoord(origin, view));
+
+            mSortKeys[i] = hot.SortKey | DrawSortKey::QuantizeDepth(viewDepth, CameraNearZ, CameraFarZ);
+            mSortIndices[i] = dense;
+        }
+    });
+
+    RadixSortKeys(mSortKeys, mSortIndices, mSortScratch, mJobs.get());
+}
+
+void Renderer::BuildInstanceGroups(){
+    size_t count = mSortIndices.size();
+    mInstanceKeys.resize(count);
+    for(size_t i = 0; i < count; ++i){
+        const RenderItem* ritem = &mRenderItems.ColdAt(mSortIndices[i]);
+        InstanceKey& key = mInstanceKeys[i];
+        key.Geometry = (std::uint64_t)reinterpret_cast<std::uintptr_t>(ritem->Geo);
+        key.Material = ritem->Mat->MatCBIndex;
+        key.IndexCount = ritem->IndexCount;
+        key.StartIndexLocation = ritem->StartIndexLocation;
+        key.BaseVertexLocation = ritem->BaseVertexLocation;
+        key.PrimitiveTopology = (std::uint32_t)ritem->PrimitiveType;
+    }
+
+    mInstanceBatcher.Build(mInstanceKeys.data(), count);
+}
+
+void Renderer::UpdateInstanceData(){
+    //绘制顺序和这个帧资源上次写入时相同，实例缓冲区不用动
+    if(mCurrFrameResource->InstanceGeneration == mSortedGeneration){
+        mUploadStats.InstanceBytes = 0;
+        return;
+    }
+
+    LinearAllocation instanceBuffer = mCurrFrameResource->InstanceBuffer;
+    const std::vector<std::uint32_t>& instanceOrder = mInstanceBatcher.InstanceOrder();
+
+    //实例顺序变了就整块重写；每个实例只写 4 字节的物体下标，
+    //物体数据本身在物体表里，只在变化时写
+    mJobs->ParallelFor(0, instanceOrder.size(), ObjectUpdateGrainSize, [&](size_t first, size_t last){
+        //每个任务的写入器只覆盖自己的 [first, last)
+        UploadWriter<InstanceObjectIndex> instanceWriter(instanceBuffer.CpuAddress, sizeof(InstanceObjectIndex), first, last - first);
+
+        //先在栈上攒一段，再整段写入，避免每个实例一次 4 字节的零散写入
+        InstanceObjectIndex indices[ObjectUpdateGrainSize];
+        for(size_t i = first; i < last; ){
+            size_t count = (std::min)(last - i, ObjectUpdateGrainSize);
+            for(size_t k = 0; k < count; ++k)
+                indices[k] = mRenderItems.HotAt(mSortIndices[instanceOrder[i + k]]).ObjectIndex;
+            instanceWriter.WriteRange(i, indices, count);
+            i += count;
+        }
+    });
+
+    mCurrFrameResource->InstanceGeneration = mSortedGeneration;
+    mUploadStats.InstanceBytes = sizeof(InstanceObjectIndex) * instanceOrder.size();
+}
 
-    //遍历渲染项数组
-	for (size_t i = 0; i < ritems.size(); i++)
+void Renderer::BuildIndirectCommands(){
+    const std::vector<InstanceGroup>& groups = mInstanceBatcher.Groups();
+    BuildIndirectRuns(groups.data(), groups.size(), mIndirectRuns);
+
+    //实例组和这个帧资源上次写入时相同，间接命令不用重写
+    if(mCurrFrameResource->IndirectGeneration == mSortedGeneration){
+        mUploadStats.IndirectBytes = 0;
+        return;
+    }
+
+    IndirectDrawCommand* commands = reinterpret_cast<IndirectDrawCommand*>(mCurrFrameResource->IndirectArgs.CpuAddress);
+    mJobs->ParallelFor(0, groups.size(), IndirectCommandGrainSize, [&](size_t first, size_t last){
+        BuildIndirectDrawCommands(groups.data() + first, last - first, commands + first);
+        WriteCombined::Fence();
+    });
+
+    mCurrFrameResource->IndirectGeneration = mSortedGeneration;
+    mUploadStats.IndirectBytes = sizeof(IndirectDrawCommand) * groups.size();
+}
+
+void Renderer::DrawInstanceGroups(StateCachingEncoder& encoder, size_t firstGroup, size_t lastGroup){
+    const std::vector<InstanceGroup>& groups = mInstanceBatcher.Groups();
+    const std::vector<std::uint32_t>& instanceOrder = mInstanceBatcher.InstanceOrder();
+
+    //遍历实例组。重复的状态设置由 encoder 过滤
+    MeshGeometry* currentGeo = nullptr;
+    VertexBufferBinding vertexBuffer;
+    IndexBufferBinding indexBuffer;
+	for (size_t g = firstGroup; g < lastGroup; g++)
 	{
-		auto ritem = ritems[i];
+        const InstanceGroup& group = groups[g];
+        // 组内渲染项的绘制状态完全相同，取第一个
+		const RenderItem* ritem = &mRenderItems.ColdAt(mSortIndices[instanceOrder[group.FirstInstance]]);
+
+        // 几何体被驱逐（或还没有流送完成）时跳过
+        if(ritem->Geo->VertexBufferGPU == nullptr)
+            continue;
+
+        // 相邻渲染项通常共用几何体，只在几何体变化时标记使用（减少多线程录制时的锁竞争）
+        // 并重新生成缓冲区视图（GetGPUVirtualAddress 不必每项都调用）
+        if(ritem->Geo != currentGeo)
+        {
+            mResidency->Touch(ritem->Geo->ResidencyId);
+            currentGeo = ritem->Geo;
+            vertexBuffer = ToBinding(currentGeo->VertexBufferView());
+            indexBuffer = ToBinding(currentGeo->IndexBufferView());
+        }
 
         // 设置顶点/索引缓冲区和图元拓扑
-		m_commandList->IASetVertexBuffers(0, 1, &ritem->Geo->VertexBufferView());
-		m_commandList->IASetIndexBuffer(&ritem->Geo->IndexBufferView());
-		m_commandList->IASetPrimitiveTopology(ritem->PrimitiveType);
+		encoder.SetVertexBuffer(vertexBuffer);
+		encoder.SetIndexBuffer(indexBuffer);
+		encoder.SetPrimitiveTopology((std::uint32_t)ritem->PrimitiveType);
 
-		// 设置 ObjectCB 的根描述符表（槽位 0）
-        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ritem->ObjCBIndex*objCBByteSize;
-        D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + ritem->Mat->MatCBIndex*matCBByteSize;
-        m_commandList->SetGraphicsRootConstantBufferView(0, objCBAddress);
-        m_commandList->SetGraphicsRootConstantBufferView(1, matCBAddress);
+		// 实例组在实例缓冲区中的起始下标（槽位 0）和材质表下标（槽位 1），都是 32 位根常量
+        encoder.SetGraphicsRoot32BitConstant(0, group.FirstInstance, 0);
+        encoder.SetGraphicsRoot32BitConstant(1, (std::uint32_t)ritem->Mat->MatCBIndex, 0);
 
 		//绘制顶点（通过索引缓冲区绘制）
-		m_commandList->DrawIndexedInstanced(ritem->IndexCount, //每个实例要绘制的索引数
-			1,	//实例化个数
+		encoder.DrawIndexedInstanced(ritem->IndexCount, //每个实例要绘制的索引数
+			group.InstanceCount,	//实例化个数
 			ritem->StartIndexLocation,	//起始索引位置
 			ritem->BaseVertexLocation,	//子物体起始索引在全局索引中的位置
-			0);	//实例化的高级技术，暂时设置为0
+			0);	//SV_InstanceID 不受它影响，基准下标走根常量
 	}
 }
 
+void Renderer::DrawIndirectRuns(StateCachingEncoder& encoder, size_t firstRun, size_t lastRun){
+    const std::vector<InstanceGroup>& groups = mInstanceBatcher.Groups();
+    const std::vector<std::uint32_t>& instanceOrder = mInstanceBatcher.InstanceOrder();
+
+    ResourceHandle argumentBuffer = ToHandle(mCurrFrameResource->UploadRing->Resource());
+    UINT64 argumentOffset = mCurrFrameResource->IndirectArgs.Offset;
+    CommandSignatureHandle signature = ToHandle(mDrawCommandSignature.Get());
+
+    for(size_t r = firstRun; r < lastRun; r++)
+    {
+        const IndirectRun& run = mIndirectRuns[r];
+        // 段内所有组共用几何体和图元拓扑，取第一组的第一个渲染项
+        const RenderItem* ritem = &mRenderItems.ColdAt(mSortIndices[instanceOrder[groups[run.First].FirstInstance]]);
+
+        // 几何体被驱逐（或还没有流送完成）时跳过整段
+        if(ritem->Geo->VertexBufferGPU == nullptr)
+            continue;
+
+        mResidency->Touch(ritem->Geo->ResidencyId);
+        encoder.SetVertexBuffer(ToBinding(ritem->Geo->VertexBufferView()));
+        encoder.SetIndexBuffer(ToBinding(ritem->Geo->IndexBufferView()));
+        encoder.SetPrimitiveTopology((std::uint32_t)ritem->PrimitiveType);
+
+        //材质和基准实例下标由每条命令自己设置
+        encoder.ExecuteIndirect(signature, (std::uint32_t)(run.Last - run.First), argumentBuffer,
+            argumentOffset + run.First * sizeof(IndirectDrawCommand));
+    }
+}
+
 void Renderer::Render()
 {
     std::cout << "Render" << std::endl;
-    // 重置命令分配器和命令列表
-    auto currCmdAllocator = mCurrFrameResource->CmdListAlloc;
-    ThrowIfFailed(currCmdAllocator->Reset());
-    ThrowIfFailed(m_commandList->Reset(currCmdAllocator.Get(), m_pipelineState.Get()));
-
-    //设置视口和裁剪矩形
-    SetViewportAndScissor(m_width,m_height);
-
-    // 指定渲染目标
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-        CurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_PRESENT,
-        D3D12_RESOURCE_STATE_RENDER_TARGET));
-
-    // 清屏
-    m_commandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-    m_commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-
-    // 设置我们要渲染的buffer
-    m_commandList->OMSetRenderTargets(1, &CurrentBackBufferView(), TRUE, &DepthStencilView()); //RTV
-    m_commandList->SetGraphicsRootSignature(m_rootSignature.Get()); //RootSignature
-
-    //绑定passCbv
-    auto passCB = mCurrFrameResource->PassCB->Resource();
-    m_commandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
-
-    //渲染几何体
-    DrawRenderItems(m_commandList.Get(),mOpaqueRitems);
+    // 实例组切成连续的批次，每批由一个线程录制进自己的命令列表；
+    // 第一批负责清屏，最后一批负责转换到 PRESENT，提交顺序与批次顺序一致
+    //间接绘制时按段切分（通常只有一两段，只用一个命令列表）
+    size_t drawCount = mIndirectThisFrame ? mIndirectRuns.size() : mInstanceBatcher.Groups().size();
+    std::vector<RecordBatch> batches = PartitionRecordBatches(drawCount,
+        (UINT)mCurrFrameResource->CmdLists.size(), MinGroupsPerRecordBatch);
+
+    std::vector<CommandList*> cmdLists;
+    for(auto& cmdList : mCurrFrameResource->CmdLists)
+        cmdLists.push_back(cmdList.get());
+
+    std::vector<StateCachingEncoder::Stats> batchStats(batches.size());
+
+    auto recordBatch = [this, &batches, &batchStats](CommandList* cmdList, const RecordBatch& batch)
+    {
+        // 重置命令分配器和命令列表
+        PipelineHandle pipeline = ToHandle(m_pipelineState.Get());
+        cmdList->Begin(pipeline);
+        StateCachingEncoder encoder(cmdList, pipeline);
+
+        bool firstBatch = batch.ListIndex == 0;
+        bool lastBatch = batch.ListIndex + 1 == batches.size();
+
+        if(firstBatch)
+        {
+            // 指定渲染目标
+            cmdList->TransitionBarrier(ToHandle(CurrentBackBuffer()),
+                ResourceState::Present,
+                ResourceState::RenderTarget);
+
+            // 清屏
+            cmdList->ClearRenderTarget(ToHandle(CurrentBackBufferView()), Colors::LightSteelBlue);
+            cmdList->ClearDepthStencil(ToHandle(DepthStencilView()), 1.0f, 0);
+
+            // 变化的静态物体在任何绘制之前补进默认堆（后面的命令列表按顺序提交，也能看到）
+            RecordStaticObjectPatches(cmdList);
+        }
+
+        // 管线状态不会跨命令列表继承，每个列表都要重新设置
+        SetViewportAndScissor(cmdList, m_width, m_height);
+        cmdList->SetRenderTarget(ToHandle(CurrentBackBufferView()), ToHandle(DepthStencilView())); //RTV
+        encoder.SetGraphicsRootSignature(ToHandle(m_rootSignature.Get())); //RootSignature
+
+        //绑定passCbv、实例缓冲区、材质表和两层物体表
+        encoder.SetGraphicsRootConstantBufferView(2, mCurrFrameResource->PassCB.GpuAddress);
+        encoder.SetGraphicsRootShaderResourceView(3, mCurrFrameResource->InstanceBuffer.GpuAddress);
+        encoder.SetGraphicsRootShaderResourceView(4, mCurrFrameResource->MaterialBuffer.GpuAddress);
+        encoder.SetGraphicsRootShaderResourceView(5, mStaticObjectBuffer->GetGPUVirtualAddress());
+        encoder.SetGraphicsRootShaderResourceView(6, mCurrFrameResource->DynamicObjectBuffer.GpuAddress);
+
+        //渲染几何体
+        //实例组按排序键的顺序排列，相同材质/几何体的组相邻，encoder 能跳过更多重复设置
+        if(mIndirectThisFrame)
+            DrawIndirectRuns(encoder, batch.First, batch.Last);
+        else
+            DrawInstanceGroups(encoder, batch.First, batch.Last);
+        batchStats[batch.ListIndex] = encoder.GetStats();
+
+        if(lastBatch)
+        {
+            // 过渡到 PRESENT 状态
+            cmdList->TransitionBarrier(ToHandle(CurrentBackBuffer()),
+                ResourceState::RenderTarget,
+                ResourceState::Present);
+        }
+
+        cmdList->End();
+    };
+
+    std::vector<CommandList*> ordered = RecordBatchesInParallel(*mJobs, batches, cmdLists.data(), recordBatch);
+
+    mEncoderStats = StateCachingEncoder::Stats();
+    for(const auto& stats : batchStats)
+        mEncoderStats += stats;
     std::cout << "finish" << std::endl;
 
-    // 过渡到 PRESENT 状态
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-        CurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET,
-        D3D12_RESOURCE_STATE_PRESENT));
+    // 跨队列同步：本帧可能用到刚流送完成的资源，让图形队列在 GPU 端等复制队列的围栏
+    if(mStreaming->ResidentFenceValue() > 0)
+        ThrowIfFailed(m_commandQueue->Wait(mCopyStreamer->Fence(), mStreaming->ResidentFenceValue()));
 
-    // 关闭命令列表并执行
-    ThrowIfFailed(m_commandList->Close());
-    ID3D12CommandList* commandLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+    // 所有批次按顺序一次提交
+    mGraphics->ExecuteCommandLists(ordered.data(), (std::uint32_t)ordered.size());
 
     // 交换缓冲区
 	ThrowIfFailed(m_swapChain->Present(0, 0));
@@ -840,16 +1328,170 @@ void Renderer::Render()
 
     // 等待 GPU 完成
     mCurrFrameResource->Fence = ++mCurrentFence;
-    m_commandQueue->Signal(m_fence.Get(), mCurrentFence);
+    mGraphics->Signal(mCurrentFence);
+
+    if(mCapture->HasCompletedCapture())
+    {
+        if(!SaveCommandCapture(mCapture->TakeCapture(), mCapturePath))
+            std::cout << "failed to write capture " << mCapturePath << std::endl;
+    }
+}
+
+void Renderer::CaptureFrames(UINT frameCount, const std::string& path)
+{
+    //按每个渲染项约 128 字节命令、加上每帧上传的各块常量预留捕获内存
+    FrameResource* frame = mCurrFrameResource;
+    size_t uploadBytes = (size_t)(frame->DynamicObjectBuffer.Size + frame->StaticPatchStaging.Size + frame->InstanceBuffer.Size +
+        frame->MaterialBuffer.Size + frame->PassCB.Size + frame->IndirectArgs.Size);
+    size_t commandBytes = mRenderItems.Size() * 128;
+    size_t bytesPerFrame = commandBytes + uploadBytes + 4096;
+    //各命令列表分到的实例组大致相同
+    size_t bytesPerList = commandBytes / frame->CmdLists.size() + 4096;
+
+    mCapturePath = path;
+    mCapture->BeginCapture(frameCount, bytesPerFrame * frameCount, bytesPerList);
+}
+
+
+void Renderer::StreamMeshGeometryAsync(std::unique_ptr<MeshGeometry> geo,
+    std::vector<BYTE> vertexData, std::vector<BYTE> indexData, ShadowCopyPolicy shadowPolicy)
+{
+    // std::function 需要可复制，所以用 shared_ptr 把数据带进回调
+    auto sharedGeo = std::shared_ptr<MeshGeometry>(std::move(geo));
+    auto vertices = std::make_shared<std::vector<BYTE>>(std::move(vertexData));
+    auto indices = std::make_shared<std::vector<BYTE>>(std::move(indexData));
+
+    StreamRequest request;
+    request.ByteSize = vertices->size() + indices->size();
+
+    // 渲染线程上执行：分配显存并录制到复制队列。顶点和索引数据看作连续的一段，
+    // [0, 顶点字节数) 是顶点、之后是索引；大几何体会被拆到几帧里录制，每次录制其中一段
+    request.RecordRange = [this, sharedGeo, vertices, indices, shadowPolicy](std::uint64_t firstByte, std::uint64_t byteCount)
+    {
+        UploadBatcher& uploader = mCopyStreamer->Uploader();
+        if(firstByte == 0)
+        {
+            sharedGeo->VertexBufferGPU = mBufferAllocator->CreatePlacedResource(
+                CD3DX12_RESOURCE_DESC::Buffer(vertices->size()), D3D12_RESOURCE_STATE_COMMON, nullptr, sharedGeo->VertexBufferAllocation);
+            sharedGeo->IndexBufferGPU = mBufferAllocator->CreatePlacedResource(
+                CD3DX12_RESOURCE_DESC::Buffer(indices->size()), D3D12_RESOURCE_STATE_COMMON, nullptr, sharedGeo->IndexBufferAllocation);
+            sharedGeo->VertexBufferByteSize = (UINT)vertices->size();
+            sharedGeo->IndexBufferByteSize = (UINT)indices->size();
+        }
+
+        std::uint64_t vertexBytes = vertices->size();
+        std::uint64_t lastByte = firstByte + byteCount;
+        if(firstByte < vertexBytes)
+        {
+            std::uint64_t end = (std::min)(lastByte, vertexBytes);
+            uploader.UploadBuffer(sharedGeo->VertexBufferGPU.Get(), firstByte, vertices->data() + firstByte,
+                end - firstByte, D3D12_RESOURCE_STATE_GENERIC_READ);
+        }
+        if(lastByte > vertexBytes)
+        {
+            std::uint64_t begin = (std::max)(firstByte, vertexBytes) - vertexBytes;
+            uploader.UploadBuffer(sharedGeo->IndexBufferGPU.Get(), begin, indices->data() + begin,
+                lastByte - vertexBytes - begin, D3D12_RESOURCE_STATE_GENERIC_READ);
+        }
+
+        //最后一段录制完，上传数据都已经复制进暂存环，CPU端副本按策略保留
+        if(lastByte == vertexBytes + indices->size())
+        {
+            sharedGeo->VertexBufferCPU.Store(vertices->data(), vertices->size(), shadowPolicy, sharedGeo->VertexByteStride);
+            sharedGeo->IndexBufferCPU.Store(indices->data(), indices->size(), shadowPolicy,
+                sharedGeo->IndexFormat == DXGI_FORMAT_R32_UINT ? 4 : 2);
+            vertices->clear();
+            vertices->shrink_to_fit();
+            indices->clear();
+            indices->shrink_to_fit();
+        }
+    };
+
+    // 复制围栏完成后才加入 mGeometries，渲染项从这时起才能引用它
+    request.OnResident = [this, sharedGeo]()
+    {
+        auto resident = std::make_unique<MeshGeometry>(std::move(*sharedGeo));
+        MeshGeometry* geoPtr = resident.get();
+        resident->ResidencyId = mResidency->Track(MemoryCategory::Geometry,
+            resident->VertexBufferAllocation.Size + resident->IndexBufferAllocation.Size,
+            true, [this, geoPtr]() { EvictGeometry(geoPtr); });
+
+        NamedResourceId id = ResourceIdFromString(resident->Name);
+        std::uint32_t index = mGeometries.IndexOf(id);
+        if(index == ResourceRegistry<std::unique_ptr<MeshGeometry>>::InvalidIndex)
+        {
+            resident->SortId = mNextGeometrySortId++;
+            mGeometries.Add(id, std::move(resident));
+        }
+        else
+        {
+            auto& slot = mGeometries.At(index);
+            resident->SortId = slot->SortId;
+            //替换同名几何体：渲染项改为引用新的，旧的等之前的帧都完成后再释放；实例组按几何体地址分组，要重新分
+            for(size_t i = 0; i < mRenderItems.Size(); ++i)
+            {
+                RenderItem& ritem = mRenderItems.ColdAt(i);
+                if(ritem.Geo == slot.get())
+                    ritem.Geo = resident.get();
+            }
+            ++mDrawListGeneration;
+            DeferReleaseGeometry(std::move(slot));
+            slot = std::move(resident);
+        }
+    };
+
+    mStreaming->Enqueue(std::move(request));
 }
 
+void Renderer::DeferReleaseGeometry(std::unique_ptr<MeshGeometry> geo)
+{
+    //已提交的最后一帧的围栏值：本帧还没有提交，且不会再引用它
+    UINT64 lastUseFence = mCurrentFence;
+
+    //注销后它不会再被驱逐回调引用
+    mResidency->Untrack(geo->ResidencyId);
+    geo->ResidencyId = ResidencyManager::InvalidId;
+
+    //同一个回调里先释放放置资源本身，再把它在堆中的位置还给分配器
+    //（std::function 需要可复制，所以用 shared_ptr 持有几何体）
+    auto sharedGeo = std::shared_ptr<MeshGeometry>(std::move(geo));
+    mDeferredRelease.EnqueueCallback(lastUseFence, [this, sharedGeo]() mutable
+    {
+        PoolAllocation vertexAlloc = sharedGeo->VertexBufferAllocation;
+        PoolAllocation indexAlloc = sharedGeo->IndexBufferAllocation;
+        sharedGeo.reset();
+
+        mBufferAllocator->Free(vertexAlloc);
+        mBufferAllocator->Free(indexAlloc);
+    });
+}
+
+void Renderer::EvictGeometry(MeshGeometry* geo)
+{
+    //ResidencyManager 在驱逐时已经注销了这个登记
+    geo->ResidencyId = ResidencyManager::InvalidId;
+
+    auto evicted = std::make_unique<MeshGeometry>();
+    evicted->VertexBufferGPU = std::move(geo->VertexBufferGPU);
+    evicted->IndexBufferGPU = std::move(geo->IndexBufferGPU);
+    evicted->VertexBufferAllocation = geo->VertexBufferAllocation;
+    evicted->IndexBufferAllocation = geo->IndexBufferAllocation;
+    geo->VertexBufferAllocation = PoolAllocation();
+    geo->IndexBufferAllocation = PoolAllocation();
+
+    DeferReleaseGeometry(std::move(evicted));
+}
 
 void Renderer::BuildFrameResources()
 {
+    //按当前的渲染项和材质数量确定上传环的初始大小，之后不够时在 Update 里增长
+    UINT64 ringByteSize = (std::max)(FrameUploadRingByteSize, FrameConstantsByteSize());
     for(int i = 0; i < gNumFrameResources; ++i)
     {
-        mFrameResources.push_back(std::make_unique<FrameResource>(m_device.Get(),
-            1, (UINT)mAllRitems.size(),(UINT)mMaterials.size()));
+        auto frame = std::make_unique<FrameResource>(m_device.Get(), *mGraphics, ringByteSize,
+            std::min(mJobs->ThreadCount(), MaxRecordingLists));
+        frame->UploadRingResidencyId = mResidency->Track(MemoryCategory::UploadHeap, frame->UploadRing->Allocator().Capacity());
+        mFrameResources.push_back(std::move(frame));
     }
 }
 
@@ -858,15 +1500,8 @@ void Renderer::FlushCommandQueue()
 {
     mCurrentFence++;
 
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), mCurrentFence));
-
-    if (m_fence->GetCompletedValue() < mCurrentFence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, FALSE, FALSE, EVENT_ALL_ACCESS);
-        ThrowIfFailed(m_fence->SetEventOnCompletion(mCurrentFence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    mGraphics->Signal(mCurrentFence);
+    mGraphics->WaitForFenceValue(mCurrentFence);
 }
 
 void Renderer::ProcessInput()
@@ -914,6 +1549,8 @@ void Renderer::ProcessInput()
 void Renderer::OnKeyboardInput()
 {
     const float dt = 0.003f;
+	const float oldSunTheta = sunTheta;
+	const float oldSunPhi = sunPhi;
 	//左右键改变平行光的Theta角，上下键改变平行光的Phi角
 	if (GetAsyncKeyState(VK_LEFT) & 0x8000)
 		sunTheta -= 1.0f * dt;
@@ -926,4 +1563,22 @@ void Renderer::OnKeyboardInput()
 
 	//将Phi约束在[0, PI/2]之间
 	sunPhi = MathHelper::Clamp(sunPhi, 0.1f, XM_PIDIV2);
+
+	//光照变了，常量缓冲区要重写
+	if (sunTheta != oldSunTheta || sunPhi != oldSunPhi)
+		++mPassGeneration;
+
+	//F8 切换间接绘制
+	if (GetAsyncKeyState(VK_F8) & 0x0001)
+		mIndirectDraws = !mIndirectDraws;
+
+	//F10 切换视锥剔除，可见列表要重新生成
+	if (GetAsyncKeyState(VK_F10) & 0x0001){
+		mFrustumCulling = !mFrustumCulling;
+		++mDrawListGeneration;
+	}
+
+	//F9 捕获接下来 60 帧的命令流
+	if ((GetAsyncKeyState(VK_F9) & 0x0001) && !mCapture->IsCapturing())
+		CaptureFrames(60, "capture.d3dcap");
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "ResidencyManager.h"
+
+const char* MemoryCategoryName(MemoryCategory category)
+{
+    switch(category)
+    {
+    case MemoryCategory::Geometry:   return "Geometry";
+    case MemoryCategory::Texture:    return "Texture";
+    case MemoryCategory::UploadHeap: return "UploadHeap";
+    case MemoryCategory::Other:      return "Other";
+    default:                         return "Unknown";
+    }
+}
+
+ResidencyManager::ResidencyManager(BudgetSource& source, float highWatermark, float lowWatermark, std::uint64_t minIdleFrames) :
+    mSource(source),
+    mHighWatermark(highWatermark),
+    mLowWatermark(lowWatermark < highWatermark ? lowWatermark : highWatermark),
+    mMinIdleFrames(minIdleFrames)
+{
+}
+
+std::uint32_t ResidencyManager::Track(MemoryCategory category, std::uint64_t byteSize, bool streamable, std::function<void()> evict)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    std::uint32_t id;
+    if(!mFreeIds.empty())
+    {
+        id = mFreeIds.back();
+        mFreeIds.pop_back();
+    }
+    else
+    {
+        id = (std::uint32_t)mEntries.size();
+        mEntries.emplace_back();
+    }
+
+    Entry& entry = mEntries[id];
+    entry.Category = category;
+    entry.ByteSize = byteSize;
+    entry.LastUsedFrame = mFrame;
+    entry.Evict = std::move(evict);
+    entry.Alive = true;
+    entry.Streamable = streamable;
+    if(streamable)
+        LinkBack(id);
+
+    CategoryUsage& usage = mStats.Categories[(size_t)category];
+    usage.Bytes += byteSize;
+    usage.Count++;
+    mStats.TrackedBytes += byteSize;
+
+    return id;
+}
+
+void ResidencyManager::Untrack(std::uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(id < mEntries.size() && mEntries[id].Alive)
+        Release(id);
+}
+
+void ResidencyManager::Touch(std::uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(id >= mEntries.size() || !mEntries[id].Alive)
+        return;
+
+    Entry& entry = mEntries[id];
+    if(entry.LastUsedFrame == mFrame)
+        return;
+
+    entry.LastUsedFrame = mFrame;
+    if(entry.Streamable)
+    {
+        Unlink(id);
+        LinkBack(id);
+    }
+}
+
+std::uint64_t ResidencyManager::Update()
+{
+    MemoryBudget budget = mSource.Query();
+
+    std::vector<std::function<void()>> evictions;
+    std::uint64_t evictedBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFrame++;
+        mStats.LastBudget = budget;
+
+        std::uint64_t high = (std::uint64_t)(budget.Budget * (double)mHighWatermark);
+        std::uint64_t low = (std::uint64_t)(budget.Budget * (double)mLowWatermark);
+
+        if(budget.Budget != 0 && mStats.TrackedBytes > high)
+        {
+            // 从最久未使用的开始驱逐，遇到最近 mMinIdleFrames 帧内用过的就停止（后面的都更新）
+            while(mLruHead != InvalidId && mStats.TrackedBytes > low)
+            {
+                Entry& entry = mEntries[mLruHead];
+                if(entry.LastUsedFrame + mMinIdleFrames > mFrame)
+                    break;
+
+                CategoryUsage& usage = mStats.Categories[(size_t)entry.Category];
+                usage.EvictedBytes += entry.ByteSize;
+                usage.Evictions++;
+                evictedBytes += entry.ByteSize;
+
+                if(entry.Evict)
+                    evictions.push_back(std::move(entry.Evict));
+                Release(mLruHead);
+            }
+        }
+    }
+
+    // 驱逐回调可能再调用 Track/Untrack，所以在锁外执行
+    for(auto& evict : evictions)
+        evict();
+
+    return evictedBytes;
+}
+
+bool ResidencyManager::IsTracked(std::uint32_t id) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return id < mEntries.size() && mEntries[id].Alive;
+}
+
+ResidencyManager::CategoryUsage ResidencyManager::GetCategoryUsage(MemoryCategory category) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats.Categories[(size_t)category];
+}
+
+ResidencyManager::Stats ResidencyManager::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+std::uint64_t ResidencyManager::TrackedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats.TrackedBytes;
+}
+
+void ResidencyManager::LinkBack(std::uint32_t id)
+{
+    Entry& entry = mEntries[id];
+    entry.Prev = mLruTail;
+    entry.Next = InvalidId;
+    if(mLruTail != InvalidId)
+        mEntries[mLruTail].Next = id;
+    else
+        mLruHead = id;
+    mLruTail = id;
+}
+
+void ResidencyManager::Unlink(std::uint32_t id)
+{
+    Entry& entry = mEntries[id];
+    if(entry.Prev != InvalidId)
+        mEntries[entry.Prev].Next = entry.Next;
+    else
+        mLruHead = entry.Next;
+
+    if(entry.Next != InvalidId)
+        mEntries[entry.Next].Prev = entry.Prev;
+    else
+        mLruTail = entry.Prev;
+
+    entry.Prev = InvalidId;
+    entry.Next = InvalidId;
+}
+
+void ResidencyManager::Release(std::uint32_t id)
+{
+    Entry& entry = mEntries[id];
+    if(entry.Streamable)
+        Unlink(id);
+
+    CategoryUsage& usage = mStats.Categories[(size_t)entry.Category];
+    usage.Bytes -= entry.ByteSize;
+    usage.Count--;
+    mStats.TrackedBytes -= entry.ByteSize;
+
+    entry.Alive = false;
+    entry.Streamable = false;
+    entry.Evict = nullptr;
+    mFreeIds.push_back(id);
+}
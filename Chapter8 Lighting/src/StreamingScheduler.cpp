@@ -0,0 +1,178 @@
+#include "StreamingScheduler.h"
+#include <algorithm>
+
+StreamingScheduler::StreamingScheduler(StreamingQueue& queue, std::uint64_t maxBytesPerPump, std::uint64_t maxBytesInFlight) :
+    mQueue(queue),
+    mMaxBytesPerPump(maxBytesPerPump),
+    mMaxBytesInFlight(maxBytesInFlight)
+{
+}
+
+std::uint64_t StreamingScheduler::Enqueue(StreamRequest request)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.push_back(std::move(request));
+    return ++mStats.Enqueued;
+}
+
+std::uint64_t StreamingScheduler::RecordBudget() const
+{
+    std::uint64_t budget = ~0ull;
+    if(mMaxBytesPerPump != 0)
+        budget = mMaxBytesPerPump;
+    if(mMaxBytesInFlight != 0)
+        budget = std::min(budget, mMaxBytesInFlight > mInFlightBytes ? mMaxBytesInFlight - mInFlightBytes : 0);
+    return budget;
+}
+
+void StreamingScheduler::RecordPartial(std::uint64_t budget, std::uint64_t& recordedBytes, std::vector<InFlight>& recorded)
+{
+    std::uint64_t remaining = mPartial.Request.ByteSize - mPartial.RecordedBytes;
+    std::uint64_t count = std::min(remaining, budget - recordedBytes);
+    if(count == 0)
+        return;
+
+    mPartial.Request.RecordRange(mPartial.RecordedBytes, count);
+    mPartial.RecordedBytes += count;
+    recordedBytes += count;
+
+    InFlight part;
+    part.ByteSize = count;
+    part.CompletesRequest = mPartial.RecordedBytes == mPartial.Request.ByteSize;
+    if(part.CompletesRequest)
+    {
+        part.OnResident = std::move(mPartial.Request.OnResident);
+        mPartial = PartialRequest();
+    }
+    recorded.push_back(std::move(part));
+}
+
+std::uint32_t StreamingScheduler::Pump()
+{
+    // 先回收已完成的批次，腾出在途字节的额度
+    std::uint32_t madeResident = RetireCompleted();
+
+    std::uint64_t budget = RecordBudget();
+    std::uint64_t recordedBytes = 0;
+    std::vector<InFlight> recorded;
+
+    // 上次没录完的请求排在最前面，录完之前不开始新的请求，保持先进先出
+    if(mPartial.Active)
+        RecordPartial(budget, recordedBytes, recorded);
+
+    if(!mPartial.Active)
+    {
+        // 把放得下的新请求整体取出来，录制时不持有锁，加载线程不会被阻塞
+        std::vector<StreamRequest> batch;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            std::uint64_t takenBytes = 0;
+            while(!mPending.empty())
+            {
+                StreamRequest& next = mPending.front();
+                std::uint64_t room = budget - recordedBytes - takenBytes;
+                if(next.ByteSize <= room)
+                {
+                    takenBytes += next.ByteSize;
+                    batch.push_back(std::move(next));
+                    mPending.pop_front();
+                    continue;
+                }
+
+                if(next.RecordRange && room > 0)
+                {
+                    // 拆开录制：这次先录放得下的部分，剩下的留给之后的 Pump
+                    mPartial.Request = std::move(next);
+                    mPartial.RecordedBytes = 0;
+                    mPartial.Active = true;
+                    mPending.pop_front();
+                    mStats.SplitRequests++;
+                }
+                else if(!next.RecordRange && batch.empty() && recordedBytes == 0 && mInFlight.empty())
+                {
+                    // 不能拆分又超出上限：等复制队列空闲、暂存环全空时单独录制
+                    batch.push_back(std::move(next));
+                    mPending.pop_front();
+                }
+                break;
+            }
+        }
+
+        for(StreamRequest& request : batch)
+        {
+            if(request.RecordRange)
+                request.RecordRange(0, request.ByteSize);
+            else if(request.Record)
+                request.Record();
+
+            InFlight inFlight;
+            inFlight.ByteSize = request.ByteSize;
+            inFlight.OnResident = std::move(request.OnResident);
+            recorded.push_back(std::move(inFlight));
+            recordedBytes += request.ByteSize;
+        }
+
+        if(mPartial.Active)
+            RecordPartial(budget, recordedBytes, recorded);
+    }
+
+    if(!recorded.empty())
+    {
+        std::uint64_t fence = mQueue.Submit();
+        std::uint64_t completedRequests = 0;
+        for(InFlight& inFlight : recorded)
+        {
+            inFlight.FenceValue = fence;
+            mInFlightBytes += inFlight.ByteSize;
+            completedRequests += inFlight.CompletesRequest ? 1 : 0;
+            mInFlight.push_back(std::move(inFlight));
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.Submitted += completedRequests;
+        mStats.BytesSubmitted += recordedBytes;
+        mStats.Batches++;
+    }
+
+    return madeResident + RetireCompleted();
+}
+
+std::uint32_t StreamingScheduler::RetireCompleted()
+{
+    // 只查询围栏，不等待
+    std::uint32_t madeResident = 0;
+    std::uint64_t completed = mQueue.CompletedValue();
+    while(!mInFlight.empty() && mInFlight.front().FenceValue <= completed)
+    {
+        InFlight& front = mInFlight.front();
+        if(front.OnResident)
+            front.OnResident();
+
+        if(front.FenceValue > mResidentFence)
+            mResidentFence = front.FenceValue;
+
+        mInFlightBytes -= front.ByteSize;
+        madeResident += front.CompletesRequest ? 1 : 0;
+        mInFlight.pop_front();
+    }
+
+    if(madeResident != 0)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.Resident += madeResident;
+    }
+    return madeResident;
+}
+
+bool StreamingScheduler::Idle() const
+{
+    // mInFlight 和 mPartial 只在渲染线程访问，所以 Idle 也只应在渲染线程调用
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending.empty() && mInFlight.empty() && !mPartial.Active;
+}
+
+StreamingScheduler::Stats StreamingScheduler::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
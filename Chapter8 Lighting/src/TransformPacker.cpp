@@ -0,0 +1,160 @@
+#include "TransformPacker.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <immintrin.h>
+    #define TP_HAS_SSE 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        // MSVC 不需要 /arch:AVX 就能使用 AVX 内建函数
+        #define TP_AVX_TARGET
+    #else
+        #define TP_AVX_TARGET __attribute__((target("avx")))
+    #endif
+#else
+    #define TP_HAS_SSE 0
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // 物体表里一个元素是 12 个 float，源矩阵是 16 个 float
+    static_assert(sizeof(ObjectConstants) == 12 * sizeof(float), "ObjectConstants 必须是紧密的 3x4 矩阵");
+    static_assert(sizeof(XMFLOAT4X4) == 16 * sizeof(float), "XMFLOAT4X4 必须是紧密的 4x4 矩阵");
+
+    // 预取多少个物体之后的源矩阵
+    constexpr std::size_t PrefetchDistance = 8;
+
+    // 参考实现：out 的第 r 行是 world 的第 r 列
+    inline void PackScalar(const XMFLOAT4X4& world, ObjectConstants& out)
+    {
+        const float* src = &world.m[0][0];
+        float* dst = reinterpret_cast<float*>(&out);
+        for(int r = 0; r < 3; ++r)
+        {
+            for(int c = 0; c < 4; ++c)
+                dst[r * 4 + c] = src[c * 4 + r];
+        }
+    }
+
+#if TP_HAS_SSE
+    // 源矩阵分散在各个渲染项里，提前预取 PrefetchDistance 个物体之后的矩阵
+    inline void PrefetchWorld(const XMFLOAT4X4* const* worlds, std::size_t i, std::size_t count)
+    {
+        if(i + PrefetchDistance < count)
+            _mm_prefetch(reinterpret_cast<const char*>(worlds[i + PrefetchDistance]), _MM_HINT_T0);
+    }
+
+    inline void PackSse(const XMFLOAT4X4& world, ObjectConstants* out)
+    {
+        const float* src = &world.m[0][0];
+        __m128 r0 = _mm_loadu_ps(src);
+        __m128 r1 = _mm_loadu_ps(src + 4);
+        __m128 r2 = _mm_loadu_ps(src + 8);
+        __m128 r3 = _mm_loadu_ps(src + 12);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        // 转置后的第 4 行恒为 (0,0,0,1)，不写
+        float* dst = reinterpret_cast<float*>(out);
+        _mm_stream_ps(dst, r0);
+        _mm_stream_ps(dst + 4, r1);
+        _mm_stream_ps(dst + 8, r2);
+    }
+
+    // 两个矩阵一起转置：a 在低 128 位，b 在高 128 位。
+    // 输出 [a.c0 a.c1][a.c2 b.c0][b.c1 b.c2] 正好是相邻两个 ObjectConstants 的 96 字节，dst 必须 32 字节对齐
+    TP_AVX_TARGET inline void PackPairAvx(const XMFLOAT4X4& a, const XMFLOAT4X4& b, ObjectConstants* out)
+    {
+        const float* sa = &a.m[0][0];
+        const float* sb = &b.m[0][0];
+        __m256 v0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(sa)), _mm_loadu_ps(sb), 1);
+        __m256 v1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(sa + 4)), _mm_loadu_ps(sb + 4), 1);
+        __m256 v2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(sa + 8)), _mm_loadu_ps(sb + 8), 1);
+        __m256 v3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(sa + 12)), _mm_loadu_ps(sb + 12), 1);
+
+        // 每个 128 位通道内做与 _MM_TRANSPOSE4_PS 相同的转置，只算需要的前 3 列
+        __m256 t0 = _mm256_unpacklo_ps(v0, v1);
+        __m256 t1 = _mm256_unpacklo_ps(v2, v3);
+        __m256 t2 = _mm256_unpackhi_ps(v0, v1);
+        __m256 t3 = _mm256_unpackhi_ps(v2, v3);
+        __m256 c0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 c1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 c2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+
+        float* dst = reinterpret_cast<float*>(out);
+        _mm256_stream_ps(dst, _mm256_permute2f128_ps(c0, c1, 0x20));
+        _mm256_stream_ps(dst + 8, _mm256_permute2f128_ps(c2, c0, 0x30));
+        _mm256_stream_ps(dst + 16, _mm256_permute2f128_ps(c1, c2, 0x31));
+    }
+
+    TP_AVX_TARGET void PackContiguousAvx(const XMFLOAT4X4* const* worlds, std::size_t count, ObjectConstants* dst)
+    {
+        std::size_t i = 0;
+        // 16 字节对齐但不是 32 字节对齐时先单独写一个，之后每两个物体 96 字节，对齐保持不变
+        if(count != 0 && (reinterpret_cast<std::uintptr_t>(dst) & 31) != 0)
+        {
+            PackSse(*worlds[0], dst);
+            i = 1;
+        }
+
+        for(; i + 4 <= count; i += 4)
+        {
+            for(std::size_t k = 0; k < 4; ++k)
+                PrefetchWorld(worlds, i + k, count);
+            PackPairAvx(*worlds[i], *worlds[i + 1], dst + i);
+            PackPairAvx(*worlds[i + 2], *worlds[i + 3], dst + i + 2);
+        }
+        for(; i < count; ++i)
+            PackSse(*worlds[i], dst + i);
+    }
+#endif
+}
+
+void PackObjectWorlds(const XMFLOAT4X4* const* worlds, std::size_t count, ObjectConstants* dst, SimdPath path)
+{
+#if TP_HAS_SSE
+    if((reinterpret_cast<std::uintptr_t>(dst) & 15) == 0)
+    {
+        if(path == SimdPath::Avx)
+        {
+            PackContiguousAvx(worlds, count, dst);
+            return;
+        }
+        if(path == SimdPath::Sse)
+        {
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                PrefetchWorld(worlds, i, count);
+                PackSse(*worlds[i], dst + i);
+            }
+            return;
+        }
+    }
+#else
+    (void)path;
+#endif
+
+    for(std::size_t i = 0; i < count; ++i)
+        PackScalar(*worlds[i], dst[i]);
+}
+
+void PackObjectWorldsScattered(const XMFLOAT4X4* const* worlds, std::size_t count,
+    ObjectConstants* dstBase, const std::uint32_t* dstSlots, SimdPath path)
+{
+    // 槽位不相邻，没法两个物体合成一次 32 字节存储，AVX 也走每个矩阵一次转置的 SSE 路径
+#if TP_HAS_SSE
+    if(path != SimdPath::Scalar && (reinterpret_cast<std::uintptr_t>(dstBase) & 15) == 0)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            PrefetchWorld(worlds, i, count);
+            PackSse(*worlds[i], dstBase + dstSlots[i]);
+        }
+        return;
+    }
+#else
+    (void)path;
+#endif
+
+    for(std::size_t i = 0; i < count; ++i)
+        PackScalar(*worlds[i], dstBase[dstSlots[i]]);
+}
@@ -0,0 +1,298 @@
+#include "UploadBatcher.h"
+#include "WriteCombined.h"
+#include <stdexcept>
+
+using Microsoft::WRL::ComPtr;
+
+UploadBatcher::UploadBatcher(ID3D12Device* device, ID3D12CommandQueue* queue, UINT64 stagingByteSize, UINT64 batchByteSize) :
+    mDevice(device),
+    mQueue(queue),
+    mStagingByteSize(stagingByteSize),
+    mBatchByteSize(batchByteSize),
+    mRing(stagingByteSize)
+{
+    mListType = queue->GetDesc().Type;
+
+    ThrowIfFailed(mDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+}
+
+UploadBatcher::~UploadBatcher()
+{
+    if(mFence != nullptr)
+        WaitIdle();
+
+    if(mStaging != nullptr)
+        mStaging->Unmap(0, nullptr);
+}
+
+void UploadBatcher::EnsureStaging()
+{
+    if(mStaging != nullptr)
+        return;
+
+    ThrowIfFailed(mDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(mStagingByteSize),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&mStaging)));
+
+    ThrowIfFailed(mStaging->Map(0, nullptr, reinterpret_cast<void**>(&mStagingData)));
+    mRing = FencedRingAllocator(mStagingByteSize);
+}
+
+UINT64 UploadBatcher::AllocateStaging(UINT64 byteSize, UINT64 alignment)
+{
+    EnsureStaging();
+
+    UINT64 offset = mRing.Allocate(byteSize, alignment);
+    if(offset != FencedRingAllocator::InvalidOffset)
+        return offset;
+
+    // 暂存环满了：先把当前批次提交出去，再按提交顺序等待最旧的批次完成
+    Submit();
+    RetireCompleted();
+    offset = mRing.Allocate(byteSize, alignment);
+    while(offset == FencedRingAllocator::InvalidOffset && mRing.HasInFlightBatches())
+    {
+        WaitForFence(mRing.OldestFence());
+        offset = mRing.Allocate(byteSize, alignment);
+    }
+
+    if(offset == FencedRingAllocator::InvalidOffset)
+        throw std::runtime_error("UploadBatcher: upload does not fit in the staging ring");
+
+    return offset;
+}
+
+void UploadBatcher::TrackResource(ID3D12Resource* dest, D3D12_RESOURCE_STATES stateAfter)
+{
+    auto it = mPendingResourceIndex.find(dest);
+    if(it != mPendingResourceIndex.end())
+    {
+        mPendingStates[it->second] = stateAfter;
+        return;
+    }
+
+    mPendingResourceIndex[dest] = mPendingResources.size();
+    mPendingResources.push_back(dest);
+    mPendingStates.push_back(stateAfter);
+}
+
+void UploadBatcher::UploadBuffer(ID3D12Resource* dest, UINT64 destOffset, const void* data, UINT64 byteSize,
+    D3D12_RESOURCE_STATES stateAfter)
+{
+    const BYTE* src = static_cast<const BYTE*>(data);
+
+    // 大缓冲区按暂存环容量分块，每块一条 CopyBufferRegion
+    UINT64 maxChunk = mStagingByteSize / 2;
+    while(byteSize > 0)
+    {
+        UINT64 chunk = byteSize < maxChunk ? byteSize : maxChunk;
+        UINT64 srcOffset = AllocateStaging(chunk, 16);
+
+        WriteCombined::StreamCopy(mStagingData + srcOffset, src, (size_t)chunk);
+
+        PendingCopy copy;
+        copy.Dest = dest;
+        copy.DestOffset = destOffset;
+        copy.SrcOffset = srcOffset;
+        copy.ByteSize = chunk;
+        mPendingCopies.push_back(copy);
+        TrackResource(dest, stateAfter);
+
+        src += chunk;
+        destOffset += chunk;
+        byteSize -= chunk;
+        mPendingBytes += chunk;
+        mStats.BytesUploaded += chunk;
+
+        if(mPendingBytes >= mBatchByteSize)
+            Submit();
+    }
+    WriteCombined::Fence();
+}
+
+void UploadBatcher::UploadTexture(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources,
+    const D3D12_SUBRESOURCE_DATA* srcData, D3D12_RESOURCE_STATES stateAfter)
+{
+    D3D12_RESOURCE_DESC desc = dest->GetDesc();
+
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
+    std::vector<UINT> numRows(numSubresources);
+    std::vector<UINT64> rowSizes(numSubresources);
+    UINT64 totalBytes = 0;
+    mDevice->GetCopyableFootprints(&desc, firstSubresource, numSubresources, 0,
+        layouts.data(), numRows.data(), rowSizes.data(), &totalBytes);
+
+    UINT64 baseOffset = AllocateStaging(totalBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+    for(UINT i = 0; i < numSubresources; ++i)
+    {
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = layouts[i];
+        footprint.Offset += baseOffset;
+
+        // 逐行写入，目标行距按 D3D12_TEXTURE_DATA_PITCH_ALIGNMENT 对齐
+        for(UINT z = 0; z < footprint.Footprint.Depth; ++z)
+        {
+            BYTE* dstSlice = mStagingData + footprint.Offset + (UINT64)footprint.Footprint.RowPitch * numRows[i] * z;
+            const BYTE* srcSlice = static_cast<const BYTE*>(srcData[i].pData) + srcData[i].SlicePitch * z;
+            for(UINT row = 0; row < numRows[i]; ++row)
+            {
+                WriteCombined::StreamCopy(dstSlice + (UINT64)footprint.Footprint.RowPitch * row,
+                    srcSlice + srcData[i].RowPitch * row, (size_t)rowSizes[i]);
+            }
+        }
+
+        PendingCopy copy;
+        copy.Dest = dest;
+        copy.IsTexture = true;
+        copy.Subresource = firstSubresource + i;
+        copy.Footprint = footprint;
+        mPendingCopies.push_back(copy);
+    }
+    WriteCombined::Fence();
+
+    TrackResource(dest, stateAfter);
+    mPendingBytes += totalBytes;
+    mStats.BytesUploaded += totalBytes;
+
+    if(mPendingBytes >= mBatchByteSize)
+        Submit();
+}
+
+ID3D12CommandAllocator* UploadBatcher::AcquireAllocator()
+{
+    UINT64 completed = mFence->GetCompletedValue();
+    for(auto& ctx : mContexts)
+    {
+        if(ctx.FenceValue <= completed)
+        {
+            ThrowIfFailed(ctx.Allocator->Reset());
+            ctx.FenceValue = mFenceValue + 1;
+            return ctx.Allocator.Get();
+        }
+    }
+
+    CommandContext ctx;
+    ThrowIfFailed(mDevice->CreateCommandAllocator(mListType, IID_PPV_ARGS(ctx.Allocator.GetAddressOf())));
+    ctx.FenceValue = mFenceValue + 1;
+    mContexts.push_back(ctx);
+    return mContexts.back().Allocator.Get();
+}
+
+UINT64 UploadBatcher::Submit()
+{
+    if(mPendingCopies.empty())
+        return mFenceValue;
+
+    ID3D12CommandAllocator* allocator = AcquireAllocator();
+    if(mCommandList == nullptr)
+    {
+        ThrowIfFailed(mDevice->CreateCommandList(0, mListType, allocator, nullptr,
+            IID_PPV_ARGS(mCommandList.GetAddressOf())));
+    }
+    else
+    {
+        ThrowIfFailed(mCommandList->Reset(allocator, nullptr));
+    }
+
+    // 复制队列上只能使用 COMMON/COPY_* 状态：资源从 COMMON 隐式提升为 COPY_DEST，
+    // 执行完后又衰减回 COMMON，之后由图形队列隐式提升为读取状态，所以不需要屏障
+    bool recordBarriers = mListType != D3D12_COMMAND_LIST_TYPE_COPY;
+
+    // 整批资源的状态转换合并成一次 ResourceBarrier。
+    // 缓冲区在 ExecuteCommandLists 完成后会自动衰减回 COMMON，所以分到多个批次的大缓冲区也从 COMMON 开始
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    if(recordBarriers)
+    {
+        barriers.reserve(mPendingResources.size());
+        for(auto& resource : mPendingResources)
+        {
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource.Get(),
+                D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+        }
+        mCommandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+    }
+
+    for(const auto& copy : mPendingCopies)
+    {
+        if(copy.IsTexture)
+        {
+            CD3DX12_TEXTURE_COPY_LOCATION dst(copy.Dest, copy.Subresource);
+            CD3DX12_TEXTURE_COPY_LOCATION src(mStaging.Get(), copy.Footprint);
+            mCommandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        }
+        else
+        {
+            mCommandList->CopyBufferRegion(copy.Dest, copy.DestOffset, mStaging.Get(), copy.SrcOffset, copy.ByteSize);
+        }
+    }
+
+    if(recordBarriers)
+    {
+        barriers.clear();
+        for(size_t i = 0; i < mPendingResources.size(); ++i)
+        {
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(mPendingResources[i].Get(),
+                D3D12_RESOURCE_STATE_COPY_DEST, mPendingStates[i]));
+        }
+        mCommandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+        mStats.BarrierCalls += 2;
+    }
+
+    ThrowIfFailed(mCommandList->Close());
+    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+    mQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+
+    mFenceValue++;
+    ThrowIfFailed(mQueue->Signal(mFence.Get(), mFenceValue));
+
+    if(mRing.Used() > mStats.PeakStagingBytes)
+        mStats.PeakStagingBytes = mRing.Used();
+    mRing.FinishBatch(mFenceValue);
+    mStats.BatchesSubmitted++;
+
+    mPendingCopies.clear();
+    mPendingResources.clear();
+    mPendingStates.clear();
+    mPendingResourceIndex.clear();
+    mPendingBytes = 0;
+
+    return mFenceValue;
+}
+
+void UploadBatcher::RetireCompleted()
+{
+    mRing.Retire(mFence->GetCompletedValue());
+}
+
+void UploadBatcher::WaitForFence(UINT64 fenceValue)
+{
+    if(mFence->GetCompletedValue() < fenceValue)
+    {
+        HANDLE eventHandle = CreateEventEx(nullptr, FALSE, FALSE, EVENT_ALL_ACCESS);
+        ThrowIfFailed(mFence->SetEventOnCompletion(fenceValue, eventHandle));
+        WaitForSingleObject(eventHandle, INFINITE);
+        CloseHandle(eventHandle);
+    }
+    RetireCompleted();
+}
+
+void UploadBatcher::WaitIdle()
+{
+    Submit();
+    WaitForFence(mFenceValue);
+}
+
+void UploadBatcher::ReleaseStagingIfIdle()
+{
+    RetireCompleted();
+    if(mStaging == nullptr || !mRing.Empty() || !mPendingCopies.empty())
+        return;
+
+    mStaging->Unmap(0, nullptr);
+    mStaging = nullptr;
+    mStagingData = nullptr;
+}
@@ -1,5 +1,7 @@
 
 #include "d3dUtil.h"
+#include "GpuMemoryAllocator.h"
+#include "UploadBatcher.h"
 #include <comdef.h>
 #include <fstream>
 #include <iostream>
@@ -54,6 +56,38 @@ Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
         nullptr,
         IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
 
+    UploadToDefaultBuffer(device, cmdList, defaultBuffer.Get(), initData, byteSize, uploadBuffer);
+
+    return defaultBuffer;
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
+    GpuMemoryAllocator& allocator,
+    UploadBatcher& uploader,
+    const void* initData,
+    UINT64 byteSize,
+    PoolAllocation& allocation)
+{
+    // Place the default buffer inside one of the allocator's heaps.
+    ComPtr<ID3D12Resource> defaultBuffer = allocator.CreatePlacedResource(
+        CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+        D3D12_RESOURCE_STATE_COMMON,
+        nullptr,
+        allocation);
+
+    uploader.UploadBuffer(defaultBuffer.Get(), 0, initData, byteSize, D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    return defaultBuffer;
+}
+
+void d3dUtil::UploadToDefaultBuffer(
+    ID3D12Device* device,
+    ID3D12GraphicsCommandList* cmdList,
+    ID3D12Resource* defaultBuffer,
+    const void* initData,
+    UINT64 byteSize,
+    Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer)
+{
     // In order to copy CPU memory data into our default buffer, we need to create
     // an intermediate upload heap. 
     ThrowIfFailed(device->CreateCommittedResource(
@@ -74,18 +108,15 @@ Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     // Schedule to copy the data to the default buffer resource.  At a high level, the helper function UpdateSubresources
     // will copy the CPU memory into the intermediate upload heap.  Then, using ID3D12CommandList::CopySubresourceRegion,
     // the intermediate upload heap data will be copied to mBuffer.
-	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), 
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer, 
 		D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
-    UpdateSubresources<1>(cmdList, defaultBuffer.Get(), uploadBuffer.Get(), 0, 0, 1, &subResourceData);
-	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
+    UpdateSubresources<1>(cmdList, defaultBuffer, uploadBuffer.Get(), 0, 0, 1, &subResourceData);
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer,
 		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
 
     // Note: uploadBuffer has to be kept alive after the above function calls because
     // the command list has not been executed yet that performs the actual copy.
     // The caller can Release the uploadBuffer after it knows the copy has been executed.
-
-
-    return defaultBuffer;
 }
 
 ComPtr<ID3DBlob> d3dUtil::CompileShader(
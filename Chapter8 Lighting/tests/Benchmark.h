@@ -0,0 +1,51 @@
+/*
+基准测试用的小工具。基准程序只在命令行上手动运行并打印结果，不计入 ctest 的通过与否；
+ctest 里登记的是带 --quick 参数的冒烟运行，只用很小的规模跑一遍，保证基准程序本身不会坏掉。
+*/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Benchmark
+{
+    // 命令行里有 --quick 时只做冒烟运行
+    inline bool IsQuickRun(int argc, char** argv)
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            if(std::strcmp(argv[i], "--quick") == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // 重复 repeats 次取最快的一次，单位毫秒
+    template<typename Function>
+    double BestOfMs(int repeats, Function&& function)
+    {
+        double best = 1e30;
+        for(int r = 0; r < repeats; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    // 阻止编译器把只为计时而算出的结果优化掉（通常是一个校验和）。
+    // GCC/Clang 用一条空的内联汇编把值当作输入；MSVC 写进 volatile 变量再读回来
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(value) : "memory");
+#else
+        volatile T sink = value;
+        (void)sink;
+#endif
+    }
+}
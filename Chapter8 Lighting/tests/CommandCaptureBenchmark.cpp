@@ -0,0 +1,133 @@
+// 命令流捕获开销的基准：按 Renderer 的方式录制一帧（每个渲染项 6 条命令），比较直接录制、包一层
+// CaptureGraphicsDevice 但不捕获、正在捕获三种情况。内层后端分两种：NullGraphicsDevice 本身记录命令流，
+// 捕获只在提交时复制一次；OpaqueNullDevice 不暴露命令流（相当于 D3D12），捕获要逐条命令再写一份。
+// 每帧上传内容（每个渲染项 256 字节常量）的复制单独计时。开销都相对于同一后端直接录制的时间
+//
+//   CommandCaptureBenchmark [--quick]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "Benchmark.h"
+#include "CommandCapture.h"
+#include "NullGraphicsDevice.h"
+
+namespace
+{
+    class OpaqueNullCommandList : public NullCommandList
+    {
+    public:
+        const CommandStreamWriter* RecordedStream()const override { return nullptr; }
+    };
+
+    class OpaqueNullDevice : public NullGraphicsDevice
+    {
+    public:
+        std::unique_ptr<CommandList> CreateCommandList() override { return std::make_unique<OpaqueNullCommandList>(); }
+        bool RecordsCommandStreams()const override { return false; }
+    };
+
+    constexpr std::size_t CommandsPerItem = 6;
+    constexpr std::size_t ObjectConstantsSize = 256;
+
+    void RecordFrame(GraphicsDevice& device, CommandList& list, std::size_t itemCount, std::uint64_t fence)
+    {
+        list.Begin(0x1000);
+        for(std::size_t i = 0; i < itemCount; ++i)
+        {
+            list.SetVertexBuffer(VertexBufferBinding{ 0x8000000 + (i % 16) * 0x10000, 0x10000, 32 });
+            list.SetIndexBuffer(IndexBufferBinding{ 0x9000000 + (i % 16) * 0x1000, 0x1000, IndexFormat::R16Uint });
+            list.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+            list.SetGraphicsRootConstantBufferView(0, 0x7000000 + i * ObjectConstantsSize);
+            list.SetGraphicsRoot32BitConstant(3, (std::uint32_t)i, 0);
+            list.DrawIndexedInstanced(36, 1, 0, 0, (std::uint32_t)i);
+        }
+        list.End();
+        CommandList* lists[] = { &list };
+        device.ExecuteCommandLists(lists, 1);
+        device.Signal(fence);
+        device.WaitForFenceValue(fence);
+    }
+
+    struct Result
+    {
+        double Direct = 0.0;
+        double Idle = 0.0;
+        double Capturing = 0.0;
+        double Uploads = 0.0;
+    };
+
+    template<typename Backend>
+    Result Measure(std::size_t itemCount, int repeats, const std::vector<std::uint8_t>& uploads)
+    {
+        Result result;
+        std::uint64_t fence = 0;
+
+        Backend direct;
+        std::unique_ptr<CommandList> directList = direct.CreateCommandList();
+        RecordFrame(direct, *directList, itemCount, ++fence); // 预热，命令流的内存分配好
+        result.Direct = Benchmark::BestOfMs(repeats, [&]() { RecordFrame(direct, *directList, itemCount, ++fence); });
+
+        CaptureGraphicsDevice capture(std::make_unique<Backend>());
+        std::unique_ptr<CommandList> list = capture.CreateCommandList();
+        RecordFrame(capture, *list, itemCount, ++fence);
+        result.Idle = Benchmark::BestOfMs(repeats, [&]() { RecordFrame(capture, *list, itemCount, ++fence); });
+
+        // 与 Renderer::CaptureFrames 相同：按命令流和上传内容的预计大小预留，BeginCapture 不计时
+        const std::size_t listBytes = itemCount * 128;
+        const std::size_t reserveBytes = listBytes + uploads.size() + 4096;
+        result.Capturing = 1e30;
+        result.Uploads = 1e30;
+        for(int r = 0; r < repeats + 1; ++r)
+        {
+            capture.BeginCapture(1, reserveBytes, listBytes);
+            auto start = std::chrono::steady_clock::now();
+            capture.CaptureUpload(0x7000000, uploads.data(), uploads.size());
+            auto uploaded = std::chrono::steady_clock::now();
+            RecordFrame(capture, *list, itemCount, ++fence);
+            auto end = std::chrono::steady_clock::now();
+            CommandCapture taken = capture.TakeCapture();
+            Benchmark::DoNotOptimize(taken.Bytes.size());
+            // 第一次捕获时命令列表的命令流还要分配，算作预热
+            if(r > 0)
+            {
+                result.Uploads = std::min(result.Uploads, std::chrono::duration<double, std::milli>(uploaded - start).count());
+                result.Capturing = std::min(result.Capturing, std::chrono::duration<double, std::milli>(end - uploaded).count());
+            }
+        }
+        return result;
+    }
+
+    void Print(const char* backend, const Result& result, std::size_t commandCount)
+    {
+        auto row = [&](const char* variant, double ms)
+        {
+            std::printf("%-8s %-16s %8.3f  %8.2f  %+7.1f%%\n", backend, variant, ms, ms * 1e6 / commandCount,
+                (ms - result.Direct) * 100.0 / result.Direct);
+        };
+        row("direct", result.Direct);
+        row("wrapped, idle", result.Idle);
+        row("capturing", result.Capturing);
+        std::printf("%-8s %-16s %8.3f  %8.2f  %+7.1f%%\n", backend, "upload copy", result.Uploads,
+            result.Uploads * 1e6 / commandCount, result.Uploads * 100.0 / result.Direct);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::size_t itemCount = quick ? 2000 : 50000;
+    const int repeats = quick ? 1 : 20;
+    const std::size_t commandCount = itemCount * CommandsPerItem + 1;
+
+    std::vector<std::uint8_t> uploads(itemCount * ObjectConstantsSize);
+    for(std::size_t i = 0; i < uploads.size(); ++i)
+        uploads[i] = (std::uint8_t)i;
+
+    std::printf("%zu items, %zu commands per frame, %zu upload bytes\n", itemCount, commandCount, uploads.size());
+    std::printf("backend  variant                ms  ns/cmd   overhead\n");
+    Print("null", Measure<NullGraphicsDevice>(itemCount, repeats, uploads), commandCount);
+    Print("opaque", Measure<OpaqueNullDevice>(itemCount, repeats, uploads), commandCount);
+    return 0;
+}
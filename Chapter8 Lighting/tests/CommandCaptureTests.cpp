@@ -0,0 +1,261 @@
+// CommandCapture 的往返测试：通过 CaptureGraphicsDevice 录制几帧（多个命令列表、每帧的上传内容），
+// 保存、读回、用 CommandReplayer 回放到另一个正在捕获的设备上，回放得到的命令流和上传内容与原来的逐字节相同。
+// 内层后端分两种：NullGraphicsDevice 本身记录命令流，捕获直接复制它；OpaqueNullDevice 不暴露命令流，
+// 捕获要在转发的同时自己写一份。两种方式捕获的内容也要完全相同。另外检查损坏的文件被拒绝
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "CommandCapture.h"
+#include "NullGraphicsDevice.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 不暴露命令流的命令列表，代替 D3D12 这样只能逐条转发的后端
+    class OpaqueNullCommandList : public NullCommandList
+    {
+    public:
+        const CommandStreamWriter* RecordedStream()const override { return nullptr; }
+    };
+
+    class OpaqueNullDevice : public NullGraphicsDevice
+    {
+    public:
+        std::unique_ptr<CommandList> CreateCommandList() override { return std::make_unique<OpaqueNullCommandList>(); }
+        bool RecordsCommandStreams()const override { return false; }
+    };
+
+    constexpr GpuAddress UploadBase = 0x7000000;
+
+    // 录制 frameCount 帧：每帧先登记上传内容，再分两批提交三个命令列表，最后 Signal
+    void RecordFrames(CaptureGraphicsDevice& device, std::uint32_t frameCount, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::unique_ptr<CommandList>> lists;
+        for(int i = 0; i < 3; ++i)
+            lists.push_back(device.CreateCommandList());
+
+        std::uint64_t fence = 0;
+        for(std::uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            std::vector<std::uint8_t> upload(256 + rng() % 4096);
+            for(std::uint8_t& byte : upload)
+                byte = (std::uint8_t)rng();
+            device.CaptureUpload(UploadBase + frame * 0x10000, upload.data(), upload.size());
+
+            for(std::size_t l = 0; l < lists.size(); ++l)
+            {
+                CommandList& list = *lists[l];
+                list.Begin(l == 0 ? 0 : 0x1000 + l);
+                if(l == 0)
+                {
+                    const float color[4] = { 0.1f, 0.2f, 0.3f, 1.0f };
+                    list.TransitionBarrier(0x3000, ResourceState::Present, ResourceState::RenderTarget);
+                    list.ClearRenderTarget(0x4000, color);
+                    list.ClearDepthStencil(0x5000, 1.0f, 0);
+                    list.CopyBufferRegion(0x6000, 64, 0x6100, 0, 4096);
+                }
+                ViewportDesc viewport;
+                viewport.Width = 1280.0f;
+                viewport.Height = 720.0f;
+                list.SetViewport(viewport);
+                list.SetScissorRect(ScissorRect{ 0, 0, 1280, 720 });
+                list.SetRenderTarget(0x4000, 0x5000);
+                list.SetGraphicsRootSignature(0x2000);
+                list.SetGraphicsRootShaderResourceView(3, UploadBase + 0x800);
+                std::uint32_t drawCount = 1 + rng() % 40;
+                for(std::uint32_t d = 0; d < drawCount; ++d)
+                {
+                    list.SetVertexBuffer(VertexBufferBinding{ 0x8000000 + (rng() % 8) * 0x10000, 0x10000, 32 });
+                    list.SetIndexBuffer(IndexBufferBinding{ 0x9000000 + (rng() % 8) * 0x1000, 0x1000, IndexFormat::R16Uint });
+                    list.SetPrimitiveTopology(rng() % 2 == 0 ? PrimitiveTopology::TriangleList : PrimitiveTopology::TriangleStrip);
+                    list.SetGraphicsRootConstantBufferView(1, UploadBase + d * 256);
+                    list.SetGraphicsRoot32BitConstant(4, rng(), d % 4);
+                    list.DrawIndexedInstanced(36 + rng() % 300, 1 + rng() % 4, 3 * (rng() % 100), (std::int32_t)(rng() % 50) - 25, d);
+                }
+                if(l == 2)
+                {
+                    list.ExecuteIndirect(0xA000, 512, 0xB000, 256);
+                    list.TransitionBarrier(0x3000, ResourceState::RenderTarget, ResourceState::Present);
+                }
+                list.End();
+            }
+
+            CommandList* first[] = { lists[0].get() };
+            device.ExecuteCommandLists(first, 1);
+            CommandList* rest[] = { lists[1].get(), lists[2].get() };
+            device.ExecuteCommandLists(rest, 2);
+            device.Signal(++fence);
+            device.WaitForFenceValue(fence);
+        }
+    }
+
+    CommandCapture CaptureFrames(std::unique_ptr<GraphicsDevice> inner, std::uint32_t frameCount, unsigned seed)
+    {
+        CaptureGraphicsDevice capture(std::move(inner));
+        capture.BeginCapture(frameCount, 64 * 1024);
+        RecordFrames(capture, frameCount, seed);
+        CHECK(capture.HasCompletedCapture());
+        return capture.TakeCapture();
+    }
+
+    bool SameBytes(const CommandCapture& a, const CaptureRange& ra, const CommandCapture& b, const CaptureRange& rb)
+    {
+        if(ra.Size != rb.Size)
+            return false;
+        return ra.Size == 0 || std::memcmp(a.Data(ra), b.Data(rb), (std::size_t)ra.Size) == 0;
+    }
+
+    // 逐条记录比较；围栏值由回放器重新编号，compareFences 为 false 时不比较
+    void CheckSameCapture(const CommandCapture& expected, const CommandCapture& actual, bool compareFences)
+    {
+        CHECK_EQ(actual.FrameCount, expected.FrameCount);
+        REQUIRE(actual.Records.size() == expected.Records.size());
+        for(std::size_t r = 0; r < expected.Records.size(); ++r)
+        {
+            const CaptureRecord& e = expected.Records[r];
+            const CaptureRecord& a = actual.Records[r];
+            REQUIRE(a.Kind == e.Kind);
+            switch(e.Kind)
+            {
+            case CaptureRecordKind::Execute:
+                REQUIRE(a.Lists.size() == e.Lists.size());
+                for(std::size_t i = 0; i < e.Lists.size(); ++i)
+                    CHECK(SameBytes(expected, e.Lists[i], actual, a.Lists[i]));
+                break;
+            case CaptureRecordKind::Signal:
+                if(compareFences)
+                    CHECK_EQ(a.Value, e.Value);
+                break;
+            case CaptureRecordKind::Upload:
+                CHECK_EQ(a.Value, e.Value);
+                CHECK(SameBytes(expected, e.Data, actual, a.Data));
+                break;
+            }
+        }
+    }
+
+    const char* const TempPath = "CommandCaptureTests.d3dcap";
+
+    void RoundTrip(std::unique_ptr<GraphicsDevice> recordingBackend, std::unique_ptr<GraphicsDevice> replayBackend)
+    {
+        const std::uint32_t frameCount = 5;
+        CommandCapture original = CaptureFrames(std::move(recordingBackend), frameCount, 38);
+        CHECK_EQ(original.FrameCount, frameCount);
+        CHECK_EQ(original.Records.size(), (std::size_t)frameCount * 4); // 上传、两次提交、Signal
+
+        REQUIRE(SaveCommandCapture(original, TempPath));
+        CommandCapture loaded;
+        REQUIRE(LoadCommandCapture(TempPath, loaded));
+        std::remove(TempPath);
+        CheckSameCapture(original, loaded, true);
+
+        // 回放到另一个正在捕获的设备上，上传内容通过回调再登记一次
+        CaptureGraphicsDevice recapture(std::move(replayBackend));
+        recapture.BeginCapture(frameCount);
+        CommandReplayer replayer(recapture);
+        CommandReplayer::Stats stats = replayer.Replay(loaded, [&](GpuAddress address, const std::uint8_t* data, std::size_t byteSize)
+        {
+            recapture.CaptureUpload(address, data, byteSize);
+        });
+        replayer.Flush();
+
+        CHECK_EQ(stats.Frames, (std::uint64_t)frameCount);
+        CHECK_EQ(stats.Lists, (std::uint64_t)frameCount * 3);
+        REQUIRE(recapture.HasCompletedCapture());
+        CheckSameCapture(original, recapture.TakeCapture(), false);
+    }
+}
+
+TEST_CASE(RoundTripThroughARecordingBackendIsByteExact)
+{
+    RoundTrip(std::make_unique<NullGraphicsDevice>(), std::make_unique<NullGraphicsDevice>());
+}
+
+TEST_CASE(RoundTripThroughAForwardingBackendIsByteExact)
+{
+    RoundTrip(std::make_unique<OpaqueNullDevice>(), std::make_unique<OpaqueNullDevice>());
+}
+
+TEST_CASE(SharedAndTeedStreamsAreIdentical)
+{
+    // 同样的录制，复制内层命令流和自己逐条写得到的结果相同，绘制数也对得上
+    CommandCapture shared = CaptureFrames(std::make_unique<NullGraphicsDevice>(), 4, 7);
+    CommandCapture teed = CaptureFrames(std::make_unique<OpaqueNullDevice>(), 4, 7);
+    CheckSameCapture(shared, teed, true);
+
+    CommandHistogram counts = CountCommands(shared);
+    CHECK_EQ(counts[(std::size_t)CommandOp::ExecuteIndirect], 4u);
+    CHECK_EQ(counts[(std::size_t)CommandOp::SetPipelineState], 8u); // 后两个列表 Begin 时的初始管线
+    CHECK(counts[(std::size_t)CommandOp::DrawIndexedInstanced] > 0);
+}
+
+TEST_CASE(OnlyTheRequestedFramesAreCaptured)
+{
+    CaptureGraphicsDevice capture(std::make_unique<NullGraphicsDevice>());
+    capture.CaptureUpload(UploadBase, "idle", 4); // 不在捕获，忽略
+    RecordFrames(capture, 2, 1);
+    CHECK(!capture.HasCompletedCapture());
+
+    capture.BeginCapture(2);
+    RecordFrames(capture, 3, 1); // 第三帧不再记录
+    CHECK(!capture.IsCapturing());
+    CommandCapture taken = capture.TakeCapture();
+    CHECK_EQ(taken.FrameCount, 2u);
+    CHECK_EQ(taken.Records.size(), 8u);
+    CHECK(!capture.HasCompletedCapture());
+}
+
+TEST_CASE(CorruptFilesAreRejected)
+{
+    CommandCapture original = CaptureFrames(std::make_unique<NullGraphicsDevice>(), 2, 3);
+    REQUIRE(SaveCommandCapture(original, TempPath));
+    std::vector<char> bytes;
+    {
+        std::ifstream file(TempPath, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    REQUIRE(bytes.size() > 64);
+
+    auto loadVariant = [&](const std::vector<char>& variant)
+    {
+        {
+            std::ofstream file(TempPath, std::ios::binary | std::ios::trunc);
+            file.write(variant.data(), (std::streamsize)variant.size());
+        }
+        CommandCapture loaded;
+        loaded.FrameCount = 99;
+        bool ok = LoadCommandCapture(TempPath, loaded);
+        CHECK_EQ(loaded.FrameCount, ok ? original.FrameCount : 99u); // 失败时不修改输出
+        return ok;
+    };
+
+    CHECK(loadVariant(bytes));
+
+    std::vector<char> badMagic = bytes;
+    badMagic[0] = 'X';
+    CHECK(!loadVariant(badMagic));
+
+    std::vector<char> truncated(bytes.begin(), bytes.end() - 7);
+    CHECK(!loadVariant(truncated));
+
+    // 第一条记录（上传）的长度改成远超文件大小
+    std::vector<char> hugeLength = bytes;
+    const std::size_t uploadSizeOffset = 8 + 4 + 4 + 8 + 1 + 8;
+    std::memset(hugeLength.data() + uploadSizeOffset, 0x7F, 8);
+    CHECK(!loadVariant(hugeLength));
+
+    std::remove(TempPath);
+    CommandCapture missing;
+    CHECK(!LoadCommandCapture(TempPath, missing));
+}
+
+int main()
+{
+    return RunAllTests();
+}
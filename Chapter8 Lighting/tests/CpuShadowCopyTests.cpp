@@ -0,0 +1,324 @@
+// CpuShadowCopy 的单元测试：各个保留策略的往返（原样、压缩、从文件分页读回）、
+// 压缩格式本身的往返和损坏数据的检测、多个使用者共享解压结果，以及移动之后源对象仍然可用
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CpuShadowCopy.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 类似顶点缓冲区的数据：位置平滑变化、法线大多相同，压缩后应明显变小
+    std::vector<std::uint8_t> MakeVertexData(std::size_t vertexCount)
+    {
+        struct Vertex
+        {
+            float Pos[3];
+            float Normal[3];
+            float TexC[2];
+        };
+        std::vector<Vertex> vertices(vertexCount);
+        for(std::size_t i = 0; i < vertexCount; ++i)
+        {
+            vertices[i].Pos[0] = (float)(i % 64) * 0.5f;
+            vertices[i].Pos[1] = 0.0f;
+            vertices[i].Pos[2] = (float)(i / 64) * 0.5f;
+            vertices[i].Normal[0] = 0.0f;
+            vertices[i].Normal[1] = 1.0f;
+            vertices[i].Normal[2] = 0.0f;
+            vertices[i].TexC[0] = (float)(i % 64) / 63.0f;
+            vertices[i].TexC[1] = (float)(i / 64) / 63.0f;
+        }
+        std::vector<std::uint8_t> bytes(vertexCount * sizeof(Vertex));
+        std::memcpy(bytes.data(), vertices.data(), bytes.size());
+        return bytes;
+    }
+
+    std::vector<std::uint8_t> MakeRandomData(std::size_t byteSize, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::uint8_t> bytes(byteSize);
+        for(std::uint8_t& b : bytes)
+            b = (std::uint8_t)rng();
+        return bytes;
+    }
+
+    bool SameBytes(const ShadowCopyView& view, const std::vector<std::uint8_t>& expected)
+    {
+        return view.IsValid() && view.Size() == expected.size() &&
+            (expected.empty() || std::memcmp(view.Data(), expected.data(), expected.size()) == 0);
+    }
+
+    // 测试结束时删除的临时文件
+    struct TempFile
+    {
+        explicit TempFile(const char* name) :
+            Path((std::filesystem::temp_directory_path() / name).string())
+        {
+        }
+        ~TempFile() { std::remove(Path.c_str()); }
+
+        std::string Path;
+    };
+}
+
+TEST_CASE(CompressionRoundTrip)
+{
+    struct Input
+    {
+        std::vector<std::uint8_t> Bytes;
+        std::uint32_t Stride;
+    };
+    std::vector<Input> inputs;
+    inputs.push_back({ MakeVertexData(4096), 32 });
+    inputs.push_back({ MakeVertexData(4096), 1 });
+    inputs.push_back({ MakeRandomData(10000, 1), 4 });     // 不可压缩，长字面量
+    inputs.push_back({ MakeRandomData(10001, 2), 4 });     // 长度不是步长的整数倍
+    inputs.push_back({ MakeRandomData(7, 3), 32 });        // 比一个元素还短
+    inputs.push_back({ std::vector<std::uint8_t>(100000, 0x5a), 2 }); // 超长匹配
+    inputs.push_back({ std::vector<std::uint8_t>(), 4 });
+
+    // 索引缓冲区：16 位索引，网格的规则排列
+    std::vector<std::uint8_t> indices;
+    for(std::uint16_t quad = 0; quad < 3000; ++quad)
+    {
+        std::uint16_t tri[6] = { quad, (std::uint16_t)(quad + 1), (std::uint16_t)(quad + 65),
+            quad, (std::uint16_t)(quad + 65), (std::uint16_t)(quad + 64) };
+        const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(tri);
+        indices.insert(indices.end(), p, p + sizeof(tri));
+    }
+    inputs.push_back({ indices, 2 });
+
+    for(const Input& input : inputs)
+    {
+        std::vector<std::uint8_t> compressed = ShadowCompression::Compress(input.Bytes.data(), input.Bytes.size(), input.Stride);
+        std::vector<std::uint8_t> decompressed;
+        REQUIRE(ShadowCompression::Decompress(compressed, decompressed));
+        CHECK(decompressed == input.Bytes);
+    }
+
+    // 结构化数据应当压缩得更小
+    std::vector<std::uint8_t> vertices = MakeVertexData(4096);
+    CHECK(ShadowCompression::Compress(vertices.data(), vertices.size(), 32).size() < vertices.size() / 4);
+}
+
+TEST_CASE(DecompressRejectsCorruptData)
+{
+    std::vector<std::uint8_t> bytes = MakeVertexData(1024);
+    std::vector<std::uint8_t> compressed = ShadowCompression::Compress(bytes.data(), bytes.size(), 32);
+    std::vector<std::uint8_t> out;
+
+    std::vector<std::uint8_t> empty;
+    CHECK(!ShadowCompression::Decompress(empty, out));
+
+    // 截断
+    std::vector<std::uint8_t> truncated(compressed.begin(), compressed.begin() + compressed.size() / 2);
+    CHECK(!ShadowCompression::Decompress(truncated, out));
+
+    // 头部声明的长度与数据不符
+    std::vector<std::uint8_t> wrongSize = compressed;
+    wrongSize[0] ^= 0x01;
+    CHECK(!ShadowCompression::Decompress(wrongSize, out));
+
+    // 随机改坏若干字节：可以失败，也可以恰好解出数据，但不能越界或崩溃
+    std::mt19937 rng(34);
+    for(int trial = 0; trial < 200; ++trial)
+    {
+        std::vector<std::uint8_t> damaged = compressed;
+        for(int k = 0; k < 4; ++k)
+            damaged[12 + rng() % (damaged.size() - 12)] = (std::uint8_t)rng();
+        if(ShadowCompression::Decompress(damaged, out))
+            CHECK_EQ(out.size(), bytes.size());
+    }
+}
+
+TEST_CASE(PoliciesRoundTrip)
+{
+    std::vector<std::uint8_t> bytes = MakeVertexData(2048);
+
+    CpuShadowCopy raw;
+    raw.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::KeepRaw, 32);
+    CHECK(raw.Available());
+    CHECK_EQ(raw.ResidentBytes(), bytes.size());
+    CHECK(SameBytes(raw.Acquire(), bytes));
+
+    CpuShadowCopy compressed;
+    compressed.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::KeepCompressed, 32);
+    CHECK(compressed.Available());
+    CHECK_EQ(compressed.ByteSize(), bytes.size());
+    CHECK(compressed.ResidentBytes() < bytes.size());
+    CHECK(SameBytes(compressed.Acquire(), bytes));
+
+    CpuShadowCopy dropped;
+    dropped.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::DropAfterUpload, 32);
+    CHECK(!dropped.Available());
+    CHECK_EQ(dropped.ResidentBytes(), 0u);
+    CHECK(!dropped.Acquire().IsValid());
+
+    // 没有文件来源的 PageFromFile 等同于丢弃
+    CpuShadowCopy noFile;
+    noFile.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::PageFromFile, 32);
+    CHECK(!noFile.Available());
+    CHECK(!noFile.Acquire().IsValid());
+
+    // Reset 之后回到空的状态
+    compressed.Reset();
+    CHECK(!compressed.Available());
+    CHECK_EQ(compressed.ResidentBytes(), 0u);
+    CHECK(!compressed.Acquire().IsValid());
+}
+
+TEST_CASE(PageFromFileRoundTrip)
+{
+    // 资源文件里数据前后都有别的内容，只读 Offset 开始的 ByteSize 字节
+    std::vector<std::uint8_t> bytes = MakeVertexData(1024);
+    std::vector<std::uint8_t> prefix = MakeRandomData(333, 5);
+    std::vector<std::uint8_t> suffix = MakeRandomData(77, 6);
+
+    TempFile temp("CpuShadowCopyTests.bin");
+    {
+        std::ofstream file(temp.Path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(prefix.data()), (std::streamsize)prefix.size());
+        file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+        file.write(reinterpret_cast<const char*>(suffix.data()), (std::streamsize)suffix.size());
+    }
+
+    CpuShadowCopy copy;
+    copy.SetFileSource({ temp.Path, prefix.size(), bytes.size() });
+    copy.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::PageFromFile, 32);
+    CHECK(copy.Available());
+    CHECK_EQ(copy.ResidentBytes(), 0u);
+    CHECK(SameBytes(copy.Acquire(), bytes));
+
+    // 长度与文件来源不符时不再相信文件
+    CpuShadowCopy mismatched;
+    mismatched.SetFileSource({ temp.Path, prefix.size(), bytes.size() });
+    mismatched.Store(bytes.data(), bytes.size() - 4, ShadowCopyPolicy::PageFromFile, 32);
+    CHECK(!mismatched.Available());
+
+    // 文件读不到（不存在或不够长）时返回无效的 view
+    CpuShadowCopy missing;
+    missing.SetFileSource({ temp.Path + ".missing", 0, bytes.size() });
+    CHECK(!missing.Acquire().IsValid());
+
+    CpuShadowCopy pastEnd;
+    pastEnd.SetFileSource({ temp.Path, prefix.size() + suffix.size() + 1, bytes.size() });
+    CHECK(!pastEnd.Acquire().IsValid());
+}
+
+TEST_CASE(ConcurrentUsersShareOneDecompression)
+{
+    std::vector<std::uint8_t> bytes = MakeVertexData(2048);
+    CpuShadowCopy copy;
+    copy.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::KeepCompressed, 32);
+
+    ShadowCopyView first = copy.Acquire();
+    ShadowCopyView second = copy.Acquire();
+    CHECK(first.Data() == second.Data());
+
+    // 多个线程同时 Acquire，结果都正确
+    std::vector<std::thread> threads;
+    std::vector<int> ok(8, 0);
+    for(int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for(int i = 0; i < 50; ++i)
+                ok[t] += SameBytes(copy.Acquire(), bytes) ? 1 : 0;
+        });
+    }
+    for(std::thread& t : threads)
+        t.join();
+    for(int count : ok)
+        CHECK_EQ(count, 50);
+
+    // 重新 Store 之后不会拿到旧的缓存
+    std::vector<std::uint8_t> other = MakeRandomData(500, 7);
+    copy.Store(other.data(), other.size(), ShadowCopyPolicy::KeepCompressed, 4);
+    CHECK(SameBytes(copy.Acquire(), other));
+    CHECK(SameBytes(first, bytes)); // 之前的 view 继续有效
+}
+
+TEST_CASE(MoveLeavesSourceEmptyAndReusable)
+{
+    std::vector<std::uint8_t> bytes = MakeVertexData(1024);
+
+    CpuShadowCopy source;
+    source.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::KeepCompressed, 32);
+    ShadowCopyView held = source.Acquire();
+
+    CpuShadowCopy target(std::move(source));
+    CHECK(target.Policy() == ShadowCopyPolicy::KeepCompressed);
+    CHECK_EQ(target.ByteSize(), bytes.size());
+    CHECK(SameBytes(target.Acquire(), bytes));
+    CHECK(target.Acquire().Data() == held.Data()); // 缓存随数据一起移动
+
+    // 源对象为空，Acquire 不会崩溃
+    CHECK(source.Policy() == ShadowCopyPolicy::DropAfterUpload);
+    CHECK_EQ(source.ByteSize(), 0u);
+    CHECK_EQ(source.ResidentBytes(), 0u);
+    CHECK(!source.Available());
+    CHECK(!source.Acquire().IsValid());
+
+    // 被移动过的对象可以重新保存数据
+    std::vector<std::uint8_t> other = MakeRandomData(300, 8);
+    source.Store(other.data(), other.size(), ShadowCopyPolicy::KeepCompressed, 4);
+    CHECK(SameBytes(source.Acquire(), other));
+    CHECK(SameBytes(target.Acquire(), bytes));
+}
+
+TEST_CASE(MoveAssignmentTransfersFileSource)
+{
+    std::vector<std::uint8_t> bytes = MakeRandomData(4096, 9);
+    TempFile temp("CpuShadowCopyMoveTests.bin");
+    {
+        std::ofstream file(temp.Path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+    }
+
+    CpuShadowCopy source;
+    source.SetFileSource({ temp.Path, 0, bytes.size() });
+
+    // 覆盖一个已经有数据的对象
+    std::vector<std::uint8_t> old = MakeVertexData(64);
+    CpuShadowCopy target;
+    target.Store(old.data(), old.size(), ShadowCopyPolicy::KeepRaw, 32);
+    ShadowCopyView oldView = target.Acquire();
+
+    target = std::move(source);
+    CHECK(target.Policy() == ShadowCopyPolicy::PageFromFile);
+    CHECK(target.Available());
+    CHECK(SameBytes(target.Acquire(), bytes));
+    CHECK(SameBytes(oldView, old)); // 原来的 view 不受影响
+
+    // 源对象没有文件来源了，PageFromFile 也读不到
+    CHECK(!source.Available());
+    CHECK(!source.Acquire().IsValid());
+    source.Store(bytes.data(), bytes.size(), ShadowCopyPolicy::PageFromFile, 1);
+    CHECK(!source.Available());
+
+    // 自移动不改变内容
+    CpuShadowCopy& alias = target;
+    target = std::move(alias);
+    CHECK(SameBytes(target.Acquire(), bytes));
+
+    // 放进容器后随扩容移动
+    std::vector<CpuShadowCopy> copies;
+    for(int i = 0; i < 16; ++i)
+    {
+        copies.emplace_back();
+        copies.back().Store(bytes.data(), bytes.size(), ShadowCopyPolicy::KeepCompressed, 4);
+    }
+    for(const CpuShadowCopy& copy : copies)
+        CHECK(SameBytes(copy.Acquire(), bytes));
+}
+
+int main()
+{
+    return RunAllTests();
+}
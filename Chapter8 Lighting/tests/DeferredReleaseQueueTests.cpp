@@ -0,0 +1,177 @@
+// DeferredReleaseQueue 的单元测试：用模拟的围栏检查对象不会在围栏完成之前被释放，
+// 包括多个线程同时入队、围栏值乱序入队、限制单次回收个数的情况
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "DeferredReleaseQueue.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 模拟的 GPU 围栏和释放记录
+    struct SimulatedFence
+    {
+        std::atomic<std::uint64_t> Completed{ 0 };
+        std::atomic<std::uint64_t> Released{ 0 };
+        std::atomic<std::uint64_t> ReleasedEarly{ 0 };
+    };
+
+    // 只能移动的资源替身：析构时检查围栏是否已经越过它的围栏值
+    class TrackedResource
+    {
+    public:
+        TrackedResource(SimulatedFence* fence, std::uint64_t fenceValue) :
+            mFence(fence),
+            mFenceValue(fenceValue)
+        {
+        }
+
+        TrackedResource(TrackedResource&& rhs) noexcept :
+            mFence(rhs.mFence),
+            mFenceValue(rhs.mFenceValue)
+        {
+            rhs.mFence = nullptr;
+        }
+
+        TrackedResource(const TrackedResource& rhs) = delete;
+        TrackedResource& operator=(const TrackedResource& rhs) = delete;
+        TrackedResource& operator=(TrackedResource&& rhs) = delete;
+
+        ~TrackedResource()
+        {
+            if(mFence == nullptr)
+                return;
+            if(mFence->Completed.load() < mFenceValue)
+                mFence->ReleasedEarly++;
+            mFence->Released++;
+        }
+
+    private:
+        SimulatedFence* mFence;
+        std::uint64_t mFenceValue;
+    };
+}
+
+TEST_CASE(ReleasesOnlyAfterFenceCompletes)
+{
+    SimulatedFence fence;
+    DeferredReleaseQueue queue;
+
+    queue.Enqueue(3, TrackedResource(&fence, 3));
+    queue.Enqueue(1, TrackedResource(&fence, 1));
+    queue.Enqueue(2, TrackedResource(&fence, 2));
+    CHECK(!queue.Empty());
+
+    CHECK_EQ(queue.Reclaim(0), 0u);
+    CHECK_EQ(queue.PendingCount(), 3u);
+
+    fence.Completed = 2;
+    CHECK_EQ(queue.Reclaim(2), 2u);
+    CHECK_EQ(fence.Released.load(), 2u);
+    CHECK_EQ(queue.PendingCount(), 1u);
+
+    fence.Completed = 3;
+    CHECK_EQ(queue.Reclaim(3), 1u);
+    CHECK(queue.Empty());
+    CHECK_EQ(queue.ReleasedCount(), 3u);
+    CHECK_EQ(fence.ReleasedEarly.load(), 0u);
+}
+
+TEST_CASE(ReclaimHonoursMaxCountAndFenceOrder)
+{
+    SimulatedFence fence;
+    DeferredReleaseQueue queue;
+    std::vector<std::uint64_t> order;
+
+    // 乱序入队，回收时按围栏值从小到大
+    for(std::uint64_t value : { 5u, 2u, 9u, 1u, 7u, 3u })
+        queue.EnqueueCallback(value, [&order, value]() { order.push_back(value); });
+
+    CHECK_EQ(queue.Reclaim(10, 2), 2u);
+    CHECK_EQ(queue.Reclaim(10, 3), 3u);
+    CHECK_EQ(queue.Reclaim(10, 3), 1u);
+    const std::uint64_t expected[] = { 1, 2, 3, 5, 7, 9 };
+    REQUIRE(order.size() == 6);
+    for(std::size_t i = 0; i < 6; ++i)
+        CHECK_EQ(order[i], expected[i]);
+}
+
+TEST_CASE(DestructorReleasesEverything)
+{
+    SimulatedFence fence;
+    {
+        DeferredReleaseQueue queue;
+        queue.Enqueue(100, std::make_unique<TrackedResource>(&fence, 0));
+        queue.Enqueue(200, std::make_unique<TrackedResource>(&fence, 0));
+    }
+    CHECK_EQ(fence.Released.load(), 2u);
+}
+
+TEST_CASE(ConcurrentProducersNeverReleaseEarly)
+{
+    // 8 个线程同时入队，每个对象的围栏值是“当前帧”之后随机几帧（所以入队顺序和围栏值顺序不同）；
+    // 渲染线程逐帧推进模拟围栏并分批回收
+    SimulatedFence fence;
+    DeferredReleaseQueue queue;
+    std::atomic<std::uint64_t> currentFrame(1);
+    std::atomic<int> producersDone(0);
+
+    const int producerCount = 8;
+    const int objectsPerProducer = 20000;
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&, p]()
+        {
+            std::mt19937 rng(32 + p);
+            for(int i = 0; i < objectsPerProducer; ++i)
+            {
+                std::uint64_t value = currentFrame.load() + 1 + rng() % 8;
+                if(i % 3 == 0)
+                {
+                    // 回调也一样检查
+                    queue.EnqueueCallback(value, [&fence, value]()
+                    {
+                        if(fence.Completed.load() < value)
+                            fence.ReleasedEarly++;
+                        fence.Released++;
+                    });
+                }
+                else
+                {
+                    queue.Enqueue(value, TrackedResource(&fence, value));
+                }
+                if(i % 1000 == 0)
+                    std::this_thread::yield();
+            }
+            producersDone++;
+        });
+    }
+
+    std::uint64_t reclaimed = 0;
+    while(producersDone.load() < producerCount || !queue.Empty())
+    {
+        // GPU 完成的永远落后当前帧几帧
+        std::uint64_t frame = currentFrame.fetch_add(1) + 1;
+        std::uint64_t completed = frame > 3 ? frame - 3 : 0;
+        fence.Completed = completed;
+        reclaimed += queue.Reclaim(completed, 5000);
+        std::this_thread::yield();
+    }
+    for(std::thread& t : producers)
+        t.join();
+
+    const std::uint64_t total = (std::uint64_t)producerCount * objectsPerProducer;
+    CHECK_EQ(reclaimed, total);
+    CHECK_EQ(fence.Released.load(), total);
+    CHECK_EQ(queue.ReleasedCount(), total);
+    CHECK_EQ(fence.ReleasedEarly.load(), 0u);
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,143 @@
+// 第七章第二部分描述符分配的基准：10 万个描述符规模下常驻区域（空闲链表）和每帧临时区域（线性分配）
+// 的分配/释放开销，包括碎片化之后有大量空闲区间的情况。
+//
+//   DescriptorAllocatorBenchmark [--quick]
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "DescriptorAllocator.h"
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::uint32_t descriptorCount = quick ? 1000 : 100000;
+    const int repeats = quick ? 1 : 5;
+
+    std::printf("%u descriptors\n", descriptorCount);
+
+    // 1. 每个物体一个描述符，依次分配到满，再全部释放
+    double fillMs = 0.0;
+    double drainMs = 0.0;
+    {
+        std::vector<std::uint32_t> starts(descriptorCount);
+        fillMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            DescriptorFreeList list(descriptorCount);
+            for(std::uint32_t i = 0; i < descriptorCount; ++i)
+                starts[i] = list.Allocate(1);
+            Benchmark::DoNotOptimize(list.AllocatedCount());
+        });
+
+        drainMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            DescriptorFreeList list(descriptorCount);
+            for(std::uint32_t i = 0; i < descriptorCount; ++i)
+                starts[i] = list.Allocate(1);
+            // 隔一个释放一个，再释放剩下的：每次释放都要和两边的区间合并
+            for(std::uint32_t i = 0; i < descriptorCount; i += 2)
+                list.Free(starts[i], 1);
+            for(std::uint32_t i = 1; i < descriptorCount; i += 2)
+                list.Free(starts[i], 1);
+            Benchmark::DoNotOptimize(list.FreeRangeCount());
+        });
+        // drain 里包含了一次 fill
+        drainMs = drainMs > fillMs ? drainMs - fillMs : 0.0;
+    }
+    std::printf("persistent fill           %8.3f ms  %6.1f ns/alloc\n", fillMs, fillMs * 1e6 / descriptorCount);
+    std::printf("persistent free+coalesce  %8.3f ms  %6.1f ns/free\n", drainMs, drainMs * 1e6 / descriptorCount);
+
+    // 2. 碎片化：满载后隔一个释放一个，留下 N/2 个长度为 1 的空闲区间，然后请求长度 2 的区间
+    //    （按起始索引逐个扫描的首次适配要扫完所有放不下的区间，按长度索引时直接找到）
+    {
+        DescriptorFreeList list(descriptorCount + 64);
+        for(std::uint32_t i = 0; i < descriptorCount; ++i)
+            list.Allocate(1);
+        for(std::uint32_t i = 0; i < descriptorCount; i += 2)
+            list.Free(i, 1);
+
+        const int attempts = quick ? 10 : 1000;
+        std::uint32_t lastStart = 0;
+        double ms = Benchmark::BestOfMs(repeats, [&]()
+        {
+            for(int k = 0; k < attempts; ++k)
+            {
+                lastStart = list.Allocate(2);
+                list.Free(lastStart, 2);
+            }
+        });
+        std::printf("fragmented (%u ranges)  %8.3f ms  %6.1f ns/alloc of 2\n",
+            list.FreeRangeCount(), ms, ms * 1e6 / attempts);
+        Benchmark::DoNotOptimize(lastStart);
+    }
+
+    // 3. 稳态：常驻区域维持在八成满，随机释放并分配 1..8 个
+    {
+        DescriptorFreeList list(descriptorCount);
+        struct Live
+        {
+            std::uint32_t Start;
+            std::uint32_t Count;
+        };
+        std::vector<Live> live;
+        std::mt19937 rng(31);
+        std::uint32_t target = descriptorCount / 10 * 8;
+        while(list.AllocatedCount() < target)
+        {
+            std::uint32_t count = 1 + rng() % 8;
+            std::uint32_t start = list.Allocate(count);
+            if(start == DescriptorFreeList::InvalidIndex)
+                break;
+            live.push_back({ start, count });
+        }
+
+        const int steps = quick ? 1000 : 100000;
+        int failed = 0;
+        double ms = Benchmark::BestOfMs(1, [&]()
+        {
+            for(int step = 0; step < steps; ++step)
+            {
+                std::size_t k = rng() % live.size();
+                list.Free(live[k].Start, live[k].Count);
+                std::uint32_t count = 1 + rng() % 8;
+                std::uint32_t start = list.Allocate(count);
+                if(start == DescriptorFreeList::InvalidIndex)
+                {
+                    failed++;
+                    live[k] = live.back();
+                    live.pop_back();
+                    continue;
+                }
+                live[k] = { start, count };
+            }
+        });
+        std::printf("steady churn at 80%%       %8.3f ms  %6.1f ns/free+alloc, %u free ranges, %d failed\n",
+            ms, ms * 1e6 / steps, list.FreeRangeCount(), failed);
+    }
+
+    // 4. 每帧临时区域：三帧轮换，每帧分配 N 个再整体回收
+    {
+        const std::uint32_t frameCount = 3;
+        std::vector<DescriptorLinearAllocator> frames;
+        for(std::uint32_t f = 0; f < frameCount; ++f)
+            frames.emplace_back(descriptorCount + f * descriptorCount, descriptorCount);
+
+        const int frameLoops = quick ? 3 : 30;
+        std::uint64_t checksum = 0;
+        double ms = Benchmark::BestOfMs(repeats, [&]()
+        {
+            for(int frame = 0; frame < frameLoops; ++frame)
+            {
+                DescriptorLinearAllocator& ring = frames[frame % frameCount];
+                ring.Reset();
+                for(std::uint32_t i = 0; i < descriptorCount; ++i)
+                    checksum += ring.Allocate(1);
+            }
+        });
+        std::printf("transient ring            %8.3f ms  %6.2f ns/alloc\n",
+            ms, ms * 1e6 / ((double)descriptorCount * frameLoops));
+        Benchmark::DoNotOptimize(checksum);
+    }
+
+    return 0;
+}
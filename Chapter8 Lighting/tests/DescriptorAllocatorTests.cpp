@@ -0,0 +1,252 @@
+// 第七章第二部分 DescriptorAllocator.h 的单元测试：常驻区域的空闲链表（最佳适配、合并、句柄稳定）
+// 和每帧临时区域的线性分配（按帧轮换、围栏完成后整体回收）
+#include <random>
+#include <vector>
+#include "DescriptorAllocator.h"
+#include "TestHarness.h"
+
+TEST_CASE(FreeListAllocatesFromTheFront)
+{
+    DescriptorFreeList list(100);
+    CHECK_EQ(list.Capacity(), 100u);
+    CHECK_EQ(list.Allocate(10), 0u);
+    CHECK_EQ(list.Allocate(1), 10u);
+    CHECK_EQ(list.Allocate(5), 11u);
+    CHECK_EQ(list.AllocatedCount(), 16u);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+    CHECK_EQ(list.LargestFreeRange(), 84u);
+
+    // 释放最前面一段后，放得下的请求回到这个空位
+    list.Free(0, 10);
+    CHECK_EQ(list.Allocate(4), 0u);
+    CHECK_EQ(list.Allocate(7), 16u); // [4, 10) 只有 6 个，放不下
+    CHECK_EQ(list.Allocate(6), 4u);
+}
+
+TEST_CASE(FreeListPicksTheSmallestRangeThatFits)
+{
+    DescriptorFreeList list(64);
+    CHECK_EQ(list.Allocate(64), 0u);
+    list.Free(0, 8);   // [0, 8)
+    list.Free(20, 3);  // [20, 23)
+    list.Free(30, 3);  // [30, 33)
+    list.Free(40, 24); // [40, 64)
+    CHECK_EQ(list.LargestFreeRange(), 24u);
+
+    // 放得下的最短区间，同样长时取起始索引最低的，把长区间留给大请求
+    CHECK_EQ(list.Allocate(3), 20u);
+    CHECK_EQ(list.Allocate(2), 30u);
+    CHECK_EQ(list.Allocate(1), 32u);
+    CHECK_EQ(list.Allocate(8), 0u);
+    CHECK_EQ(list.Allocate(9), 40u);
+    CHECK_EQ(list.LargestFreeRange(), 15u);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+}
+
+TEST_CASE(FreeListRejectsZeroAndOversizedRequests)
+{
+    DescriptorFreeList list(8);
+    CHECK_EQ(list.Allocate(0), DescriptorFreeList::InvalidIndex);
+    CHECK_EQ(list.Allocate(9), DescriptorFreeList::InvalidIndex);
+    CHECK_EQ(list.Allocate(8), 0u);
+    CHECK_EQ(list.Allocate(1), DescriptorFreeList::InvalidIndex);
+    CHECK_EQ(list.FreeRangeCount(), 0u);
+    CHECK_EQ(list.LargestFreeRange(), 0u);
+
+    // 空闲总数够，但没有足够长的连续区间
+    list.Free(0, 2);
+    list.Free(4, 2);
+    CHECK_EQ(list.AllocatedCount(), 4u);
+    CHECK_EQ(list.Allocate(3), DescriptorFreeList::InvalidIndex);
+
+    DescriptorFreeList empty;
+    CHECK_EQ(empty.Allocate(1), DescriptorFreeList::InvalidIndex);
+}
+
+TEST_CASE(FreeListCoalescesNeighbours)
+{
+    DescriptorFreeList list(40);
+    std::uint32_t a = list.Allocate(10); // [0, 10)
+    std::uint32_t b = list.Allocate(10); // [10, 20)
+    std::uint32_t c = list.Allocate(10); // [20, 30)
+    std::uint32_t d = list.Allocate(10); // [30, 40)
+    CHECK_EQ(list.FreeRangeCount(), 0u);
+
+    list.Free(a, 10);
+    list.Free(c, 10);
+    CHECK_EQ(list.FreeRangeCount(), 2u);
+
+    // b 和前后两个空闲区间都相邻，合并成 [0, 30)
+    list.Free(b, 10);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+    CHECK_EQ(list.LargestFreeRange(), 30u);
+
+    // 与前一个区间合并
+    list.Free(d, 10);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+    CHECK_EQ(list.LargestFreeRange(), 40u);
+    CHECK_EQ(list.AllocatedCount(), 0u);
+
+    // 与后一个区间合并
+    CHECK_EQ(list.Allocate(40), 0u);
+    list.Free(30, 10);
+    list.Free(20, 10);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+    CHECK_EQ(list.LargestFreeRange(), 20u);
+}
+
+TEST_CASE(FreeListIgnoresInvalidFrees)
+{
+    DescriptorFreeList list(16);
+    std::uint32_t a = list.Allocate(4);
+    list.Free(DescriptorFreeList::InvalidIndex, 4);
+    list.Free(a, 0);
+    CHECK_EQ(list.AllocatedCount(), 4u);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+}
+
+TEST_CASE(FreeListHandlesStayStableUnderChurn)
+{
+    // 随机分配、释放，用逐个描述符的归属表检查区间不重叠、分配过的起始索引不会移动
+    const std::uint32_t capacity = 4096;
+    DescriptorFreeList list(capacity);
+    std::vector<int> owner(capacity, -1);
+
+    struct Live
+    {
+        std::uint32_t Start;
+        std::uint32_t Count;
+        int Id;
+    };
+    std::vector<Live> live;
+
+    std::mt19937 rng(31);
+    int nextId = 0;
+    for(int step = 0; step < 50000; ++step)
+    {
+        if(live.empty() || rng() % 100 < 55)
+        {
+            std::uint32_t count = 1 + rng() % 16;
+            std::uint32_t start = list.Allocate(count);
+            if(start == DescriptorFreeList::InvalidIndex)
+            {
+                CHECK(list.LargestFreeRange() < count);
+                continue;
+            }
+            REQUIRE(start + count <= capacity);
+            for(std::uint32_t i = start; i < start + count; ++i)
+            {
+                CHECK_EQ(owner[i], -1);
+                owner[i] = nextId;
+            }
+            live.push_back({ start, count, nextId++ });
+        }
+        else
+        {
+            std::size_t k = rng() % live.size();
+            for(std::uint32_t i = live[k].Start; i < live[k].Start + live[k].Count; ++i)
+            {
+                CHECK_EQ(owner[i], live[k].Id);
+                owner[i] = -1;
+            }
+            list.Free(live[k].Start, live[k].Count);
+            live[k] = live.back();
+            live.pop_back();
+        }
+
+        if(step % 1000 == 0)
+        {
+            // 按长度的索引和逐个描述符的归属表一致
+            std::uint32_t longest = 0;
+            std::uint32_t run = 0;
+            for(std::uint32_t i = 0; i < capacity; ++i)
+            {
+                run = owner[i] == -1 ? run + 1 : 0;
+                longest = run > longest ? run : longest;
+            }
+            CHECK_EQ(list.LargestFreeRange(), longest);
+        }
+    }
+
+    std::uint32_t allocated = 0;
+    for(const Live& l : live)
+        allocated += l.Count;
+    CHECK_EQ(list.AllocatedCount(), allocated);
+
+    for(const Live& l : live)
+        list.Free(l.Start, l.Count);
+    CHECK_EQ(list.AllocatedCount(), 0u);
+    CHECK_EQ(list.FreeRangeCount(), 1u);
+    CHECK_EQ(list.LargestFreeRange(), capacity);
+}
+
+TEST_CASE(LinearAllocatorReturnsAbsoluteIndices)
+{
+    DescriptorLinearAllocator linear(1000, 10);
+    CHECK_EQ(linear.Base(), 1000u);
+    CHECK_EQ(linear.Capacity(), 10u);
+    CHECK_EQ(linear.Allocate(3), 1000u);
+    CHECK_EQ(linear.Allocate(7), 1003u);
+    CHECK_EQ(linear.Used(), 10u);
+    CHECK_EQ(linear.Allocate(1), DescriptorLinearAllocator::InvalidIndex);
+    CHECK_EQ(linear.Allocate(0), DescriptorLinearAllocator::InvalidIndex);
+
+    linear.Reset();
+    CHECK_EQ(linear.Used(), 0u);
+    CHECK_EQ(linear.HighWatermark(), 10u);
+    CHECK_EQ(linear.Allocate(11), DescriptorLinearAllocator::InvalidIndex);
+    CHECK_EQ(linear.Allocate(2), 1000u);
+    CHECK_EQ(linear.HighWatermark(), 10u);
+}
+
+TEST_CASE(PerFrameRingsDoNotOverlap)
+{
+    // 与 DescriptorHeapManager 相同的布局：[常驻区域 | 第0帧 | 第1帧 | 第2帧]
+    const std::uint32_t persistent = 64;
+    const std::uint32_t perFrame = 32;
+    const std::uint32_t frameCount = 3;
+
+    std::vector<DescriptorLinearAllocator> frames;
+    for(std::uint32_t f = 0; f < frameCount; ++f)
+        frames.emplace_back(persistent + f * perFrame, perFrame);
+
+    // 模拟 10 帧，每帧从自己的区域里分配，轮到这一帧时先 Reset
+    std::vector<int> lastWriter(persistent + perFrame * frameCount, -1);
+    for(int frame = 0; frame < 10; ++frame)
+    {
+        DescriptorLinearAllocator& ring = frames[frame % frameCount];
+        ring.Reset();
+
+        std::uint32_t used = 0;
+        for(std::uint32_t count : { 5u, 9u, 1u, 17u })
+        {
+            std::uint32_t index = ring.Allocate(count);
+            if(used + count > perFrame)
+            {
+                CHECK_EQ(index, DescriptorLinearAllocator::InvalidIndex);
+                continue;
+            }
+            REQUIRE(index != DescriptorLinearAllocator::InvalidIndex);
+            CHECK(index >= ring.Base());
+            CHECK(index + count <= ring.Base() + ring.Capacity());
+            CHECK(index >= persistent); // 不会写进常驻区域
+            for(std::uint32_t i = index; i < index + count; ++i)
+            {
+                // 同一个位置只会被相隔 frameCount 帧的那一帧重用
+                if(lastWriter[i] != -1)
+                    CHECK((frame - lastWriter[i]) % (int)frameCount == 0);
+                lastWriter[i] = frame;
+            }
+            used += count;
+        }
+        CHECK_EQ(ring.Used(), used);
+    }
+
+    for(const DescriptorLinearAllocator& ring : frames)
+        CHECK(ring.HighWatermark() <= perFrame);
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,313 @@
+// FrustumCuller.h 的单元测试：随机摆放的包围盒用标量、SSE、AVX 三条路径剔除，可见下标逐个相同；
+// 并且 DirectXCollision 的 BoundingFrustum::Contains 认为和视锥相交（或在视锥内）的包围盒一个都不会被剔掉。
+// 剔除只测 6 个平面，是保守的，反过来不成立：Contains 判为不相交的盒子可能被留下。
+// 预先变换好的 SoA 包围盒（WorldBoundsArray）与按结构体跨步读的结果逐位相同，增删改之后也一样。
+// 当前 CPU 不支持的路径跳过
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "FrustumCuller.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // 与渲染项相同的摆放方式：世界矩阵和局部包围盒在同一个结构体里，CullSource 按结构体大小跨步
+    struct CullItem
+    {
+        XMFLOAT4X4 World;
+        BoundingBox Bounds;
+        std::uint32_t ObjectIndex;
+    };
+
+    struct Camera
+    {
+        XMFLOAT4X4 View;
+        XMFLOAT4X4 Proj;
+        XMFLOAT4X4 ViewProj;
+    };
+
+    Camera MakeCamera(FXMVECTOR eye, FXMVECTOR target, float fovY, float aspect, float nearZ, float farZ)
+    {
+        XMMATRIX view = XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX proj = XMMatrixPerspectiveFovLH(fovY, aspect, nearZ, farZ);
+        Camera camera;
+        XMStoreFloat4x4(&camera.View, view);
+        XMStoreFloat4x4(&camera.Proj, proj);
+        XMStoreFloat4x4(&camera.ViewProj, XMMatrixMultiply(view, proj));
+        return camera;
+    }
+
+    // 世界空间的 BoundingFrustum：从投影矩阵得到观察空间的视锥，再用观察矩阵的逆变换过去
+    BoundingFrustum WorldFrustum(const Camera& camera)
+    {
+        BoundingFrustum local;
+        BoundingFrustum::CreateFromMatrix(local, XMLoadFloat4x4(&camera.Proj));
+        XMMATRIX view = XMLoadFloat4x4(&camera.View);
+        XMMATRIX invView = XMMatrixInverse(nullptr, view);
+        BoundingFrustum world;
+        local.Transform(world, invView);
+        return world;
+    }
+
+    // 随机的旋转、非均匀缩放（偶尔是镜像）和平移，散布在摄像机周围 range 的范围内
+    std::vector<CullItem> MakeItems(std::size_t count, float range, std::uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> scale(0.2f, 3.0f);
+        std::uniform_real_distribution<float> extent(0.05f, 4.0f);
+
+        std::vector<CullItem> items(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            float sx = scale(rng) * (rng() % 16 == 0 ? -1.0f : 1.0f);
+            XMMATRIX world = XMMatrixScaling(sx, scale(rng), scale(rng)) *
+                XMMatrixRotationRollPitchYaw(unit(rng) * XM_PI, unit(rng) * XM_PI, unit(rng) * XM_PI) *
+                XMMatrixTranslation(unit(rng) * range, unit(rng) * range, unit(rng) * range);
+            XMStoreFloat4x4(&items[i].World, world);
+
+            // 偶尔放一个很大的盒子，横跨好几个平面
+            float big = rng() % 32 == 0 ? 20.0f : 1.0f;
+            items[i].Bounds = BoundingBox(XMFLOAT3(unit(rng), unit(rng), unit(rng)),
+                XMFLOAT3(extent(rng) * big, extent(rng) * big, extent(rng) * big));
+            items[i].ObjectIndex = (std::uint32_t)i;
+        }
+        return items;
+    }
+
+    CullSource SourceOf(const std::vector<CullItem>& items, std::size_t first)
+    {
+        CullSource source;
+        source.World = &items[first].World;
+        source.Bounds = &items[first].Bounds;
+        source.Stride = sizeof(CullItem);
+        return source;
+    }
+
+    bool Near(float a, float b)
+    {
+        return std::fabs(a - b) <= 1e-4f * (1.0f + std::fabs(b));
+    }
+
+    std::vector<SimdPath> AvailablePaths()
+    {
+        std::vector<SimdPath> paths = { SimdPath::Scalar };
+        if(BestSimdPath() != SimdPath::Scalar)
+            paths.push_back(SimdPath::Sse);
+        if(BestSimdPath() == SimdPath::Avx)
+            paths.push_back(SimdPath::Avx);
+        return paths;
+    }
+
+    std::vector<Camera> TestCameras()
+    {
+        std::vector<Camera> cameras;
+        cameras.push_back(MakeCamera(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+            0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 100.0f));
+        cameras.push_back(MakeCamera(XMVectorSet(10.0f, 5.0f, -30.0f, 1.0f), XMVectorSet(-20.0f, 0.0f, 40.0f, 1.0f),
+            0.35f * XM_PI, 1.0f, 0.5f, 60.0f));
+        cameras.push_back(MakeCamera(XMVectorSet(-15.0f, 30.0f, 15.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+            0.2f * XM_PI, 4.0f / 3.0f, 2.0f, 200.0f));
+        return cameras;
+    }
+}
+
+TEST_CASE(AllPathsReturnIdenticalVisibleLists)
+{
+    const std::vector<CullItem> items = MakeItems(4099, 60.0f, 50);
+    const std::vector<SimdPath> paths = AvailablePaths();
+
+    // 奇数个数和不同的起点，覆盖 AVX 的 8 个一轮、SSE 的 4 个一轮和标量尾部
+    const std::size_t counts[] = { 0, 1, 3, 4, 7, 8, 9, 15, 17, 31, 1000, 4096 };
+    for(const Camera& camera : TestCameras())
+    {
+        FrustumPlanes frustum = ExtractFrustumPlanes(camera.ViewProj);
+        for(std::size_t count : counts)
+        {
+            for(std::size_t first : { (std::size_t)0, (std::size_t)3 })
+            {
+                CullSource source = SourceOf(items, first);
+                std::vector<std::uint32_t> reference(count + 1, 0xFFFFFFFFu);
+                std::size_t referenceCount = CullBoxes(frustum, source, count, 100, reference.data(), SimdPath::Scalar);
+                REQUIRE(referenceCount <= count);
+                for(std::size_t k = 1; k < referenceCount; ++k)
+                    CHECK(reference[k] > reference[k - 1]);
+
+                for(SimdPath path : paths)
+                {
+                    std::vector<std::uint32_t> visible(count + 1, 0xFFFFFFFFu);
+                    std::size_t visibleCount = CullBoxes(frustum, source, count, 100, visible.data(), path);
+                    CHECK_EQ(visibleCount, referenceCount);
+                    CHECK(std::memcmp(visible.data(), reference.data(), referenceCount * sizeof(std::uint32_t)) == 0);
+                    CHECK_EQ(visible[count], 0xFFFFFFFFu); // 不会写到 count 个元素之外
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(NeverCullsBoxesThatIntersectTheFrustum)
+{
+    const std::size_t count = 4000;
+    const std::vector<CullItem> items = MakeItems(count, 80.0f, 51);
+    const std::vector<SimdPath> paths = AvailablePaths();
+
+    for(const Camera& camera : TestCameras())
+    {
+        FrustumPlanes frustum = ExtractFrustumPlanes(camera.ViewProj);
+        BoundingFrustum reference = WorldFrustum(camera);
+
+        // 局部包围盒变换到世界空间（8 个角点的轴对齐包围盒），和 BoundingFrustum 比较
+        std::vector<ContainmentType> containment(count);
+        std::size_t intersecting = 0;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            BoundingBox worldBox;
+            items[i].Bounds.Transform(worldBox, XMLoadFloat4x4(&items[i].World));
+            containment[i] = reference.Contains(worldBox);
+            intersecting += containment[i] != DISJOINT ? 1 : 0;
+        }
+        // 摆放要让一部分盒子在视锥里、一部分在外面，测试才有意义
+        CHECK(intersecting > 0);
+        CHECK(intersecting < count);
+
+        for(SimdPath path : paths)
+        {
+            std::vector<std::uint32_t> visible(count);
+            std::size_t visibleCount = CullBoxes(frustum, SourceOf(items, 0), count, 0, visible.data(), path);
+
+            std::vector<bool> kept(count, false);
+            for(std::size_t k = 0; k < visibleCount; ++k)
+                kept[visible[k]] = true;
+
+            std::size_t wronglyCulled = 0;
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                if(containment[i] != DISJOINT && !kept[i])
+                    wronglyCulled++;
+            }
+            CHECK_EQ(wronglyCulled, (std::size_t)0);
+            CHECK(visibleCount >= intersecting);
+            CHECK(visibleCount < count);
+        }
+    }
+}
+
+TEST_CASE(SoaBoundsMatchStridedSource)
+{
+    const std::vector<CullItem> items = MakeItems(4099, 60.0f, 53);
+    WorldBoundsArray bounds;
+    for(const CullItem& item : items)
+        bounds.PushBack(item.World, item.Bounds);
+    REQUIRE(bounds.Size() == items.size());
+
+    const std::size_t counts[] = { 0, 1, 3, 4, 7, 8, 9, 15, 17, 31, 1000, 4096 };
+    for(const Camera& camera : TestCameras())
+    {
+        FrustumPlanes frustum = ExtractFrustumPlanes(camera.ViewProj);
+        for(std::size_t count : counts)
+        {
+            for(std::size_t first : { (std::size_t)0, (std::size_t)3 })
+            {
+                std::vector<std::uint32_t> reference(count + 1, 0xFFFFFFFFu);
+                std::size_t referenceCount = CullBoxes(frustum, SourceOf(items, first), count, 7, reference.data(),
+                    SimdPath::Scalar);
+                for(SimdPath path : AvailablePaths())
+                {
+                    std::vector<std::uint32_t> visible(count + 1, 0xFFFFFFFFu);
+                    std::size_t visibleCount = CullBoxes(frustum, bounds.View(first), count, 7, visible.data(), path);
+                    CHECK_EQ(visibleCount, referenceCount);
+                    CHECK(std::memcmp(visible.data(), reference.data(), referenceCount * sizeof(std::uint32_t)) == 0);
+                    CHECK_EQ(visible[count], 0xFFFFFFFFu);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(WorldBoundsFollowSetAndSwapBackRemove)
+{
+    // 按 HandlePool 的方式增删改，包围盒数组和物体数组保持一一对应
+    std::vector<CullItem> items = MakeItems(300, 40.0f, 54);
+    const std::vector<CullItem> moved = MakeItems(300, 40.0f, 55);
+    WorldBoundsArray bounds;
+    for(const CullItem& item : items)
+        bounds.PushBack(item.World, item.Bounds);
+
+    std::mt19937 rng(56);
+    for(int step = 0; step < 200; ++step)
+    {
+        std::size_t i = rng() % items.size();
+        if(step % 3 == 0)
+        {
+            items[i] = items.back();
+            items.pop_back();
+            bounds.RemoveSwapBack(i);
+        }
+        else
+        {
+            items[i].World = moved[(std::size_t)step].World;
+            bounds.Set(i, items[i].World, items[i].Bounds);
+        }
+    }
+    REQUIRE(bounds.Size() == items.size());
+
+    // 与 BoundingBox::Transform 变换 8 个角点得到的世界空间包围盒一致（允许浮点误差）
+    for(std::size_t i = 0; i < items.size(); ++i)
+    {
+        BoundingBox expected;
+        items[i].Bounds.Transform(expected, XMLoadFloat4x4(&items[i].World));
+        BoundingBox actual = bounds.At(i);
+        CHECK(Near(actual.Center.x, expected.Center.x));
+        CHECK(Near(actual.Center.y, expected.Center.y));
+        CHECK(Near(actual.Center.z, expected.Center.z));
+        CHECK(Near(actual.Extents.x, expected.Extents.x));
+        CHECK(Near(actual.Extents.y, expected.Extents.y));
+        CHECK(Near(actual.Extents.z, expected.Extents.z));
+    }
+
+    for(const Camera& camera : TestCameras())
+    {
+        FrustumPlanes frustum = ExtractFrustumPlanes(camera.ViewProj);
+        std::vector<std::uint32_t> reference(items.size());
+        std::vector<std::uint32_t> visible(items.size());
+        std::size_t referenceCount = CullBoxes(frustum, SourceOf(items, 0), items.size(), 0, reference.data());
+        std::size_t visibleCount = CullBoxes(frustum, bounds.View(), bounds.Size(), 0, visible.data());
+        REQUIRE(visibleCount == referenceCount);
+        CHECK(std::memcmp(visible.data(), reference.data(), visibleCount * sizeof(std::uint32_t)) == 0);
+    }
+
+    bounds.Clear();
+    CHECK_EQ(bounds.Size(), (std::size_t)0);
+}
+
+TEST_CASE(ExtractedPlanesMatchBoundingFrustum)
+{
+    // BoundingFrustum 判为在视锥内的点，到 6 个平面的有符号距离都不小于 0（留一点浮点误差）
+    std::mt19937 rng(52);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for(const Camera& camera : TestCameras())
+    {
+        FrustumPlanes frustum = ExtractFrustumPlanes(camera.ViewProj);
+        BoundingFrustum reference = WorldFrustum(camera);
+        std::size_t inside = 0;
+        for(int i = 0; i < 20000; ++i)
+        {
+            XMFLOAT3 p(unit(rng) * 100.0f, unit(rng) * 100.0f, unit(rng) * 100.0f);
+            if(reference.Contains(XMLoadFloat3(&p)) != CONTAINS)
+                continue;
+            inside++;
+            for(const XMFLOAT4& plane : frustum.Planes)
+                CHECK(plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w >= -1e-3f);
+        }
+        CHECK(inside > 0);
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
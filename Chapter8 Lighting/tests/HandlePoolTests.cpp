@@ -0,0 +1,232 @@
+// HandlePool 的单元测试：删除之后、槽位被新元素占用之后旧句柄都查不到，
+// swap-back 搬过来的最后一个元素仍然能用它原来的句柄找到，块边界上的 ChunkCount/ChunkLength，
+// 代数回绕时跳过 0（以及 GenerationBits 注释里说明的：回绕一圈之后旧句柄重新有效），
+// 并且和一个朴素的模型对照做随机增删
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "HandlePool.h"
+#include "TestHarness.h"
+
+namespace
+{
+    struct Hot
+    {
+        int Value = 0;
+    };
+
+    struct Cold
+    {
+        std::string Name;
+    };
+
+    // 小块，容易测到块边界
+    using SmallPool = HandlePool<Hot, Cold, 4>;
+
+    PoolHandle AddNamed(SmallPool& pool, int value)
+    {
+        return pool.Add(Hot{ value }, Cold{ "item" + std::to_string(value) });
+    }
+}
+
+TEST_CASE(StaleHandlesReturnNull)
+{
+    SmallPool pool;
+    PoolHandle a = AddNamed(pool, 1);
+    PoolHandle b = AddNamed(pool, 2);
+    CHECK(!a.IsNull());
+    CHECK(a != b);
+    REQUIRE(pool.TryGetHot(a) != nullptr);
+    CHECK_EQ(pool.TryGetHot(a)->Value, 1);
+    CHECK(pool.TryGetCold(a)->Name == "item1");
+
+    CHECK(pool.Remove(a));
+    CHECK(!pool.IsValid(a));
+    CHECK(pool.TryGetHot(a) == nullptr);
+    CHECK(pool.TryGetCold(a) == nullptr);
+    CHECK(!pool.Remove(a)); // 重复删除没有影响
+    CHECK_EQ(pool.Size(), 1u);
+
+    // 新元素复用 a 的槽位，但代数不同：旧句柄仍然查不到，不会访问到新元素
+    PoolHandle c = AddNamed(pool, 3);
+    CHECK_EQ(c.Slot(), a.Slot());
+    CHECK(c.Generation() != a.Generation());
+    CHECK(pool.TryGetHot(a) == nullptr);
+    CHECK(!pool.Remove(a));
+    REQUIRE(pool.TryGetHot(c) != nullptr);
+    CHECK_EQ(pool.TryGetHot(c)->Value, 3);
+    CHECK_EQ(pool.TryGetHot(b)->Value, 2);
+
+    // 空句柄和超出范围的槽位
+    CHECK(pool.TryGetHot(PoolHandle()) == nullptr);
+    CHECK(pool.TryGetHot(PoolHandle::Make(1000, 1)) == nullptr);
+    const SmallPool& constPool = pool;
+    CHECK(constPool.TryGetCold(a) == nullptr);
+    CHECK(constPool.TryGetCold(c)->Name == "item3");
+}
+
+TEST_CASE(SwapBackKeepsTheMovedElementReachable)
+{
+    SmallPool pool;
+    std::vector<PoolHandle> handles;
+    for(int i = 0; i < 10; ++i)
+        handles.push_back(AddNamed(pool, i));
+
+    // 删除稠密下标 2：最后一个元素（9）搬到下标 2
+    CHECK(pool.Remove(handles[2]));
+    CHECK_EQ(pool.Size(), 9u);
+    CHECK_EQ(pool.HotAt(2).Value, 9);
+    CHECK(pool.ColdAt(2).Name == "item9");
+    CHECK(pool.HandleAt(2) == handles[9]);
+    CHECK_EQ(pool.DenseIndexOf(handles[9]), 2u);
+    CHECK_EQ(pool.DenseIndexOf(handles[3]), 3u);
+    REQUIRE(pool.TryGetHot(handles[9]) != nullptr);
+    CHECK_EQ(pool.TryGetHot(handles[9]), &pool.HotAt(2));
+    CHECK(pool.TryGetCold(handles[9])->Name == "item9");
+
+    // 删除最后一个元素时不搬动；空出的位置恢复成默认值
+    CHECK(pool.Remove(handles[8]));
+    CHECK_EQ(pool.Size(), 8u);
+    CHECK(pool.Remove(handles[7]));
+    for(int i : { 0, 1, 3, 4, 5, 6, 9 })
+    {
+        REQUIRE(pool.TryGetHot(handles[i]) != nullptr);
+        CHECK_EQ(pool.TryGetHot(handles[i])->Value, i);
+    }
+
+    // 稠密区间没有空洞，HandleAt、DenseIndexOf 与句柄一一对应
+    for(std::size_t dense = 0; dense < pool.Size(); ++dense)
+    {
+        CHECK_EQ(pool.TryGetHot(pool.HandleAt(dense)), &pool.HotAt(dense));
+        CHECK_EQ(pool.DenseIndexOf(pool.HandleAt(dense)), dense);
+    }
+}
+
+TEST_CASE(ChunkCountAndLengthAtBoundaries)
+{
+    SmallPool pool;
+    CHECK_EQ(pool.ChunkCount(), 0u);
+
+    std::vector<PoolHandle> handles;
+    for(int i = 0; i < 9; ++i)
+    {
+        handles.push_back(AddNamed(pool, i));
+        const std::size_t size = (std::size_t)i + 1;
+        CHECK_EQ(pool.ChunkCount(), (size + 3) / 4);
+        CHECK_EQ(pool.ChunkLength(pool.ChunkCount() - 1), size % 4 == 0 ? 4u : size % 4);
+    }
+    CHECK_EQ(pool.ChunkLength(0), 4u);
+    CHECK_EQ(pool.ChunkLength(1), 4u);
+    CHECK_EQ(pool.ChunkLength(2), 1u);
+
+    // 块是连续数组，和按稠密下标访问一致；已有元素的地址不因增长而改变
+    const Hot* firstChunk = pool.ChunkHot(0);
+    for(std::size_t chunk = 0; chunk < pool.ChunkCount(); ++chunk)
+    {
+        for(std::size_t k = 0; k < pool.ChunkLength(chunk); ++k)
+            CHECK_EQ(&pool.ChunkHot(chunk)[k], &pool.HotAt(chunk * 4 + k));
+    }
+
+    // 缩到刚好 8 个（两个满块），再缩到 4 个
+    CHECK(pool.Remove(handles[0]));
+    CHECK_EQ(pool.ChunkCount(), 2u);
+    CHECK_EQ(pool.ChunkLength(1), 4u);
+    for(int i = 1; i <= 4; ++i)
+        CHECK(pool.Remove(handles[i]));
+    CHECK_EQ(pool.ChunkCount(), 1u);
+    CHECK_EQ(pool.ChunkLength(0), 4u);
+
+    // 重新长回去时复用已经分配的块
+    for(int i = 0; i < 5; ++i)
+        AddNamed(pool, 100 + i);
+    CHECK_EQ(pool.ChunkCount(), 3u);
+    CHECK_EQ(pool.ChunkLength(2), 1u);
+    CHECK_EQ(pool.ChunkHot(0), firstChunk);
+}
+
+TEST_CASE(GenerationWrapsAroundSkippingZero)
+{
+    SmallPool pool;
+    const PoolHandle first = AddNamed(pool, 0);
+    CHECK_EQ(first.Generation(), 1u);
+
+    // 同一个槽位反复删除、重新占用（空闲槽位后进先出）
+    const std::uint32_t generations = PoolHandle::GenerationMask; // 1..1023
+    PoolHandle handle = first;
+    for(std::uint32_t i = 1; i < generations; ++i)
+    {
+        CHECK(pool.Remove(handle));
+        handle = AddNamed(pool, (int)i);
+        CHECK_EQ(handle.Slot(), first.Slot());
+        CHECK_EQ(handle.Generation(), i + 1);
+        CHECK(!pool.IsValid(first));
+    }
+    CHECK_EQ(handle.Generation(), PoolHandle::GenerationMask);
+
+    // 再删一次代数回绕：跳过 0 回到 1，句柄永远不是空句柄
+    CHECK(pool.Remove(handle));
+    PoolHandle wrapped = AddNamed(pool, 5000);
+    CHECK_EQ(wrapped.Generation(), 1u);
+    CHECK(!wrapped.IsNull());
+    CHECK(!pool.IsValid(handle));
+
+    // 这就是 GenerationBits 的限制：回绕一圈之后，最早的句柄和新句柄相同，又被当成有效
+    CHECK(wrapped == first);
+    CHECK(pool.IsValid(first));
+    CHECK_EQ(pool.TryGetHot(first)->Value, 5000);
+
+    // 槽位 0、代数 1 的句柄不是 0：Value 为 0 的空句柄永远无效
+    CHECK(PoolHandle::Make(0, 1).Value != 0);
+    CHECK(!pool.IsValid(PoolHandle()));
+}
+
+TEST_CASE(RandomAddRemoveMatchesAModel)
+{
+    SmallPool pool;
+    std::map<std::uint32_t, int> live; // 句柄值 -> 元素
+    std::vector<PoolHandle> dead;
+    std::mt19937 rng(48);
+    int next = 0;
+    for(int step = 0; step < 20000; ++step)
+    {
+        if(live.empty() || rng() % 5 < 3)
+        {
+            PoolHandle handle = AddNamed(pool, next);
+            CHECK(live.find(handle.Value) == live.end());
+            live[handle.Value] = next++;
+        }
+        else
+        {
+            auto it = live.begin();
+            std::advance(it, rng() % live.size());
+            PoolHandle handle;
+            handle.Value = it->first;
+            CHECK(pool.Remove(handle));
+            dead.push_back(handle);
+            live.erase(it);
+        }
+
+        if(step % 97 == 0)
+        {
+            REQUIRE(pool.Size() == live.size());
+            for(const auto& entry : live)
+            {
+                PoolHandle handle;
+                handle.Value = entry.first;
+                REQUIRE(pool.TryGetHot(handle) != nullptr);
+                CHECK_EQ(pool.TryGetHot(handle)->Value, entry.second);
+                CHECK(pool.TryGetCold(handle)->Name == "item" + std::to_string(entry.second));
+            }
+            // 远不到回绕的次数，死句柄都查不到（除非同一个值又被发出去，那时它在 live 里）
+            for(PoolHandle handle : dead)
+                CHECK(live.count(handle.Value) != 0 || pool.TryGetHot(handle) == nullptr);
+        }
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
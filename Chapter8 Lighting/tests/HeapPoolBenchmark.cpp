@@ -0,0 +1,131 @@
+// HeapPool 碎片基准：模拟流式加载时资源不断装入、卸载，统计堆的利用率、内部/外部碎片，
+// 以及碎片整理计划能腾空多少个堆、要搬多少字节。
+//
+//   HeapPoolBenchmark [--quick]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "HeapPool.h"
+
+namespace
+{
+    constexpr std::uint64_t KB = 1024;
+    constexpr std::uint64_t MB = 1024 * KB;
+
+    struct Report
+    {
+        std::uint32_t Heaps = 0;
+        std::uint64_t Capacity = 0;
+        std::uint64_t Allocated = 0;
+        std::uint64_t Requested = 0;
+        std::uint64_t Free = 0;
+        std::uint64_t LargestFreeSum = 0;
+    };
+
+    Report Measure(const HeapPool& pool)
+    {
+        Report r;
+        for(const HeapStats& s : pool.GetHeapStats())
+        {
+            if(s.AllocationCount == 0)
+                continue; // 空堆可以直接释放，不算在占用里
+            r.Heaps++;
+            r.Capacity += s.Capacity;
+            r.Allocated += s.AllocatedBytes;
+            r.Requested += s.RequestedBytes;
+            r.Free += s.Capacity - s.AllocatedBytes;
+            r.LargestFreeSum += s.LargestFreeBlock;
+        }
+        return r;
+    }
+
+    void Print(const char* label, const Report& r)
+    {
+        double utilization = r.Capacity ? 100.0 * r.Requested / r.Capacity : 0.0;
+        double internal = r.Allocated ? 100.0 * (r.Allocated - r.Requested) / r.Allocated : 0.0;
+        // 外部碎片：空闲空间里不在各堆最大空闲块中的比例
+        double external = r.Free ? 100.0 * (r.Free - r.LargestFreeSum) / r.Free : 0.0;
+        std::printf("%-16s heaps %4u  capacity %7.1f MB  requested %7.1f MB  utilization %5.1f%%  internal %5.1f%%  external %5.1f%%\n",
+            label, r.Heaps, r.Capacity / double(MB), r.Requested / double(MB), utilization, internal, external);
+    }
+
+    // 大小按对数均匀分布在 [4KB, 8MB]：大量小缓冲区加少量大纹理；十六分之一按 4MB 对齐（MSAA 纹理）
+    struct Request
+    {
+        std::uint64_t Size;
+        std::uint64_t Alignment;
+    };
+
+    Request RandomRequest(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<double> logSize(std::log2(4.0 * KB), std::log2(8.0 * MB));
+        Request r;
+        r.Size = (std::uint64_t)std::exp2(logSize(rng));
+        r.Alignment = (rng() % 16 == 0) ? 4 * MB : BuddyAllocator::DefaultMinBlockSize;
+        return r;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::uint64_t heapSize = 64 * MB;
+    const int liveCount = quick ? 200 : 4000;
+    const int churnSteps = quick ? 2000 : 200000;
+
+    std::mt19937 rng(28);
+    HeapPool pool(heapSize);
+    std::vector<PoolAllocation> live;
+    live.reserve(liveCount);
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < liveCount; ++i)
+    {
+        Request r = RandomRequest(rng);
+        live.push_back(pool.Allocate(r.Size, r.Alignment));
+    }
+    Print("initial load", Measure(pool));
+
+    // 每一步卸载一个随机资源、装入一个新资源，常驻数量不变
+    for(int step = 0; step < churnSteps; ++step)
+    {
+        std::size_t i = rng() % live.size();
+        pool.Free(live[i]);
+        Request r = RandomRequest(rng);
+        live[i] = pool.Allocate(r.Size, r.Alignment);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / (liveCount + 2.0 * churnSteps);
+    Print("after churn", Measure(pool));
+    std::printf("allocate/free: %.0f ns per operation, %u heaps created\n", ns, pool.HeapCount());
+
+    DefragPlan plan;
+    double planMs = Benchmark::BestOfMs(quick ? 1 : 5, [&]() { plan = pool.PlanDefragmentation(); });
+    std::printf("defrag plan:  %zu moves, %.1f MB moved, %zu heaps freed, planned in %.2f ms\n",
+        plan.Moves.size(), plan.BytesMoved / double(MB), plan.FreedHeaps.size(), planMs);
+
+    // 每帧最多搬 32MB 时，一次计划能腾出多少
+    DefragPlan budgeted = pool.PlanDefragmentation(32 * MB);
+    std::printf("budget 32 MB: %zu moves, %.1f MB moved, %zu heaps freed\n",
+        budgeted.Moves.size(), budgeted.BytesMoved / double(MB), budgeted.FreedHeaps.size());
+
+    // 执行完整计划
+    for(const DefragMove& move : plan.Moves)
+    {
+        PoolAllocation dest = pool.AllocateInHeap(move.DestHeap, move.Source.Size, move.BlockSize);
+        if(!dest.IsValid() || dest.Offset != move.DestOffset)
+        {
+            std::printf("defrag plan could not be executed\n");
+            return 1;
+        }
+    }
+    for(const DefragMove& move : plan.Moves)
+        pool.Free(move.Source);
+    Print("after defrag", Measure(pool));
+
+    return 0;
+}
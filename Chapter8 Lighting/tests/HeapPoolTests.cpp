@@ -0,0 +1,500 @@
+// BuddyAllocator / HeapPool 的单元测试：分配释放与伙伴合并、对齐、空间不足、统计、碎片整理计划
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "HeapPool.h"
+#include "TestHarness.h"
+
+namespace
+{
+    constexpr std::uint64_t KB = 1024;
+    constexpr std::uint64_t MB = 1024 * KB;
+
+    // 所有已分配的伙伴块互不重叠，且都在容量以内、按块大小对齐
+    bool BlocksAreDisjoint(const BuddyAllocator& heap)
+    {
+        std::vector<BuddyAllocator::Block> blocks = heap.Allocations();
+        std::sort(blocks.begin(), blocks.end(), [](const BuddyAllocator::Block& a, const BuddyAllocator::Block& b)
+        {
+            return a.Offset < b.Offset;
+        });
+
+        std::uint64_t end = 0;
+        for(const auto& b : blocks)
+        {
+            if(b.Offset < end || b.Offset % b.BlockSize != 0 || b.Size > b.BlockSize)
+                return false;
+            end = b.Offset + b.BlockSize;
+        }
+        return end <= heap.Capacity();
+    }
+
+    // 释放全部分配之后，整个堆应该合并回一个最大的空闲块
+    bool FullyCoalesced(const BuddyAllocator& heap)
+    {
+        return heap.Empty() && heap.FreeBlockCount() == 1 && heap.LargestFreeBlock() == heap.Capacity() &&
+            heap.AllocatedBytes() == 0 && heap.RequestedBytes() == 0;
+    }
+}
+
+TEST_CASE(CapacityRoundsUpToPowerOfTwoBlocks)
+{
+    BuddyAllocator heap(100 * KB);
+    CHECK_EQ(heap.Capacity(), 128 * KB);
+    CHECK_EQ(heap.MinBlockSize(), 64 * KB);
+
+    BuddyAllocator exact(4 * MB);
+    CHECK_EQ(exact.Capacity(), 4 * MB);
+    CHECK_EQ(exact.FreeBlockCount(), 1u);
+    CHECK_EQ(exact.LargestFreeBlock(), 4 * MB);
+}
+
+TEST_CASE(SmallRequestsTakeOneMinimumBlock)
+{
+    BuddyAllocator heap(1 * MB);
+    std::uint64_t a = heap.Allocate(1);
+    std::uint64_t b = heap.Allocate(64 * KB);
+    std::uint64_t c = heap.Allocate(0);
+
+    CHECK(a != BuddyAllocator::InvalidOffset);
+    CHECK(b != BuddyAllocator::InvalidOffset);
+    CHECK(c != BuddyAllocator::InvalidOffset);
+    // 地址最低的空闲块优先，分配挤在堆的前部
+    CHECK_EQ(a, 0u);
+    CHECK_EQ(b, 64 * KB);
+    CHECK_EQ(c, 128 * KB);
+    CHECK_EQ(heap.AllocatedBytes(), 3 * 64 * KB);
+    CHECK_EQ(heap.RequestedBytes(), 1 + 64 * KB + 1);
+    CHECK_EQ(heap.AllocationCount(), 3u);
+}
+
+TEST_CASE(FreeCoalescesBuddiesInAnyOrder)
+{
+    const std::uint64_t orders[][4] = { { 0, 1, 2, 3 }, { 3, 2, 1, 0 }, { 1, 3, 0, 2 }, { 2, 0, 3, 1 } };
+    for(const auto& order : orders)
+    {
+        BuddyAllocator heap(256 * KB);
+        std::uint64_t offsets[4];
+        for(std::uint64_t& offset : offsets)
+            offset = heap.Allocate(64 * KB);
+        CHECK_EQ(heap.FreeBytes(), 0u);
+        CHECK_EQ(heap.LargestFreeBlock(), 0u);
+        CHECK(heap.Allocate(1) == BuddyAllocator::InvalidOffset);
+
+        for(std::uint64_t i : order)
+            heap.Free(offsets[i]);
+        CHECK(FullyCoalesced(heap));
+    }
+}
+
+TEST_CASE(FreeDoesNotMergeNonBuddies)
+{
+    BuddyAllocator heap(256 * KB);
+    std::uint64_t a = heap.Allocate(64 * KB); // [0, 64K)
+    std::uint64_t b = heap.Allocate(64 * KB); // [64K, 128K)
+    std::uint64_t c = heap.Allocate(64 * KB); // [128K, 192K)
+    std::uint64_t d = heap.Allocate(64 * KB); // [192K, 256K)
+
+    // b 和 c 相邻但不是伙伴，释放后只能是两个 64KB 块，拼不出 128KB
+    heap.Free(b);
+    heap.Free(c);
+    CHECK_EQ(heap.FreeBlockCount(), 2u);
+    CHECK_EQ(heap.LargestFreeBlock(), 64 * KB);
+    CHECK(heap.Allocate(128 * KB) == BuddyAllocator::InvalidOffset);
+
+    // a 和 b 是伙伴，合并成 [0, 128K)
+    heap.Free(a);
+    CHECK_EQ(heap.LargestFreeBlock(), 128 * KB);
+    CHECK_EQ(heap.Allocate(128 * KB), 0u);
+    heap.Free(0);
+    heap.Free(d);
+    CHECK(FullyCoalesced(heap));
+}
+
+TEST_CASE(FreeOfUnknownOffsetIsIgnored)
+{
+    BuddyAllocator heap(256 * KB);
+    std::uint64_t a = heap.Allocate(64 * KB);
+    heap.Free(a + 64 * KB);
+    heap.Free(12345);
+    CHECK_EQ(heap.AllocationCount(), 1u);
+    heap.Free(a);
+    heap.Free(a); // 重复释放
+    CHECK(FullyCoalesced(heap));
+}
+
+TEST_CASE(AlignmentEnlargesTheBlock)
+{
+    BuddyAllocator heap(4 * MB);
+    std::uint64_t small = heap.Allocate(4 * KB);
+    std::uint64_t aligned = heap.Allocate(4 * KB, 1 * MB);
+    std::uint64_t msaa = heap.Allocate(100 * KB, 2 * MB);
+
+    CHECK_EQ(small, 0u);
+    REQUIRE(aligned != BuddyAllocator::InvalidOffset);
+    CHECK_EQ(aligned % (1 * MB), 0u);
+    CHECK(aligned != 0);
+    REQUIRE(msaa != BuddyAllocator::InvalidOffset);
+    CHECK_EQ(msaa % (2 * MB), 0u);
+
+    std::vector<BuddyAllocator::Block> blocks = heap.Allocations();
+    REQUIRE(blocks.size() == 3);
+    for(const auto& b : blocks)
+    {
+        if(b.Offset == aligned)
+            CHECK_EQ(b.BlockSize, 1 * MB);
+        if(b.Offset == msaa)
+            CHECK_EQ(b.BlockSize, 2 * MB);
+    }
+    CHECK(BlocksAreDisjoint(heap));
+}
+
+TEST_CASE(NonPowerOfTwoSizesRoundUp)
+{
+    BuddyAllocator heap(1 * MB);
+    std::uint64_t a = heap.Allocate(65 * KB);
+    std::uint64_t b = heap.Allocate(300 * KB);
+    REQUIRE(a != BuddyAllocator::InvalidOffset);
+    REQUIRE(b != BuddyAllocator::InvalidOffset);
+    CHECK_EQ(heap.AllocatedBytes(), 128 * KB + 512 * KB);
+    CHECK_EQ(heap.RequestedBytes(), 65 * KB + 300 * KB);
+    CHECK_EQ(b % (512 * KB), 0u);
+}
+
+TEST_CASE(OutOfSpaceReturnsInvalidOffset)
+{
+    BuddyAllocator heap(1 * MB);
+    CHECK(heap.Allocate(1 * MB + 1) == BuddyAllocator::InvalidOffset);
+    CHECK(heap.Allocate(1, 2 * MB) == BuddyAllocator::InvalidOffset);
+    CHECK(heap.Empty());
+
+    std::uint64_t whole = heap.Allocate(1 * MB);
+    CHECK_EQ(whole, 0u);
+    CHECK(heap.Allocate(1) == BuddyAllocator::InvalidOffset);
+    heap.Free(whole);
+
+    // 空闲总量够但没有足够大的连续块
+    std::vector<std::uint64_t> offsets;
+    for(int i = 0; i < 16; ++i)
+        offsets.push_back(heap.Allocate(64 * KB));
+    for(int i = 0; i < 16; i += 2)
+        heap.Free(offsets[i]);
+    CHECK_EQ(heap.FreeBytes(), 512 * KB);
+    CHECK_EQ(heap.LargestFreeBlock(), 64 * KB);
+    CHECK(heap.Allocate(128 * KB) == BuddyAllocator::InvalidOffset);
+    CHECK(heap.Allocate(64 * KB) != BuddyAllocator::InvalidOffset);
+}
+
+TEST_CASE(RandomAllocFreeKeepsInvariants)
+{
+    std::mt19937 rng(28);
+    std::uniform_int_distribution<std::uint64_t> sizeDist(1, 1 * MB);
+    std::uniform_int_distribution<int> alignDist(0, 3);
+
+    BuddyAllocator heap(16 * MB);
+    std::vector<std::uint64_t> live;
+    for(int step = 0; step < 20000; ++step)
+    {
+        bool allocate = live.empty() || (rng() % 100) < 55;
+        if(allocate)
+        {
+            std::uint64_t alignment = 64 * KB << alignDist(rng);
+            std::uint64_t offset = heap.Allocate(sizeDist(rng), alignment);
+            if(offset != BuddyAllocator::InvalidOffset)
+            {
+                CHECK_EQ(offset % alignment, 0u);
+                live.push_back(offset);
+            }
+        }
+        else
+        {
+            std::size_t i = rng() % live.size();
+            heap.Free(live[i]);
+            live[i] = live.back();
+            live.pop_back();
+        }
+
+        if(step % 1000 == 0)
+        {
+            CHECK(BlocksAreDisjoint(heap));
+            CHECK_EQ(heap.AllocationCount(), (std::uint32_t)live.size());
+        }
+    }
+
+    for(std::uint64_t offset : live)
+        heap.Free(offset);
+    CHECK(FullyCoalesced(heap));
+}
+
+TEST_CASE(PoolAppendsHeapsWhenFull)
+{
+    HeapPool pool(1 * MB);
+    CHECK_EQ(pool.HeapCount(), 0u);
+
+    std::vector<PoolAllocation> allocs;
+    for(int i = 0; i < 20; ++i)
+    {
+        PoolAllocation a = pool.Allocate(128 * KB);
+        REQUIRE(a.IsValid());
+        CHECK_EQ(a.Size, 128 * KB);
+        allocs.push_back(a);
+    }
+    // 每个堆放 8 个 128KB
+    CHECK_EQ(pool.HeapCount(), 3u);
+    CHECK_EQ(allocs[0].HeapIndex, 0u);
+    CHECK_EQ(allocs[8].HeapIndex, 1u);
+    CHECK_EQ(allocs[19].HeapIndex, 2u);
+
+    // 前面的堆有了空位，新分配回到前面的堆，不再追加
+    pool.Free(allocs[3]);
+    PoolAllocation reuse = pool.Allocate(100 * KB);
+    CHECK_EQ(reuse.HeapIndex, 0u);
+    CHECK_EQ(reuse.Offset, allocs[3].Offset);
+    CHECK_EQ(pool.HeapCount(), 3u);
+}
+
+TEST_CASE(PoolGivesOversizedRequestsADedicatedHeap)
+{
+    HeapPool pool(1 * MB);
+    PoolAllocation small = pool.Allocate(64 * KB);
+    PoolAllocation big = pool.Allocate(3 * MB);
+    PoolAllocation aligned = pool.Allocate(64 * KB, 2 * MB);
+
+    REQUIRE(big.IsValid());
+    REQUIRE(aligned.IsValid());
+    CHECK_EQ(small.HeapIndex, 0u);
+    CHECK_EQ(pool.HeapCapacity(0), 1 * MB);
+    // 3MB 占满一个 4MB 的伙伴块
+    CHECK_EQ(big.HeapIndex, 1u);
+    CHECK_EQ(pool.HeapCapacity(1), 4 * MB);
+    // 对齐比堆还大时也得到专用堆
+    CHECK_EQ(aligned.HeapIndex, 2u);
+    CHECK_EQ(pool.HeapCapacity(2), 2 * MB);
+    CHECK_EQ(aligned.Offset % (2 * MB), 0u);
+}
+
+TEST_CASE(PoolAllocateInHeapAndInvalidFrees)
+{
+    HeapPool pool(1 * MB);
+    CHECK(!pool.AllocateInHeap(0, 64 * KB).IsValid()); // 还没有堆
+
+    PoolAllocation a = pool.Allocate(64 * KB);
+    PoolAllocation b = pool.AllocateInHeap(0, 64 * KB);
+    CHECK_EQ(b.HeapIndex, 0u);
+    CHECK(!pool.AllocateInHeap(0, 2 * MB).IsValid());
+    CHECK(!pool.AllocateInHeap(7, 64 * KB).IsValid());
+
+    pool.Free(PoolAllocation());
+    PoolAllocation bogus = a;
+    bogus.HeapIndex = 9;
+    pool.Free(bogus);
+    CHECK_EQ(pool.GetHeapStats()[0].AllocationCount, 2u);
+
+    pool.Free(a);
+    pool.Free(b);
+    CHECK_EQ(pool.GetHeapStats()[0].AllocatedBytes, 0u);
+}
+
+TEST_CASE(PoolHeapStats)
+{
+    HeapPool pool(1 * MB);
+    pool.Allocate(100 * KB);
+    pool.Allocate(10 * KB);
+    pool.Allocate(2 * MB);
+
+    std::vector<HeapStats> stats = pool.GetHeapStats();
+    REQUIRE(stats.size() == 2);
+
+    CHECK_EQ(stats[0].HeapIndex, 0u);
+    CHECK_EQ(stats[0].Capacity, 1 * MB);
+    CHECK_EQ(stats[0].AllocatedBytes, 128 * KB + 64 * KB);
+    CHECK_EQ(stats[0].RequestedBytes, 110 * KB);
+    CHECK_EQ(stats[0].AllocationCount, 2u);
+    CHECK_EQ(stats[0].LargestFreeBlock, 512 * KB);
+
+    CHECK_EQ(stats[1].Capacity, 2 * MB);
+    CHECK_EQ(stats[1].AllocatedBytes, 2 * MB);
+    CHECK_EQ(stats[1].LargestFreeBlock, 0u);
+    CHECK_EQ(stats[1].FreeBlockCount, 0u);
+}
+
+namespace
+{
+    // 按计划执行搬迁：先在目标堆分配，再释放源分配
+    void ExecutePlan(HeapPool& pool, const DefragPlan& plan)
+    {
+        for(const DefragMove& move : plan.Moves)
+        {
+            PoolAllocation dest = pool.AllocateInHeap(move.DestHeap, move.Source.Size, move.BlockSize);
+            CHECK(dest.IsValid());
+            CHECK_EQ(dest.Offset, move.DestOffset);
+        }
+        for(const DefragMove& move : plan.Moves)
+            pool.Free(move.Source);
+    }
+
+    // 三个 1MB 的堆，各分配 8 个 128KB，再在每个堆里释放一部分
+    HeapPool MakeFragmentedPool(std::vector<PoolAllocation>& live)
+    {
+        HeapPool pool(1 * MB);
+        std::vector<PoolAllocation> all;
+        for(int i = 0; i < 24; ++i)
+            all.push_back(pool.Allocate(128 * KB));
+
+        // 堆 0 留 5 个（空出 3 个位置），堆 1 留 2 个，堆 2 留 1 个
+        const int keep[] = { 5, 2, 1 };
+        for(int h = 0; h < 3; ++h)
+        {
+            for(int i = 0; i < 8; ++i)
+            {
+                const PoolAllocation& a = all[h * 8 + i];
+                if(i < keep[h])
+                    live.push_back(a);
+                else
+                    pool.Free(a);
+            }
+        }
+        return pool;
+    }
+}
+
+TEST_CASE(DefragPlanEmptiesLeastUsedHeaps)
+{
+    std::vector<PoolAllocation> live;
+    HeapPool pool = MakeFragmentedPool(live);
+    std::vector<HeapStats> before = pool.GetHeapStats();
+
+    DefragPlan plan = pool.PlanDefragmentation();
+
+    // 计划只是模拟，不改动真实状态
+    std::vector<HeapStats> after = pool.GetHeapStats();
+    for(std::size_t i = 0; i < before.size(); ++i)
+    {
+        CHECK_EQ(after[i].AllocatedBytes, before[i].AllocatedBytes);
+        CHECK_EQ(after[i].AllocationCount, before[i].AllocationCount);
+    }
+
+    // 堆 2（1 个分配）和堆 1（2 个分配）都能搬进堆 0 的空位
+    REQUIRE(plan.FreedHeaps.size() == 2);
+    CHECK_EQ(plan.FreedHeaps[0], 2u);
+    CHECK_EQ(plan.FreedHeaps[1], 1u);
+    CHECK_EQ(plan.Moves.size(), 3u);
+    CHECK_EQ(plan.BytesMoved, 3 * 128 * KB);
+    for(const DefragMove& move : plan.Moves)
+    {
+        CHECK_EQ(move.DestHeap, 0u);
+        CHECK_EQ(move.BlockSize, 128 * KB);
+    }
+
+    ExecutePlan(pool, plan);
+    std::vector<HeapStats> stats = pool.GetHeapStats();
+    CHECK_EQ(stats[0].AllocatedBytes, 1 * MB);
+    CHECK_EQ(stats[1].AllocationCount, 0u);
+    CHECK_EQ(stats[2].AllocationCount, 0u);
+
+    // 整理完以后没有可以再腾空的堆
+    DefragPlan again = pool.PlanDefragmentation();
+    CHECK(again.Moves.empty());
+    CHECK(again.FreedHeaps.empty());
+}
+
+TEST_CASE(DefragPlanRespectsByteBudget)
+{
+    std::vector<PoolAllocation> live;
+    HeapPool pool = MakeFragmentedPool(live);
+
+    // 只够搬一个 128KB：只腾空堆 2
+    DefragPlan plan = pool.PlanDefragmentation(200 * KB);
+    REQUIRE(plan.FreedHeaps.size() == 1);
+    CHECK_EQ(plan.FreedHeaps[0], 2u);
+    CHECK_EQ(plan.BytesMoved, 128 * KB);
+    CHECK(plan.BytesMoved <= 200 * KB);
+
+    // 连一个都搬不动
+    DefragPlan none = pool.PlanDefragmentation(64 * KB);
+    CHECK(none.Moves.empty());
+    CHECK_EQ(none.BytesMoved, 0u);
+}
+
+TEST_CASE(DefragPlanSkipsHeapsThatCannotBeEmptied)
+{
+    HeapPool pool(1 * MB);
+    // 堆 0：512KB + 256KB + 64KB，剩 192KB
+    pool.Allocate(512 * KB);
+    pool.Allocate(256 * KB);
+    pool.Allocate(64 * KB);
+    // 堆 0 放不下，追加堆 1：512KB + 256KB，剩 256KB
+    PoolAllocation c = pool.Allocate(512 * KB);
+    PoolAllocation d = pool.Allocate(256 * KB);
+    CHECK_EQ(c.HeapIndex, 1u);
+    CHECK_EQ(d.HeapIndex, 1u);
+
+    // 哪个堆的分配都装不进另一个堆的空闲空间，计划为空
+    DefragPlan plan = pool.PlanDefragmentation();
+    CHECK(plan.Moves.empty());
+    CHECK(plan.FreedHeaps.empty());
+    CHECK_EQ(plan.BytesMoved, 0u);
+}
+
+TEST_CASE(DefragPlanDoesNotMoveIntoEmptyHeaps)
+{
+    HeapPool pool(1 * MB);
+    PoolAllocation a = pool.Allocate(512 * KB);
+    PoolAllocation b = pool.Allocate(1 * MB);
+    PoolAllocation c = pool.Allocate(256 * KB);
+    CHECK_EQ(a.HeapIndex, 0u);
+    CHECK_EQ(b.HeapIndex, 1u);
+    CHECK_EQ(c.HeapIndex, 0u);
+    pool.Free(b);
+
+    // 堆 0 没有别的地方可去：搬进空着的堆 1 只是换了个堆，腾不出任何空间
+    DefragPlan plan = pool.PlanDefragmentation();
+    CHECK(plan.Moves.empty());
+    CHECK(plan.FreedHeaps.empty());
+}
+
+TEST_CASE(DefragPlanOnRandomPoolIsExecutable)
+{
+    std::mt19937 rng(2028);
+    std::uniform_int_distribution<std::uint64_t> sizeDist(1, 512 * KB);
+
+    HeapPool pool(4 * MB);
+    std::vector<PoolAllocation> live;
+    for(int i = 0; i < 400; ++i)
+        live.push_back(pool.Allocate(sizeDist(rng)));
+    std::shuffle(live.begin(), live.end(), rng);
+    for(std::size_t i = 0; i < live.size() * 3 / 4; ++i)
+        pool.Free(live[i]);
+    live.erase(live.begin(), live.begin() + live.size() * 3 / 4);
+
+    std::uint32_t heapsInUse = 0;
+    for(const HeapStats& s : pool.GetHeapStats())
+        heapsInUse += s.AllocationCount != 0 ? 1 : 0;
+
+    DefragPlan plan = pool.PlanDefragmentation();
+    CHECK(!plan.FreedHeaps.empty());
+
+    std::uint64_t planned = 0;
+    for(const DefragMove& move : plan.Moves)
+    {
+        planned += move.Source.Size;
+        CHECK(std::find(plan.FreedHeaps.begin(), plan.FreedHeaps.end(), move.Source.HeapIndex) != plan.FreedHeaps.end());
+        CHECK(std::find(plan.FreedHeaps.begin(), plan.FreedHeaps.end(), move.DestHeap) == plan.FreedHeaps.end());
+    }
+    CHECK_EQ(planned, plan.BytesMoved);
+
+    ExecutePlan(pool, plan);
+
+    std::uint32_t heapsAfter = 0;
+    std::vector<HeapStats> stats = pool.GetHeapStats();
+    for(const HeapStats& s : stats)
+        heapsAfter += s.AllocationCount != 0 ? 1 : 0;
+    for(std::uint32_t freed : plan.FreedHeaps)
+        CHECK_EQ(stats[freed].AllocationCount, 0u);
+    CHECK_EQ(heapsAfter, heapsInUse - (std::uint32_t)plan.FreedHeaps.size());
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,78 @@
+// 间接命令参数的吞吐基准：BuildIndirectDrawCommands 把实例组写进（模拟的）上传堆、
+// BuildIndirectRuns 按几何体分段，以及每帧为间接命令预留的上传字节数：
+// 原来按每个渲染项一条预留，现在按上一次的组数加余量（IndirectCommandCapacity）。
+//
+//   IndirectDrawBenchmark [--quick]
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "IndirectDraw.h"
+#include "WriteCombined.h"
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const int repeats = quick ? 1 : 20;
+    const std::size_t groupCounts[] = { 1000, 10000, 100000 };
+    const std::size_t minHeadroom = 256; // Renderer::MinIndirectHeadroom
+
+    std::printf("groups   build ms   MB/s      ns/cmd   runs   runs ms\n");
+    for(std::size_t groupCount : groupCounts)
+    {
+        if(quick && groupCount > 10000)
+            break;
+
+        // 按排序键排好的实例组：相邻的组经常共用几何体
+        std::mt19937 rng(42);
+        std::vector<InstanceGroup> groups(groupCount);
+        std::uint32_t first = 0;
+        std::uint64_t geometry = 0;
+        for(InstanceGroup& group : groups)
+        {
+            if(rng() % 16 == 0)
+                geometry++;
+            group.Key.Geometry = geometry;
+            group.Key.PrimitiveTopology = 4;
+            group.Key.Material = rng() % 64;
+            group.Key.IndexCount = 36;
+            group.Key.StartIndexLocation = 3 * (rng() % 1000);
+            group.Key.BaseVertexLocation = (std::int32_t)(rng() % 1000);
+            group.FirstInstance = first;
+            group.InstanceCount = 1 + rng() % 4;
+            first += group.InstanceCount;
+        }
+
+        // 模拟映射的上传堆，16 字节对齐
+        std::vector<IndirectDrawCommand> mapped(groupCount);
+        double buildMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            BuildIndirectDrawCommands(groups.data(), groups.size(), mapped.data());
+            WriteCombined::Fence();
+        });
+
+        std::vector<IndirectRun> runs;
+        runs.reserve(groupCount);
+        double runsMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            BuildIndirectRuns(groups.data(), groups.size(), runs);
+        });
+
+        double megabytes = groupCount * sizeof(IndirectDrawCommand) / (1024.0 * 1024.0);
+        std::printf("%6zu  %8.3f  %8.1f  %7.2f  %5zu  %8.3f\n", groupCount, buildMs, megabytes / (buildMs / 1000.0),
+            buildMs * 1e6 / groupCount, runs.size(), runsMs);
+        Benchmark::DoNotOptimize(mapped[groupCount / 2].InstanceCount);
+    }
+
+    // 每帧预留：渲染项数和实例组数相差越大（实例化合并得越多），按组数预留省得越多
+    std::printf("\nitems     groups   per-item reserve   per-group reserve\n");
+    const std::size_t scenes[][2] = { { 10000, 9000 }, { 100000, 2000 }, { 1000000, 5000 }, { 1000000, 1000000 } };
+    for(const auto& scene : scenes)
+    {
+        std::size_t capacity = IndirectCommandCapacity(scene[1], 0, scene[0], minHeadroom);
+        std::printf("%7zu  %7zu  %14.2f MB  %15.2f MB\n", scene[0], scene[1],
+            scene[0] * sizeof(IndirectDrawCommand) / (1024.0 * 1024.0),
+            capacity * sizeof(IndirectDrawCommand) / (1024.0 * 1024.0));
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// IndirectDraw.h 的单元测试：间接命令的字节布局、按几何体和图元拓扑分段，
+// 以及按上一次的组数预留间接命令的条数（增长、余量内不变、收缩的滞后）
+#include <cstring>
+#include <vector>
+#include "IndirectDraw.h"
+#include "WriteCombined.h"
+#include "TestHarness.h"
+
+namespace
+{
+    InstanceGroup MakeGroup(std::uint64_t geometry, std::uint32_t topology, std::uint32_t material,
+        std::uint32_t firstInstance, std::uint32_t instanceCount)
+    {
+        InstanceGroup group;
+        group.Key.Geometry = geometry;
+        group.Key.PrimitiveTopology = topology;
+        group.Key.Material = material;
+        group.Key.IndexCount = 36 + material;
+        group.Key.StartIndexLocation = 3 * material;
+        group.Key.BaseVertexLocation = -(std::int32_t)material;
+        group.FirstInstance = firstInstance;
+        group.InstanceCount = instanceCount;
+        return group;
+    }
+}
+
+TEST_CASE(CommandsMatchGroups)
+{
+    std::vector<InstanceGroup> groups;
+    std::uint32_t first = 0;
+    for(std::uint32_t i = 0; i < 37; ++i)
+    {
+        groups.push_back(MakeGroup(i / 5, 4, i, first, 1 + i % 3));
+        first += 1 + i % 3;
+    }
+
+    // 写进 16 字节对齐的缓冲区，前后各留一条检查没有越界
+    std::vector<IndirectDrawCommand> storage(groups.size() + 2);
+    // 按字节填充哨兵值；IndirectDrawCommand 有默认成员初始化，不是平凡类型，经 void* 传给 memset
+    std::memset(static_cast<void*>(storage.data()), 0xcd, storage.size() * sizeof(IndirectDrawCommand));
+    BuildIndirectDrawCommands(groups.data(), groups.size(), storage.data() + 1);
+    WriteCombined::Fence();
+
+    for(std::size_t i = 0; i < groups.size(); ++i)
+    {
+        const IndirectDrawCommand& command = storage[i + 1];
+        CHECK_EQ(command.BaseInstance, groups[i].FirstInstance);
+        CHECK_EQ(command.MaterialIndex, groups[i].Key.Material);
+        CHECK_EQ(command.IndexCountPerInstance, groups[i].Key.IndexCount);
+        CHECK_EQ(command.InstanceCount, groups[i].InstanceCount);
+        CHECK_EQ(command.StartIndexLocation, groups[i].Key.StartIndexLocation);
+        CHECK_EQ(command.BaseVertexLocation, groups[i].Key.BaseVertexLocation);
+        CHECK_EQ(command.StartInstanceLocation, 0u);
+        CHECK_EQ(command.Padding, 0u);
+    }
+    const std::uint8_t* before = reinterpret_cast<const std::uint8_t*>(&storage.front());
+    const std::uint8_t* after = reinterpret_cast<const std::uint8_t*>(&storage.back());
+    for(std::size_t b = 0; b < sizeof(IndirectDrawCommand); ++b)
+    {
+        CHECK_EQ(before[b], 0xcd);
+        CHECK_EQ(after[b], 0xcd);
+    }
+}
+
+TEST_CASE(RunsSplitOnGeometryOrTopology)
+{
+    std::vector<InstanceGroup> groups = {
+        MakeGroup(1, 4, 0, 0, 1),
+        MakeGroup(1, 4, 1, 1, 1), // 只有材质不同，同一段
+        MakeGroup(1, 5, 2, 2, 1), // 拓扑不同
+        MakeGroup(2, 5, 3, 3, 1), // 几何体不同
+        MakeGroup(2, 5, 4, 4, 1),
+        MakeGroup(1, 4, 5, 5, 1), // 回到前面出现过的几何体也是新的一段
+    };
+    std::vector<IndirectRun> runs;
+    BuildIndirectRuns(groups.data(), groups.size(), runs);
+    REQUIRE(runs.size() == 4);
+    const std::size_t expected[4][2] = { { 0, 2 }, { 2, 3 }, { 3, 5 }, { 5, 6 } };
+    for(std::size_t r = 0; r < 4; ++r)
+    {
+        CHECK_EQ(runs[r].First, expected[r][0]);
+        CHECK_EQ(runs[r].Last, expected[r][1]);
+    }
+
+    BuildIndirectRuns(groups.data(), 0, runs);
+    CHECK(runs.empty());
+}
+
+TEST_CASE(CapacityFollowsPreviousGroupCount)
+{
+    const std::size_t items = 100000;
+    const std::size_t headroom = 256;
+
+    // 还没有分组：只预留余量
+    std::size_t capacity = IndirectCommandCapacity(0, 0, items, headroom);
+    CHECK_EQ(capacity, headroom);
+
+    // 组数超过预留：增长到组数加余量（余量取 1/8 和最小值中较大的）
+    capacity = IndirectCommandCapacity(1000, capacity, items, headroom);
+    CHECK_EQ(capacity, 1000u + 256u);
+    capacity = IndirectCommandCapacity(8000, capacity, items, headroom);
+    CHECK_EQ(capacity, 8000u + 1000u);
+
+    // 在余量内波动，或者下降不到一半，预留不变（块的大小不变就不用整块重写）
+    CHECK_EQ(IndirectCommandCapacity(8500, capacity, items, headroom), capacity);
+    CHECK_EQ(IndirectCommandCapacity(9000, capacity, items, headroom), capacity);
+    CHECK_EQ(IndirectCommandCapacity(5000, capacity, items, headroom), capacity);
+
+    // 降到一半以下才收缩
+    capacity = IndirectCommandCapacity(3000, capacity, items, headroom);
+    CHECK_EQ(capacity, 3000u + 375u);
+
+    // 不超过渲染项数（组数不可能更多）
+    CHECK_EQ(IndirectCommandCapacity(90000, capacity, items, headroom), items);
+    CHECK_EQ(IndirectCommandCapacity(10, 0, 50, headroom), 50u);
+    // 渲染项减少到预留之下时跟着收缩
+    CHECK_EQ(IndirectCommandCapacity(10, 300, 50, headroom), 50u);
+    CHECK_EQ(IndirectCommandCapacity(0, 0, 0, headroom), 0u);
+}
+
+TEST_CASE(CapacityAlwaysCoversPreviousGroups)
+{
+    // 任意组数序列下，预留都不少于上一次的组数，也不多于渲染项数
+    const std::size_t items = 20000;
+    std::size_t capacity = 0;
+    std::uint32_t state = 42;
+    for(int frame = 0; frame < 10000; ++frame)
+    {
+        state = state * 1664525u + 1013904223u;
+        std::size_t groups = (state >> 8) % (items + 1);
+        if(frame % 7 != 0)
+            groups = groups % 3000; // 大多数帧组数变化不大
+        capacity = IndirectCommandCapacity(groups, capacity, items, 256);
+        CHECK(capacity >= groups);
+        CHECK(capacity <= items);
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
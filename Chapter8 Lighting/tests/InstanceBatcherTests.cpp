@@ -0,0 +1,208 @@
+// InstanceBatcher 的单元测试：组按第一次出现的顺序排列、每个输入在 InstanceOrder 里恰好出现一次并且组内保持输入顺序、
+// FirstInstance 是各组实例数的前缀和、只差材质/子网格/图元拓扑的键分在不同的组、重复 Build 复用同一个对象，
+// 以及相同的键相邻和不相邻两种情况（相邻时走和上一个比较的捷径）
+#include <random>
+#include <vector>
+#include "InstanceBatcher.h"
+#include "TestHarness.h"
+
+namespace
+{
+    InstanceKey MakeKey(std::uint64_t geometry, std::uint32_t material, std::uint32_t submesh = 0,
+        std::uint32_t topology = 4)
+    {
+        InstanceKey key;
+        key.Geometry = geometry;
+        key.Material = material;
+        key.IndexCount = 36 + submesh * 6;
+        key.StartIndexLocation = submesh * 100;
+        key.BaseVertexLocation = (std::int32_t)submesh * 24;
+        key.PrimitiveTopology = topology;
+        return key;
+    }
+
+    // 与朴素做法逐项比较：线性查找得到每个输入的组，组内按输入顺序
+    void CheckAgainstReference(const InstanceBatcher& batcher, const std::vector<InstanceKey>& keys)
+    {
+        std::vector<InstanceKey> expectedKeys;
+        std::vector<std::vector<std::uint32_t>> expectedMembers;
+        for(std::size_t i = 0; i < keys.size(); ++i)
+        {
+            std::size_t g = 0;
+            while(g < expectedKeys.size() && !(expectedKeys[g] == keys[i]))
+                g++;
+            if(g == expectedKeys.size())
+            {
+                expectedKeys.push_back(keys[i]);
+                expectedMembers.emplace_back();
+            }
+            expectedMembers[g].push_back((std::uint32_t)i);
+        }
+
+        const std::vector<InstanceGroup>& groups = batcher.Groups();
+        const std::vector<std::uint32_t>& order = batcher.InstanceOrder();
+        REQUIRE(groups.size() == expectedKeys.size());
+        REQUIRE(order.size() == keys.size());
+
+        std::uint32_t firstInstance = 0;
+        for(std::size_t g = 0; g < groups.size(); ++g)
+        {
+            CHECK(groups[g].Key == expectedKeys[g]);
+            CHECK_EQ(groups[g].FirstInstance, firstInstance);
+            REQUIRE(groups[g].InstanceCount == expectedMembers[g].size());
+            for(std::uint32_t k = 0; k < groups[g].InstanceCount; ++k)
+                CHECK_EQ(order[groups[g].FirstInstance + k], expectedMembers[g][k]);
+            firstInstance += groups[g].InstanceCount;
+        }
+        CHECK_EQ((std::size_t)firstInstance, keys.size());
+
+        std::vector<int> seen(keys.size(), 0);
+        for(std::uint32_t index : order)
+        {
+            REQUIRE(index < keys.size());
+            seen[index]++;
+        }
+        for(int count : seen)
+            CHECK_EQ(count, 1);
+    }
+}
+
+TEST_CASE(GroupsFollowFirstAppearanceAndKeepInputOrder)
+{
+    const InstanceKey a = MakeKey(1, 0);
+    const InstanceKey b = MakeKey(2, 0);
+    const InstanceKey c = MakeKey(1, 1);
+    const std::vector<InstanceKey> keys = { b, a, b, c, a, a, b };
+
+    InstanceBatcher batcher;
+    batcher.Build(keys.data(), keys.size());
+    const std::vector<InstanceGroup>& groups = batcher.Groups();
+    REQUIRE(groups.size() == 3);
+    CHECK(groups[0].Key == b);
+    CHECK(groups[1].Key == a);
+    CHECK(groups[2].Key == c);
+    CHECK_EQ(groups[0].InstanceCount, 3u);
+    CHECK_EQ(groups[1].InstanceCount, 3u);
+    CHECK_EQ(groups[2].InstanceCount, 1u);
+    CHECK_EQ(groups[1].FirstInstance, 3u);
+    CHECK_EQ(groups[2].FirstInstance, 6u);
+
+    const std::vector<std::uint32_t> expectedOrder = { 0, 2, 6, 1, 4, 5, 3 };
+    CHECK(batcher.InstanceOrder() == expectedOrder);
+    CheckAgainstReference(batcher, keys);
+}
+
+TEST_CASE(KeysDifferingInOneFieldAreSeparateGroups)
+{
+    const InstanceKey base = MakeKey(7, 3, 1, 4);
+    InstanceKey material = base;
+    material.Material = 4;
+    InstanceKey indexCount = base;
+    indexCount.IndexCount++;
+    InstanceKey startIndex = base;
+    startIndex.StartIndexLocation++;
+    InstanceKey baseVertex = base;
+    baseVertex.BaseVertexLocation = -1;
+    InstanceKey topology = base;
+    topology.PrimitiveTopology = 5;
+    InstanceKey geometry = base;
+    geometry.Geometry = 8;
+
+    // 每个变体夹在两个 base 之间，也和前一个输入比较不相等
+    const std::vector<InstanceKey> variants = { material, indexCount, startIndex, baseVertex, topology, geometry };
+    std::vector<InstanceKey> keys = { base };
+    for(const InstanceKey& variant : variants)
+    {
+        keys.push_back(variant);
+        keys.push_back(base);
+    }
+
+    InstanceBatcher batcher;
+    batcher.Build(keys.data(), keys.size());
+    REQUIRE(batcher.Groups().size() == 1 + variants.size());
+    CHECK_EQ(batcher.Groups()[0].InstanceCount, (std::uint32_t)(1 + variants.size()));
+    for(std::size_t v = 0; v < variants.size(); ++v)
+    {
+        CHECK(batcher.Groups()[1 + v].Key == variants[v]);
+        CHECK_EQ(batcher.Groups()[1 + v].InstanceCount, 1u);
+    }
+    CheckAgainstReference(batcher, keys);
+}
+
+TEST_CASE(AdjacentAndScatteredDuplicatesGroupTheSame)
+{
+    const InstanceKey a = MakeKey(1, 0);
+    const InstanceKey b = MakeKey(2, 0);
+
+    // 全部相邻（只走捷径）、完全交替（每次都查表）、回到早先的组之后又相邻
+    const std::vector<std::vector<InstanceKey>> inputs =
+    {
+        { a, a, a, a },
+        { a, b, a, b, a, b },
+        { a, a, b, b, a, a, b },
+        { a },
+    };
+    for(const std::vector<InstanceKey>& keys : inputs)
+    {
+        InstanceBatcher batcher;
+        batcher.Build(keys.data(), keys.size());
+        CheckAgainstReference(batcher, keys);
+    }
+
+    InstanceBatcher empty;
+    empty.Build(nullptr, 0);
+    CHECK(empty.Groups().empty());
+    CHECK(empty.InstanceOrder().empty());
+}
+
+TEST_CASE(RebuildDiscardsThePreviousResult)
+{
+    InstanceBatcher batcher;
+    std::vector<InstanceKey> large;
+    for(std::uint32_t i = 0; i < 100; ++i)
+        large.push_back(MakeKey(i % 10, i % 3));
+    batcher.Build(large.data(), large.size());
+    CheckAgainstReference(batcher, large);
+
+    // 更少的输入、完全不同的键：之前的组和顺序都不能残留
+    const std::vector<InstanceKey> small = { MakeKey(50, 1), MakeKey(51, 1), MakeKey(50, 1) };
+    batcher.Build(small.data(), small.size());
+    CheckAgainstReference(batcher, small);
+
+    // 同样的输入再来一次，结果相同
+    batcher.Build(large.data(), large.size());
+    CheckAgainstReference(batcher, large);
+    batcher.Build(large.data(), large.size());
+    CheckAgainstReference(batcher, large);
+
+    batcher.Build(nullptr, 0);
+    CHECK(batcher.Groups().empty());
+    CHECK(batcher.InstanceOrder().empty());
+}
+
+TEST_CASE(RandomInputsMatchTheReference)
+{
+    std::mt19937 rng(41);
+    InstanceBatcher batcher;
+    for(int round = 0; round < 200; ++round)
+    {
+        std::size_t count = rng() % 500;
+        std::uint32_t distinct = 1 + rng() % 40;
+        bool sorted = rng() % 2 == 0; // 模拟按排序键排好的输入，相同的键成段出现
+        std::vector<InstanceKey> keys(count);
+        std::uint32_t current = rng() % distinct;
+        for(InstanceKey& key : keys)
+        {
+            if(!sorted || rng() % 8 == 0)
+                current = rng() % distinct;
+            key = MakeKey(current % 5, current / 5 % 3, current / 15, current % 2 == 0 ? 4 : 5);
+        }
+        batcher.Build(keys.data(), keys.size());
+        CheckAgainstReference(batcher, keys);
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
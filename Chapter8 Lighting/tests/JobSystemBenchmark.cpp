@@ -0,0 +1,84 @@
+// 作业系统的扩展性基准：线程总数从 1 到 64，测量
+//   1. ParallelFor 处理计算量均匀的数组（与 Renderer 的物体更新相当的粒度）；
+//   2. 大量空作业的 Run + Wait（调度本身的开销）；
+//   3. 计数器链上的 RunAfter 后续作业。
+// 超过硬件线程数之后是超额订阅，加速比应当持平而不是明显下降。
+//
+//   JobSystemBenchmark [--quick]
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::size_t itemCount = quick ? 20000 : 1000000;
+    const std::size_t grainSize = 64; // Renderer::ObjectUpdateGrainSize
+    const int emptyJobCount = quick ? 2000 : 100000;
+    const int chainLength = quick ? 100 : 10000;
+    const int repeats = quick ? 1 : 5;
+
+    std::vector<unsigned> threadCounts = quick ? std::vector<unsigned>{ 1, 2, 4 } :
+        std::vector<unsigned>{ 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+
+    std::vector<float> input(itemCount);
+    std::vector<float> output(itemCount);
+    for(std::size_t i = 0; i < itemCount; ++i)
+        input[i] = (float)i * 0.001f;
+
+    std::printf("%zu items, grain %zu, %d empty jobs, chain of %d, hardware threads %u\n",
+        itemCount, grainSize, emptyJobCount, chainLength, std::thread::hardware_concurrency());
+    std::printf("threads  parallel-for ms  speedup   empty jobs ns/job   chain ns/link\n");
+
+    double singleThreadMs = 0.0;
+    for(unsigned threads : threadCounts)
+    {
+        JobSystem jobs(threads - 1);
+
+        double forMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            jobs.ParallelFor(0, itemCount, grainSize, [&](std::size_t first, std::size_t last)
+            {
+                for(std::size_t i = first; i < last; ++i)
+                {
+                    float x = input[i];
+                    for(int k = 0; k < 16; ++k)
+                        x = std::sqrt(x * x + 1.0f) * 0.5f;
+                    output[i] = x;
+                }
+            });
+        });
+        if(threads == 1)
+            singleThreadMs = forMs;
+
+        double emptyMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            JobCounter counter;
+            for(int i = 0; i < emptyJobCount; ++i)
+                jobs.Run([]() {}, &counter);
+            jobs.Wait(counter);
+        });
+
+        double chainMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            std::vector<JobCounter> counters((std::size_t)chainLength);
+            jobs.Run([]() {}, &counters[0]);
+            for(int i = 1; i < chainLength; ++i)
+                jobs.RunAfter(counters[(std::size_t)i - 1], []() {}, &counters[(std::size_t)i]);
+            for(JobCounter& counter : counters)
+                jobs.Wait(counter);
+        });
+
+        std::printf("%7u  %15.3f  %7.2fx   %17.1f   %13.1f\n", threads, forMs,
+            singleThreadMs / forMs, emptyMs * 1e6 / emptyJobCount, chainMs * 1e6 / chainLength);
+    }
+
+    float checksum = 0.0f;
+    for(std::size_t i = 0; i < itemCount; i += 97)
+        checksum += output[i];
+    Benchmark::DoNotOptimize(checksum);
+    return 0;
+}
@@ -0,0 +1,462 @@
+// JobSystem 的压力测试：Chase-Lev 队列的所有者弹出与多个窃取者之间的竞争、
+// ParallelFor 对每个下标恰好执行一次、JobCounter 的等待和 RunAfter 后续作业的顺序，以及异常的传递。
+// 每个用例在不同的工作线程数下各跑一遍（单核机器上同样会交错执行）
+#include <atomic>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "JobSystem.h"
+#include "TestHarness.h"
+
+namespace
+{
+    const unsigned WorkerCounts[] = { 0, 1, 3, 7 };
+}
+
+TEST_CASE(DequeIsLifoForOwnerAndFifoForThieves)
+{
+    WorkStealingDeque deque(4);
+    CHECK_EQ(deque.Capacity(), 4u);
+
+    Job jobs[5];
+    for(int i = 0; i < 4; ++i)
+        CHECK(deque.Push(&jobs[i]));
+    CHECK(!deque.Push(&jobs[4])); // 满了
+
+    CHECK(deque.Steal() == &jobs[0]);
+    CHECK(deque.Pop() == &jobs[3]);
+    CHECK(deque.Steal() == &jobs[1]);
+    CHECK(deque.Pop() == &jobs[2]);
+    CHECK(deque.Pop() == nullptr);
+    CHECK(deque.Steal() == nullptr);
+
+    // 取空之后可以继续使用（环形缓冲区绕回）
+    for(int round = 0; round < 10; ++round)
+    {
+        CHECK(deque.Push(&jobs[round % 5]));
+        CHECK(deque.Pop() == &jobs[round % 5]);
+    }
+}
+
+TEST_CASE(DequeOwnerAndThievesTakeEachJobOnce)
+{
+    // 所有者不断压入、弹出，几个线程同时窃取；每个作业只能被取走一次，一个都不能丢。
+    // 所有者每次只压入少量作业再弹出，经常只剩最后一个元素，覆盖 Pop 与 Steal 争抢同一个元素的路径
+    const int jobCount = 200000;
+    const int thiefCount = 3;
+    std::vector<Job> jobs(jobCount);
+    std::vector<std::atomic<int>> taken(jobCount);
+    for(auto& t : taken)
+        t.store(0);
+
+    WorkStealingDeque deque(64);
+    std::atomic<bool> ownerDone(false);
+    std::atomic<int> stolen(0);
+
+    auto take = [&](Job* job)
+    {
+        taken[(std::size_t)(job - jobs.data())].fetch_add(1);
+    };
+
+    std::vector<std::thread> thieves;
+    for(int t = 0; t < thiefCount; ++t)
+    {
+        thieves.emplace_back([&]()
+        {
+            while(!ownerDone.load())
+            {
+                if(Job* job = deque.Steal())
+                {
+                    take(job);
+                    stolen++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::mt19937 rng(35);
+    int popped = 0;
+    int next = 0;
+    while(next < jobCount)
+    {
+        int burst = 1 + (int)(rng() % 4);
+        for(int k = 0; k < burst && next < jobCount; ++k)
+        {
+            if(deque.Push(&jobs[(std::size_t)next]))
+                next++;
+        }
+        int pops = (int)(rng() % 4);
+        for(int k = 0; k < pops; ++k)
+        {
+            if(Job* job = deque.Pop())
+            {
+                take(job);
+                popped++;
+            }
+        }
+    }
+    while(Job* job = deque.Pop())
+    {
+        take(job);
+        popped++;
+    }
+    ownerDone = true;
+    for(std::thread& t : thieves)
+        t.join();
+
+    CHECK_EQ(popped + stolen.load(), jobCount);
+    int wrong = 0;
+    for(auto& t : taken)
+        wrong += t.load() != 1 ? 1 : 0;
+    CHECK_EQ(wrong, 0);
+}
+
+TEST_CASE(ParallelForCoversEveryIndexOnce)
+{
+    struct Range
+    {
+        std::size_t Begin;
+        std::size_t End;
+        std::size_t Grain;
+    };
+    const Range ranges[] = {
+        { 0, 0, 16 },       // 空
+        { 5, 3, 16 },       // end < begin
+        { 0, 1, 16 },
+        { 0, 1000, 0 },     // grainSize 0 按 1 处理
+        { 0, 1000, 1 },
+        { 7, 1000, 64 },    // 最后一块不满
+        { 0, 1024, 64 },    // 正好整除
+        { 100, 150, 1000 }, // 一块
+        { 0, 100000, 97 },
+    };
+
+    for(unsigned workers : WorkerCounts)
+    {
+        JobSystem jobs(workers);
+        CHECK_EQ(jobs.ThreadCount(), workers + 1);
+        for(const Range& range : ranges)
+        {
+            std::size_t size = range.End > range.Begin ? range.End : range.Begin;
+            std::vector<std::atomic<int>> hits(size + 1);
+            for(auto& h : hits)
+                h.store(0);
+            std::atomic<int> calls(0);
+
+            jobs.ParallelFor(range.Begin, range.End, range.Grain, [&](std::size_t first, std::size_t last)
+            {
+                calls++;
+                CHECK(first < last);
+                CHECK(last - first <= (range.Grain == 0 ? 1 : range.Grain));
+                for(std::size_t i = first; i < last; ++i)
+                    hits[i]++;
+            });
+
+            int wrong = 0;
+            for(std::size_t i = 0; i < hits.size(); ++i)
+            {
+                int expected = i >= range.Begin && i < range.End ? 1 : 0;
+                wrong += hits[i].load() != expected ? 1 : 0;
+            }
+            CHECK_EQ(wrong, 0);
+            if(range.End > range.Begin)
+            {
+                std::size_t grain = range.Grain == 0 ? 1 : range.Grain;
+                CHECK_EQ((std::size_t)calls.load(), (range.End - range.Begin + grain - 1) / grain);
+            }
+        }
+    }
+}
+
+TEST_CASE(NestedParallelForAndManySmallJobs)
+{
+    // 作业里再 ParallelFor（Renderer 的帧作业就是这样），以及一次提交超过队列容量的作业（溢出到注入队列）
+    for(unsigned workers : WorkerCounts)
+    {
+        JobSystem jobs(workers);
+        std::atomic<long long> sum(0);
+        jobs.ParallelFor(0, 64, 1, [&](std::size_t first, std::size_t)
+        {
+            jobs.ParallelFor(0, 256, 16, [&](std::size_t a, std::size_t b)
+            {
+                long long local = 0;
+                for(std::size_t i = a; i < b; ++i)
+                    local += (long long)(first * 256 + i);
+                sum += local;
+            });
+        });
+        const long long n = 64 * 256;
+        CHECK_EQ(sum.load(), n * (n - 1) / 2);
+
+        const int jobCount = 10000;
+        JobCounter counter;
+        std::atomic<int> ran(0);
+        for(int i = 0; i < jobCount; ++i)
+            jobs.Run([&ran]() { ran++; }, &counter);
+        jobs.Wait(counter);
+        CHECK(counter.IsDone());
+        CHECK_EQ(ran.load(), jobCount);
+    }
+}
+
+TEST_CASE(WaitOnUnusedCounterReturnsImmediately)
+{
+    JobSystem jobs(1);
+    JobCounter counter;
+    CHECK(counter.IsDone());
+    jobs.Wait(counter);
+
+    // 不关心完成时间的作业：计数器为空
+    std::atomic<int> ran(0);
+    jobs.Run([&ran]() { ran++; });
+    JobCounter after;
+    jobs.Run([]() {}, &after);
+    jobs.Wait(after);
+    while(ran.load() == 0)
+        std::this_thread::yield();
+    CHECK_EQ(ran.load(), 1);
+}
+
+TEST_CASE(RunAfterStartsOnlyWhenDependencyReachesZero)
+{
+    for(unsigned workers : WorkerCounts)
+    {
+        JobSystem jobs(workers);
+        for(int round = 0; round < 50; ++round)
+        {
+            // 扇入：N 个作业完成后，M 个后续作业才开始，看到的完成数必须是 N
+            const int producerCount = 32;
+            const int continuationCount = 8;
+            JobCounter produced;
+            JobCounter consumed;
+            std::atomic<int> finished(0);
+            std::atomic<int> earlyStarts(0);
+            std::atomic<int> continuationsRan(0);
+
+            for(int i = 0; i < producerCount; ++i)
+            {
+                jobs.Run([&finished, i]()
+                {
+                    if(i % 4 == 0)
+                        std::this_thread::yield();
+                    finished++;
+                }, &produced);
+            }
+            for(int i = 0; i < continuationCount; ++i)
+            {
+                jobs.RunAfter(produced, [&]()
+                {
+                    if(finished.load() != producerCount)
+                        earlyStarts++;
+                    continuationsRan++;
+                }, &consumed);
+            }
+
+            jobs.Wait(consumed);
+            CHECK(produced.IsDone());
+            CHECK_EQ(continuationsRan.load(), continuationCount);
+            CHECK_EQ(earlyStarts.load(), 0);
+        }
+
+        // 依赖已经归零时直接执行
+        JobCounter done;
+        JobCounter counter;
+        std::atomic<int> ran(0);
+        jobs.RunAfter(done, [&ran]() { ran++; }, &counter);
+        jobs.Wait(counter);
+        CHECK_EQ(ran.load(), 1);
+    }
+}
+
+TEST_CASE(RunAfterChainsKeepOrder)
+{
+    // 一条 A -> B -> C ... 的链，每一环都挂在上一环的计数器上；
+    // 后续作业在前一环的作业里面提交，覆盖计数器归零与 RunAfter 同时发生的情况
+    for(unsigned workers : WorkerCounts)
+    {
+        JobSystem jobs(workers);
+        const int length = 200;
+        std::vector<std::unique_ptr<JobCounter>> counters;
+        for(int i = 0; i < length; ++i)
+            counters.push_back(std::make_unique<JobCounter>());
+
+        std::vector<int> order;
+        std::mutex orderMutex;
+        auto record = [&](int step)
+        {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(step);
+        };
+
+        jobs.Run([&]() { record(0); }, counters[0].get());
+        for(int i = 1; i < length; ++i)
+        {
+            jobs.Run([&, i]()
+            {
+                jobs.RunAfter(*counters[(std::size_t)i - 1], [&, i]() { record(i); }, counters[(std::size_t)i].get());
+            }, counters[(std::size_t)i].get());
+        }
+        jobs.Wait(*counters[(std::size_t)length - 1]);
+        // 链中间的计数器也要等，保证所有作业结束之后才销毁
+        for(auto& counter : counters)
+            jobs.Wait(*counter);
+
+        REQUIRE(order.size() == (std::size_t)length);
+        for(int i = 0; i < length; ++i)
+            CHECK_EQ(order[(std::size_t)i], i);
+    }
+}
+
+TEST_CASE(RandomDependencyGraphs)
+{
+    // 随机生成的有向无环图：每个节点挂在若干个更早的节点的计数器上，检查开始执行时所有前驱都已完成
+    for(unsigned workers : WorkerCounts)
+    {
+        JobSystem jobs(workers);
+        std::mt19937 rng(350 + workers);
+        for(int graph = 0; graph < 20; ++graph)
+        {
+            const int nodeCount = 300;
+            std::vector<std::unique_ptr<JobCounter>> counters;
+            std::vector<std::atomic<int>> done(nodeCount);
+            for(int i = 0; i < nodeCount; ++i)
+            {
+                counters.push_back(std::make_unique<JobCounter>());
+                done[(std::size_t)i].store(0);
+            }
+            std::atomic<int> violations(0);
+
+            for(int i = 0; i < nodeCount; ++i)
+            {
+                // 最多一个前驱时直接 RunAfter；多个前驱时用一个汇合计数器
+                int dependency = i > 0 && rng() % 4 != 0 ? (int)(rng() % (unsigned)i) : -1;
+                int second = dependency >= 0 && i > 1 ? (int)(rng() % (unsigned)i) : -1;
+                auto body = [&, i, dependency, second]()
+                {
+                    if(dependency >= 0 && done[(std::size_t)dependency].load() == 0)
+                        violations++;
+                    if(second >= 0 && done[(std::size_t)second].load() == 0)
+                        violations++;
+                    done[(std::size_t)i].store(1);
+                };
+
+                if(dependency < 0)
+                {
+                    jobs.Run(body, counters[(std::size_t)i].get());
+                }
+                else if(second < 0 || second == dependency)
+                {
+                    jobs.RunAfter(*counters[(std::size_t)dependency], [&, i, dependency]()
+                    {
+                        if(done[(std::size_t)dependency].load() == 0)
+                            violations++;
+                        done[(std::size_t)i].store(1);
+                    }, counters[(std::size_t)i].get());
+                }
+                else
+                {
+                    // 先等第一个前驱，在它的后续作业里再挂到第二个前驱上
+                    JobCounter* own = counters[(std::size_t)i].get();
+                    JobCounter* secondCounter = counters[(std::size_t)second].get();
+                    jobs.RunAfter(*counters[(std::size_t)dependency], [&jobs, own, secondCounter, body]()
+                    {
+                        jobs.RunAfter(*secondCounter, body, own);
+                    }, own);
+                }
+            }
+
+            for(auto& counter : counters)
+                jobs.Wait(*counter);
+            CHECK_EQ(violations.load(), 0);
+            int finished = 0;
+            for(auto& d : done)
+                finished += d.load();
+            CHECK_EQ(finished, nodeCount);
+        }
+    }
+}
+
+TEST_CASE(ExternalThreadsSubmitAndWait)
+{
+    // 不属于作业系统的线程提交作业（进入注入队列）并等待，Wait 在这些线程上也会帮忙执行
+    JobSystem jobs(2);
+    const int threadCount = 4;
+    const int jobsPerThread = 2000;
+    std::atomic<int> ran(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&]()
+        {
+            CHECK_EQ(jobs.CurrentThreadIndex(), -1);
+            JobCounter counter;
+            for(int i = 0; i < jobsPerThread; ++i)
+                jobs.Run([&ran]() { ran++; }, &counter);
+            jobs.Wait(counter);
+        });
+    }
+    for(std::thread& t : threads)
+        t.join();
+    CHECK_EQ(ran.load(), threadCount * jobsPerThread);
+    CHECK_EQ(jobs.CurrentThreadIndex(), 0);
+}
+
+TEST_CASE(ExceptionsPropagateToWait)
+{
+    for(unsigned workers : WorkerCounts)
+    {
+        JobSystem jobs(workers);
+
+        JobCounter counter;
+        std::atomic<int> ran(0);
+        for(int i = 0; i < 100; ++i)
+        {
+            jobs.Run([&ran, i]()
+            {
+                ran++;
+                if(i == 37)
+                    throw std::runtime_error("job 37");
+            }, &counter);
+        }
+        bool caught = false;
+        try
+        {
+            jobs.Wait(counter);
+        }
+        catch(const std::runtime_error&)
+        {
+            caught = true;
+        }
+        CHECK(caught);
+        CHECK_EQ(ran.load(), 100); // 其他作业照常完成
+
+        // 异常只抛一次
+        jobs.Wait(counter);
+
+        caught = false;
+        try
+        {
+            jobs.ParallelFor(0, 1000, 10, [](std::size_t first, std::size_t)
+            {
+                if(first == 500)
+                    throw std::runtime_error("chunk 500");
+            });
+        }
+        catch(const std::runtime_error&)
+        {
+            caught = true;
+        }
+        CHECK(caught);
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
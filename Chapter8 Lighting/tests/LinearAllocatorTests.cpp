@@ -0,0 +1,181 @@
+// LinearAllocator.h 的单元测试：底层是普通内存。每个子分配按 256 字节对齐、空间不足、Reset 回到 0、高水位，
+// 以及 GrowableLinearAllocator（FrameUploadRing 的增长策略）：至少增长一半、按 64KB 取整、只有换了内存时才返回 true
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "LinearAllocator.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 普通内存的 Backing，记录创建和释放的次数；GPU 地址用一个假的基址，检查它和 CPU 指针同步前进
+    struct PlainMemoryBacking
+    {
+        static constexpr std::uint64_t FakeGpuBase = 0x100000000ull;
+
+        struct Counters
+        {
+            int Created = 0;
+            int Released = 0;
+            std::uint64_t LastByteSize = 0;
+        };
+
+        std::shared_ptr<Counters> Stats = std::make_shared<Counters>();
+        std::unique_ptr<std::uint8_t[]> Memory;
+
+        LinearAllocator Create(std::uint64_t byteSize)
+        {
+            CHECK(Memory == nullptr); // 先 Release 再 Create
+            Memory.reset(new std::uint8_t[byteSize]);
+            Stats->Created++;
+            Stats->LastByteSize = byteSize;
+            return LinearAllocator(Memory.get(), FakeGpuBase, byteSize);
+        }
+
+        void Release()
+        {
+            Memory.reset();
+            Stats->Released++;
+        }
+    };
+}
+
+TEST_CASE(EverySuballocationIs256ByteAligned)
+{
+    std::vector<std::uint8_t> memory(64 * 1024);
+    LinearAllocator allocator(memory.data(), 0x10000, memory.size());
+
+    const std::uint64_t sizes[] = { 1, 255, 256, 257, 80, 4096, 3, 512, 1000 };
+    std::uint64_t previousEnd = 0;
+    for(std::uint64_t size : sizes)
+    {
+        LinearAllocation alloc = allocator.Allocate(size);
+        REQUIRE(alloc.IsValid());
+        CHECK_EQ(alloc.Offset % LinearAllocator::ConstantBufferAlignment, 0u);
+        CHECK_EQ(alloc.GpuAddress % LinearAllocator::ConstantBufferAlignment, 0u);
+        CHECK_EQ(alloc.GpuAddress, 0x10000 + alloc.Offset);
+        CHECK(alloc.CpuAddress == memory.data() + alloc.Offset);
+        CHECK_EQ(alloc.Size, size);
+        CHECK(alloc.Offset >= previousEnd); // 不重叠
+        CHECK(alloc.Offset - previousEnd < LinearAllocator::ConstantBufferAlignment); // 只跳过对齐需要的部分
+        previousEnd = alloc.Offset + size;
+        std::memset(alloc.CpuAddress, 0xAB, (std::size_t)size);
+    }
+    CHECK_EQ(allocator.Used(), previousEnd);
+
+    // 显式给出的其他对齐
+    LinearAllocation small = allocator.Allocate(4, 4);
+    REQUIRE(small.IsValid());
+    CHECK_EQ(small.Offset % 4, 0u);
+    CHECK(small.Offset < previousEnd + 4);
+    CHECK(!allocator.Allocate(16, 3).IsValid());
+    CHECK(!allocator.Allocate(16, 0).IsValid());
+}
+
+TEST_CASE(ExhaustionFailsWithoutMovingTheOffset)
+{
+    std::vector<std::uint8_t> memory(1024);
+    LinearAllocator allocator(memory.data(), 0, memory.size());
+
+    CHECK(allocator.Allocate(600).IsValid());
+    std::uint64_t used = allocator.Used();
+    // 对齐到 768 之后只剩 256 字节
+    CHECK(!allocator.Allocate(257).IsValid());
+    CHECK_EQ(allocator.Used(), used);
+    LinearAllocation last = allocator.Allocate(256);
+    REQUIRE(last.IsValid());
+    CHECK_EQ(last.Offset, 768u);
+    CHECK_EQ(allocator.Used(), 1024u);
+
+    // 满了以后任何非空请求都失败；对齐后的偏移超过容量也不会回绕
+    CHECK(!allocator.Allocate(1).IsValid());
+    CHECK(!allocator.Allocate(~0ull).IsValid());
+    CHECK_EQ(allocator.Used(), 1024u);
+
+    LinearAllocator empty;
+    CHECK(!empty.Allocate(1).IsValid());
+}
+
+TEST_CASE(ResetRewindsToZeroAndKeepsTheHighWatermark)
+{
+    std::vector<std::uint8_t> memory(4096);
+    LinearAllocator allocator(memory.data(), 0, memory.size());
+
+    allocator.Allocate(1000);
+    allocator.Allocate(1000);
+    CHECK_EQ(allocator.Used(), 2024u);
+    CHECK_EQ(allocator.HighWatermark(), 2024u);
+
+    allocator.Reset();
+    CHECK_EQ(allocator.Used(), 0u);
+    CHECK_EQ(allocator.HighWatermark(), 2024u);
+    LinearAllocation first = allocator.Allocate(16);
+    CHECK_EQ(first.Offset, 0u);
+
+    // 高水位只增不减
+    allocator.Reset();
+    allocator.Allocate(100);
+    CHECK_EQ(allocator.HighWatermark(), 2024u);
+    allocator.Allocate(3000);
+    CHECK_EQ(allocator.HighWatermark(), 3256u);
+}
+
+TEST_CASE(GrowableAllocatorKeepsTheBufferWhenItFits)
+{
+    PlainMemoryBacking backing;
+    std::shared_ptr<PlainMemoryBacking::Counters> stats = backing.Stats;
+    GrowableLinearAllocator<PlainMemoryBacking> ring(std::move(backing), 100000);
+    CHECK_EQ(stats->Created, 1);
+    CHECK_EQ(ring.Allocator().Capacity(), 100000u); // 初始容量不取整
+
+    ring.Allocate(5000);
+    CHECK(!ring.Reset());
+    CHECK(!ring.Reset(100000));
+    CHECK_EQ(ring.Allocator().Used(), 0u);
+    CHECK_EQ(stats->Created, 1);
+    CHECK_EQ(stats->Released, 0);
+}
+
+TEST_CASE(GrowableAllocatorGrowsByAtLeastHalfInWholeChunks)
+{
+    const std::uint64_t granularity = GrowableLinearAllocator<PlainMemoryBacking>::GrowthGranularity;
+    CHECK_EQ(granularity, 64u * 1024u);
+
+    PlainMemoryBacking backing;
+    std::shared_ptr<PlainMemoryBacking::Counters> stats = backing.Stats;
+    GrowableLinearAllocator<PlainMemoryBacking> ring(std::move(backing), 100000);
+
+    // 只多一个字节：至少增长一半（150000），再按 64KB 取整（196608）
+    ring.Allocate(90000);
+    CHECK(ring.Reset(100001));
+    CHECK_EQ(stats->Created, 2);
+    CHECK_EQ(stats->Released, 1);
+    CHECK_EQ(ring.Allocator().Capacity(), 3 * granularity);
+    CHECK_EQ(ring.Allocator().Used(), 0u);
+    CHECK_EQ(ring.Allocator().HighWatermark(), 0u); // 新的内存，统计重新开始
+
+    // 需要的比一半多：按需要的取整
+    CHECK(ring.Reset(1000000));
+    CHECK_EQ(ring.Allocator().Capacity(), 16 * granularity);
+    CHECK_EQ(stats->LastByteSize, 16 * granularity);
+
+    // 刚好是 64KB 的倍数时不再多取
+    CHECK(ring.Reset(32 * granularity));
+    CHECK_EQ(ring.Allocator().Capacity(), 32 * granularity);
+
+    // 增长之后的分配仍然成功并且对齐
+    LinearAllocation alloc = ring.Allocate(32 * granularity - 256);
+    CHECK(alloc.IsValid());
+    CHECK_EQ(alloc.Offset, 0u);
+
+    // 需要的更少时不收缩，也不换内存
+    CHECK(!ring.Reset(1000));
+    CHECK_EQ(ring.Allocator().Capacity(), 32 * granularity);
+    CHECK_EQ(stats->Created, 4);
+    CHECK_EQ(stats->Released, 3);
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,318 @@
+// 多线程录制的无头测试：用 NullGraphicsDevice 代替 D3D12，按 Renderer::Render 的方式
+// （第一批清屏、每个列表重新设置管线状态、StateCachingEncoder 过滤重复设置、最后一批转换到 PRESENT）
+// 把合成的实例组分批并行录制，检查合并提交后的命令流与在一个线程上依次录制同样的批次完全相同，
+// 绘制的顺序和参数与只用一个命令列表录制时一致
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "CommandStream.h"
+#include "NullGraphicsDevice.h"
+#include "ParallelRecording.h"
+#include "StateCachingEncoder.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 与 Renderer 的实例组相当：几何体、材质、图元拓扑和绘制参数
+    struct SyntheticGroup
+    {
+        std::uint32_t Geometry;
+        std::uint32_t Material;
+        std::uint32_t Topology;
+        std::uint32_t IndexCount;
+        std::uint32_t InstanceCount;
+        std::uint32_t StartIndex;
+        std::int32_t BaseVertex;
+        std::uint32_t FirstInstance;
+        bool Resident; // 几何体被驱逐时跳过（Renderer 里 VertexBufferGPU 为空）
+    };
+
+    constexpr PipelineHandle Pipeline = 0x1000;
+    constexpr RootSignatureHandle RootSignature = 0x2000;
+    constexpr ResourceHandle BackBuffer = 0x3000;
+    constexpr DescriptorHandle Rtv = 0x4000;
+    constexpr DescriptorHandle Dsv = 0x5000;
+
+    // 按排序后的顺序生成：相邻的组经常共用几何体和材质，encoder 能跳过其中的重复设置
+    std::vector<SyntheticGroup> MakeGroups(std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<SyntheticGroup> groups(count);
+        std::uint32_t geometry = 0;
+        std::uint32_t material = 0;
+        std::uint32_t firstInstance = 0;
+        for(SyntheticGroup& group : groups)
+        {
+            if(rng() % 4 == 0)
+                geometry = rng() % 16;
+            if(rng() % 3 == 0)
+                material = rng() % 32;
+            group.Geometry = geometry;
+            group.Material = material;
+            group.Topology = geometry % 5 == 0 ? PrimitiveTopology::TriangleStrip : PrimitiveTopology::TriangleList;
+            group.IndexCount = 36 + 3 * (rng() % 100);
+            group.InstanceCount = 1 + rng() % 8;
+            group.StartIndex = 3 * (rng() % 1000);
+            group.BaseVertex = (std::int32_t)(rng() % 500);
+            group.FirstInstance = firstInstance;
+            group.Resident = rng() % 20 != 0;
+            firstInstance += group.InstanceCount;
+        }
+        return groups;
+    }
+
+    // Renderer::Render 里 recordBatch 的无头版本
+    void RecordGroups(CommandList* list, const RecordBatch& batch, std::size_t batchCount,
+        const std::vector<SyntheticGroup>& groups)
+    {
+        list->Begin(Pipeline);
+        StateCachingEncoder encoder(list, Pipeline);
+
+        if(batch.ListIndex == 0)
+        {
+            const float clearColor[4] = { 0.69f, 0.77f, 0.87f, 1.0f };
+            list->TransitionBarrier(BackBuffer, ResourceState::Present, ResourceState::RenderTarget);
+            list->ClearRenderTarget(Rtv, clearColor);
+            list->ClearDepthStencil(Dsv, 1.0f, 0);
+        }
+
+        ViewportDesc viewport;
+        viewport.Width = 800.0f;
+        viewport.Height = 600.0f;
+        ScissorRect scissor;
+        scissor.Right = 800;
+        scissor.Bottom = 600;
+        list->SetViewport(viewport);
+        list->SetScissorRect(scissor);
+        list->SetRenderTarget(Rtv, Dsv);
+        encoder.SetGraphicsRootSignature(RootSignature);
+        encoder.SetGraphicsRootConstantBufferView(2, 0x10000);
+        for(std::uint32_t slot = 3; slot <= 6; ++slot)
+            encoder.SetGraphicsRootShaderResourceView(slot, 0x20000 + slot * 0x1000);
+
+        for(std::size_t g = batch.First; g < batch.Last; ++g)
+        {
+            const SyntheticGroup& group = groups[g];
+            if(!group.Resident)
+                continue;
+
+            VertexBufferBinding vertexBuffer;
+            vertexBuffer.BufferLocation = 0x100000 + (GpuAddress)group.Geometry * 0x10000;
+            vertexBuffer.SizeInBytes = 0x8000;
+            vertexBuffer.StrideInBytes = 32;
+            IndexBufferBinding indexBuffer;
+            indexBuffer.BufferLocation = 0x900000 + (GpuAddress)group.Geometry * 0x10000;
+            indexBuffer.SizeInBytes = 0x4000;
+            encoder.SetVertexBuffer(vertexBuffer);
+            encoder.SetIndexBuffer(indexBuffer);
+            encoder.SetPrimitiveTopology(group.Topology);
+            encoder.SetGraphicsRoot32BitConstant(0, group.FirstInstance, 0);
+            encoder.SetGraphicsRoot32BitConstant(1, group.Material, 0);
+            encoder.DrawIndexedInstanced(group.IndexCount, group.InstanceCount, group.StartIndex, group.BaseVertex, 0);
+        }
+
+        if(batch.ListIndex + 1 == batchCount)
+            list->TransitionBarrier(BackBuffer, ResourceState::RenderTarget, ResourceState::Present);
+        list->End();
+    }
+
+    // 一次提交的全部结果：按提交顺序拼接的命令流、设备统计、按顺序的绘制参数
+    struct Submission
+    {
+        std::vector<std::uint8_t> Bytes;
+        NullGraphicsDevice::Stats Stats;
+        std::vector<DrawIndexedInstancedArgs> Draws;
+    };
+
+    Submission Submit(NullGraphicsDevice& device, const std::vector<CommandList*>& ordered)
+    {
+        NullGraphicsDevice::Stats before = device.GetStats();
+        device.ExecuteCommandLists(ordered.data(), (std::uint32_t)ordered.size());
+        NullGraphicsDevice::Stats after = device.GetStats();
+
+        Submission result;
+        result.Stats.CommandLists = after.CommandLists - before.CommandLists;
+        result.Stats.Commands = after.Commands - before.Commands;
+        result.Stats.Draws = after.Draws - before.Draws;
+        for(CommandList* list : ordered)
+        {
+            const CommandStreamWriter& stream = static_cast<NullCommandList*>(list)->Stream();
+            result.Bytes.insert(result.Bytes.end(), stream.Data(), stream.Data() + stream.Size());
+
+            CommandStreamReader reader(stream.Data(), stream.Size());
+            CommandOp op;
+            const std::uint8_t* payload = nullptr;
+            while(reader.Next(op, payload))
+            {
+                if(op == CommandOp::DrawIndexedInstanced)
+                    result.Draws.push_back(CommandStreamReader::Read<DrawIndexedInstancedArgs>(payload));
+            }
+        }
+        return result;
+    }
+
+    bool SameDraws(const std::vector<DrawIndexedInstancedArgs>& a, const std::vector<DrawIndexedInstancedArgs>& b)
+    {
+        if(a.size() != b.size())
+            return false;
+        for(std::size_t i = 0; i < a.size(); ++i)
+        {
+            if(a[i].IndexCountPerInstance != b[i].IndexCountPerInstance || a[i].InstanceCount != b[i].InstanceCount ||
+                a[i].StartIndexLocation != b[i].StartIndexLocation || a[i].BaseVertexLocation != b[i].BaseVertexLocation ||
+                a[i].StartInstanceLocation != b[i].StartInstanceLocation)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST_CASE(PartitionKeepsItemsContiguousAndBalanced)
+{
+    for(std::size_t itemCount : { 0u, 1u, 7u, 100u, 511u, 512u, 1025u, 100000u })
+    {
+        for(unsigned maxLists : { 0u, 1u, 3u, 8u })
+        {
+            for(std::size_t minItems : { 0u, 1u, 64u, 512u })
+            {
+                std::vector<RecordBatch> batches = PartitionRecordBatches(itemCount, maxLists, minItems);
+                REQUIRE(!batches.empty());
+                CHECK(batches.size() <= (maxLists == 0 ? 1u : maxLists));
+                if(batches.size() > 1)
+                    CHECK(itemCount / batches.size() >= (minItems == 0 ? 1u : minItems));
+
+                std::size_t expectedFirst = 0;
+                std::size_t smallest = itemCount;
+                std::size_t largest = 0;
+                for(std::size_t i = 0; i < batches.size(); ++i)
+                {
+                    CHECK_EQ(batches[i].ListIndex, (unsigned)i);
+                    CHECK_EQ(batches[i].First, expectedFirst);
+                    CHECK(batches[i].Last >= batches[i].First);
+                    std::size_t size = batches[i].Last - batches[i].First;
+                    smallest = std::min(smallest, size);
+                    largest = std::max(largest, size);
+                    expectedFirst = batches[i].Last;
+                }
+                CHECK_EQ(expectedFirst, itemCount);
+                CHECK(largest - smallest <= 1);
+            }
+        }
+    }
+}
+
+TEST_CASE(ParallelRecordingMatchesSingleThreadedRecording)
+{
+    const unsigned maxListCount = 8;
+    for(unsigned workers : { 0u, 1u, 3u })
+    {
+        JobSystem jobs(workers);
+        NullGraphicsDevice device;
+        std::vector<std::unique_ptr<CommandList>> owned;
+        std::vector<CommandList*> lists;
+        for(unsigned i = 0; i < maxListCount; ++i)
+        {
+            owned.push_back(device.CreateCommandList());
+            lists.push_back(owned.back().get());
+        }
+
+        for(std::size_t groupCount : { 0u, 1u, 37u, 1000u, 5000u })
+        {
+            std::vector<SyntheticGroup> groups = MakeGroups(groupCount, 36 + (unsigned)groupCount);
+
+            // 参照：只用一个命令列表录制
+            std::vector<RecordBatch> single = PartitionRecordBatches(groupCount, 1, 1);
+            RecordGroups(lists[0], single[0], 1, groups);
+            Submission reference = Submit(device, { lists[0] });
+
+            std::uint64_t residentDraws = 0;
+            for(const SyntheticGroup& group : groups)
+                residentDraws += group.Resident ? 1 : 0;
+            CHECK_EQ(reference.Stats.Draws, residentDraws);
+
+            for(unsigned listCount = 1; listCount <= maxListCount; ++listCount)
+            {
+                std::vector<RecordBatch> batches = PartitionRecordBatches(groupCount, listCount, 16);
+
+                // 同样的批次在当前线程上依次录制
+                for(const auto& batch : batches)
+                    RecordGroups(lists[batch.ListIndex], batch, batches.size(), groups);
+                std::vector<CommandList*> sequentialOrder;
+                for(const auto& batch : batches)
+                    sequentialOrder.push_back(lists[batch.ListIndex]);
+                Submission sequential = Submit(device, sequentialOrder);
+
+                // 并行录制几遍，每遍的合并结果都要和依次录制的完全相同
+                for(int round = 0; round < 3; ++round)
+                {
+                    std::vector<CommandList*> ordered = RecordBatchesInParallel(jobs, batches, lists.data(),
+                        [&](CommandList* list, const RecordBatch& batch)
+                        {
+                            RecordGroups(list, batch, batches.size(), groups);
+                        });
+                    REQUIRE(ordered.size() == batches.size());
+                    Submission parallel = Submit(device, ordered);
+
+                    CHECK_EQ(parallel.Stats.CommandLists, (std::uint64_t)batches.size());
+                    CHECK_EQ(parallel.Stats.Draws, sequential.Stats.Draws);
+                    CHECK_EQ(parallel.Stats.Commands, sequential.Stats.Commands);
+                    CHECK(parallel.Bytes == sequential.Bytes);
+                    CHECK(SameDraws(parallel.Draws, reference.Draws));
+                }
+
+                // 与单个列表相比只多了每个列表开头重新设置的状态，绘制完全相同
+                CHECK_EQ(sequential.Stats.Draws, reference.Stats.Draws);
+                CHECK(SameDraws(sequential.Draws, reference.Draws));
+                CHECK(sequential.Stats.Commands >= reference.Stats.Commands);
+                if(batches.size() == 1)
+                {
+                    CHECK_EQ(sequential.Stats.Commands, reference.Stats.Commands);
+                    CHECK(sequential.Bytes == reference.Bytes);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(RecordingExceptionsReachTheCaller)
+{
+    // 任意一批录制失败（包括在当前线程录制的第一批）都由 RecordBatchesInParallel 重新抛出，其他批次照常结束
+    JobSystem jobs(2);
+    NullGraphicsDevice device;
+    std::vector<std::unique_ptr<CommandList>> owned;
+    std::vector<CommandList*> lists;
+    for(int i = 0; i < 4; ++i)
+    {
+        owned.push_back(device.CreateCommandList());
+        lists.push_back(owned.back().get());
+    }
+    std::vector<SyntheticGroup> groups = MakeGroups(400, 7);
+    std::vector<RecordBatch> batches = PartitionRecordBatches(groups.size(), 4, 16);
+    REQUIRE(batches.size() == 4);
+
+    for(unsigned failing = 0; failing < 4; ++failing)
+    {
+        bool caught = false;
+        try
+        {
+            RecordBatchesInParallel(jobs, batches, lists.data(), [&](CommandList* list, const RecordBatch& batch)
+            {
+                RecordGroups(list, batch, batches.size(), groups);
+                if(batch.ListIndex == failing)
+                    throw std::runtime_error("record failed");
+            });
+        }
+        catch(const std::runtime_error&)
+        {
+            caught = true;
+        }
+        CHECK(caught);
+        for(CommandList* list : lists)
+            CHECK(!static_cast<NullCommandList*>(list)->IsRecording());
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
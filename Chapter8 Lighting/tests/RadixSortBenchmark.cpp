@@ -0,0 +1,91 @@
+// 排序键的基准：std::sort / std::stable_sort（按键排序下标）与 RadixSortKeys 在当前线程、
+// 以及作业系统上多块并行时的耗时。键分别是完全随机的 64 位数和 Renderer 的绘制排序键
+// （高位字段取值很少，基数排序可以跳过大部分趟）。
+// 10 万个键是每帧排序的目标规模（1 毫秒以内），另外测 100 万个键；多线程的列只有在
+// 至少有那么多硬件线程时才有意义，开头打印 hardware_concurrency。
+//
+//   RadixSortBenchmark [--quick]
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "DrawSortKey.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::vector<std::size_t> counts = quick ? std::vector<std::size_t>{ 20000 } : std::vector<std::size_t>{ 100000, 1000000 };
+    const int repeats = quick ? 1 : 5;
+    const std::size_t minItemsPerJob = quick ? 2048 : 16384; // RadixSortKeys 的默认值
+
+    std::printf("%u hardware threads, min %zu items per job\n", std::thread::hardware_concurrency(), minItemsPerJob);
+    std::printf("keys     count    std::sort ms  stable_sort ms  radix 1T ms  radix 2T ms  radix 4T ms  radix 8T ms\n");
+
+    std::uint64_t checksum = 0;
+    auto measure = [&](const char* name, const std::vector<std::uint64_t>& input)
+    {
+        const std::size_t count = input.size();
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint32_t> values;
+        auto reset = [&]()
+        {
+            keys = input;
+            values.resize(count);
+            std::iota(values.begin(), values.end(), 0u);
+        };
+
+        // 比较排序：和 Renderer 原来的写法一样排下标
+        double sortMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            reset();
+            std::sort(values.begin(), values.end(), [&input](std::uint32_t a, std::uint32_t b) { return input[a] < input[b]; });
+        });
+        checksum += values[count / 2];
+        double stableMs = Benchmark::BestOfMs(repeats, [&]()
+        {
+            reset();
+            std::stable_sort(values.begin(), values.end(), [&input](std::uint32_t a, std::uint32_t b) { return input[a] < input[b]; });
+        });
+        checksum += values[count / 3];
+
+        RadixSortScratch scratch;
+        double radixMs[4] = {};
+        const unsigned threadCounts[4] = { 1, 2, 4, 8 };
+        for(int t = 0; t < 4; ++t)
+        {
+            JobSystem jobs(threadCounts[t] - 1);
+            radixMs[t] = Benchmark::BestOfMs(repeats, [&]()
+            {
+                reset();
+                RadixSortKeys(keys, values, scratch, threadCounts[t] == 1 ? nullptr : &jobs, minItemsPerJob);
+            });
+            checksum += values[count / 4];
+        }
+        // 计时里包含了 reset 的复制，数组较大时约占几个百分点
+        std::printf("%-7s %7zu  %12.3f  %14.3f  %11.3f  %11.3f  %11.3f  %11.3f\n", name, count, sortMs, stableMs,
+            radixMs[0], radixMs[1], radixMs[2], radixMs[3]);
+    };
+
+    for(std::size_t count : counts)
+    {
+        std::mt19937_64 rng(40);
+        std::vector<std::uint64_t> randomKeys(count);
+        std::vector<std::uint64_t> drawKeys(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            randomKeys[i] = rng();
+            drawKeys[i] = DrawSortKey::Make(0, (std::uint32_t)(rng() % 3), (std::uint32_t)(rng() % 40),
+                (std::uint32_t)(rng() % 25), (std::uint32_t)(rng() % (1u << 24)));
+        }
+        measure("random", randomKeys);
+        measure("draw", drawKeys);
+    }
+
+    Benchmark::DoNotOptimize(checksum);
+    return 0;
+}
@@ -0,0 +1,183 @@
+// RadixSortKeys 的单元测试：各种键分布（随机、大部分相同、只有高位不同、绘制排序键）
+// 在当前线程、一块和多块（count / minItemsPerJob > 1 才走多块路径）下的结果与 std::stable_sort 逐个相同，
+// 包括相同键之间载荷的先后顺序
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "DrawSortKey.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+#include "TestHarness.h"
+
+namespace
+{
+    enum class KeyPattern
+    {
+        Random,
+        MostlyConstant, // 百分之一的键不同
+        AllEqual,       // 一趟都不用排
+        HighByteOnly,   // 只有最高字节不同：只排一趟，结果留在临时缓冲区里再交换回来
+        FewDistinct,    // 大量重复键，检查稳定性
+        DrawKeys        // Renderer 的排序键：高位字段取值很少
+    };
+
+    std::vector<std::uint64_t> MakeKeys(KeyPattern pattern, std::size_t count, unsigned seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<std::uint64_t> keys(count);
+        const std::uint64_t constant = 0x0123456789abcdefull;
+        for(std::uint64_t& key : keys)
+        {
+            switch(pattern)
+            {
+            case KeyPattern::Random:         key = rng(); break;
+            case KeyPattern::MostlyConstant: key = rng() % 100 == 0 ? rng() : constant; break;
+            case KeyPattern::AllEqual:       key = constant; break;
+            case KeyPattern::HighByteOnly:   key = (constant & 0x00ffffffffffffffull) | (rng() % 256) << 56; break;
+            case KeyPattern::FewDistinct:    key = (rng() % 7) * 0x0101010101010101ull; break;
+            case KeyPattern::DrawKeys:
+                key = DrawSortKey::Make(0, (std::uint32_t)(rng() % 3), (std::uint32_t)(rng() % 40),
+                    (std::uint32_t)(rng() % 25), (std::uint32_t)(rng() % (1u << 24)));
+                break;
+            }
+        }
+        return keys;
+    }
+
+    // 参照结果：按键稳定排序，载荷是原来的下标
+    void ReferenceSort(const std::vector<std::uint64_t>& keys, std::vector<std::uint64_t>& sortedKeys,
+        std::vector<std::uint32_t>& sortedValues)
+    {
+        sortedValues.resize(keys.size());
+        std::iota(sortedValues.begin(), sortedValues.end(), 0u);
+        std::stable_sort(sortedValues.begin(), sortedValues.end(),
+            [&keys](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+        sortedKeys.resize(keys.size());
+        for(std::size_t i = 0; i < keys.size(); ++i)
+            sortedKeys[i] = keys[sortedValues[i]];
+    }
+
+    // 排序后与参照结果不同的位置数
+    std::size_t SortAndCompare(const std::vector<std::uint64_t>& input, RadixSortScratch& scratch,
+        JobSystem* jobs, std::size_t minItemsPerJob)
+    {
+        std::vector<std::uint64_t> keys = input;
+        std::vector<std::uint32_t> values(input.size());
+        std::iota(values.begin(), values.end(), 0u);
+        RadixSortKeys(keys, values, scratch, jobs, minItemsPerJob);
+
+        std::vector<std::uint64_t> expectedKeys;
+        std::vector<std::uint32_t> expectedValues;
+        ReferenceSort(input, expectedKeys, expectedValues);
+
+        if(keys.size() != input.size() || values.size() != input.size())
+            return input.size() + 1;
+        std::size_t mismatches = 0;
+        for(std::size_t i = 0; i < input.size(); ++i)
+            mismatches += keys[i] != expectedKeys[i] || values[i] != expectedValues[i] ? 1 : 0;
+        return mismatches;
+    }
+
+    const KeyPattern Patterns[] = {
+        KeyPattern::Random, KeyPattern::MostlyConstant, KeyPattern::AllEqual,
+        KeyPattern::HighByteOnly, KeyPattern::FewDistinct, KeyPattern::DrawKeys
+    };
+}
+
+TEST_CASE(MatchesStableSortOnCurrentThread)
+{
+    RadixSortScratch scratch;
+    for(std::size_t count : { 0u, 1u, 2u, 3u, 255u, 1000u, 65537u })
+    {
+        for(KeyPattern pattern : Patterns)
+        {
+            std::vector<std::uint64_t> keys = MakeKeys(pattern, count, 40 + (unsigned)count);
+            CHECK_EQ(SortAndCompare(keys, scratch, nullptr, 16384), 0u);
+        }
+    }
+}
+
+TEST_CASE(MatchesStableSortWithOneChunk)
+{
+    // 有作业系统，但 count / minItemsPerJob <= 1，只有一块（一次遍历统计全部直方图的路径）
+    JobSystem jobs(3);
+    RadixSortScratch scratch;
+    for(KeyPattern pattern : Patterns)
+    {
+        std::vector<std::uint64_t> keys = MakeKeys(pattern, 20000, 41);
+        CHECK_EQ(SortAndCompare(keys, scratch, &jobs, 20000), 0u);
+        CHECK_EQ(SortAndCompare(keys, scratch, &jobs, 1000000), 0u);
+        CHECK_EQ(SortAndCompare(keys, scratch, &jobs, 0), 0u); // minItemsPerJob 为 0 也只有一块
+    }
+}
+
+TEST_CASE(MatchesStableSortWithManyChunks)
+{
+    // 块数 = min(线程数, count / minItemsPerJob)，覆盖 2 块、块数等于线程数，以及块大小不整除的情况
+    for(unsigned workers : { 1u, 3u, 7u })
+    {
+        JobSystem jobs(workers);
+        RadixSortScratch scratch;
+        for(std::size_t count : { 64u, 1001u, 100000u })
+        {
+            const std::size_t minItemsPerJob[] = { 1, 7, count / 2 };
+            for(std::size_t minItems : minItemsPerJob)
+            {
+                for(KeyPattern pattern : Patterns)
+                {
+                    std::vector<std::uint64_t> keys = MakeKeys(pattern, count, 42 + workers);
+                    CHECK_EQ(SortAndCompare(keys, scratch, &jobs, minItems), 0u);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(ScratchIsReusedAcrossSizes)
+{
+    // 同一个 scratch 依次排大、小、大的数组（Renderer 每帧复用），结果不受上一次的影响
+    JobSystem jobs(3);
+    RadixSortScratch scratch;
+    for(std::size_t count : { 50000u, 10u, 3000u, 50000u, 2u })
+    {
+        std::vector<std::uint64_t> keys = MakeKeys(KeyPattern::DrawKeys, count, (unsigned)count);
+        CHECK_EQ(SortAndCompare(keys, scratch, &jobs, 1000), 0u);
+        CHECK_EQ(SortAndCompare(keys, scratch, nullptr, 1000), 0u);
+    }
+}
+
+TEST_CASE(SortedInputAndReversedInput)
+{
+    JobSystem jobs(3);
+    RadixSortScratch scratch;
+    std::vector<std::uint64_t> keys = MakeKeys(KeyPattern::Random, 30000, 43);
+    std::sort(keys.begin(), keys.end());
+    CHECK_EQ(SortAndCompare(keys, scratch, &jobs, 1000), 0u);
+    std::reverse(keys.begin(), keys.end());
+    CHECK_EQ(SortAndCompare(keys, scratch, &jobs, 1000), 0u);
+    CHECK_EQ(SortAndCompare(keys, scratch, nullptr, 1000), 0u);
+}
+
+TEST_CASE(RejectsMismatchedLengths)
+{
+    RadixSortScratch scratch;
+    std::vector<std::uint64_t> keys(10, 1);
+    std::vector<std::uint32_t> values(9, 0);
+    bool caught = false;
+    try
+    {
+        RadixSortKeys(keys, values, scratch);
+    }
+    catch(const std::invalid_argument&)
+    {
+        caught = true;
+    }
+    CHECK(caught);
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,223 @@
+// ResidencyManager 的单元测试：用 FixedBudgetSource 模拟预算。
+// Touch 之后的 LRU 驱逐顺序、高低水位之间不驱逐（回差）、minIdleFrames 保护最近用过的资源、
+// 不可流送的资源从不驱逐、登记/注销/驱逐之后的分类统计，以及驱逐回调里再次登记
+#include <string>
+#include <vector>
+#include "ResidencyManager.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 登记一个可流送的资源，驱逐时把名字记进 log
+    std::uint32_t TrackLogged(ResidencyManager& residency, std::vector<std::string>& log, const std::string& name,
+        std::uint64_t byteSize, MemoryCategory category = MemoryCategory::Texture)
+    {
+        return residency.Track(category, byteSize, true, [&log, name]() { log.push_back(name); });
+    }
+
+    constexpr std::uint64_t Unlimited = ~0ull / 2;
+}
+
+TEST_CASE(EvictsLeastRecentlyUsedFirst)
+{
+    FixedBudgetSource budget(Unlimited);
+    ResidencyManager residency(budget, 0.95f, 0.85f, 1);
+    std::vector<std::string> log;
+
+    std::uint32_t a = TrackLogged(residency, log, "a", 250);
+    TrackLogged(residency, log, "b", 250);
+    std::uint32_t c = TrackLogged(residency, log, "c", 250);
+    TrackLogged(residency, log, "d", 250);
+
+    // 第 1 帧用了 c 和 a：LRU 顺序变成 b、d、c、a
+    CHECK_EQ(residency.Update(), 0u);
+    residency.Touch(c);
+    residency.Touch(a);
+
+    // 1000 超过高水位 950，驱逐到低水位 850 以下：只驱逐 b
+    budget.SetBudget(1000);
+    CHECK_EQ(residency.Update(), 250u);
+    REQUIRE(log.size() == 1);
+    CHECK(log[0] == "b");
+    CHECK_EQ(residency.TrackedBytes(), 750u);
+
+    // 预算再降，依次是 d、c、a
+    budget.SetBudget(100);
+    CHECK_EQ(residency.Update(), 750u);
+    REQUIRE(log.size() == 4);
+    CHECK(log[1] == "d");
+    CHECK(log[2] == "c");
+    CHECK(log[3] == "a");
+    CHECK(!residency.IsTracked(a));
+    CHECK_EQ(residency.TrackedBytes(), 0u);
+}
+
+TEST_CASE(NoEvictionBetweenTheWatermarks)
+{
+    FixedBudgetSource budget(1000);
+    ResidencyManager residency(budget, 0.95f, 0.85f, 0);
+    std::vector<std::string> log;
+
+    for(int i = 0; i < 9; ++i)
+        TrackLogged(residency, log, "r" + std::to_string(i), 100);
+
+    // 900 在 850 和 950 之间：不驱逐，多跑几帧也一样
+    for(int frame = 0; frame < 5; ++frame)
+        CHECK_EQ(residency.Update(), 0u);
+    CHECK(log.empty());
+
+    // 1000 超过高水位：驱逐到 850 以下，也就是 800
+    TrackLogged(residency, log, "r9", 100);
+    CHECK_EQ(residency.Update(), 200u);
+    CHECK_EQ(residency.TrackedBytes(), 800u);
+    CHECK_EQ(log.size(), 2u);
+
+    // 回到 900，仍在回差范围内
+    TrackLogged(residency, log, "r10", 100);
+    CHECK_EQ(residency.Update(), 0u);
+    CHECK_EQ(residency.TrackedBytes(), 900u);
+
+    // 预算为 0（来源不提供）时不驱逐
+    budget.SetBudget(0);
+    CHECK_EQ(residency.Update(), 0u);
+}
+
+TEST_CASE(RecentlyUsedResourcesAreProtected)
+{
+    FixedBudgetSource budget(100);
+    ResidencyManager residency(budget, 0.95f, 0.85f, 3);
+    std::vector<std::string> log;
+
+    std::uint32_t hot = TrackLogged(residency, log, "hot", 200);
+    TrackLogged(residency, log, "cold", 200);
+
+    // 登记在第 0 帧，前 2 帧内都算最近用过
+    CHECK_EQ(residency.Update(), 0u); // 第 1 帧
+    residency.Touch(hot);
+    CHECK_EQ(residency.Update(), 0u); // 第 2 帧
+    residency.Touch(hot);
+    CHECK(log.empty());
+
+    // 第 3 帧：cold 闲置满 3 帧被驱逐；hot 一直在用，即使仍然超出预算也不驱逐
+    CHECK_EQ(residency.Update(), 200u);
+    REQUIRE(log.size() == 1);
+    CHECK(log[0] == "cold");
+    residency.Touch(hot);
+    for(int frame = 0; frame < 5; ++frame)
+    {
+        CHECK_EQ(residency.Update(), 0u);
+        residency.Touch(hot);
+    }
+    CHECK(residency.IsTracked(hot));
+
+    // 不再使用之后，闲置满 3 帧才驱逐
+    CHECK_EQ(residency.Update(), 0u);
+    CHECK_EQ(residency.Update(), 0u);
+    CHECK_EQ(residency.Update(), 200u);
+    CHECK(!residency.IsTracked(hot));
+}
+
+TEST_CASE(NonStreamableResourcesAreNeverEvicted)
+{
+    FixedBudgetSource budget(1000);
+    ResidencyManager residency(budget, 0.95f, 0.85f, 0);
+    std::vector<std::string> log;
+
+    std::uint32_t pinned = residency.Track(MemoryCategory::Geometry, 1500);
+    std::uint32_t uploadRing = residency.Track(MemoryCategory::UploadHeap, 300, false, [&log]() { log.push_back("ring"); });
+    std::uint32_t texture = TrackLogged(residency, log, "texture", 200);
+
+    // 超出预算：可流送的全部驱逐，剩下的不可流送资源仍然超出也不再驱逐
+    CHECK_EQ(residency.Update(), 200u);
+    REQUIRE(log.size() == 1);
+    CHECK(log[0] == "texture");
+    CHECK(!residency.IsTracked(texture));
+    CHECK(residency.IsTracked(pinned));
+    CHECK(residency.IsTracked(uploadRing));
+    CHECK_EQ(residency.TrackedBytes(), 1800u);
+
+    for(int frame = 0; frame < 10; ++frame)
+        CHECK_EQ(residency.Update(), 0u);
+    CHECK_EQ(log.size(), 1u);
+}
+
+TEST_CASE(CategoryAccountingFollowsTrackUntrackAndEvict)
+{
+    FixedBudgetSource budget(Unlimited);
+    ResidencyManager residency(budget, 0.95f, 0.85f, 0);
+    std::vector<std::string> log;
+
+    std::uint32_t mesh = residency.Track(MemoryCategory::Geometry, 100);
+    std::uint32_t t0 = TrackLogged(residency, log, "t0", 200);
+    TrackLogged(residency, log, "t1", 300);
+    std::uint32_t ring = residency.Track(MemoryCategory::UploadHeap, 50);
+
+    ResidencyManager::Stats stats = residency.GetStats();
+    CHECK_EQ(stats.TrackedBytes, 650u);
+    CHECK_EQ(stats.Categories[(size_t)MemoryCategory::Geometry].Bytes, 100u);
+    CHECK_EQ(stats.Categories[(size_t)MemoryCategory::Geometry].Count, 1u);
+    CHECK_EQ(stats.Categories[(size_t)MemoryCategory::Texture].Bytes, 500u);
+    CHECK_EQ(stats.Categories[(size_t)MemoryCategory::Texture].Count, 2u);
+    CHECK_EQ(stats.Categories[(size_t)MemoryCategory::UploadHeap].Bytes, 50u);
+    CHECK_EQ(stats.Categories[(size_t)MemoryCategory::Other].Count, 0u);
+
+    // 注销：字节数和个数减少，不算驱逐；重复注销没有影响
+    residency.Untrack(ring);
+    residency.Untrack(ring);
+    residency.Untrack(ResidencyManager::InvalidId);
+    ResidencyManager::CategoryUsage upload = residency.GetCategoryUsage(MemoryCategory::UploadHeap);
+    CHECK_EQ(upload.Bytes, 0u);
+    CHECK_EQ(upload.Count, 0u);
+    CHECK_EQ(upload.Evictions, 0u);
+
+    // 驱逐 t0（最久未使用）：计入 EvictedBytes
+    residency.Update();
+    residency.Touch(mesh);
+    budget.SetBudget(500);
+    CHECK_EQ(residency.Update(), 200u);
+    CHECK(!residency.IsTracked(t0));
+    ResidencyManager::CategoryUsage texture = residency.GetCategoryUsage(MemoryCategory::Texture);
+    CHECK_EQ(texture.Bytes, 300u);
+    CHECK_EQ(texture.Count, 1u);
+    CHECK_EQ(texture.EvictedBytes, 200u);
+    CHECK_EQ(texture.Evictions, 1u);
+    CHECK_EQ(residency.GetCategoryUsage(MemoryCategory::Geometry).Evictions, 0u);
+    CHECK_EQ(residency.TrackedBytes(), 400u);
+    CHECK_EQ(residency.GetStats().LastBudget.Budget, 500u);
+}
+
+TEST_CASE(EvictionCallbackMayTrackAgain)
+{
+    // 驱逐回调在锁外执行：可以登记一个较小的替代版本（例如只保留低精度 mip），也可以注销别的资源
+    FixedBudgetSource budget(Unlimited);
+    ResidencyManager residency(budget, 0.95f, 0.85f, 0);
+
+    std::uint32_t other = residency.Track(MemoryCategory::Other, 10);
+    std::uint32_t replacement = ResidencyManager::InvalidId;
+    residency.Track(MemoryCategory::Texture, 1000, true, [&]()
+    {
+        replacement = residency.Track(MemoryCategory::Texture, 100, true);
+        residency.Untrack(other);
+    });
+
+    budget.SetBudget(500);
+    CHECK_EQ(residency.Update(), 1000u);
+    REQUIRE(replacement != ResidencyManager::InvalidId);
+    CHECK(residency.IsTracked(replacement));
+    CHECK(!residency.IsTracked(other));
+    CHECK_EQ(residency.TrackedBytes(), 100u);
+    ResidencyManager::CategoryUsage texture = residency.GetCategoryUsage(MemoryCategory::Texture);
+    CHECK_EQ(texture.Bytes, 100u);
+    CHECK_EQ(texture.Count, 1u);
+    CHECK_EQ(texture.Evictions, 1u);
+
+    // 新登记的资源照常参与之后的驱逐
+    budget.SetBudget(50);
+    CHECK_EQ(residency.Update(), 100u);
+    CHECK(!residency.IsTracked(replacement));
+}
+
+int main()
+{
+    return RunAllTests();
+}
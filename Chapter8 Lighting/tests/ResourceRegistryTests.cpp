@@ -0,0 +1,158 @@
+// ResourceId 和 ResourceRegistry 的单元测试：constexpr 的 "name"_rid 与运行时的 ResourceIdFromString 相同、
+// 查不到的标识 Find 返回 nullptr 并且不插入、哈希表多次 Rehash 增长之后所有标识仍然查得到、
+// Add 返回的稠密下标在之后的增长中保持不变，以及调试版本的反查表（这个文件另外以 DEBUG 编译一次）
+#include <memory>
+#include <string>
+#include <vector>
+#include "ResourceRegistry.h"
+#include "TestHarness.h"
+
+namespace
+{
+    // 编译期就能算出来
+    constexpr ResourceId BoxId = "box"_rid;
+    static_assert(BoxId.Value == HashResourceName("box", 3).Value, "_rid 必须是 constexpr");
+    static_assert(""_rid.Id.Value == 0xcbf29ce484222325ull, "空名字是 FNV-1a 的初始值");
+    static_assert("a"_rid.Id.Value == 0xaf63dc4c8601ec8cull, "FNV-1a 64 位的标准值");
+    static_assert("box"_rid.Name.size() == 3, "名字指向字面量本身");
+
+    std::string NameOf(int i)
+    {
+        return "resource" + std::to_string(i);
+    }
+}
+
+TEST_CASE(LiteralMatchesRuntimeHash)
+{
+    const char* const names[] = { "box", "grid", "sphere", "cylinder", "shapeGeo", "bricks0", "stone0", "tile0", "skullMat" };
+    for(const char* name : names)
+    {
+        NamedResourceId runtime = ResourceIdFromString(name);
+        CHECK(runtime.Name == name);
+        CHECK(!runtime.Id.IsNull());
+    }
+    CHECK(ResourceIdFromString("box").Id == BoxId);
+    CHECK(ResourceIdFromString(std::string("grid")).Id == "grid"_rid.Id);
+    CHECK(ResourceIdFromString("bricks0").Id == "bricks0"_rid.Id);
+    CHECK("box"_rid.Id != "Box"_rid.Id);
+    CHECK("box"_rid.Id != "box "_rid.Id);
+
+    // NamedResourceId 可以直接当 ResourceId 用
+    ResourceId converted = "sphere"_rid;
+    CHECK(converted == ResourceIdFromString("sphere").Id);
+    CHECK(ResourceId().IsNull());
+}
+
+TEST_CASE(FindUnknownIdReturnsNullWithoutInserting)
+{
+    ResourceRegistry<int> registry;
+    CHECK(registry.Find("missing"_rid) == nullptr);
+    CHECK_EQ(registry.IndexOf("missing"_rid), ResourceRegistry<int>::InvalidIndex);
+    CHECK_EQ(registry.Size(), 0u);
+
+    registry.Add("box"_rid, 1);
+    registry.Add("grid"_rid, 2);
+    CHECK(registry.Find("missing"_rid) == nullptr);
+    CHECK(registry.Find("Box"_rid) == nullptr);
+    CHECK(registry.Find(ResourceId()) == nullptr);
+    CHECK_EQ(registry.Size(), 2u);
+
+    // 查找不会插入：之后仍然可以用同一个标识 Add
+    CHECK_EQ(registry.Add("missing"_rid, 3), 2u);
+    REQUIRE(registry.Find("missing"_rid) != nullptr);
+    CHECK_EQ(*registry.Find("missing"_rid), 3);
+    CHECK_EQ(registry.Get("box"_rid), 1);
+
+    const ResourceRegistry<int>& constRegistry = registry;
+    CHECK(constRegistry.Find("absent"_rid) == nullptr);
+    CHECK_EQ(constRegistry.Get("grid"_rid), 2);
+}
+
+TEST_CASE(LookupsSurviveRehashGrowth)
+{
+    // 初始容量 16，装载率超过一半就翻倍：3000 个标识经过很多次 Rehash
+    ResourceRegistry<std::unique_ptr<int>> registry;
+    std::vector<std::string> names;
+    for(int i = 0; i < 3000; ++i)
+    {
+        names.push_back(NameOf(i));
+        registry.Add(ResourceIdFromString(names.back()), std::make_unique<int>(i));
+
+        // 每次增长前后都检查一批早先加入的
+        if((i & (i + 1)) == 0 || i % 251 == 0)
+        {
+            for(int j = 0; j <= i; j += 1 + i / 64)
+            {
+                const std::unique_ptr<int>* value = registry.Find(ResourceIdFromString(names[j]));
+                REQUIRE(value != nullptr);
+                CHECK_EQ(**value, j);
+            }
+        }
+    }
+
+    CHECK_EQ(registry.Size(), 3000u);
+    for(int i = 0; i < 3000; ++i)
+    {
+        const std::unique_ptr<int>* value = registry.Find(ResourceIdFromString(names[i]));
+        REQUIRE(value != nullptr);
+        CHECK_EQ(**value, i);
+    }
+    for(int i = 3000; i < 3500; ++i)
+        CHECK(registry.Find(ResourceIdFromString(NameOf(i))) == nullptr);
+}
+
+TEST_CASE(IndexOfIsStableAcrossGrowth)
+{
+    ResourceRegistry<std::string> registry;
+    std::vector<std::string> names;
+    std::vector<std::uint32_t> indices;
+    for(int i = 0; i < 1000; ++i)
+    {
+        names.push_back(NameOf(i));
+        indices.push_back(registry.Add(ResourceIdFromString(names.back()), names.back()));
+        CHECK_EQ(indices.back(), (std::uint32_t)i); // 按加入顺序的稠密下标
+    }
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        ResourceId id = ResourceIdFromString(names[i]);
+        CHECK_EQ(registry.IndexOf(id), indices[i]);
+        CHECK(registry.IdAt(indices[i]) == id);
+        CHECK(registry.At(indices[i]) == names[i]);
+        CHECK_EQ(&registry.At(indices[i]), registry.Find(id));
+    }
+
+    // 按下标改写（替换同名资源的方式）之后按标识查到的是新值
+    registry.At(indices[10]) = "replaced";
+    CHECK(registry.Get(ResourceIdFromString(names[10])) == "replaced");
+    CHECK_EQ(registry.Size(), 1000u);
+}
+
+TEST_CASE(DebugNameTableRecordsRegisteredNames)
+{
+#if RESOURCE_ID_DEBUG_NAMES
+    ResourceRegistry<int> registry;
+    registry.Add("debugBox"_rid, 1);
+    std::string runtimeName = "debugRuntime";
+    registry.Add(ResourceIdFromString(runtimeName), 2);
+    runtimeName = "changed"; // 反查表保存的是名字的副本
+
+    CHECK(ResourceNames::Lookup("debugBox"_rid) == "debugBox");
+    CHECK(ResourceNames::Lookup(ResourceIdFromString("debugRuntime")) == "debugRuntime");
+    CHECK(ResourceNames::Lookup("neverRegistered"_rid).empty());
+
+    // 同一个名字在另一张表里再登记一次不算冲突
+    ResourceRegistry<float> other;
+    other.Add("debugBox"_rid, 1.0f);
+    CHECK(ResourceNames::Lookup("debugBox"_rid) == "debugBox");
+#else
+    // 发布版本不保存名字，Record 是空函数
+    ResourceNames::Record("releaseBox"_rid);
+    CHECK_EQ(RESOURCE_ID_DEBUG_NAMES, 0);
+#endif
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,216 @@
+// RingAllocator.h（FencedRingAllocator）的单元测试：对齐填充和回绕、环满与环空时头尾重合的区分、
+// 多个批次按围栏顺序回收、没有待提交字节时的 FinishBatch，以及随机分配回收时区间互不重叠
+#include <deque>
+#include <random>
+#include <vector>
+#include "RingAllocator.h"
+#include "TestHarness.h"
+
+TEST_CASE(AlignmentPaddingCountsAsUsed)
+{
+    FencedRingAllocator ring(1024);
+    CHECK_EQ(ring.Allocate(10), 0u);
+    CHECK_EQ(ring.Allocate(16, 256), 256u);
+    CHECK_EQ(ring.Used(), 272u); // 10 + 246 字节填充 + 16
+    CHECK_EQ(ring.PendingBytes(), 272u);
+    CHECK_EQ(ring.Allocate(1, 64), 320u);
+    CHECK_EQ(ring.Used(), 321u);
+}
+
+TEST_CASE(WrapAroundWastesTheTailAndReleasesItWithTheBatch)
+{
+    FencedRingAllocator ring(1000);
+    CHECK_EQ(ring.Allocate(400), 0u);
+    ring.FinishBatch(1);
+    CHECK_EQ(ring.Allocate(500), 400u);
+    ring.FinishBatch(2);
+    CHECK_EQ(ring.Used(), 900u);
+
+    // 尾部只剩 100 字节，头部还被第 1 批占着
+    CHECK_EQ(ring.Allocate(200), FencedRingAllocator::InvalidOffset);
+    CHECK_EQ(ring.Used(), 900u);
+
+    ring.Retire(1);
+    CHECK_EQ(ring.Used(), 500u);
+
+    // 对齐到 960 之后尾部放不下，回绕到 0；[900, 1000) 算作这一批的填充
+    CHECK_EQ(ring.Allocate(200, 64), 0u);
+    CHECK_EQ(ring.Used(), 800u);
+    CHECK_EQ(ring.PendingBytes(), 300u);
+    ring.FinishBatch(3);
+
+    // 已经回绕，可用区间是 [200, 400)
+    CHECK_EQ(ring.Allocate(201), FencedRingAllocator::InvalidOffset);
+    CHECK_EQ(ring.Allocate(100, 128), 256u);
+    CHECK_EQ(ring.Allocate(100), FencedRingAllocator::InvalidOffset);
+    CHECK_EQ(ring.Allocate(44), 356u);
+    CHECK_EQ(ring.Used(), 1000u);
+    ring.FinishBatch(4);
+
+    ring.Retire(2);
+    CHECK_EQ(ring.Used(), 500u);
+    ring.Retire(4);
+    CHECK_EQ(ring.Used(), 0u);
+    CHECK(ring.Empty());
+}
+
+TEST_CASE(FullAndEmptyRingsAreDistinguished)
+{
+    // 两种情况下头尾都重合，靠 Used 区分
+    FencedRingAllocator ring(512);
+    CHECK_EQ(ring.Allocate(256), 0u);
+    CHECK_EQ(ring.Allocate(256), 256u); // 头回到 0
+    CHECK_EQ(ring.Used(), 512u);
+    CHECK(!ring.Empty());
+    CHECK_EQ(ring.Allocate(1), FencedRingAllocator::InvalidOffset);
+    ring.FinishBatch(1);
+    CHECK_EQ(ring.Allocate(1), FencedRingAllocator::InvalidOffset);
+
+    ring.Retire(1);
+    CHECK(ring.Empty());
+    CHECK(!ring.HasInFlightBatches());
+    CHECK_EQ(ring.Allocate(512), 0u); // 空的时候整个环都能用
+
+    // 回绕之后刚好填满到尾指针，也是满而不是空
+    FencedRingAllocator wrapped(512);
+    wrapped.Allocate(100);
+    wrapped.FinishBatch(1);
+    wrapped.Allocate(300);
+    wrapped.FinishBatch(2);
+    wrapped.Retire(1);
+    CHECK_EQ(wrapped.Allocate(112), 400u);
+    CHECK_EQ(wrapped.Allocate(100), 0u);
+    CHECK_EQ(wrapped.Used(), 512u);
+    CHECK_EQ(wrapped.Allocate(1), FencedRingAllocator::InvalidOffset);
+
+    // 空环从 0 开始分配，不会因为旧的头指针而回绕
+    wrapped.FinishBatch(3);
+    wrapped.Retire(3);
+    CHECK(wrapped.Empty());
+    CHECK_EQ(wrapped.Allocate(500), 0u);
+}
+
+TEST_CASE(RetireReleasesBatchesInFenceOrder)
+{
+    FencedRingAllocator ring(4096);
+    const std::uint64_t sizes[] = { 100, 700, 300, 1000 };
+    std::uint64_t fence = 10;
+    for(std::uint64_t size : sizes)
+    {
+        CHECK(ring.Allocate(size) != FencedRingAllocator::InvalidOffset);
+        ring.FinishBatch(fence);
+        fence += 10;
+    }
+    CHECK_EQ(ring.OldestFence(), 10u);
+    CHECK_EQ(ring.Used(), 2100u);
+
+    ring.Retire(5); // 还没有批次完成
+    CHECK_EQ(ring.Used(), 2100u);
+    ring.Retire(25); // 第 1、2 批
+    CHECK_EQ(ring.Used(), 1300u);
+    CHECK_EQ(ring.OldestFence(), 30u);
+    ring.Retire(25); // 重复回收没有影响
+    CHECK_EQ(ring.Used(), 1300u);
+    ring.Retire(100);
+    CHECK_EQ(ring.Used(), 0u);
+    CHECK(!ring.HasInFlightBatches());
+    CHECK_EQ(ring.OldestFence(), 0u);
+}
+
+TEST_CASE(FinishBatchWithoutPendingBytesIsANoOp)
+{
+    FencedRingAllocator ring(1024);
+    ring.FinishBatch(1);
+    CHECK(!ring.HasInFlightBatches());
+
+    CHECK_EQ(ring.Allocate(100), 0u);
+    ring.FinishBatch(2);
+    ring.FinishBatch(3); // 没有新的分配，不产生空批次
+    CHECK_EQ(ring.OldestFence(), 2u);
+    CHECK_EQ(ring.PendingBytes(), 0u);
+
+    CHECK_EQ(ring.Allocate(50), 100u);
+    ring.FinishBatch(4);
+    ring.Retire(3);
+    CHECK_EQ(ring.Used(), 50u);
+    CHECK_EQ(ring.OldestFence(), 4u);
+
+    // 失败的分配不计入待提交字节
+    CHECK_EQ(ring.Allocate(2000), FencedRingAllocator::InvalidOffset);
+    CHECK_EQ(ring.Allocate(0), FencedRingAllocator::InvalidOffset);
+    CHECK_EQ(ring.PendingBytes(), 0u);
+    ring.FinishBatch(5);
+    CHECK_EQ(ring.OldestFence(), 4u);
+}
+
+TEST_CASE(RandomBatchesNeverOverlap)
+{
+    // 用逐字节的归属表模拟：活着的分配互不重叠、都在环内、满足对齐；Used 不小于活着的字节数
+    const std::uint64_t capacity = 4096;
+    FencedRingAllocator ring(capacity);
+    std::vector<int> owner(capacity, -1);
+
+    struct Live
+    {
+        std::uint64_t Offset;
+        std::uint64_t Size;
+        std::uint64_t Fence;
+    };
+    std::deque<Live> live;
+
+    std::mt19937 rng(29);
+    std::uint64_t nextFence = 1;
+    std::uint64_t completed = 0;
+    std::uint64_t liveBytes = 0;
+    for(int step = 0; step < 50000; ++step)
+    {
+        std::uint32_t action = rng() % 10;
+        if(action < 6)
+        {
+            std::uint64_t size = 1 + rng() % 700;
+            std::uint64_t alignment = 1ull << (rng() % 9);
+            std::uint64_t offset = ring.Allocate(size, alignment);
+            if(offset == FencedRingAllocator::InvalidOffset)
+                continue;
+            REQUIRE(offset + size <= capacity);
+            CHECK_EQ(offset % alignment, 0u);
+            for(std::uint64_t i = offset; i < offset + size; ++i)
+            {
+                CHECK_EQ(owner[i], -1);
+                owner[i] = step;
+            }
+            live.push_back({ offset, size, nextFence });
+            liveBytes += size;
+        }
+        else if(action < 8)
+        {
+            ring.FinishBatch(nextFence++);
+        }
+        else
+        {
+            // GPU 完成到最近提交的某个围栏
+            if(nextFence - 1 > completed)
+                completed += 1 + rng() % (nextFence - 1 - completed);
+            ring.Retire(completed);
+            while(!live.empty() && live.front().Fence <= completed)
+            {
+                for(std::uint64_t i = live.front().Offset; i < live.front().Offset + live.front().Size; ++i)
+                    owner[i] = -1;
+                liveBytes -= live.front().Size;
+                live.pop_front();
+            }
+        }
+        CHECK(ring.Used() >= liveBytes);
+        CHECK(ring.Used() <= capacity);
+        CHECK_EQ(ring.Empty(), live.empty());
+    }
+
+    ring.FinishBatch(nextFence);
+    ring.Retire(nextFence);
+    CHECK(ring.Empty());
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,133 @@
+// StateCachingEncoder 的基准：在 NullGraphicsDevice 上按 Renderer 的绘制循环录制并提交 50k 个渲染项，
+// 每项设置顶点/索引缓冲区、图元拓扑、两个根常量再绘制。直接调用命令列表与经过 encoder 过滤比较，
+// 报告下发和跳过的调用数、命令流字节数和每项耗时。渲染项按几何体和材质排好序，相邻的项经常共用状态
+//
+//   StateCachingEncoderBenchmark [--quick]
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "NullGraphicsDevice.h"
+#include "StateCachingEncoder.h"
+
+namespace
+{
+    struct Item
+    {
+        std::uint32_t Geometry;
+        std::uint32_t Material;
+        std::uint32_t Topology;
+        std::uint32_t IndexCount;
+        std::uint32_t ObjectIndex;
+    };
+
+    constexpr PipelineHandle Pipeline = 0x1000;
+    constexpr RootSignatureHandle RootSignature = 0x2000;
+
+    std::vector<Item> MakeItems(std::size_t count)
+    {
+        std::mt19937 rng(39);
+        std::vector<Item> items(count);
+        std::uint32_t geometry = 0;
+        std::uint32_t material = 0;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            if(rng() % 8 == 0)
+                geometry = rng() % 64;
+            if(rng() % 4 == 0)
+                material = rng() % 128;
+            items[i].Geometry = geometry;
+            items[i].Material = material;
+            items[i].Topology = geometry % 5 == 0 ? PrimitiveTopology::TriangleStrip : PrimitiveTopology::TriangleList;
+            items[i].IndexCount = 36 + 3 * (rng() % 100);
+            items[i].ObjectIndex = (std::uint32_t)i;
+        }
+        return items;
+    }
+
+    VertexBufferBinding VertexBufferOf(const Item& item)
+    {
+        VertexBufferBinding view;
+        view.BufferLocation = 0x100000 + (GpuAddress)item.Geometry * 0x10000;
+        view.SizeInBytes = 0x8000;
+        view.StrideInBytes = 32;
+        return view;
+    }
+
+    IndexBufferBinding IndexBufferOf(const Item& item)
+    {
+        IndexBufferBinding view;
+        view.BufferLocation = 0x900000 + (GpuAddress)item.Geometry * 0x10000;
+        view.SizeInBytes = 0x4000;
+        return view;
+    }
+
+    // Target 是 CommandList 或 StateCachingEncoder，两者的设置函数同名
+    template<typename Target>
+    void RecordItems(Target& target, const std::vector<Item>& items)
+    {
+        target.SetGraphicsRootSignature(RootSignature);
+        target.SetGraphicsRootConstantBufferView(2, 0x10000);
+        for(const Item& item : items)
+        {
+            target.SetVertexBuffer(VertexBufferOf(item));
+            target.SetIndexBuffer(IndexBufferOf(item));
+            target.SetPrimitiveTopology(item.Topology);
+            target.SetGraphicsRoot32BitConstant(0, item.ObjectIndex, 0);
+            target.SetGraphicsRoot32BitConstant(1, item.Material, 0);
+            target.DrawIndexedInstanced(item.IndexCount, 1, 0, 0, 0);
+        }
+    }
+
+    void Submit(NullGraphicsDevice& device, CommandList& list, std::uint64_t& fence)
+    {
+        list.End();
+        CommandList* lists[] = { &list };
+        device.ExecuteCommandLists(lists, 1);
+        device.Signal(++fence);
+        device.WaitForFenceValue(fence);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::size_t itemCount = quick ? 2000 : 50000;
+    const int repeats = quick ? 1 : 20;
+    const std::vector<Item> items = MakeItems(itemCount);
+
+    NullGraphicsDevice device;
+    std::unique_ptr<CommandList> list = device.CreateCommandList();
+    const NullCommandList& nullList = static_cast<const NullCommandList&>(*list);
+    std::uint64_t fence = 0;
+
+    // 直接调用时每次设置都下发
+    double directMs = Benchmark::BestOfMs(repeats, [&]()
+    {
+        list->Begin(Pipeline);
+        RecordItems(*list, items);
+        Submit(device, *list, fence);
+    });
+    std::size_t directCommands = nullList.Stream().CommandCount() - 1; // 不算 Begin 设置的 PSO
+    std::size_t directBytes = nullList.Stream().Size();
+
+    StateCachingEncoder::Stats stats;
+    double encodedMs = Benchmark::BestOfMs(repeats, [&]()
+    {
+        list->Begin(Pipeline);
+        StateCachingEncoder encoder(list.get(), Pipeline);
+        RecordItems(encoder, items);
+        Submit(device, *list, fence);
+        stats = encoder.GetStats();
+    });
+    std::size_t encodedBytes = nullList.Stream().Size();
+
+    std::printf("%zu items\n", itemCount);
+    std::printf("variant     issued   skipped   stream KB       ms  ns/item\n");
+    std::printf("direct   %9zu %9u %11.1f %8.3f %8.2f\n", directCommands, 0u, directBytes / 1024.0,
+        directMs, directMs * 1e6 / itemCount);
+    std::printf("encoder  %9llu %9llu %11.1f %8.3f %8.2f\n", (unsigned long long)stats.Issued,
+        (unsigned long long)stats.Skipped, encodedBytes / 1024.0, encodedMs, encodedMs * 1e6 / itemCount);
+    return 0;
+}
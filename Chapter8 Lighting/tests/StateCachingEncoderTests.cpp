@@ -0,0 +1,254 @@
+// StateCachingEncoder 的单元测试：在 NullCommandList 上录制，读回命令流检查哪些调用真正下发了。
+// 重复的状态设置被跳过、Invalidate 之后重新下发、换根签名和 ExecuteIndirect 清空根参数缓存、
+// destOffset 不为 0 的根常量和 MaxCachedRootSlots 及以上的槽位总是下发，以及 Issued 等于命令流里的命令数
+#include <vector>
+#include "CommandStream.h"
+#include "NullGraphicsDevice.h"
+#include "StateCachingEncoder.h"
+#include "TestHarness.h"
+
+namespace
+{
+    constexpr PipelineHandle Pipeline = 0x1000;
+
+    // 录制的命令，不含 Begin 时写入的初始 PSO
+    std::vector<CommandOp> RecordedOps(const NullCommandList& list)
+    {
+        std::vector<CommandOp> ops;
+        CommandStreamReader reader(list.Stream().Data(), list.Stream().Size());
+        CommandOp op;
+        const std::uint8_t* payload = nullptr;
+        bool first = true;
+        while(reader.Next(op, payload))
+        {
+            if(!first || op != CommandOp::SetPipelineState)
+                ops.push_back(op);
+            first = false;
+        }
+        CHECK(reader.Valid());
+        return ops;
+    }
+
+    VertexBufferBinding VertexBuffer(GpuAddress address)
+    {
+        VertexBufferBinding view;
+        view.BufferLocation = address;
+        view.SizeInBytes = 0x1000;
+        view.StrideInBytes = 32;
+        return view;
+    }
+
+    IndexBufferBinding IndexBuffer(GpuAddress address)
+    {
+        IndexBufferBinding view;
+        view.BufferLocation = address;
+        view.SizeInBytes = 0x800;
+        return view;
+    }
+}
+
+TEST_CASE(RedundantStateIsSkipped)
+{
+    NullCommandList list;
+    list.Begin(Pipeline);
+    StateCachingEncoder encoder(&list, Pipeline);
+
+    encoder.SetPipelineState(Pipeline);           // Begin 时已经设置
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetVertexBuffer(VertexBuffer(0x10000));
+    encoder.SetVertexBuffer(VertexBuffer(0x10000));
+    encoder.SetIndexBuffer(IndexBuffer(0x20000));
+    encoder.SetIndexBuffer(IndexBuffer(0x20000));
+    encoder.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+    encoder.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+    encoder.SetGraphicsRootShaderResourceView(2, 0x40000);
+    encoder.SetGraphicsRootShaderResourceView(2, 0x40000);
+    encoder.SetGraphicsRoot32BitConstant(0, 7, 0);
+    encoder.SetGraphicsRoot32BitConstant(0, 7, 0);
+    encoder.DrawIndexedInstanced(36, 1, 0, 0, 0);
+    encoder.DrawIndexedInstanced(36, 1, 0, 0, 0); // 绘制从不跳过
+
+    // 只有一个字段不同也要下发
+    VertexBufferBinding stride = VertexBuffer(0x10000);
+    stride.StrideInBytes = 16;
+    encoder.SetVertexBuffer(stride);
+    IndexBufferBinding format = IndexBuffer(0x20000);
+    format.Format = IndexFormat::R32Uint;
+    encoder.SetIndexBuffer(format);
+    encoder.SetPrimitiveTopology(PrimitiveTopology::TriangleStrip);
+    encoder.SetPipelineState(0x1001);
+    list.End();
+
+    const std::vector<CommandOp> expected =
+    {
+        CommandOp::SetGraphicsRootSignature, CommandOp::SetVertexBuffer, CommandOp::SetIndexBuffer,
+        CommandOp::SetPrimitiveTopology, CommandOp::SetGraphicsRootConstantBufferView,
+        CommandOp::SetGraphicsRootShaderResourceView, CommandOp::SetGraphicsRoot32BitConstant,
+        CommandOp::DrawIndexedInstanced, CommandOp::DrawIndexedInstanced,
+        CommandOp::SetVertexBuffer, CommandOp::SetIndexBuffer, CommandOp::SetPrimitiveTopology, CommandOp::SetPipelineState,
+    };
+    CHECK(RecordedOps(list) == expected);
+    CHECK_EQ(encoder.GetStats().Issued, (std::uint64_t)expected.size());
+    CHECK_EQ(encoder.GetStats().Skipped, 8u);
+}
+
+TEST_CASE(InvalidateReissuesEverything)
+{
+    NullCommandList list;
+    list.Begin(Pipeline);
+    StateCachingEncoder encoder(&list, Pipeline);
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetVertexBuffer(VertexBuffer(0x10000));
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+
+    encoder.Invalidate();
+    encoder.SetPipelineState(Pipeline);
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetVertexBuffer(VertexBuffer(0x10000));
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+    list.End();
+
+    CHECK_EQ(RecordedOps(list).size(), 7u);
+    CHECK_EQ(encoder.GetStats().Skipped, 0u);
+
+    // 句柄为 0 表示未设置，总是下发
+    NullCommandList empty;
+    empty.Begin(0);
+    StateCachingEncoder unset(&empty, 0);
+    unset.SetPipelineState(0);
+    unset.SetGraphicsRootSignature(0);
+    unset.SetGraphicsRootSignature(0);
+    empty.End();
+    CHECK_EQ(unset.GetStats().Issued, 3u);
+}
+
+TEST_CASE(RootSignatureChangeClearsRootSlots)
+{
+    NullCommandList list;
+    list.Begin(Pipeline);
+    StateCachingEncoder encoder(&list, Pipeline);
+
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+    encoder.SetGraphicsRoot32BitConstant(0, 5, 0);
+
+    // 同一个根签名：槽位缓存保留
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+    encoder.SetGraphicsRoot32BitConstant(0, 5, 0);
+    CHECK_EQ(encoder.GetStats().Skipped, 3u);
+
+    // 换根签名：同样的值也要重新下发；顶点缓冲区等不属于根参数的状态不受影响
+    encoder.SetVertexBuffer(VertexBuffer(0x10000));
+    encoder.SetGraphicsRootSignature(0x2001);
+    encoder.SetGraphicsRootConstantBufferView(1, 0x30000);
+    encoder.SetGraphicsRoot32BitConstant(0, 5, 0);
+    encoder.SetVertexBuffer(VertexBuffer(0x10000));
+    list.End();
+
+    const std::vector<CommandOp> expected =
+    {
+        CommandOp::SetGraphicsRootSignature, CommandOp::SetGraphicsRootConstantBufferView, CommandOp::SetGraphicsRoot32BitConstant,
+        CommandOp::SetVertexBuffer,
+        CommandOp::SetGraphicsRootSignature, CommandOp::SetGraphicsRootConstantBufferView, CommandOp::SetGraphicsRoot32BitConstant,
+    };
+    CHECK(RecordedOps(list) == expected);
+    CHECK_EQ(encoder.GetStats().Skipped, 4u);
+}
+
+TEST_CASE(ExecuteIndirectClearsRootSlots)
+{
+    NullCommandList list;
+    list.Begin(Pipeline);
+    StateCachingEncoder encoder(&list, Pipeline);
+
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetGraphicsRootShaderResourceView(3, 0x50000);
+    encoder.SetGraphicsRoot32BitConstant(0, 9, 0);
+    encoder.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+    encoder.ExecuteIndirect(0xA000, 64, 0xB000, 0);
+
+    // 命令签名可能改写了根参数：全部重新下发；根签名和图元拓扑不受影响
+    encoder.SetGraphicsRootSignature(0x2000);
+    encoder.SetGraphicsRootShaderResourceView(3, 0x50000);
+    encoder.SetGraphicsRoot32BitConstant(0, 9, 0);
+    encoder.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+    list.End();
+
+    const std::vector<CommandOp> expected =
+    {
+        CommandOp::SetGraphicsRootSignature, CommandOp::SetGraphicsRootShaderResourceView,
+        CommandOp::SetGraphicsRoot32BitConstant, CommandOp::SetPrimitiveTopology, CommandOp::ExecuteIndirect,
+        CommandOp::SetGraphicsRootShaderResourceView, CommandOp::SetGraphicsRoot32BitConstant,
+    };
+    CHECK(RecordedOps(list) == expected);
+    CHECK_EQ(encoder.GetStats().Issued, 7u);
+    CHECK_EQ(encoder.GetStats().Skipped, 2u);
+}
+
+TEST_CASE(NonZeroDestOffsetAlwaysIssues)
+{
+    NullCommandList list;
+    list.Begin(Pipeline);
+    StateCachingEncoder encoder(&list, Pipeline);
+
+    encoder.SetGraphicsRoot32BitConstant(0, 11, 0);
+    for(int i = 0; i < 3; ++i)
+        encoder.SetGraphicsRoot32BitConstant(0, 22, 1);
+    // 偏移 1 的写入不影响偏移 0 的缓存
+    encoder.SetGraphicsRoot32BitConstant(0, 11, 0);
+    list.End();
+
+    CHECK_EQ(RecordedOps(list).size(), 4u);
+    CHECK_EQ(encoder.GetStats().Issued, 4u);
+    CHECK_EQ(encoder.GetStats().Skipped, 1u);
+
+    // 下发的参数原样写进命令流
+    CommandStreamReader reader(list.Stream().Data(), list.Stream().Size());
+    CommandOp op;
+    const std::uint8_t* payload = nullptr;
+    std::uint32_t offsets = 0;
+    while(reader.Next(op, payload))
+    {
+        if(op != CommandOp::SetGraphicsRoot32BitConstant)
+            continue;
+        SetRoot32BitConstantArgs args = CommandStreamReader::Read<SetRoot32BitConstantArgs>(payload);
+        if(args.DestOffset == 1)
+        {
+            CHECK_EQ(args.Value, 22u);
+            offsets++;
+        }
+    }
+    CHECK_EQ(offsets, 3u);
+}
+
+TEST_CASE(SlotsBeyondTheCacheAlwaysIssue)
+{
+    NullCommandList list;
+    list.Begin(Pipeline);
+    StateCachingEncoder encoder(&list, Pipeline);
+
+    const std::uint32_t last = StateCachingEncoder::MaxCachedRootSlots - 1;
+    const std::uint32_t beyond = StateCachingEncoder::MaxCachedRootSlots;
+    encoder.SetGraphicsRootConstantBufferView(last, 0x30000);
+    encoder.SetGraphicsRootConstantBufferView(last, 0x30000);
+    for(int i = 0; i < 3; ++i)
+    {
+        encoder.SetGraphicsRootConstantBufferView(beyond, 0x30000);
+        encoder.SetGraphicsRootShaderResourceView(beyond + 1, 0x40000);
+        encoder.SetGraphicsRoot32BitConstant(beyond + 5, 3, 0);
+    }
+    list.End();
+
+    CHECK_EQ(RecordedOps(list).size(), 10u);
+    CHECK_EQ(encoder.GetStats().Issued, 10u);
+    CHECK_EQ(encoder.GetStats().Skipped, 1u);
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,367 @@
+// StreamingScheduler 的单元测试：先进先出、围栏完成后才可见、超大请求的拆分与推迟，
+// 以及在 SimulatedStreamingQueue 上模拟暂存环，检查持续流送时录制从不等待 GPU。
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include "StreamingScheduler.h"
+#include "TestHarness.h"
+
+namespace
+{
+    constexpr std::uint64_t MB = 1024 * 1024;
+
+    // 带暂存环的模拟复制队列：录制时占用暂存空间，批次的围栏完成后释放。
+    // 空间不够时像 UploadBatcher::AllocateStaging 一样阻塞等待旧批次完成，并记一次阻塞
+    class StagingQueue : public StreamingQueue
+    {
+    public:
+        StagingQueue(std::chrono::microseconds latency, std::uint64_t capacity) :
+            mQueue(latency),
+            mCapacity(capacity)
+        {
+        }
+
+        void Allocate(std::uint64_t byteSize)
+        {
+            Retire();
+            if(mUsed + mRecording + byteSize > mCapacity)
+            {
+                Stalls++;
+                while(mUsed + mRecording + byteSize > mCapacity && !mBatches.empty())
+                {
+                    std::this_thread::yield();
+                    Retire();
+                }
+            }
+            mRecording += byteSize;
+            PeakBytes = std::max(PeakBytes, mUsed + mRecording);
+        }
+
+        std::uint64_t Submit() override
+        {
+            std::uint64_t fence = mQueue.Submit();
+            mBatches.push_back({ fence, mRecording });
+            mUsed += mRecording;
+            mRecording = 0;
+            return fence;
+        }
+
+        std::uint64_t CompletedValue() const override { return mQueue.CompletedValue(); }
+
+        SimulatedStreamingQueue& Simulated() { return mQueue; }
+
+        std::uint32_t Stalls = 0;
+        std::uint64_t PeakBytes = 0;
+
+    private:
+        struct Batch
+        {
+            std::uint64_t Fence;
+            std::uint64_t Bytes;
+        };
+
+        void Retire()
+        {
+            std::uint64_t completed = mQueue.CompletedValue();
+            while(!mBatches.empty() && mBatches.front().Fence <= completed)
+            {
+                mUsed -= mBatches.front().Bytes;
+                mBatches.erase(mBatches.begin());
+            }
+        }
+
+        SimulatedStreamingQueue mQueue;
+        std::uint64_t mCapacity;
+        std::uint64_t mUsed = 0;      // 已提交、围栏未完成
+        std::uint64_t mRecording = 0; // 当前批次
+        std::vector<Batch> mBatches;
+    };
+
+    struct RecordedPart
+    {
+        int Request;
+        std::uint64_t FirstByte;
+        std::uint64_t ByteCount;
+    };
+
+    StreamRequest MakeRequest(StagingQueue& queue, int id, std::uint64_t byteSize, bool splittable,
+        std::vector<RecordedPart>& parts, std::vector<int>& resident)
+    {
+        StreamRequest request;
+        request.ByteSize = byteSize;
+        if(splittable)
+        {
+            request.RecordRange = [&queue, &parts, id](std::uint64_t firstByte, std::uint64_t byteCount)
+            {
+                queue.Allocate(byteCount);
+                parts.push_back({ id, firstByte, byteCount });
+            };
+        }
+        else
+        {
+            request.Record = [&queue, &parts, id, byteSize]()
+            {
+                queue.Allocate(byteSize);
+                parts.push_back({ id, 0, byteSize });
+            };
+        }
+        request.OnResident = [&resident, id]() { resident.push_back(id); };
+        return request;
+    }
+
+    void PumpUntilIdle(StreamingScheduler& scheduler)
+    {
+        while(!scheduler.Idle())
+        {
+            scheduler.Pump();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+TEST_CASE(RequestsBecomeResidentInOrder)
+{
+    StagingQueue queue(std::chrono::microseconds(0), 64 * MB);
+    StreamingScheduler scheduler(queue);
+    std::vector<RecordedPart> parts;
+    std::vector<int> resident;
+
+    for(int i = 0; i < 10; ++i)
+        scheduler.Enqueue(MakeRequest(queue, i, (i + 1) * MB, i % 2 == 0, parts, resident));
+    PumpUntilIdle(scheduler);
+
+    REQUIRE(resident.size() == 10);
+    for(int i = 0; i < 10; ++i)
+        CHECK_EQ(resident[i], i);
+
+    StreamingScheduler::Stats stats = scheduler.GetStats();
+    CHECK_EQ(stats.Enqueued, 10u);
+    CHECK_EQ(stats.Submitted, 10u);
+    CHECK_EQ(stats.Resident, 10u);
+    CHECK_EQ(stats.SplitRequests, 0u);
+    CHECK_EQ(stats.BytesSubmitted, 55 * MB);
+    CHECK_EQ(scheduler.BytesInFlight(), 0u);
+}
+
+TEST_CASE(ResidentOnlyAfterFenceCompletes)
+{
+    StagingQueue queue(std::chrono::milliseconds(30), 64 * MB);
+    StreamingScheduler scheduler(queue);
+    std::vector<RecordedPart> parts;
+    std::vector<int> resident;
+
+    scheduler.Enqueue(MakeRequest(queue, 0, 1 * MB, true, parts, resident));
+    CHECK_EQ(scheduler.Pump(), 0u);
+    CHECK_EQ(parts.size(), 1u);
+    CHECK(resident.empty());
+    CHECK_EQ(scheduler.ResidentFenceValue(), 0u);
+    CHECK_EQ(scheduler.BytesInFlight(), 1 * MB);
+    CHECK(!scheduler.Idle());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    CHECK_EQ(scheduler.Pump(), 1u);
+    CHECK_EQ(resident.size(), 1u);
+    CHECK_EQ(scheduler.ResidentFenceValue(), 1u);
+    CHECK(scheduler.Idle());
+}
+
+TEST_CASE(OversizedSplittableRequestIsSplitAcrossPumps)
+{
+    StagingQueue queue(std::chrono::microseconds(0), 64 * MB);
+    StreamingScheduler scheduler(queue, 4 * MB);
+    std::vector<RecordedPart> parts;
+    std::vector<int> resident;
+
+    scheduler.Enqueue(MakeRequest(queue, 0, 1 * MB, true, parts, resident));
+    scheduler.Enqueue(MakeRequest(queue, 1, 10 * MB, true, parts, resident));
+    scheduler.Enqueue(MakeRequest(queue, 2, 1 * MB, false, parts, resident));
+
+    // 第一次：请求 0 整个录制，请求 1 录制剩余额度 3MB
+    scheduler.Pump();
+    REQUIRE(parts.size() == 2);
+    CHECK_EQ(parts[1].Request, 1);
+    CHECK_EQ(parts[1].FirstByte, 0u);
+    CHECK_EQ(parts[1].ByteCount, 3 * MB);
+    for(const RecordedPart& part : parts)
+        CHECK(part.ByteCount <= 4 * MB);
+
+    PumpUntilIdle(scheduler);
+
+    // 请求 1 按顺序分段录完，请求 2 排在它之后
+    std::uint64_t next = 0;
+    for(const RecordedPart& part : parts)
+    {
+        if(part.Request != 1)
+            continue;
+        CHECK_EQ(part.FirstByte, next);
+        CHECK(part.ByteCount <= 4 * MB);
+        next += part.ByteCount;
+    }
+    CHECK_EQ(next, 10 * MB);
+    CHECK_EQ(parts.back().Request, 2);
+
+    REQUIRE(resident.size() == 3);
+    CHECK_EQ(resident[0], 0);
+    CHECK_EQ(resident[1], 1);
+    CHECK_EQ(resident[2], 2);
+
+    StreamingScheduler::Stats stats = scheduler.GetStats();
+    CHECK_EQ(stats.SplitRequests, 1u);
+    CHECK_EQ(stats.Submitted, 3u);
+    CHECK_EQ(stats.Resident, 3u);
+    CHECK_EQ(stats.BytesSubmitted, 12 * MB);
+}
+
+TEST_CASE(SplitRequestIsResidentOnlyAfterLastPart)
+{
+    StagingQueue queue(std::chrono::milliseconds(5), 64 * MB);
+    StreamingScheduler scheduler(queue, 2 * MB);
+    std::vector<RecordedPart> parts;
+    std::vector<int> resident;
+
+    scheduler.Enqueue(MakeRequest(queue, 0, 5 * MB, true, parts, resident));
+    while(!scheduler.Idle())
+    {
+        std::uint64_t recorded = 0;
+        for(const RecordedPart& part : parts)
+            recorded += part.ByteCount;
+        // 最后一部分录制之前不可能可见
+        if(recorded < 5 * MB)
+            CHECK(resident.empty());
+        scheduler.Pump();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQ(parts.size(), 3u);
+    CHECK_EQ(resident.size(), 1u);
+}
+
+TEST_CASE(OversizedUnsplittableRequestWaitsForIdleQueue)
+{
+    StagingQueue queue(std::chrono::milliseconds(20), 64 * MB);
+    StreamingScheduler scheduler(queue, 4 * MB);
+    std::vector<RecordedPart> parts;
+    std::vector<int> resident;
+
+    scheduler.Enqueue(MakeRequest(queue, 0, 1 * MB, false, parts, resident));
+    scheduler.Enqueue(MakeRequest(queue, 1, 10 * MB, false, parts, resident));
+    scheduler.Enqueue(MakeRequest(queue, 2, 1 * MB, false, parts, resident));
+
+    // 请求 0 在途时，超大的请求 1 推迟，请求 2 也不越过它
+    scheduler.Pump();
+    scheduler.Pump();
+    REQUIRE(parts.size() == 1);
+    CHECK_EQ(parts[0].Request, 0);
+
+    // 请求 0 完成后，请求 1 单独录制
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    scheduler.Pump();
+    REQUIRE(parts.size() == 2);
+    CHECK_EQ(parts[1].Request, 1);
+    CHECK_EQ(parts[1].ByteCount, 10 * MB);
+
+    PumpUntilIdle(scheduler);
+    REQUIRE(resident.size() == 3);
+    CHECK_EQ(resident[2], 2);
+    CHECK_EQ(queue.Stalls, 0u);
+}
+
+TEST_CASE(InFlightLimitDefersRecording)
+{
+    StagingQueue queue(std::chrono::milliseconds(20), 64 * MB);
+    StreamingScheduler scheduler(queue, 4 * MB, 8 * MB);
+    std::vector<RecordedPart> parts;
+    std::vector<int> resident;
+
+    for(int i = 0; i < 6; ++i)
+        scheduler.Enqueue(MakeRequest(queue, i, 3 * MB, false, parts, resident));
+
+    // 每次最多 4MB：一次一个；在途最多 8MB：两次之后停下
+    for(int i = 0; i < 5; ++i)
+        scheduler.Pump();
+    CHECK_EQ(parts.size(), 2u);
+    CHECK(scheduler.BytesInFlight() <= 8 * MB);
+
+    PumpUntilIdle(scheduler);
+    CHECK_EQ(resident.size(), 6u);
+}
+
+namespace
+{
+    struct LoadResult
+    {
+        std::uint32_t Stalls = 0;
+        std::uint64_t PeakStagingBytes = 0;
+        std::uint64_t Resident = 0;
+        double WorstPumpMs = 0.0;
+    };
+
+    // 加载线程持续提交随机大小的请求（大部分可拆分），渲染线程每毫秒 Pump 一次
+    LoadResult StreamUnderLoad(std::uint64_t stagingBytes, std::uint64_t maxBytesPerPump, std::uint64_t maxBytesInFlight)
+    {
+        StagingQueue queue(std::chrono::milliseconds(3), stagingBytes);
+        StreamingScheduler scheduler(queue, maxBytesPerPump, maxBytesInFlight);
+        std::vector<RecordedPart> parts;
+        std::vector<int> resident;
+
+        const int requestCount = 150;
+        std::atomic<bool> loaded(false);
+        std::thread loader([&]()
+        {
+            std::mt19937 rng(30);
+            std::uniform_int_distribution<std::uint64_t> size(64 * 1024, 40 * MB);
+            for(int i = 0; i < requestCount; ++i)
+            {
+                bool splittable = i % 4 != 0;
+                std::uint64_t byteSize = splittable ? size(rng) : std::min<std::uint64_t>(size(rng), stagingBytes);
+                // 回调只在渲染线程执行，共享的 parts / resident 不需要加锁
+                scheduler.Enqueue(MakeRequest(queue, i, byteSize, splittable, parts, resident));
+                if(i % 10 == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            loaded = true;
+        });
+
+        LoadResult result;
+        while(!loaded || !scheduler.Idle())
+        {
+            auto start = std::chrono::steady_clock::now();
+            scheduler.Pump();
+            auto end = std::chrono::steady_clock::now();
+            result.WorstPumpMs = std::max(result.WorstPumpMs, std::chrono::duration<double, std::milli>(end - start).count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        loader.join();
+
+        result.Stalls = queue.Stalls;
+        result.PeakStagingBytes = queue.PeakBytes;
+        result.Resident = scheduler.GetStats().Resident;
+        return result;
+    }
+}
+
+TEST_CASE(ContinuousStreamingNeverStalls)
+{
+    // 和 Renderer 里的配置相同：每次录制暂存环的四分之一，在途不超过一半
+    const std::uint64_t staging = 32 * MB;
+    LoadResult result = StreamUnderLoad(staging, staging / 4, staging / 2);
+    CHECK_EQ(result.Resident, 150u);
+    CHECK_EQ(result.Stalls, 0u);
+    CHECK(result.PeakStagingBytes <= staging);
+    std::printf("  worst pump %.2f ms, peak staging %.1f MB\n", result.WorstPumpMs, result.PeakStagingBytes / double(MB));
+}
+
+TEST_CASE(PerPumpLimitAloneStalls)
+{
+    // 只限制每次录制量时，在途数据会把暂存环占满，超大请求的录制要等 GPU：模拟环境能检测到这种阻塞
+    const std::uint64_t staging = 32 * MB;
+    LoadResult result = StreamUnderLoad(staging, staging / 2, 0);
+    CHECK_EQ(result.Resident, 150u);
+    CHECK(result.Stalls > 0);
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,81 @@
+/*
+极简的单元测试宏，不依赖第三方测试框架。
+TEST_CASE 定义的函数在静态初始化时登记，RunAllTests 依次执行；CHECK 失败只记录并打印位置，不中断当前用例，
+用例里抛出的异常也按失败处理。每个测试程序的 main 只需 return RunAllTests();，返回值非 0 时 ctest 判为失败。
+*/
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+namespace TestHarness
+{
+    struct TestCase
+    {
+        const char* Name;
+        void (*Function)();
+    };
+
+    inline std::vector<TestCase>& Registry()
+    {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    inline int& FailureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, void (*function)()) { Registry().push_back({ name, function }); }
+    };
+
+    inline void ReportFailure(const char* file, int line, const char* expression)
+    {
+        std::printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+        FailureCount()++;
+    }
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static TestHarness::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) \
+    do { if(!(expression)) TestHarness::ReportFailure(__FILE__, __LINE__, #expression); } while(0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+// 失败时直接结束当前用例，用于后面的检查依赖这一条的情况
+#define REQUIRE(expression) \
+    do { if(!(expression)) { TestHarness::ReportFailure(__FILE__, __LINE__, #expression); return; } } while(0)
+
+inline int RunAllTests()
+{
+    int failedCases = 0;
+    for(const TestHarness::TestCase& test : TestHarness::Registry())
+    {
+        int before = TestHarness::FailureCount();
+        std::printf("[ RUN  ] %s\n", test.Name);
+        try
+        {
+            test.Function();
+        }
+        catch(const std::exception& e)
+        {
+            std::printf("  unexpected exception: %s\n", e.what());
+            TestHarness::FailureCount()++;
+        }
+        bool passed = TestHarness::FailureCount() == before;
+        std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", test.Name);
+        failedCases += passed ? 0 : 1;
+    }
+
+    std::printf("%d/%d test cases passed\n", (int)TestHarness::Registry().size() - failedCases, (int)TestHarness::Registry().size());
+    return failedCases == 0 ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+// TransformPacker.h 的单元测试：标量、SSE、AVX 三条路径的输出逐位相同，
+// 包括源矩阵不按 16 字节对齐、目标只按 16 字节对齐（不是 32 字节）或完全不对齐、个数是奇数的情况。
+// 打包只搬运数据、不做运算，所以 -0、非规格化数、无穷和 NaN 也要原样搬过去。
+// 当前 CPU 不支持的路径跳过（BestSimdPath 之上的路径会执行非法指令）
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "TransformPacker.h"
+#include "WriteCombined.h"
+#include "TestHarness.h"
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr std::uint8_t Sentinel = 0xCD;
+
+    // 源矩阵放在字节缓冲区里偏移 sourceOffset 的位置，相邻两个之间隔一个 float，
+    // 所以 sourceOffset 不是 16 的倍数时每个矩阵都不按 16 字节对齐
+    struct SourceMatrices
+    {
+        std::vector<std::uint8_t> Storage;
+        std::vector<const XMFLOAT4X4*> Pointers;
+    };
+
+    SourceMatrices MakeSources(std::size_t count, std::size_t sourceOffset, std::uint32_t seed)
+    {
+        const std::size_t stride = sizeof(XMFLOAT4X4) + sizeof(float);
+        SourceMatrices sources;
+        sources.Storage.resize(sourceOffset + count * stride + 64);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+        const float specials[] = { -0.0f, 1e-40f, -1e-40f, INFINITY, -INFINITY, NAN, 0.0f, 1.0f };
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            float m[16];
+            for(int k = 0; k < 16; ++k)
+                m[k] = rng() % 8 == 0 ? specials[rng() % 8] : value(rng);
+            std::uint8_t* p = sources.Storage.data() + sourceOffset + i * stride;
+            std::memcpy(p, m, sizeof(m));
+        }
+
+        // 源矩阵分散在各个渲染项里，指针顺序和内存顺序不同
+        std::vector<std::size_t> order(count);
+        for(std::size_t i = 0; i < count; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+        for(std::size_t i : order)
+            sources.Pointers.push_back(reinterpret_cast<const XMFLOAT4X4*>(sources.Storage.data() + sourceOffset + i * stride));
+        return sources;
+    }
+
+    // 独立于 TransformPacker.cpp 的参考：第 r 行是源矩阵的第 r 列
+    void ExpectedPacked(const XMFLOAT4X4* world, std::uint8_t* out)
+    {
+        float src[16];
+        std::memcpy(src, world, sizeof(src));
+        float dst[12];
+        for(int r = 0; r < 3; ++r)
+        {
+            for(int c = 0; c < 4; ++c)
+                dst[r * 4 + c] = src[c * 4 + r];
+        }
+        std::memcpy(out, dst, sizeof(dst));
+    }
+
+    std::vector<SimdPath> AvailablePaths()
+    {
+        std::vector<SimdPath> paths = { SimdPath::Scalar };
+        if(BestSimdPath() != SimdPath::Scalar)
+            paths.push_back(SimdPath::Sse);
+        if(BestSimdPath() == SimdPath::Avx)
+            paths.push_back(SimdPath::Avx);
+        return paths;
+    }
+
+    // 目标缓冲区按 64 字节对齐，再偏移 dstOffset，前后各留一个元素的哨兵区检查越界写
+    struct TargetBuffer
+    {
+        std::vector<std::uint8_t> Storage;
+        std::uint8_t* Base = nullptr;
+        std::size_t ByteSize = 0;
+
+        TargetBuffer(std::size_t elementCount, std::size_t dstOffset)
+        {
+            ByteSize = elementCount * sizeof(ObjectConstants);
+            Storage.assign(ByteSize + 2 * sizeof(ObjectConstants) + 128 + dstOffset, Sentinel);
+            std::uint8_t* aligned = Storage.data() + ((64 - (reinterpret_cast<std::uintptr_t>(Storage.data()) & 63)) & 63);
+            Base = aligned + 64 + dstOffset;
+        }
+
+        ObjectConstants* Objects()const { return reinterpret_cast<ObjectConstants*>(Base); }
+
+        bool GuardsIntact()const
+        {
+            for(std::size_t i = 1; i <= sizeof(ObjectConstants); ++i)
+            {
+                if(Base[-(std::ptrdiff_t)i] != Sentinel || Base[ByteSize + i - 1] != Sentinel)
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    const std::size_t Counts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 31, 32, 33, 127 };
+}
+
+TEST_CASE(ContiguousPathsAreBitExact)
+{
+    // 0：32 字节对齐；16：16 字节对齐但不是 32 字节对齐（AVX 要先单独写一个）；48：一个元素之后；
+    // 4、8：不按 16 字节对齐，所有路径都退回标量
+    const std::size_t dstOffsets[] = { 0, 16, 48, 4, 8 };
+    const std::size_t sourceOffsets[] = { 0, 4, 12 };
+
+    for(std::size_t count : Counts)
+    {
+        for(std::size_t sourceOffset : sourceOffsets)
+        {
+            SourceMatrices sources = MakeSources(count, sourceOffset, (std::uint32_t)(count * 7 + sourceOffset));
+            std::vector<std::uint8_t> expected(count * sizeof(ObjectConstants));
+            for(std::size_t i = 0; i < count; ++i)
+                ExpectedPacked(sources.Pointers[i], expected.data() + i * sizeof(ObjectConstants));
+
+            for(std::size_t dstOffset : dstOffsets)
+            {
+                for(SimdPath path : AvailablePaths())
+                {
+                    TargetBuffer target(count, dstOffset);
+                    PackObjectWorlds(sources.Pointers.data(), count, target.Objects(), path);
+                    WriteCombined::Fence();
+
+                    CHECK(count == 0 || std::memcmp(target.Base, expected.data(), expected.size()) == 0);
+                    CHECK(target.GuardsIntact());
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(ScatteredPathsAreBitExact)
+{
+    // 写回物体表里分散的槽位：没写到的槽位保持原样
+    const std::size_t tableSize = 200;
+    const std::size_t dstOffsets[] = { 0, 16, 4 };
+
+    for(std::size_t count : Counts)
+    {
+        std::mt19937 rng((std::uint32_t)count + 47);
+        std::vector<std::uint32_t> slots(tableSize);
+        for(std::uint32_t i = 0; i < tableSize; ++i)
+            slots[i] = i;
+        std::shuffle(slots.begin(), slots.end(), rng);
+        slots.resize(count);
+
+        SourceMatrices sources = MakeSources(count, 4, (std::uint32_t)count);
+        std::vector<std::uint8_t> expected(tableSize * sizeof(ObjectConstants), Sentinel);
+        for(std::size_t i = 0; i < count; ++i)
+            ExpectedPacked(sources.Pointers[i], expected.data() + slots[i] * sizeof(ObjectConstants));
+
+        for(std::size_t dstOffset : dstOffsets)
+        {
+            for(SimdPath path : AvailablePaths())
+            {
+                TargetBuffer target(tableSize, dstOffset);
+                PackObjectWorldsScattered(sources.Pointers.data(), count, target.Objects(), slots.data(), path);
+                WriteCombined::Fence();
+
+                CHECK(std::memcmp(target.Base, expected.data(), expected.size()) == 0);
+                CHECK(target.GuardsIntact());
+            }
+        }
+    }
+}
+
+TEST_CASE(PathsAgreeWithEachOther)
+{
+    // 同一批输入，各条路径的输出两两逐位相同（与参考实现无关的交叉检查）
+    const std::size_t count = 1001;
+    SourceMatrices sources = MakeSources(count, 4, 2024);
+    std::vector<SimdPath> paths = AvailablePaths();
+
+    TargetBuffer reference(count, 16);
+    PackObjectWorlds(sources.Pointers.data(), count, reference.Objects(), SimdPath::Scalar);
+    for(SimdPath path : paths)
+    {
+        for(std::size_t dstOffset : { (std::size_t)0, (std::size_t)16 })
+        {
+            TargetBuffer target(count, dstOffset);
+            PackObjectWorlds(sources.Pointers.data(), count, target.Objects(), path);
+            WriteCombined::Fence();
+            CHECK(std::memcmp(target.Base, reference.Base, count * sizeof(ObjectConstants)) == 0);
+        }
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}
@@ -0,0 +1,170 @@
+// 每帧上传量的基准：原来每个物体、每个材质占一个按 256 字节对齐的常量缓冲区槽位
+// （ObjectConstants 128 字节：World + TexTransform 两个 4x4；MaterialConstants 96 字节），
+// 现在按 ShaderShared.h 的布局紧密排列在 StructuredBuffer 里（物体 48 字节的 float3x4，材质 32 字节），
+// 并且物体按更新频率分层（ObjectTierTable）：静态层在默认堆里，每帧只上传变化的动态物体和静态修补。
+// 打印每帧写进上传堆的字节数、写入耗时，以及三个帧资源的上传堆总大小。
+//
+//   UploadLayoutBenchmark [--quick]
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "ObjectTiers.h"
+#include "WriteCombined.h"
+
+namespace
+{
+    // 原来的布局
+    struct PaddedObjectConstants
+    {
+        float World[16];
+        float TexTransform[16];
+    };
+    struct PaddedMaterialConstants
+    {
+        float DiffuseAlbedo[4];
+        float FresnelR0[3];
+        float Roughness;
+        float MatTransform[16];
+    };
+    constexpr std::size_t ConstantBufferSlot = 256;
+
+    // 与 ShaderShared.h 相同的紧密布局（那个头文件依赖 DirectXMath，这里用等大的 float 数组）
+    struct PackedObjectConstants
+    {
+        float World[12];
+    };
+    struct PackedMaterialConstants
+    {
+        float DiffuseAlbedo[4];
+        float FresnelR0[3];
+        float Roughness;
+    };
+    static_assert(sizeof(PackedObjectConstants) == 48, "与 ShaderShared::ObjectConstants 的大小一致");
+    static_assert(sizeof(PackedMaterialConstants) == 32, "与 ShaderShared::MaterialConstants 的大小一致");
+
+    constexpr std::uint32_t FrameCount = 3; // gNumFrameResources
+
+    double Megabytes(double bytes) { return bytes / (1024.0 * 1024.0); }
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::size_t objectCount = quick ? 4096 : 100000;
+    const std::size_t materialCount = quick ? 64 : 1000;
+    const int repeats = quick ? 1 : 10;
+    const double dynamicFraction = 0.1;        // 一成物体每帧都在动
+    const std::size_t staticChangesPerFrame = objectCount / 1000; // 偶尔变化的静态物体
+
+    std::vector<PaddedObjectConstants> paddedObjects(objectCount);
+    std::vector<PackedObjectConstants> packedObjects(objectCount);
+    for(std::size_t i = 0; i < objectCount; ++i)
+    {
+        for(int k = 0; k < 16; ++k)
+            paddedObjects[i].World[k] = paddedObjects[i].TexTransform[k] = (float)(i + k);
+        for(int k = 0; k < 12; ++k)
+            packedObjects[i].World[k] = (float)(i + k);
+    }
+    std::vector<PaddedMaterialConstants> paddedMaterials(materialCount);
+    std::vector<PackedMaterialConstants> packedMaterials(materialCount);
+
+    // 模拟映射的上传堆，按最大的布局分配
+    std::vector<std::uint8_t> mapped(objectCount * ConstantBufferSlot + materialCount * ConstantBufferSlot + 64);
+    std::uint8_t* base = mapped.data() + ((64 - (reinterpret_cast<std::uintptr_t>(mapped.data()) & 63)) & 63);
+
+    std::printf("%zu objects, %zu materials, %u frame resources\n\n", objectCount, materialCount, FrameCount);
+
+    // 1. 所有物体和材质整表上传：原来的 256 字节槽位和紧密排列
+    double paddedMs = Benchmark::BestOfMs(repeats, [&]()
+    {
+        for(std::size_t i = 0; i < objectCount; ++i)
+            std::memcpy(base + i * ConstantBufferSlot, &paddedObjects[i], sizeof(PaddedObjectConstants));
+        std::uint8_t* materialBase = base + objectCount * ConstantBufferSlot;
+        for(std::size_t i = 0; i < materialCount; ++i)
+            std::memcpy(materialBase + i * ConstantBufferSlot, &paddedMaterials[i], sizeof(PaddedMaterialConstants));
+    });
+    double packedMs = Benchmark::BestOfMs(repeats, [&]()
+    {
+        WriteCombined::StreamCopy(base, packedObjects.data(), objectCount * sizeof(PackedObjectConstants));
+        std::uint8_t* materialBase = base + objectCount * sizeof(PackedObjectConstants);
+        WriteCombined::StreamCopy(materialBase, packedMaterials.data(), materialCount * sizeof(PackedMaterialConstants));
+        WriteCombined::Fence();
+    });
+
+    const double paddedBytes = (double)(objectCount + materialCount) * ConstantBufferSlot;
+    const double packedBytes = (double)objectCount * sizeof(PackedObjectConstants) + (double)materialCount * sizeof(PackedMaterialConstants);
+    std::printf("full upload          bytes/frame  upload heap (x%u)  write ms\n", FrameCount);
+    std::printf("256-byte CB slots    %8.2f MB  %12.2f MB  %8.3f\n", Megabytes(paddedBytes), Megabytes(paddedBytes * FrameCount), paddedMs);
+    std::printf("packed structured    %8.2f MB  %12.2f MB  %8.3f\n", Megabytes(packedBytes), Megabytes(packedBytes * FrameCount), packedMs);
+
+    // 2. 分层之后的稳态：动态物体每帧都变（每个帧资源都要重写），少量静态物体变化走修补
+    ObjectTierTable tiers(sizeof(PackedObjectConstants), FrameCount);
+    std::vector<std::uint32_t> objectIndices(objectCount);
+    std::mt19937 rng(44);
+    for(std::size_t i = 0; i < objectCount; ++i)
+    {
+        UpdateFrequency frequency = rng() % 1000 < dynamicFraction * 1000 ? UpdateFrequency::Dynamic : UpdateFrequency::Static;
+        objectIndices[i] = tiers.Add(frequency, (std::uint32_t)i);
+    }
+
+    const int frames = quick ? 6 : 60;
+    std::uint64_t dynamicBytes = 0;
+    std::uint64_t patchBytes = 0;
+    std::uint64_t copyCommands = 0;
+    double tieredMs = 0.0;
+    for(int frame = 0; frame < frames; ++frame)
+    {
+        std::uint32_t frameIndex = (std::uint32_t)frame % FrameCount;
+        for(std::size_t i = 0; i < objectCount; ++i)
+        {
+            if(ObjectIndex::IsDynamic(objectIndices[i]))
+                tiers.MarkChanged(objectIndices[i]);
+        }
+        for(std::size_t k = 0; k < staticChangesPerFrame; ++k)
+        {
+            std::uint32_t index = objectIndices[rng() % objectCount];
+            if(!ObjectIndex::IsDynamic(index))
+                tiers.MarkChanged(index);
+        }
+
+        // 与 Renderer::UpdateObjectData 相同：动态层只写本帧资源的脏槽位，静态修补写进暂存块
+        tieredMs += Benchmark::BestOfMs(1, [&]()
+        {
+            tiers.BuildFramePatches();
+            std::uint8_t* dynamicBase = base;
+            for(std::uint32_t slot : tiers.DynamicDirty(frameIndex))
+                WriteCombined::StreamCopy(dynamicBase + slot * sizeof(PackedObjectConstants),
+                    &packedObjects[tiers.DynamicOwners()[slot]], sizeof(PackedObjectConstants));
+            std::uint8_t* staging = base + tiers.DynamicOwners().size() * sizeof(PackedObjectConstants);
+            const std::vector<std::uint32_t>& patchSlots = tiers.PatchSlots();
+            for(std::size_t i = 0; i < patchSlots.size(); ++i)
+                WriteCombined::StreamCopy(staging + i * sizeof(PackedObjectConstants),
+                    &packedObjects[tiers.StaticOwners()[patchSlots[i]]], sizeof(PackedObjectConstants));
+            WriteCombined::Fence();
+        });
+
+        dynamicBytes += tiers.DynamicDirty(frameIndex).size() * sizeof(PackedObjectConstants);
+        patchBytes += tiers.GetStats().PatchBytes;
+        copyCommands += tiers.GetStats().CopyCommands;
+        tiers.ClearDynamicDirty(frameIndex);
+    }
+
+    const ObjectTierTable::Stats& stats = tiers.GetStats();
+    double tieredBytes = (double)(dynamicBytes + patchBytes) / frames;
+    double tieredHeap = (double)stats.DynamicObjects * sizeof(PackedObjectConstants) * FrameCount;
+    std::printf("\ntiered objects: %llu static (default heap, %.2f MB), %llu dynamic, %zu static changes/frame\n",
+        (unsigned long long)stats.StaticObjects, Megabytes((double)stats.StaticObjects * sizeof(PackedObjectConstants)),
+        (unsigned long long)stats.DynamicObjects, staticChangesPerFrame);
+    std::printf("objects only         bytes/frame  upload heap (x%u)  write ms   copies/frame\n", FrameCount);
+    std::printf("256-byte CB slots    %8.2f MB  %12.2f MB\n", Megabytes((double)objectCount * ConstantBufferSlot),
+        Megabytes((double)objectCount * ConstantBufferSlot * FrameCount));
+    std::printf("packed, all objects  %8.2f MB  %12.2f MB\n", Megabytes((double)objectCount * sizeof(PackedObjectConstants)),
+        Megabytes((double)objectCount * sizeof(PackedObjectConstants) * FrameCount));
+    std::printf("packed, tiered       %8.2f MB  %12.2f MB  %8.3f  %8.1f\n", Megabytes(tieredBytes), Megabytes(tieredHeap),
+        tieredMs / frames, (double)copyCommands / frames);
+
+    Benchmark::DoNotOptimize(base[objectCount * sizeof(PackedObjectConstants) / 2]);
+    return 0;
+}
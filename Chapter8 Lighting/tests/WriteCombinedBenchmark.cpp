@@ -0,0 +1,90 @@
+// 上传写入的微基准：逐元素 memcpy（原来的 UploadBuffer::CopyData）、整段非临时存储，
+// 以及按作业分段、每段一个 UploadWriter 的写法（Renderer::UpdateInstanceData）。
+// 分段写入器比较了两种写法：每段的写入器覆盖整个缓冲区，或者只覆盖自己那一段。
+// 发布版本里两者一样快；WriteCombinedBenchmarkChecked 打开了 Debug 下的重复写入检查，
+// 覆盖整个缓冲区时每段都要分配并清零 N 个标记，总开销是 O(N²/grain)。
+//
+//   WriteCombinedBenchmark [--quick]
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Benchmark.h"
+#include "WriteCombined.h"
+
+namespace
+{
+    // 原来的 ObjectConstants：World 和 TexTransform 两个 4x4 矩阵，128 字节，按 256 字节对齐成常量缓冲区
+    struct ObjectConstants128
+    {
+        float World[16];
+        float TexTransform[16];
+    };
+
+    constexpr std::size_t ConstantBufferStride = 256;
+    constexpr std::size_t GrainSize = 64; // Renderer::ObjectUpdateGrainSize
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = Benchmark::IsQuickRun(argc, argv);
+    const std::size_t count = quick ? 4096 : 100000;
+    const int repeats = quick ? 1 : 20;
+
+    std::vector<ObjectConstants128> objects(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        for(int k = 0; k < 16; ++k)
+        {
+            objects[i].World[k] = (float)(i + k);
+            objects[i].TexTransform[k] = (float)(i * k);
+        }
+    }
+
+    // 模拟映射的上传堆；普通内存上非临时存储同样绕开缓存，数量级可以参考
+    std::vector<std::uint8_t> mapped(count * ConstantBufferStride + 64);
+    std::uint8_t* base = mapped.data() + ((64 - (reinterpret_cast<std::uintptr_t>(mapped.data()) & 63)) & 63);
+
+    std::printf("%zu objects, %zu bytes each, %zu byte stride, debug checks %s\n",
+        count, sizeof(ObjectConstants128), ConstantBufferStride, WC_DEBUG_CHECKS ? "on" : "off");
+
+    double perElement = Benchmark::BestOfMs(repeats, [&]()
+    {
+        for(std::size_t i = 0; i < count; ++i)
+            std::memcpy(base + i * ConstantBufferStride, &objects[i], sizeof(ObjectConstants128));
+    });
+
+    double streamed = Benchmark::BestOfMs(repeats, [&]()
+    {
+        WriteCombined::StreamCopyStrided(base, ConstantBufferStride, objects.data(), sizeof(ObjectConstants128), count);
+        WriteCombined::Fence();
+    });
+
+    double chunkedWhole = Benchmark::BestOfMs(quick ? 1 : 3, [&]()
+    {
+        for(std::size_t first = 0; first < count; first += GrainSize)
+        {
+            std::size_t last = first + GrainSize < count ? first + GrainSize : count;
+            UploadWriter<ObjectConstants128> writer(base, ConstantBufferStride, count);
+            writer.WriteRange(first, &objects[first], last - first);
+        }
+    });
+
+    double chunkedRange = Benchmark::BestOfMs(repeats, [&]()
+    {
+        for(std::size_t first = 0; first < count; first += GrainSize)
+        {
+            std::size_t last = first + GrainSize < count ? first + GrainSize : count;
+            UploadWriter<ObjectConstants128> writer(base, ConstantBufferStride, first, last - first);
+            writer.WriteRange(first, &objects[first], last - first);
+        }
+    });
+
+    double megabytes = count * sizeof(ObjectConstants128) / (1024.0 * 1024.0);
+    std::printf("per-element memcpy        %8.3f ms  %7.1f MB/s\n", perElement, megabytes / (perElement / 1000.0));
+    std::printf("StreamCopyStrided         %8.3f ms  %7.1f MB/s\n", streamed, megabytes / (streamed / 1000.0));
+    std::printf("chunked, whole-buffer     %8.3f ms  %7.1f MB/s\n", chunkedWhole, megabytes / (chunkedWhole / 1000.0));
+    std::printf("chunked, sub-range        %8.3f ms  %7.1f MB/s\n", chunkedRange, megabytes / (chunkedRange / 1000.0));
+
+    Benchmark::DoNotOptimize(base[count * ConstantBufferStride / 2]);
+    return 0;
+}
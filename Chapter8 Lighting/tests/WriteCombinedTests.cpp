@@ -0,0 +1,124 @@
+// WriteCombined / UploadWriter 的单元测试：首尾不对齐的流式复制、跨步复制、只覆盖一段的写入器
+#include <cstring>
+#include <vector>
+#include "WriteCombined.h"
+#include "TestHarness.h"
+
+namespace
+{
+    std::vector<std::uint8_t> Pattern(std::size_t size, std::uint8_t seed)
+    {
+        std::vector<std::uint8_t> bytes(size);
+        for(std::size_t i = 0; i < size; ++i)
+            bytes[i] = (std::uint8_t)(seed + i * 7);
+        return bytes;
+    }
+
+    struct Element
+    {
+        std::uint32_t Value[5]; // 20 字节，不是 16 的倍数
+    };
+
+    Element MakeElement(std::size_t index)
+    {
+        Element e;
+        for(std::uint32_t k = 0; k < 5; ++k)
+            e.Value[k] = (std::uint32_t)(index * 10 + k);
+        return e;
+    }
+}
+
+TEST_CASE(StreamCopyMatchesMemcpyForAnyAlignment)
+{
+    std::vector<std::uint8_t> src = Pattern(512, 3);
+    for(std::size_t dstOffset = 0; dstOffset < 16; ++dstOffset)
+    {
+        for(std::size_t size : { 0, 1, 15, 16, 17, 63, 64, 65, 200, 447 })
+        {
+            std::vector<std::uint8_t> dst(512 + 32, 0xcd);
+            std::vector<std::uint8_t> expected = dst;
+            WriteCombined::StreamCopy(dst.data() + dstOffset, src.data() + 1, size);
+            WriteCombined::Fence();
+            std::memcpy(expected.data() + dstOffset, src.data() + 1, size);
+            CHECK(dst == expected);
+        }
+    }
+}
+
+TEST_CASE(StreamCopyStridedLeavesPaddingUntouched)
+{
+    const std::size_t count = 9;
+    const std::size_t stride = 256;
+    std::vector<Element> src;
+    for(std::size_t i = 0; i < count; ++i)
+        src.push_back(MakeElement(i));
+
+    std::vector<std::uint8_t> dst(stride * count, 0xcd);
+    WriteCombined::StreamCopyStrided(dst.data(), stride, src.data(), sizeof(Element), count);
+    WriteCombined::Fence();
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        CHECK(std::memcmp(dst.data() + i * stride, &src[i], sizeof(Element)) == 0);
+        for(std::size_t b = sizeof(Element); b < stride; ++b)
+            CHECK_EQ(dst[i * stride + b], 0xcd);
+    }
+}
+
+TEST_CASE(WriterUsesBufferIndices)
+{
+    const std::size_t count = 100;
+    std::vector<Element> buffer(count);
+    std::memset(buffer.data(), 0, sizeof(Element) * count);
+
+    // 写入器只负责 [40, 70)，下标仍按整个缓冲区计
+    {
+        UploadWriter<Element> writer(buffer.data(), sizeof(Element), 40, 30);
+        CHECK_EQ(writer.First(), 40u);
+        CHECK_EQ(writer.Count(), 30u);
+
+        writer.Write(40, MakeElement(40));
+        std::vector<Element> range;
+        for(std::size_t i = 41; i < 69; ++i)
+            range.push_back(MakeElement(i));
+        writer.WriteRange(41, range.data(), range.size());
+        writer.Write(69, MakeElement(69));
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        bool inRange = i >= 40 && i < 70;
+        CHECK_EQ(buffer[i].Value[0], inRange ? MakeElement(i).Value[0] : 0u);
+        CHECK_EQ(buffer[i].Value[4], inRange ? MakeElement(i).Value[4] : 0u);
+    }
+}
+
+TEST_CASE(ChunkedWritersCoverTheWholeBuffer)
+{
+    // 和 Renderer::UpdateInstanceData 一样，每段一个只覆盖自己那一段的写入器
+    const std::size_t count = 1000;
+    const std::size_t grain = 64;
+    const std::size_t stride = 32;
+    std::vector<std::uint8_t> buffer(stride * count, 0);
+
+    for(std::size_t first = 0; first < count; first += grain)
+    {
+        std::size_t last = first + grain < count ? first + grain : count;
+        UploadWriter<Element> writer(buffer.data(), stride, first, last - first);
+        for(std::size_t i = first; i < last; ++i)
+            writer.Write(i, MakeElement(i));
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        Element e;
+        std::memcpy(&e, buffer.data() + i * stride, sizeof(Element));
+        Element expected = MakeElement(i);
+        CHECK(std::memcmp(&e, &expected, sizeof(Element)) == 0);
+    }
+}
+
+int main()
+{
+    return RunAllTests();
+}